@@ -57,6 +57,7 @@ public:
     void clearTasks();
 
     bool hasOutstandingTasks() const;
+    size_t numThreads() const;
 
 private:
     friend class Worker;
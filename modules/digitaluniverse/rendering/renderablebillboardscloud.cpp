@@ -494,10 +494,11 @@ RenderableBillboardsCloud::RenderableBillboardsCloud(const ghoul::Dictionary& di
 
         float minValue = std::numeric_limits<float>::max();
         float maxValue = -std::numeric_limits<float>::max();
-        for (const speck::Dataset::Entry& e : _dataset.entries) {
-            float color = e.data[colorMapInUse];
-            minValue = std::min(minValue, color);
-            maxValue = std::max(maxValue, color);
+        if (!_dataset.columns.empty()) {
+            for (float color : _dataset.columns[colorMapInUse]) {
+                minValue = std::min(minValue, color);
+                maxValue = std::max(maxValue, color);
+            }
         }
 
         _optionColorRangeData = glm::vec2(minValue, maxValue);
@@ -513,7 +514,7 @@ RenderableBillboardsCloud::RenderableBillboardsCloud(const ghoul::Dictionary& di
 }
 
 bool RenderableBillboardsCloud::isReady() const {
-    bool isReady = _program && !_dataset.entries.empty();
+    bool isReady = _program && !_dataset.empty();
 
     // If we have labels, they also need to be loaded
     if (_hasLabels) {
@@ -526,7 +527,7 @@ void RenderableBillboardsCloud::initialize() {
     ZoneScoped;
 
     if (_hasSpeckFile) {
-        _dataset = speck::data::loadFileWithCache(_speckFile);
+        _dataset = speck::data::loadMappedFileWithCache(_speckFile);
     }
 
     if (_hasColorMapFile) {
@@ -677,7 +678,7 @@ void RenderableBillboardsCloud::renderBillboards(const RenderData& data,
     _program->setUniform(_uniformCache.useColormap, _useColorMap);
 
     glBindVertexArray(_vao);
-    glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(_dataset.entries.size()));
+    glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(_dataset.size()));
     glBindVertexArray(0);
     _program->deactivate();
 
@@ -881,16 +882,16 @@ void RenderableBillboardsCloud::update(const UpdateData&) {
 std::vector<float> RenderableBillboardsCloud::createDataSlice() {
     ZoneScoped;
 
-    if (_dataset.entries.empty()) {
+    if (_dataset.empty()) {
         return std::vector<float>();
     }
 
     std::vector<float> result;
     if (_hasColorMapFile) {
-        result.reserve(8 * _dataset.entries.size());
+        result.reserve(8 * _dataset.size());
     }
     else {
-        result.reserve(4 * _dataset.entries.size());
+        result.reserve(4 * _dataset.size());
     }
 
     // what datavar in use for the index color
@@ -903,23 +904,23 @@ std::vector<float> RenderableBillboardsCloud::createDataSlice() {
 
     float minColorIdx = std::numeric_limits<float>::max();
     float maxColorIdx = -std::numeric_limits<float>::max();
-    for (const speck::Dataset::Entry& e : _dataset.entries) {
-        if (e.data.size() > 0) {
-            float color = e.data[colorMapInUse];
+    if (!_dataset.columns.empty()) {
+        for (float color : _dataset.columns[colorMapInUse]) {
             minColorIdx = std::min(color, minColorIdx);
             maxColorIdx = std::max(color, maxColorIdx);
-        } else {
-            minColorIdx = 0;
-            maxColorIdx = 0;
         }
     }
+    else {
+        minColorIdx = 0;
+        maxColorIdx = 0;
+    }
 
     double maxRadius = 0.0;
 
     float biggestCoord = -1.f;
-    for (const speck::Dataset::Entry& e : _dataset.entries) {
+    for (size_t i = 0; i < _dataset.size(); i++) {
         glm::vec3 transformedPos = glm::vec3(_transformationMatrix * glm::vec4(
-            e.position, 1.0
+            _dataset.position(i), 1.0
         ));
 
         float unitValue = 0.f;
@@ -965,7 +966,7 @@ std::vector<float> RenderableBillboardsCloud::createDataSlice() {
             biggestCoord = std::max(biggestCoord, glm::compMax(position));
             // Note: if exact colormap option is not selected, the first color and the
             // last color in the colormap file are the outliers colors.
-            float variableColor = e.data[colorMapInUse];
+            float variableColor = _dataset.columns[colorMapInUse][i];
 
             float cmax, cmin;
             if (_colorRangeData.empty()) {
@@ -1028,11 +1029,11 @@ std::vector<float> RenderableBillboardsCloud::createDataSlice() {
             }
 
             if (_hasDatavarSize) {
-                result.push_back(e.data[sizeScalingInUse]);
+                result.push_back(_dataset.columns[sizeScalingInUse][i]);
             }
         }
         else if (_hasDatavarSize) {
-            result.push_back(e.data[sizeScalingInUse]);
+            result.push_back(_dataset.columns[sizeScalingInUse][i]);
             for (int j = 0; j < 4; ++j) {
                 result.push_back(position[j]);
             }
@@ -131,7 +131,7 @@ private:
 
     DistanceUnit _unit = DistanceUnit::Parsec;
 
-    speck::Dataset _dataset;
+    speck::MappedDataset _dataset;
     speck::ColorMap _colorMap;
 
     // Everything related to the labels is handled by LabelsComponent
@@ -26,6 +26,7 @@
 #define __OPENSPACE_MODULE_FITSFILEREADER___FITSFILEREADER___H__
 
 #include <filesystem>
+#include <functional>
 #include <string>
 #include <memory>
 #include <mutex>
@@ -58,6 +59,18 @@ struct TableData {
     std::string name;
 };
 
+/**
+ * A range of rows from a FITS table, as read by `FitsFileReader::readTableInChunks()`.
+ */
+struct TableChunk {
+    /// The first row of the chunk, counted from 1 like in the FITS file
+    long long firstRow = 0;
+    /// The number of rows in the chunk
+    long long nRows = 0;
+    /// The values of every requested column, in the order the columns were requested
+    std::vector<std::vector<float>> columns;
+};
+
 class FitsFileReader {
 public:
     FitsFileReader(bool verboseMode);
@@ -83,6 +96,27 @@ public:
         const std::vector<std::string>& columnNames, int startRow = 1, int endRow = 10,
         int hduIdx = 1, bool readAll = false);
 
+    /**
+     * Reads the columns \p columnNames of the table in extension HDU \p hduIdx in
+     * chunks of at most \p rowsPerChunk rows. Only the requested columns are read from
+     * the file. The chunks are spread over \p nThreads threads that each open the file
+     * on their own, and \p onChunk is called on the reading thread as soon as a chunk has
+     * been read. Thus at most \p nThreads chunks are held in memory at the same time,
+     * independent of the size of the table. The chunks are handed out in no particular
+     * order. If the CFITSIO library was not built to be thread-safe, the reads are done
+     * one at a time and only the calls to \p onChunk run in parallel.
+     * If \p lastRow is smaller than \p firstRow, all rows from \p firstRow on are read.
+     *
+     * \return the number of rows that were read
+     * \throw ghoul::RuntimeError if the table or one of the columns could not be read,
+     *        or if \p onChunk threw an exception
+     */
+    long long readTableInChunks(const std::filesystem::path& path,
+        const std::vector<std::string>& columnNames,
+        const std::function<void(const TableChunk&)>& onChunk, long long firstRow = 1,
+        long long lastRow = 0, long long rowsPerChunk = 1 << 16, int nThreads = 1,
+        int hduIdx = 1);
+
     /**
      * Reads a single FITS file with pre-defined columns (defined for Viennas TGAS-file).
      * Returns a vector with all read stars with `nValuesPerStar`.
@@ -28,7 +28,11 @@
 #include <ghoul/fmt.h>
 #include <ghoul/logging/logmanager.h>
 #include <ghoul/misc/dictionary.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <fstream>
+#include <thread>
 
 #ifdef WIN32
 #pragma warning (push)
@@ -38,6 +42,7 @@
 #endif // WIN32
 
 #include <CCfits>
+#include <fitsio.h>
 
 #ifdef WIN32
 #pragma warning (pop)
@@ -48,6 +53,12 @@ using namespace CCfits;
 
 namespace {
     constexpr std::string_view _loggerCat = "FitsFileReader";
+
+    std::string fitsErrorMessage(int status) {
+        std::array<char, FLEN_STATUS> text = {};
+        fits_get_errstatus(status, text.data());
+        return std::string(text.data());
+    }
 } // namespace
 
 namespace openspace {
@@ -192,6 +203,167 @@ std::shared_ptr<TableData<T>> FitsFileReader::readTable(const std::filesystem::p
     return nullptr;
 }
 
+long long FitsFileReader::readTableInChunks(const std::filesystem::path& path,
+                                          const std::vector<std::string>& columnNames,
+                                const std::function<void(const TableChunk&)>& onChunk,
+                                                long long firstRow, long long lastRow,
+                                                 long long rowsPerChunk, int nThreads,
+                                                                           int hduIdx)
+{
+    const std::string fileName = path.string();
+
+    // Opens the file and moves to the table. CFITSIO counts the primary HDU as 1
+    auto openTable = [&fileName, hduIdx](int& status) {
+        fitsfile* file = nullptr;
+        fits_open_file(&file, fileName.c_str(), READONLY, &status);
+        int hduType = 0;
+        fits_movabs_hdu(file, hduIdx + 1, &hduType, &status);
+        if (status == 0 && hduType == IMAGE_HDU) {
+            status = NOT_TABLE;
+        }
+        return file;
+    };
+    auto closeTable = [](fitsfile* file) {
+        if (file) {
+            int status = 0;
+            fits_close_file(file, &status);
+        }
+    };
+
+    // Look up the row count and the column numbers once. Only these columns are read
+    int status = 0;
+    LONGLONG nRowsInTable = 0;
+    std::vector<int> columnNumbers(columnNames.size(), 0);
+    {
+        std::lock_guard lock(_mutex);
+        fitsfile* table = openTable(status);
+        fits_get_num_rowsll(table, &nRowsInTable, &status);
+        for (size_t i = 0; i < columnNames.size(); ++i) {
+            // CFITSIO takes the column name as a mutable template
+            std::string name = columnNames[i];
+            fits_get_colnum(table, CASEINSEN, name.data(), &columnNumbers[i], &status);
+        }
+        closeTable(table);
+    }
+    if (status != 0) {
+        throw ghoul::RuntimeError(fmt::format(
+            "Could not read FITS table from file '{}': {}", path, fitsErrorMessage(status)
+        ));
+    }
+
+    firstRow = std::max(firstRow, 1LL);
+    if (lastRow < firstRow || lastRow > nRowsInTable) {
+        lastRow = nRowsInTable;
+    }
+    if (firstRow > lastRow) {
+        return 0;
+    }
+    rowsPerChunk = std::max(rowsPerChunk, 1LL);
+    const long long nRows = lastRow - firstRow + 1;
+    const long long nChunks = (nRows + rowsPerChunk - 1) / rowsPerChunk;
+    nThreads = static_cast<int>(std::clamp<long long>(nThreads, 1, nChunks));
+
+    // A CFITSIO library that isn't thread-safe shares its buffers between all open files,
+    // so then the reads have to be serialized with every other use of the library
+    const bool isReentrant = fits_is_reentrant() != 0;
+    std::atomic<long long> nextChunk = 0;
+    std::atomic_bool hasFailed = false;
+    std::mutex errorMutex;
+    std::string error;
+
+    auto readChunks = [&]() {
+        int readStatus = 0;
+        fitsfile* file = nullptr;
+        {
+            std::unique_lock lock(_mutex, std::defer_lock);
+            if (!isReentrant) {
+                lock.lock();
+            }
+            file = openTable(readStatus);
+        }
+
+        // The chunk is reused, so each thread only ever holds one chunk in memory
+        TableChunk chunk;
+        chunk.columns.resize(columnNames.size());
+        try {
+            for (long long c = nextChunk++; c < nChunks; c = nextChunk++) {
+                if (readStatus != 0 || hasFailed) {
+                    break;
+                }
+
+                chunk.firstRow = firstRow + c * rowsPerChunk;
+                chunk.nRows = std::min(rowsPerChunk, lastRow - chunk.firstRow + 1);
+                {
+                    std::unique_lock lock(_mutex, std::defer_lock);
+                    if (!isReentrant) {
+                        lock.lock();
+                    }
+                    for (size_t i = 0; i < chunk.columns.size(); ++i) {
+                        std::vector<float>& column = chunk.columns[i];
+                        column.resize(chunk.nRows);
+                        // Without a null value, undefined values are returned as NaN
+                        int anyNull = 0;
+                        fits_read_col(
+                            file,
+                            TFLOAT,
+                            columnNumbers[i],
+                            chunk.firstRow,
+                            1,
+                            chunk.nRows,
+                            nullptr,
+                            column.data(),
+                            &anyNull,
+                            &readStatus
+                        );
+                    }
+                }
+
+                if (readStatus == 0) {
+                    onChunk(chunk);
+                }
+            }
+        }
+        catch (const std::exception& e) {
+            std::lock_guard lock(errorMutex);
+            hasFailed = true;
+            if (error.empty()) {
+                error = e.what();
+            }
+        }
+
+        if (readStatus != 0) {
+            std::lock_guard lock(errorMutex);
+            hasFailed = true;
+            if (error.empty()) {
+                error = fitsErrorMessage(readStatus);
+            }
+        }
+
+        std::unique_lock lock(_mutex, std::defer_lock);
+        if (!isReentrant) {
+            lock.lock();
+        }
+        closeTable(file);
+    };
+
+    // The calling thread reads chunks as well
+    std::vector<std::thread> threads;
+    for (int i = 1; i < nThreads; ++i) {
+        threads.emplace_back(readChunks);
+    }
+    readChunks();
+    for (std::thread& t : threads) {
+        t.join();
+    }
+
+    if (hasFailed) {
+        throw ghoul::RuntimeError(fmt::format(
+            "Could not read FITS table from file '{}': {}", path, error
+        ));
+    }
+    return nRows;
+}
+
 std::vector<float> FitsFileReader::readFitsFile(std::filesystem::path filePath,
                                                 int& nValuesPerStar, int firstRow,
                                                 int lastRow,
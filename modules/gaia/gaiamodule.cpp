@@ -26,20 +26,34 @@
 
 #include <modules/gaia/tasks/constructoctreetask.h>
 #include <modules/gaia/rendering/renderablegaiastars.h>
+#include <modules/gaia/tasks/octreetraversalbenchmarktask.h>
 #include <modules/gaia/tasks/readfitstask.h>
 #include <modules/gaia/tasks/readspecktask.h>
 #include <openspace/documentation/documentation.h>
 #include <openspace/rendering/renderable.h>
 #include <openspace/scripting/lualibrary.h>
 #include <openspace/util/factorymanager.h>
+#include <openspace/util/threadpool.h>
 #include <ghoul/filesystem/filesystem.h>
 #include <ghoul/misc/assert.h>
+#include <algorithm>
+#include <thread>
 
 namespace openspace {
 
 GaiaModule::GaiaModule() : OpenSpaceModule(Name) {}
 
+GaiaModule::~GaiaModule() = default;
+
 void GaiaModule::internalInitialize(const ghoul::Dictionary&) {
+    // The render thread takes part in the culling, so one thread fewer than the number
+    // of cores is needed
+    const int nCullingThreads = std::max(
+        static_cast<int>(std::thread::hardware_concurrency()) - 1,
+        0
+    );
+    _cullingThreadPool = std::make_unique<ThreadPool>(nCullingThreads);
+
     ghoul::TemplateFactory<Renderable>* fRenderable =
         FactoryManager::ref().factory<Renderable>();
     ghoul_assert(fRenderable, "No renderable factory existed");
@@ -50,6 +64,7 @@ void GaiaModule::internalInitialize(const ghoul::Dictionary&) {
     fTask->registerClass<ReadFitsTask>("ReadFitsTask");
     fTask->registerClass<ReadSpeckTask>("ReadSpeckTask");
     fTask->registerClass<ConstructOctreeTask>("ConstructOctreeTask");
+    fTask->registerClass<OctreeTraversalBenchmarkTask>("OctreeTraversalBenchmarkTask");
 }
 
 std::vector<documentation::Documentation> GaiaModule::documentations() const {
@@ -58,9 +73,14 @@ std::vector<documentation::Documentation> GaiaModule::documentations() const {
         ReadFitsTask::Documentation(),
         ReadSpeckTask::Documentation(),
         ConstructOctreeTask::Documentation(),
+        OctreeTraversalBenchmarkTask::Documentation(),
     };
 }
 
+ThreadPool* GaiaModule::cullingThreadPool() {
+    return _cullingThreadPool.get();
+}
+
 scripting::LuaLibrary GaiaModule::luaLibrary() const {
     return {
         .name = "gaia",
@@ -28,21 +28,31 @@
 #include <openspace/util/openspacemodule.h>
 
 #include <openspace/documentation/documentation.h>
+#include <memory>
 
 namespace openspace {
 
+class ThreadPool;
+
 class GaiaModule : public OpenSpaceModule {
 public:
     constexpr static const char* Name = "Gaia";
 
     GaiaModule();
-    ~GaiaModule() override = default;
+    ~GaiaModule() override;
 
     std::vector<documentation::Documentation> documentations() const override;
     scripting::LuaLibrary luaLibrary() const override;
 
+    /**
+     * Returns the thread pool that is used to cull the octrees of all Gaia renderables.
+     */
+    ThreadPool* cullingThreadPool();
+
 private:
     void internalInitialize(const ghoul::Dictionary&) override;
+
+    std::unique_ptr<ThreadPool> _cullingThreadPool;
 };
 
 } // namespace openspace
@@ -24,8 +24,12 @@
 
 #include <modules/gaia/rendering/octreeculler.h>
 
+#include <openspace/util/distanceconstants.h>
 #include <ghoul/glm.h>
 #include <ghoul/logging/logmanager.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 namespace openspace {
 
@@ -40,6 +44,16 @@ namespace {
         bb.min = glm::min(bb.min, p);
         bb.max = glm::max(bb.max, p);
     }
+
+    // Transforms a corner into clipping space and divides it by the absolute w. The
+    // columns are summed in the same order as in the matrix-vector product of glm, so the
+    // single node and the batch paths give bit-identical results
+    glm::dvec3 projectCorner(const glm::dmat4& mvp, double x, double y, double z,
+                             double w)
+    {
+        const glm::dvec4 clip = (mvp[0] * x + mvp[1] * y) + (mvp[2] * z + mvp[3] * w);
+        return glm::dvec3((1.0 / std::abs(clip.w)) * clip);
+    }
 } // namespace
 
 OctreeCuller::OctreeCuller(globebrowsing::AABB3 viewFrustum)
@@ -73,9 +87,65 @@ void OctreeCuller::createNodeBounds(const std::vector<glm::dvec4>& corners,
     _nodeBounds = globebrowsing::AABB3();
 
     for (size_t i = 0; i < 8; ++i) {
-        glm::dvec4 cornerClippingSpace = mvp * corners[i];
-        glm::dvec4 ndc = (1.f / glm::abs(cornerClippingSpace.w)) * cornerClippingSpace;
-        expand(_nodeBounds, glm::dvec3(ndc));
+        const glm::dvec4& c = corners[i];
+        expand(_nodeBounds, projectCorner(mvp, c.x, c.y, c.z, c.w));
+    }
+}
+
+void OctreeCuller::cullBatch(const NodeBatch& batch, const glm::dmat4& mvp,
+                             const glm::vec2& screenSize, BatchResult& result) const
+{
+    constexpr size_t N = BatchSize;
+    std::array<float, N> minX;
+    std::array<float, N> minY;
+    std::array<float, N> minZ;
+    std::array<float, N> maxX;
+    std::array<float, N> maxY;
+    std::array<float, N> maxZ;
+    minX.fill(std::numeric_limits<float>::max());
+    minY.fill(std::numeric_limits<float>::max());
+    minZ.fill(std::numeric_limits<float>::max());
+    maxX.fill(-std::numeric_limits<float>::max());
+    maxY.fill(-std::numeric_limits<float>::max());
+    maxZ.fill(-std::numeric_limits<float>::max());
+
+    // Same corner order and float arithmetic as in OctreeManager. Multiplying the half
+    // dimension by +-1 is exact, so this equals adding or subtracting it
+    for (int i = 0; i < 8; ++i) {
+        const float dx = (i % 2 == 0) ? 1.f : -1.f;
+        const float dy = (i % 4 < 2) ? 1.f : -1.f;
+        const float dz = (i < 4) ? 1.f : -1.f;
+
+        for (size_t j = 0; j < N; ++j) {
+            const float x = batch.originX[j] + dx * batch.halfDimension[j];
+            const float y = batch.originY[j] + dy * batch.halfDimension[j];
+            const float z = batch.originZ[j] + dz * batch.halfDimension[j];
+            const glm::vec3 ndc = projectCorner(
+                mvp,
+                static_cast<double>(x) * 1000.0 * distanceconstants::Parsec,
+                static_cast<double>(y) * 1000.0 * distanceconstants::Parsec,
+                static_cast<double>(z) * 1000.0 * distanceconstants::Parsec,
+                1.0
+            );
+            minX[j] = std::min(minX[j], ndc.x);
+            minY[j] = std::min(minY[j], ndc.y);
+            minZ[j] = std::min(minZ[j], ndc.z);
+            maxX[j] = std::max(maxX[j], ndc.x);
+            maxY[j] = std::max(maxY[j], ndc.y);
+            maxZ[j] = std::max(maxZ[j], ndc.z);
+        }
+    }
+
+    for (size_t j = 0; j < N; ++j) {
+        globebrowsing::AABB3 nodeBounds;
+        nodeBounds.min = glm::vec3(minX[j], minY[j], minZ[j]);
+        nodeBounds.max = glm::vec3(maxX[j], maxY[j], maxZ[j]);
+        result.isVisible[j] = intersects(_viewFrustum, nodeBounds);
+
+        // Screen space is mapped to [-1, 1] so divide by 2 and multiply with screen size.
+        const float sizeX = std::abs((maxX[j] - minX[j]) / 2.f) * screenSize.x;
+        const float sizeY = std::abs((maxY[j] - minY[j]) / 2.f) * screenSize.y;
+        result.totalPixels[j] = sizeX * sizeY;
     }
 }
 
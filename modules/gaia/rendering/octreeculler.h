@@ -26,6 +26,7 @@
 #define __OPENSPACE_MODULE_GAIA___OCTREECULLER___H__
 
 #include <modules/globebrowsing/src/basictypes.h>
+#include <array>
 #include <vector>
 
 // TODO: Move /geometry/* to libOpenSpace so as not to depend on globebrowsing.
@@ -41,6 +42,25 @@ namespace openspace {
 
 class OctreeCuller {
 public:
+    /// The number of nodes that are tested together by `cullBatch()`
+    static constexpr size_t BatchSize = 16;
+
+    /**
+     * A batch of octree nodes stored as a structure of arrays. The origins and half
+     * dimensions are given in kPc, as they are stored in the octree.
+     */
+    struct NodeBatch {
+        std::array<float, BatchSize> originX = {};
+        std::array<float, BatchSize> originY = {};
+        std::array<float, BatchSize> originZ = {};
+        std::array<float, BatchSize> halfDimension = {};
+    };
+
+    struct BatchResult {
+        std::array<bool, BatchSize> isVisible;
+        /// The area [in pixels] that each node covers in clipping space
+        std::array<float, BatchSize> totalPixels;
+    };
 
     /**
      * \param viewFrustum is the view space in normalized device coordinates space.
@@ -61,6 +81,17 @@ public:
     glm::vec2 getNodeSizeInPixels(const std::vector<glm::dvec4>& corners,
         const glm::dmat4& mvp, const glm::vec2& screenSize);
 
+    /**
+     * Tests all nodes in \p batch against the view frustum and calculates the area they
+     * cover on screen. The results are identical to calling `isVisible()` and
+     * `getNodeSizeInPixels()` with the corners of every node, but each corner is
+     * projected for all nodes of the batch at once so that the loops can be vectorized.
+     * Contrary to the other functions, this one may be called from several threads at
+     * the same time.
+     */
+    void cullBatch(const NodeBatch& batch, const glm::dmat4& mvp,
+        const glm::vec2& screenSize, BatchResult& result) const;
+
 private:
     /**
      * Creates an axis-aligned bounding box containing all \p corners in clipping space.
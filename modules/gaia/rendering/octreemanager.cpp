@@ -25,28 +25,55 @@
 #include <modules/gaia/rendering/octreemanager.h>
 
 #include <modules/gaia/rendering/octreeculler.h>
+#include <modules/gaia/rendering/starquantization.h>
 #include <openspace/util/distanceconstants.h>
+#include <openspace/util/threadpool.h>
 #include <ghoul/fmt.h>
 #include <ghoul/glm.h>
 #include <ghoul/logging/logmanager.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
 #include <fstream>
+#include <latch>
+#include <mutex>
+#include <numeric>
 #include <thread>
 
 namespace {
     constexpr std::string_view _loggerCat = "OctreeManager";
+
+    // The root is the first node of the node array, directly followed by its children
+    constexpr uint32_t RootNode = 0;
+    constexpr uint32_t FirstBranch = 1;
+
+    // Child sequences with fewer stars than this are built by the thread that produced
+    // them, as handing them to another thread would cost more than building them
+    constexpr size_t MinStarsPerBulkInsertJob = 1 << 16;
+
+    // Number of threads that read node files while streaming
+    constexpr int NodeLoaderThreads = 4;
+
+    // Number of culling batches that one thread claims at a time
+    constexpr size_t CullingBatchesPerJob = 16;
+
+    // Below this number of nodes in a level, the overhead of waking up the worker threads
+    // is larger than the time it takes to cull the level on the calling thread
+    constexpr size_t ParallelCullingThreshold = 4 * CullingBatchesPerJob *
+                                                openspace::OctreeCuller::BatchSize;
 } // namespace
 
 namespace openspace {
 
 void OctreeManager::initOctree(long long cpuRamBudget, int maxDist, int maxStarsPerNode) {
-    if (_root) {
+    if (!_store.nodes.empty()) {
         LDEBUG("Clear existing Octree");
-        clearAllData();
+        _store.nodes.clear();
     }
 
     LDEBUG("Initializing new Octree");
-    _root = std::make_shared<OctreeNode>();
-    _root->octreePositionIndex = 8;
 
     // Initialize the culler. The NDC.z of the comparing corners are always -1 or 1.
     globebrowsing::AABB3 box;
@@ -54,7 +81,9 @@ void OctreeManager::initOctree(long long cpuRamBudget, int maxDist, int maxStars
     box.max = glm::vec3(1.f, 1.f, 100.f);
     _culler = std::make_unique<OctreeCuller>(box);
     _removedKeysInPrevCall = std::set<int>();
-    _leastRecentlyFetchedNodes = std::queue<unsigned long long>();
+    _nodeLoader = nullptr;
+    _requestedNodes.clear();
+    _loadedNodes.clear();
 
     // Reset default values when rebuilding the Octree during runtime.
     _numInnerNodes = 0;
@@ -72,30 +101,27 @@ void OctreeManager::initOctree(long long cpuRamBudget, int maxDist, int maxStars
         MAX_STARS_PER_NODE = static_cast<size_t>(maxStarsPerNode);
     }
 
-    for (size_t i = 0; i < 8; ++i) {
-        _numLeafNodes++;
-        _root->Children[i] = std::make_shared<OctreeNode>();
-        _root->Children[i]->posData = std::vector<float>();
-        _root->Children[i]->colData = std::vector<float>();
-        _root->Children[i]->velData = std::vector<float>();
-        _root->Children[i]->magOrder = std::vector<std::pair<float, size_t>>();
-        _root->Children[i]->isLeaf = true;
-        _root->Children[i]->isLoaded = false;
-        _root->Children[i]->hasLoadedDescendant = false;
-        _root->Children[i]->bufferIndex = DEFAULT_INDEX;
-        _root->Children[i]->octreePositionIndex = 80 + i;
-        _root->Children[i]->numStars = 0;
-        _root->Children[i]->halfDimension = MAX_DIST / 2.f;
-        _root->Children[i]->originX = (i % 2 == 0) ?
-            _root->Children[i]->halfDimension :
-            -_root->Children[i]->halfDimension;
-        _root->Children[i]->originY = (i % 4 < 2) ?
-            _root->Children[i]->halfDimension :
-            -_root->Children[i]->halfDimension;
-        _root->Children[i]->originZ = (i < 4) ?
-            _root->Children[i]->halfDimension :
-            -_root->Children[i]->halfDimension;
-    }
+    // This releases the star data of any previous Octree.
+    _store.stars.configure(MAX_STARS_PER_NODE, POS_SIZE, COL_SIZE, VEL_SIZE);
+
+    // The root itself is never counted, only its 8 children.
+    OctreeNode root = {
+        .originX = 0.f,
+        .originY = 0.f,
+        .originZ = 0.f,
+        .halfDimension = static_cast<float>(MAX_DIST),
+        .octreePositionIndex = 8,
+        .firstChild = 0,
+        .numStars = 0,
+        .bufferIndex = DEFAULT_INDEX,
+        .slab = StarSlabPool::Slab(),
+        .isLeaf = true,
+        .isLoaded = false,
+        .hasLoadedDescendant = false
+    };
+    _store.nodes.push_back(root);
+    initNodeChildren(_store, RootNode);
+    _numLeafNodes = 8;
 }
 
 void OctreeManager::initBufferIndexStack(long long maxNodes, bool useVBO,
@@ -119,16 +145,254 @@ void OctreeManager::initBufferIndexStack(long long maxNodes, bool useVBO,
 void OctreeManager::insert(const std::vector<float>& starValues) {
     size_t index = getChildIndex(starValues[0], starValues[1], starValues[2]);
 
-    insertInNode(*_root->Children[index], starValues);
+    insertInNode(FirstBranch + static_cast<uint32_t>(index), starValues.data());
+}
+
+void OctreeManager::insertBulk(const std::vector<float>& starValues, size_t nThreads) {
+    const size_t nStars = starValues.size() / _valuesPerStar;
+
+    // Partition stars by branch. The order within every branch is kept, as the final
+    // structure of a node only depends on the order in which its stars arrive
+    std::array<std::vector<BulkInsertItem>, 8> branchSequences;
+    std::vector<size_t> starsInFilledBranches;
+    std::array<bool, 8> isBranchEmpty;
+    std::deque<BulkInsertJob> jobs;
+    {
+        // Another branch might be written to files at the same time
+        std::shared_lock lock(_storeMutex);
+        for (size_t i = 0; i < 8; ++i) {
+            const OctreeNode& branch = _store.nodes[FirstBranch + i];
+            isBranchEmpty[i] = branch.isLeaf && branch.numStars == 0;
+        }
+        for (size_t i = 0; i < nStars; ++i) {
+            const float* star = starValues.data() + i * _valuesPerStar;
+            size_t index = getChildIndex(star[0], star[1], star[2]);
+            if (isBranchEmpty[index]) {
+                branchSequences[index].push_back({ i, 1 });
+            }
+            else {
+                starsInFilledBranches.push_back(i);
+            }
+        }
+        for (size_t i = 0; i < 8; ++i) {
+            if (!branchSequences[i].empty()) {
+                jobs.push_back({
+                    .parentJob = NoBulkInsertJob,
+                    .placeholder = FirstBranch + static_cast<uint32_t>(i),
+                    .root = _store.nodes[FirstBranch + i],
+                    .sequence = std::move(branchSequences[i])
+                });
+            }
+        }
+    }
+
+    if (!starsInFilledBranches.empty()) {
+        // Stars that already live in the branch aren't part of any sequence, so fall
+        // back to inserting one star at a time
+        std::lock_guard lock(_storeMutex);
+        for (size_t i : starsInFilledBranches) {
+            insertInNode(
+                FirstBranch + static_cast<uint32_t>(getChildIndex(
+                    starValues[i * _valuesPerStar],
+                    starValues[i * _valuesPerStar + 1],
+                    starValues[i * _valuesPerStar + 2]
+                )),
+                starValues.data() + i * _valuesPerStar
+            );
+        }
+    }
+
+    // Every job builds its subtree into a store of its own, so the jobs never touch the
+    // nodes of the Octree or of each other. The stores are moved into the Octree once
+    // all jobs are done, in the order in which they finished.
+    std::mutex jobMutex;
+    std::condition_variable jobCondition;
+    std::vector<BulkInsertResult> results;
+    size_t nUnfinishedJobs = jobs.size();
+    BulkInsertStats totalStats;
+
+    auto worker = [&]() {
+        BulkInsertStats stats;
+        while (true) {
+            BulkInsertJob job;
+            {
+                std::unique_lock lock(jobMutex);
+                jobCondition.wait(
+                    lock,
+                    [&]() { return !jobs.empty() || nUnfinishedJobs == 0; }
+                );
+                if (jobs.empty()) {
+                    break;
+                }
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+
+            BulkInsertResult result = {
+                .parentJob = job.parentJob,
+                .placeholder = job.placeholder,
+                .store = NodeStore()
+            };
+            result.store.stars.configure(
+                MAX_STARS_PER_NODE,
+                POS_SIZE,
+                COL_SIZE,
+                VEL_SIZE
+            );
+            result.store.nodes.push_back(job.root);
+
+            std::vector<BulkInsertJob> deferredJobs;
+            insertSequenceInNode(
+                result.store,
+                0,
+                starValues,
+                std::move(job.sequence),
+                MinStarsPerBulkInsertJob,
+                stats,
+                deferredJobs
+            );
+
+            {
+                std::lock_guard lock(jobMutex);
+                const size_t jobIndex = results.size();
+                results.push_back(std::move(result));
+                for (BulkInsertJob& deferred : deferredJobs) {
+                    deferred.parentJob = jobIndex;
+                    jobs.push_back(std::move(deferred));
+                }
+                nUnfinishedJobs += deferredJobs.size();
+                nUnfinishedJobs--;
+            }
+            jobCondition.notify_all();
+        }
+
+        std::lock_guard lock(jobMutex);
+        totalStats.totalDepth = std::max(totalStats.totalDepth, stats.totalDepth);
+        totalStats.numLeafNodes += stats.numLeafNodes;
+        totalStats.numInnerNodes += stats.numInnerNodes;
+    };
+
+    if (nThreads == 0) {
+        nThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    std::vector<std::thread> workers;
+    workers.reserve(nThreads);
+    for (size_t i = 0; i < nThreads; ++i) {
+        workers.emplace_back(worker);
+    }
+    for (std::thread& t : workers) {
+        t.join();
+    }
+
+    std::lock_guard lock(_storeMutex);
+    spliceBulkInsertResults(results);
+
+    _totalDepth = std::max(_totalDepth, totalStats.totalDepth);
+    _numLeafNodes += totalStats.numLeafNodes;
+    _numInnerNodes += totalStats.numInnerNodes;
+}
+
+void OctreeManager::spliceBulkInsertResults(std::vector<BulkInsertResult>& results) {
+    size_t nNodes = _store.nodes.size();
+    for (const BulkInsertResult& result : results) {
+        nNodes += result.store.nodes.size() - 1;
+    }
+    _store.nodes.reserve(nNodes);
+
+    // The index in the Octree of the second node of every result. The first node of a
+    // result replaces its placeholder instead.
+    std::vector<uint32_t> offsets(results.size());
+    for (size_t r = 0; r < results.size(); ++r) {
+        BulkInsertResult& result = results[r];
+        const uint32_t offset = static_cast<uint32_t>(_store.nodes.size());
+        offsets[r] = offset;
+
+        const uint32_t rootIndex = (result.parentJob == NoBulkInsertJob) ?
+            result.placeholder :
+            offsets[result.parentJob] + result.placeholder - 1;
+
+        for (size_t i = 0; i < result.store.nodes.size(); ++i) {
+            OctreeNode node = result.store.nodes[i];
+            if (!node.isLeaf) {
+                node.firstChild = offset + node.firstChild - 1;
+            }
+            if (node.slab.isValid()) {
+                node.slab = _store.stars.copy(
+                    result.store.stars,
+                    node.slab,
+                    node.numStars,
+                    node.numStars
+                );
+            }
+
+            if (i == 0) {
+                _store.nodes[rootIndex] = node;
+            }
+            else {
+                _store.nodes.push_back(node);
+            }
+        }
+
+        // Release the memory of the subtree right away
+        result.store = NodeStore();
+    }
 }
 
 void OctreeManager::sliceLodData(size_t branchIndex) {
+    std::lock_guard lock(_storeMutex);
+
+    // Collect all nodes of the branch(es) that should be sliced
+    std::vector<uint32_t> nodes;
+    std::vector<uint32_t> innerNodes;
+    std::vector<uint32_t> stack;
     if (branchIndex != 8) {
-        sliceNodeLodCache(*_root->Children[branchIndex]);
+        stack.push_back(FirstBranch + static_cast<uint32_t>(branchIndex));
     }
     else {
-        for (int i = 0; i < 7; ++i) {
-            sliceNodeLodCache(*_root->Children[i]);
+        for (uint32_t i = 0; i < 8; ++i) {
+            stack.push_back(FirstBranch + i);
+        }
+    }
+    while (!stack.empty()) {
+        const uint32_t nodeIndex = stack.back();
+        stack.pop_back();
+        const OctreeNode& node = _store.nodes[nodeIndex];
+        nodes.push_back(nodeIndex);
+        if (!node.isLeaf) {
+            innerNodes.push_back(nodeIndex);
+            for (uint32_t i = 0; i < 8; ++i) {
+                stack.push_back(node.firstChild + i);
+            }
+        }
+    }
+
+    // Slicing only moves data within the slab of each node, so the nodes can be sliced
+    // on any number of threads
+    std::atomic_size_t nextNode = 0;
+    auto worker = [&]() {
+        for (size_t i = nextNode++; i < innerNodes.size(); i = nextNode++) {
+            sliceNodeLodCache(_store.nodes[innerNodes[i]]);
+        }
+    };
+    const size_t nThreads = std::min<size_t>(
+        std::max(std::thread::hardware_concurrency(), 1u),
+        innerNodes.size()
+    );
+    std::vector<std::thread> sliceThreads;
+    for (size_t i = 1; i < nThreads; ++i) {
+        sliceThreads.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& t : sliceThreads) {
+        t.join();
+    }
+
+    // Move the sliced LOD caches, and the stars of leaves that are not full, to slabs
+    // that fit them
+    for (uint32_t nodeIndex : nodes) {
+        OctreeNode& node = _store.nodes[nodeIndex];
+        if (node.slab.isValid()) {
+            resizeSlab(_store.stars, node, node.numStars);
         }
     }
 }
@@ -138,7 +402,7 @@ void OctreeManager::printStarsPerNode() const {
 
     for (int i = 0; i < 8; ++i) {
         std::string prefix = "{" + std::to_string(i);
-        accumulatedString += printStarsPerNode(*_root->Children[i], prefix);
+        accumulatedString += printStarsPerNode(_store.nodes[FirstBranch + i], prefix);
     }
     LINFO(fmt::format("Number of stars per node: \n{}", accumulatedString));
     LINFO(fmt::format("Number of leaf nodes: {}", std::to_string(_numLeafNodes)));
@@ -147,42 +411,34 @@ void OctreeManager::printStarsPerNode() const {
 }
 
 void OctreeManager::fetchSurroundingNodes(const glm::dvec3& cameraPos,
-                                          size_t chunkSizeInBytes,
                                           const glm::ivec2& additionalNodes)
 {
+    // Node data is only ever changed here, on the same thread as the traversal. The I/O
+    // threads of the node loader never touch the Octree itself.
+    installLoadedNodes();
+
+    glm::vec3 fCameraPos = static_cast<glm::vec3>(
+        cameraPos / (1000.0 * distanceconstants::Parsec)
+    );
 
     // If entire dataset fits in RAM then load the entire dataset asynchronously now.
     // Nodes will be rendered when they've been made available.
     if (_datasetFitInMemory) {
         // Only traverse Octree once!
         if (_parentNodeOfCamera == 8) {
-            // Fetch first layer of children
-            fetchChildrenNodes(*_root, 0);
-
-            for (int i = 0; i < 8; ++i) {
-                // Check so branch doesn't have a single layer.
-                if (_root->Children[i]->isLeaf) {
-                    continue;
-                }
-
-                // Use multithreading to load files and detach thread from main execution
-                // so it can execute independently. Thread will be destroyed when
-                // finished!
-                std::thread([this, n = _root->Children[i]]() {
-                    fetchChildrenNodes(*n, -1);
-                }).detach();
-            }
+            // Request all nodes, the ones closest to the camera will be read first.
+            fetchChildrenNodes(_store.nodes[RootNode], -1, fCameraPos);
             _parentNodeOfCamera = 0;
         }
         return;
     }
 
+    // Check if we should remove any nodes from RAM.
+    removeNodesFromRam();
+
     // Get leaf node in which the camera resides.
-    glm::vec3 fCameraPos = static_cast<glm::vec3>(
-        cameraPos / (1000.0 * distanceconstants::Parsec)
-    );
     size_t idx = getChildIndex(fCameraPos.x, fCameraPos.y, fCameraPos.z);
-    std::shared_ptr<OctreeNode> node = _root->Children[idx];
+    const OctreeNode* node = &_store.nodes[FirstBranch + idx];
 
     while (!node->isLeaf) {
         idx = getChildIndex(
@@ -193,7 +449,7 @@ void OctreeManager::fetchSurroundingNodes(const glm::dvec3& cameraPos,
             node->originY,
             node->originZ
         );
-        node = node->Children[idx];
+        node = &_store.nodes[node->firstChild + idx];
     }
     unsigned long long leafId = node->octreePositionIndex;
     unsigned long long firstParentId = leafId / 10;
@@ -205,6 +461,13 @@ void OctreeManager::fetchSurroundingNodes(const glm::dvec3& cameraPos,
     }
     _parentNodeOfCamera = firstParentId;
 
+    // Requests for the previous surroundings that haven't been started yet are no longer
+    // needed. Release their reserved RAM, the ones still needed are requested again.
+    for (unsigned long long id : _nodeLoader->clearQueue()) {
+        _requestedNodes.erase(id);
+        _cpuRamBudget += nodeSizeInBytes(_store.nodes[findNode(id)]);
+    }
+
     // Each parent level may be root, make sure to propagate it in that case!
     unsigned long long secondParentId = (firstParentId == 8) ? 8 : leafId / 100;
     unsigned long long thirdParentId = (secondParentId == 8) ? 8 : leafId / 1000;
@@ -229,7 +492,8 @@ void OctreeManager::fetchSurroundingNodes(const glm::dvec3& cameraPos,
                     x,
                     y,
                     z,
-                    additionalLevelsToFetch
+                    additionalLevelsToFetch,
+                    fCameraPos
                 );
                 // Fetch LOD stars from 208 parents one and two layer(s) up.
                 if (x != 0 || y != 0 || z != 0) {
@@ -239,7 +503,8 @@ void OctreeManager::fetchSurroundingNodes(const glm::dvec3& cameraPos,
                             x,
                             y,
                             z,
-                            additionalLevelsToFetch
+                            additionalLevelsToFetch,
+                            fCameraPos
                         );
                     }
                     if (additionalNodes.x > 1) {
@@ -248,7 +513,8 @@ void OctreeManager::fetchSurroundingNodes(const glm::dvec3& cameraPos,
                             x,
                             y,
                             z,
-                            additionalLevelsToFetch
+                            additionalLevelsToFetch,
+                            fCameraPos
                         );
                     }
                     if (additionalNodes.x > 2) {
@@ -257,7 +523,8 @@ void OctreeManager::fetchSurroundingNodes(const glm::dvec3& cameraPos,
                             x,
                             y,
                             z,
-                            additionalLevelsToFetch
+                            additionalLevelsToFetch,
+                            fCameraPos
                         );
                     }
                     if (additionalNodes.x > 3) {
@@ -266,42 +533,26 @@ void OctreeManager::fetchSurroundingNodes(const glm::dvec3& cameraPos,
                             x,
                             y,
                             z,
-                            additionalLevelsToFetch
+                            additionalLevelsToFetch,
+                            fCameraPos
                         );
                     }
                 }
             }
         }
     }
-
-    // Check if we should remove any nodes from RAM.
-    long long tenthOfRamBudget = _maxCpuRamBudget / 10;
-    if (_cpuRamBudget < tenthOfRamBudget) {
-        long long bytesToTenthOfRam = tenthOfRamBudget - _cpuRamBudget;
-        size_t nNodesToRemove = static_cast<size_t>(bytesToTenthOfRam / chunkSizeInBytes);
-        std::vector<unsigned long long> nodesToRemove;
-        while (nNodesToRemove > 0) {
-            // Dequeue nodes that were least recently fetched by findAndFetchNeighborNode.
-            nodesToRemove.push_back(_leastRecentlyFetchedNodes.front());
-            _leastRecentlyFetchedNodes.pop();
-            nNodesToRemove--;
-        }
-        // Use asynchronous removal.
-        if (!nodesToRemove.empty()) {
-            std::thread(&OctreeManager::removeNodesFromRam, this, nodesToRemove).detach();
-        }
-    }
 }
 
 void OctreeManager::findAndFetchNeighborNode(unsigned long long firstParentId, int x,
-                                             int y, int z, int additionalLevelsToFetch)
+                                             int y, int z, int additionalLevelsToFetch,
+                                             const glm::vec3& cameraPos)
 {
     unsigned long long parentId = firstParentId;
     std::stack<int> indexStack;
 
     // Fetch first layer children if we're already at root.
     if (parentId == 8) {
-        fetchChildrenNodes(*_root, 0);
+        fetchChildrenNodes(_store.nodes[RootNode], 0, cameraPos);
         return;
     }
 
@@ -377,28 +628,34 @@ void OctreeManager::findAndFetchNeighborNode(unsigned long long firstParentId, i
     }
 
     // Traverse to that parent node (as long as such a child exists!).
-    std::shared_ptr<OctreeNode> node = _root;
-    while (!indexStack.empty() && !node->Children[indexStack.top()]->isLeaf) {
-        node = node->Children[indexStack.top()];
-        node->hasLoadedDescendant = true;
+    uint32_t node = RootNode;
+    while (!indexStack.empty() &&
+           !_store.nodes[_store.nodes[node].firstChild + indexStack.top()].isLeaf)
+    {
+        node = _store.nodes[node].firstChild + indexStack.top();
         indexStack.pop();
     }
 
-    // Fetch all children nodes from found parent. Use multithreading to load files
-    // asynchronously! Detach thread from main execution so it can execute independently.
-    // Thread will then be destroyed when it has finished!
-    std::thread([this, node, additionalLevelsToFetch]() {
-        fetchChildrenNodes(*node, additionalLevelsToFetch);
-    }).detach();
+    // Request all children nodes from found parent. The files are read asynchronously by
+    // the node loader and installed in a later call to `fetchSurroundingNodes()`.
+    fetchChildrenNodes(_store.nodes[node], additionalLevelsToFetch, cameraPos);
 }
 
-std::map<int, std::vector<float>> OctreeManager::traverseData(const glm::dmat4& mvp,
-                                                              const glm::vec2& screenSize,
-                                                              int& deltaStars,
-                                                              gaia::RenderMode mode,
-                                                              float lodPixelThreshold)
+void OctreeManager::TraversalData::clear() {
+    for (const Chunk& chunk : chunks) {
+        chunkLookup[chunk.bufferIndex] = -1;
+    }
+    chunks.clear();
+    values.clear();
+    nCulledNodes = 0;
+}
+
+void OctreeManager::traverseData(const glm::dmat4& mvp, const glm::vec2& screenSize,
+                                 int& deltaStars, gaia::RenderMode mode,
+                                 float lodPixelThreshold, TraversalData& renderData,
+                                 ThreadPool* pool)
 {
-    std::map<int, std::vector<float>> renderData;
+    renderData.clear();
     bool innerRebuild = false;
     _minTotalPixelsLod = lodPixelThreshold;
 
@@ -445,33 +702,33 @@ std::map<int, std::vector<float>> OctreeManager::traverseData(const glm::dmat4&
         corners[i] = glm::dvec4(pos, 1.0);
     }
     if (!_culler->isVisible(corners, mvp)) {
-        return renderData;
+        return;
     }
     glm::vec2 nodeSize = _culler->getNodeSizeInPixels(corners, mvp, screenSize);
     float totalPixels = nodeSize.x * nodeSize.y;
     if (totalPixels < _minTotalPixelsLod * 2) {
         // Remove LOD from first layer of children.
         for (int i = 0; i < 8; ++i) {
-            std::map<int, std::vector<float>> tmpData = removeNodeFromCache(
-                *_root->Children[i],
-                deltaStars
-            );
-            renderData.insert(tmpData.begin(), tmpData.end());
+            removeNodeFromCache(_store.nodes[FirstBranch + i], deltaStars, renderData);
         }
-        return renderData;
+        return;
     }
 
-    for (size_t i = 0; i < 8; ++i) {
-        if (i < _traversedBranchesInRenderCall) {
-            continue;
-        }
+    // Decide what to do with all nodes that are reached in this call before any of them
+    // is changed. Only the remaining branches are traversed while rebuilding the buffer.
+    const size_t firstBranch = _traversedBranchesInRenderCall;
+    renderData.nCulledNodes = cullOctree(mvp, screenSize, pool);
 
-        std::map<int, std::vector<float>> tmpData = checkNodeIntersection(
-            *_root->Children[i],
-            mvp,
-            screenSize,
+    for (size_t i = firstBranch; i < 8; ++i) {
+        // Observe that if a buffer index already has a chunk then the new data for it
+        // will be ignored! Thus we store the removed keys until next render call!
+        checkNodeIntersection(
+            _store.nodes[FirstBranch + i],
+            0,
+            i - firstBranch,
             deltaStars,
-            mode
+            mode,
+            renderData
         );
 
         // Avoid freezing when switching render mode for large datasets by only fetching
@@ -481,23 +738,16 @@ std::map<int, std::vector<float>> OctreeManager::traverseData(const glm::dmat4&
             _traversedBranchesInRenderCall++;
             //break;
         }
-
-        // Observe that if there exists identical keys in renderData then those values in
-        // tmpData will be ignored! Thus we store the removed keys until next render call!
-        renderData.insert(tmpData.begin(), tmpData.end());
     }
 
     if (_rebuildBuffer) {
         if (_useVBO) {
             // We need to overwrite bigger indices that had data before! No need for SSBO.
-            std::map<int, std::vector<float>> idxToRemove;
+            // This will only store indices that doesn't already have a chunk
+            // (i.e. > biggestIdx).
             for (int idx : _removedKeysInPrevCall) {
-                idxToRemove[idx] = std::vector<float>();
+                storeChunk(renderData, idx, nullptr, mode);
             }
-
-            // This will only insert indices that doesn't already exist in map
-            // (i.e. > biggestIdx).
-            renderData.insert(idxToRemove.begin(), idxToRemove.end());
         }
         if (innerRebuild) {
             deltaStars = 0;
@@ -518,14 +768,13 @@ std::map<int, std::vector<float>> OctreeManager::traverseData(const glm::dmat4&
             _traversedBranchesInRenderCall = 0;
         }
     }
-    return renderData;
 }
 
 std::vector<float> OctreeManager::getAllData(gaia::RenderMode mode) {
     std::vector<float> fullData;
 
     for (size_t i = 0; i < 8; ++i) {
-        std::vector<float> tmpData = getNodeData(*_root->Children[i], mode);
+        std::vector<float> tmpData = getNodeData(_store.nodes[FirstBranch + i], mode);
         fullData.insert(fullData.end(), tmpData.begin(), tmpData.end());
     }
     return fullData;
@@ -534,16 +783,18 @@ std::vector<float> OctreeManager::getAllData(gaia::RenderMode mode) {
 void OctreeManager::clearAllData(int branchIndex) {
     // Don't clear everything if not needed.
     if (branchIndex != -1) {
-        clearNodeData(*_root->Children[branchIndex]);
+        clearNodeData(_store.nodes[FirstBranch + branchIndex]);
     }
     else {
         for (size_t i = 0; i < 8; ++i) {
-            clearNodeData(*_root->Children[i]);
+            clearNodeData(_store.nodes[FirstBranch + i]);
         }
     }
 }
 
-void OctreeManager::writeToFile(std::ofstream& outFileStream, bool writeData) {
+void OctreeManager::writeToFile(std::ofstream& outFileStream, bool writeData,
+                                bool quantizeData)
+{
     outFileStream.write(reinterpret_cast<const char*>(&_valuesPerStar), sizeof(int32_t));
     outFileStream.write(
         reinterpret_cast<const char*>(&MAX_STARS_PER_NODE),
@@ -553,12 +804,17 @@ void OctreeManager::writeToFile(std::ofstream& outFileStream, bool writeData) {
 
     // Use pre-traversal (Morton code / Z-order).
     for (size_t i = 0; i < 8; ++i) {
-        writeNodeToFile(outFileStream, *_root->Children[i], writeData);
+        writeNodeToFile(
+            outFileStream,
+            _store.nodes[FirstBranch + i],
+            writeData,
+            quantizeData
+        );
     }
 }
 
 void OctreeManager::writeNodeToFile(std::ofstream& outFileStream, const OctreeNode& node,
-                                    bool writeData)
+                                    bool writeData, bool quantizeData)
 {
     // Write node structure.
     bool isLeaf = node.isLeaf;
@@ -566,38 +822,84 @@ void OctreeManager::writeNodeToFile(std::ofstream& outFileStream, const OctreeNo
     outFileStream.write(reinterpret_cast<const char*>(&isLeaf), sizeof(bool));
     outFileStream.write(reinterpret_cast<const char*>(&numStars), sizeof(int32_t));
 
-    // Write node data if specified
+    // Write node data if specified.
     if (writeData) {
-        std::vector<float> nodeData = node.posData;
-        nodeData.insert(nodeData.end(), node.colData.begin(), node.colData.end());
-        nodeData.insert(nodeData.end(), node.velData.begin(), node.velData.end());
-        int32_t nDataSize = static_cast<int32_t>(nodeData.size());
-        size_t nBytes = nDataSize * sizeof(nodeData[0]);
-
-        outFileStream.write(reinterpret_cast<const char*>(&nDataSize), sizeof(int32_t));
-        if (nDataSize > 0) {
-            outFileStream.write(reinterpret_cast<const char*>(nodeData.data()), nBytes);
-        }
+        writeNodeData(outFileStream, node, quantizeData);
     }
 
     // Write children to file (in Morton order) if we're in an inner node.
     if (!node.isLeaf) {
         for (size_t i = 0; i < 8; ++i) {
-            writeNodeToFile(outFileStream, *node.Children[i], writeData);
+            writeNodeToFile(
+                outFileStream,
+                _store.nodes[node.firstChild + i],
+                writeData,
+                quantizeData
+            );
         }
     }
 }
 
+void OctreeManager::writeNodeData(std::ofstream& outFileStream, const OctreeNode& node,
+                                  bool quantizeData) const
+{
+    const size_t nStars = node.slab.isValid() ? node.numStars : 0;
+    const float* posData = nStars > 0 ? _store.stars.positions(node.slab) : nullptr;
+    const float* colData = nStars > 0 ? _store.stars.colors(node.slab) : nullptr;
+    const float* velData = nStars > 0 ? _store.stars.velocities(node.slab) : nullptr;
+
+    if (quantizeData) {
+        const gaia::QuantizedStars stars = gaia::quantizeStars(
+            posData,
+            colData,
+            velData,
+            nStars,
+            COL_SIZE,
+            VEL_SIZE,
+            node.originX,
+            node.originY,
+            node.originZ,
+            node.halfDimension
+        );
+        gaia::writeQuantizedStars(outFileStream, stars);
+        return;
+    }
+
+    // The positions, colors and velocities of the stars are stored one after the other,
+    // just like in the slab.
+    int32_t nDataSize = static_cast<int32_t>(nStars * _valuesPerStar);
+    outFileStream.write(reinterpret_cast<const char*>(&nDataSize), sizeof(int32_t));
+    if (nDataSize > 0) {
+        outFileStream.write(
+            reinterpret_cast<const char*>(posData),
+            nStars * POS_SIZE * sizeof(float)
+        );
+        outFileStream.write(
+            reinterpret_cast<const char*>(colData),
+            nStars * COL_SIZE * sizeof(float)
+        );
+        outFileStream.write(
+            reinterpret_cast<const char*>(velData),
+            nStars * VEL_SIZE * sizeof(float)
+        );
+    }
+}
+
 int OctreeManager::readFromFile(std::ifstream& inFileStream, bool readData,
                                 const std::string& folderPath)
 {
     int nStarsRead = 0;
-    int oldMaxdist = static_cast<int>(MAX_DIST);
 
     // If we're not reading data then we need to stream from files later on.
     _streamOctree = !readData;
     if (_streamOctree) {
-        _streamFolderPath = folderPath;
+        _nodeLoader = std::make_unique<OctreeNodeLoader>(
+            folderPath,
+            POS_SIZE,
+            COL_SIZE,
+            VEL_SIZE,
+            NodeLoaderThreads
+        );
     }
 
     _valuesPerStar = 0;
@@ -610,34 +912,24 @@ int OctreeManager::readFromFile(std::ifstream& inFileStream, bool readData,
         MAX_STARS_PER_NODE, MAX_DIST
     ));
 
-    // Octree Manager root halfDistance must be updated before any nodes are created!
-    if (static_cast<int>(MAX_DIST) != oldMaxdist) {
-        for (size_t i = 0; i < 8; ++i) {
-            _root->Children[i]->halfDimension = MAX_DIST / 2.f;
-            _root->Children[i]->originX = (i % 2 == 0) ?
-                _root->Children[i]->halfDimension :
-                -_root->Children[i]->halfDimension;
-            _root->Children[i]->originY = (i % 4 < 2) ?
-                _root->Children[i]->halfDimension :
-                -_root->Children[i]->halfDimension;
-            _root->Children[i]->originZ = (i < 4) ?
-                _root->Children[i]->halfDimension :
-                -_root->Children[i]->halfDimension;
-        }
-    }
+    // The root children and the slab sizes must be updated before any nodes are read!
+    _store.nodes.resize(1);
+    _store.nodes[RootNode].halfDimension = static_cast<float>(MAX_DIST);
+    initNodeChildren(_store, RootNode);
+    _store.stars.configure(MAX_STARS_PER_NODE, POS_SIZE, COL_SIZE, VEL_SIZE);
 
     if (_valuesPerStar != (POS_SIZE + COL_SIZE + VEL_SIZE)) {
         LERROR("Read file doesn't have the same structure of render parameters");
     }
 
     // Use the same technique to construct octree from file.
-    for (size_t i = 0; i < 8; ++i) {
-        nStarsRead += readNodeFromFile(inFileStream, *_root->Children[i], readData);
+    for (uint32_t i = 0; i < 8; ++i) {
+        nStarsRead += readNodeFromFile(inFileStream, FirstBranch + i, readData);
     }
     return nStarsRead;
 }
 
-int OctreeManager::readNodeFromFile(std::ifstream& inFileStream, OctreeNode& node,
+int OctreeManager::readNodeFromFile(std::ifstream& inFileStream, uint32_t nodeIndex,
                                     bool readData)
 {
     // Read node structure.
@@ -647,36 +939,48 @@ int OctreeManager::readNodeFromFile(std::ifstream& inFileStream, OctreeNode& nod
     inFileStream.read(reinterpret_cast<char*>(&isLeaf), sizeof(bool));
     inFileStream.read(reinterpret_cast<char*>(&numStars), sizeof(int32_t));
 
+    // Observe that the reference to the node is only valid until children are created.
+    OctreeNode& node = _store.nodes[nodeIndex];
     node.isLeaf = isLeaf;
     node.numStars = numStars;
 
-    // Read node data if specified.
+    // Read node data if specified. Quantized data is decoded right away.
     if (readData) {
-        int32_t nDataSize = 0;
-        inFileStream.read(reinterpret_cast<char*>(&nDataSize), sizeof(int32_t));
-
-        if (nDataSize > 0) {
-            std::vector<float> fetchedData(nDataSize, 0.0f);
-            size_t nBytes = nDataSize * sizeof(fetchedData[0]);
-
-            inFileStream.read(reinterpret_cast<char*>(&fetchedData[0]), nBytes);
-
-            int starsInNode = static_cast<int>(nDataSize / _valuesPerStar);
-            auto posEnd = fetchedData.begin() + (starsInNode * POS_SIZE);
-            auto colEnd = posEnd + (starsInNode * COL_SIZE);
-            auto velEnd = colEnd + (starsInNode * VEL_SIZE);
-            node.posData = std::vector<float>(fetchedData.begin(), posEnd);
-            node.colData = std::vector<float>(posEnd, colEnd);
-            node.velData = std::vector<float>(colEnd, velEnd);
+        std::vector<float> posData;
+        std::vector<float> colData;
+        std::vector<float> velData;
+        const bool success = gaia::readStarData(
+            inFileStream,
+            POS_SIZE,
+            COL_SIZE,
+            VEL_SIZE,
+            posData,
+            colData,
+            velData
+        );
+        if (!success) {
+            LERROR("Error reading node data from Octree file");
+        }
+
+        const size_t starsInNode = posData.size() / POS_SIZE;
+        if (success && starsInNode > 0) {
+            storeNodeData(
+                node,
+                posData.data(),
+                colData.data(),
+                velData.data(),
+                starsInNode
+            );
         }
     }
 
     // Create children if we're in an inner node and read from the corresponding nodes.
-    if (!node.isLeaf) {
+    if (!isLeaf) {
         numStars = 0;
-        createNodeChildren(node);
-        for (size_t i = 0; i < 8; ++i) {
-            numStars += readNodeFromFile(inFileStream, *node.Children[i], readData);
+        createNodeChildren(nodeIndex);
+        const uint32_t firstChild = _store.nodes[nodeIndex].firstChild;
+        for (uint32_t i = 0; i < 8; ++i) {
+            numStars += readNodeFromFile(inFileStream, firstChild + i, readData);
         }
     }
 
@@ -685,41 +989,43 @@ int OctreeManager::readNodeFromFile(std::ifstream& inFileStream, OctreeNode& nod
 }
 
 void OctreeManager::writeToMultipleFiles(const std::string& outFolderPath,
-                                         size_t branchIndex)
+                                         size_t branchIndex, bool quantizeData)
 {
-    // Write entire branch to disc, with one file per node.
-    std::string outFilePrefix = outFolderPath + std::to_string(branchIndex);
-    // More threads doesn't make it much faster, disk speed still the limiter.
-    writeNodeToMultipleFiles(outFilePrefix, *_root->Children[branchIndex], false);
+    {
+        // Other branches may be built at the same time, but the Octree must not change
+        // while it is read
+        std::shared_lock lock(_storeMutex);
+
+        // Write entire branch to disc, with one file per node.
+        std::string outFilePrefix = outFolderPath + std::to_string(branchIndex);
+        // More threads doesn't make it much faster, disk speed still the limiter.
+        writeNodeToMultipleFiles(
+            outFilePrefix,
+            _store.nodes[FirstBranch + branchIndex],
+            false,
+            quantizeData
+        );
+    }
 
     // Clear all data in branch.
     LINFO(fmt::format("Clear all data from branch {} in octree", branchIndex));
-    clearNodeData(*_root->Children[branchIndex]);
+    std::lock_guard lock(_storeMutex);
+    clearNodeData(_store.nodes[FirstBranch + branchIndex]);
 }
 
 void OctreeManager::writeNodeToMultipleFiles(const std::string& outFilePrefix,
-                                             OctreeNode& node, bool threadWrites)
+                                             const OctreeNode& node, bool threadWrites,
+                                             bool quantizeData)
 {
-    // Prepare node data, save nothing else.
-    std::vector<float> nodeData = node.posData;
-    nodeData.insert(nodeData.end(), node.colData.begin(), node.colData.end());
-    nodeData.insert(nodeData.end(), node.velData.begin(), node.velData.end());
-    int32_t nDataSize = static_cast<int32_t>(nodeData.size());
-    size_t nBytes = nDataSize * sizeof(nodeData[0]);
-
     // Only open output stream if we have any values to write.
-    if (nDataSize > 0) {
+    const size_t nStars = node.slab.isValid() ? node.numStars : 0;
+    if (nStars > 0) {
         // Use Morton code to name file (placement in Octree).
         std::string outPath = outFilePrefix + BINARY_SUFFIX;
         std::ofstream outFileStream(outPath, std::ofstream::binary);
         if (outFileStream.good()) {
-            // LINFO("Write " + std::to_string(nDataSize) + " values to " + outPath);
-            outFileStream.write(
-                reinterpret_cast<const char*>(&nDataSize),
-                sizeof(int32_t)
-            );
-            outFileStream.write(reinterpret_cast<const char*>(nodeData.data()), nBytes);
-
+            // Prepare node data, save nothing else.
+            writeNodeData(outFileStream, node, quantizeData);
             outFileStream.close();
         }
         else {
@@ -732,17 +1038,23 @@ void OctreeManager::writeNodeToMultipleFiles(const std::string& outFilePrefix,
         std::vector<std::thread> writeThreads(8);
         for (size_t i = 0; i < 8; ++i) {
             std::string newOutFilePrefix = outFilePrefix + std::to_string(i);
+            const OctreeNode& child = _store.nodes[node.firstChild + i];
             if (threadWrites) {
                 // Divide writing to new threads to speed up the process.
                 std::thread t(
-                    [this, newOutFilePrefix, n = node.Children[i]]() {
-                        writeNodeToMultipleFiles(newOutFilePrefix, *n, false);
+                    [this, newOutFilePrefix, &child, quantizeData]() {
+                        writeNodeToMultipleFiles(
+                            newOutFilePrefix,
+                            child,
+                            false,
+                            quantizeData
+                        );
                     }
                 );
                 writeThreads[i] = std::move(t);
             }
             else {
-                writeNodeToMultipleFiles(newOutFilePrefix, *node.Children[i], false);
+                writeNodeToMultipleFiles(newOutFilePrefix, child, false, quantizeData);
             }
         }
         if (threadWrites) {
@@ -755,148 +1067,163 @@ void OctreeManager::writeNodeToMultipleFiles(const std::string& outFilePrefix,
 }
 
 void OctreeManager::fetchChildrenNodes(OctreeNode& parentNode,
-                                       int additionalLevelsToFetch)
+                                       int additionalLevelsToFetch,
+                                       const glm::vec3& cameraPos)
 {
-    // Lock node to make sure nobody else are trying to load the same children.
-    std::lock_guard lock(parentNode.loadingLock);
-
     for (int i = 0; i < 8; ++i) {
-        // Fetch node data if we're streaming and it doesn't exist in RAM yet.
-        // (As long as there is any RAM budget left and node actually has any data!)
-        if (!parentNode.Children[i]->isLoaded &&
-            (parentNode.Children[i]->numStars > 0) &&
-            _cpuRamBudget > static_cast<long long>(parentNode.Children[i]->numStars
-            * (POS_SIZE + COL_SIZE + VEL_SIZE) * 4))
-        {
-            fetchNodeDataFromFile(*parentNode.Children[i]);
+        OctreeNode& child = _store.nodes[parentNode.firstChild + i];
+
+        if (child.isLoaded) {
+            // Keep nodes that are still in use from being unloaded.
+            if (!_datasetFitInMemory) {
+                _loadedNodes.touch(child.octreePositionIndex);
+            }
+        }
+        else if (child.numStars > 0) {
+            // Request node data if we're streaming and it doesn't exist in RAM yet.
+            requestNodeData(child, cameraPos);
         }
 
         // Fetch all Children's Children if recursive is set to true!
-        if (additionalLevelsToFetch != 0 && !parentNode.Children[i]->isLeaf) {
-            fetchChildrenNodes(*parentNode.Children[i], --additionalLevelsToFetch);
+        if (additionalLevelsToFetch != 0 && !child.isLeaf) {
+            fetchChildrenNodes(child, --additionalLevelsToFetch, cameraPos);
         }
     }
 }
 
-void OctreeManager::fetchNodeDataFromFile(OctreeNode& node) {
-    // Remove root ID ("8") from index before loading file.
-    std::string posId = std::to_string(node.octreePositionIndex);
-    posId.erase(posId.begin());
+void OctreeManager::requestNodeData(OctreeNode& node, const glm::vec3& cameraPos) {
+    // Nodes that cover a large part of the view are more urgent than small or far away
+    // nodes, which mostly matters when the entire dataset is requested at once.
+    const glm::vec3 center = glm::vec3(node.originX, node.originY, node.originZ);
+    const float priority = glm::distance(center, cameraPos) / node.halfDimension;
 
-    std::string inFilePath = _streamFolderPath + posId + BINARY_SUFFIX;
-    std::ifstream inFileStream(inFilePath, std::ifstream::binary);
-    // LINFO("Fetch node data file: " + inFilePath);
+    if (_requestedNodes.contains(node.octreePositionIndex)) {
+        _nodeLoader->reprioritize(node.octreePositionIndex, priority);
+        return;
+    }
+
+    // Reserve RAM for the node until it has been installed (as long as there is any RAM
+    // budget left).
+    const long long nBytes = nodeSizeInBytes(node);
+    if (_cpuRamBudget > nBytes) {
+        _cpuRamBudget -= nBytes;
+        _requestedNodes.insert(node.octreePositionIndex);
+        _nodeLoader->request(node.octreePositionIndex, priority);
+    }
+}
 
-    if (inFileStream.good()) {
-        // Read node data.
-        int32_t nDataSize = 0;
+void OctreeManager::installLoadedNodes() {
+    while (std::optional<OctreeNodeLoader::LoadedNode> loaded =
+           _nodeLoader->popFinishedNode())
+    {
+        const unsigned long long id = loaded->octreePositionIndex;
+        _requestedNodes.erase(id);
 
-        // Octree knows if we have any data in this node = it exists.
-        // Otherwise don't call this function!
-        inFileStream.read(reinterpret_cast<char*>(&nDataSize), sizeof(int32_t));
+        std::vector<uint32_t> ancestors = findAncestors(id);
+        const uint32_t nodeIndex = _store.nodes[ancestors.back()].firstChild + id % 10;
+        OctreeNode& node = _store.nodes[nodeIndex];
 
-        std::vector<float> readData(nDataSize, 0.f);
-        int nBytes = nDataSize * sizeof(readData[0]);
-        if (nDataSize > 0) {
-            inFileStream.read(reinterpret_cast<char*>(&readData[0]), nBytes);
+        if (!loaded->isValid) {
+            // Return the reserved RAM, the node will be requested again if it's needed.
+            _cpuRamBudget += nodeSizeInBytes(node);
+            continue;
         }
 
-        int starsInNode = static_cast<int>(nDataSize / _valuesPerStar);
-        auto posEnd = readData.begin() + (starsInNode * POS_SIZE);
-        auto colEnd = posEnd + (starsInNode * COL_SIZE);
-        auto velEnd = colEnd + (starsInNode * VEL_SIZE);
-        node.posData = std::vector<float>(readData.begin(), posEnd);
-        node.colData = std::vector<float>(posEnd, colEnd);
-        node.velData = std::vector<float>(colEnd, velEnd);
-
-        // Keep track of nodes that are loaded and update CPU RAM budget.
+        storeNodeData(
+            node,
+            loaded->posData.data(),
+            loaded->colData.data(),
+            loaded->velData.data(),
+            loaded->posData.size() / POS_SIZE
+        );
         node.isLoaded = true;
+
+        // The root is always traversed, the other ancestors only if they're flagged.
+        for (size_t i = 1; i < ancestors.size(); ++i) {
+            _store.nodes[ancestors[i]].hasLoadedDescendant = true;
+        }
+
+        // Keep track of nodes that are loaded so they can be unloaded in order later.
         if (!_datasetFitInMemory) {
-            std::lock_guard g(_leastRecentlyFetchedNodesMutex);
-            _leastRecentlyFetchedNodes.push(node.octreePositionIndex);
+            _loadedNodes.put(id, nodeIndex);
         }
-        _cpuRamBudget -= nBytes;
     }
-    else {
-        LERROR("Error opening node data file: " + inFilePath);
+}
+
+void OctreeManager::removeNodesFromRam() {
+    const long long tenthOfRamBudget = _maxCpuRamBudget / 10;
+    while (_cpuRamBudget < tenthOfRamBudget && !_loadedNodes.isEmpty()) {
+        // Remove the node that was least recently fetched by findAndFetchNeighborNode.
+        const auto [id, nodeIndex] = _loadedNodes.popLRU();
+        removeNode(_store.nodes[nodeIndex]);
+        propagateUnloadedNodes(findAncestors(id));
     }
 }
 
-void OctreeManager::removeNodesFromRam(
-                                     const std::vector<unsigned long long>& nodesToRemove)
+std::vector<uint32_t>
+OctreeManager::findAncestors(unsigned long long octreePositionIndex) const
 {
-    // LINFO("Removed " + std::to_string(nodesToRemove.size()) + " nodes from RAM");
-
-    for (unsigned long long nodePosIndex : nodesToRemove) {
-        std::stack<int> indexStack;
-        while (nodePosIndex != 8) {
-            int nodeIndex = nodePosIndex % 10;
-            indexStack.push(nodeIndex);
-            nodePosIndex /= 10;
-        }
+    std::stack<int> indexStack;
+    while (octreePositionIndex / 10 != 8) {
+        octreePositionIndex /= 10;
+        indexStack.push(octreePositionIndex % 10);
+    }
 
-        // Traverse to node and remove it.
-        std::shared_ptr<OctreeNode> node = _root;
-        std::vector<std::shared_ptr<OctreeNode>> ancestors;
-        while (!indexStack.empty()) {
-            ancestors.push_back(node);
-            node = node->Children[indexStack.top()];
-            indexStack.pop();
-        }
-        removeNode(*node);
+    std::vector<uint32_t> ancestors = { RootNode };
+    while (!indexStack.empty()) {
+        ancestors.push_back(_store.nodes[ancestors.back()].firstChild + indexStack.top());
+        indexStack.pop();
+    }
+    return ancestors;
+}
 
-        propagateUnloadedNodes(ancestors);
+uint32_t OctreeManager::findNode(unsigned long long octreePositionIndex) const {
+    std::stack<int> indexStack;
+    while (octreePositionIndex != 8) {
+        indexStack.push(octreePositionIndex % 10);
+        octreePositionIndex /= 10;
     }
+
+    uint32_t node = RootNode;
+    while (!indexStack.empty()) {
+        node = _store.nodes[node].firstChild + indexStack.top();
+        indexStack.pop();
+    }
+    return node;
 }
 
-void OctreeManager::removeNode(OctreeNode& node) {
-    // Lock node to make sure nobody else is trying to access it while removing.
-    std::lock_guard lock(node.loadingLock);
+long long OctreeManager::nodeSizeInBytes(const OctreeNode& node) const {
+    return static_cast<long long>(node.numStars * _valuesPerStar * sizeof(float));
+}
 
-    int nBytes = static_cast<int>(
-        node.numStars * _valuesPerStar * sizeof(node.posData[0])
-    );
+void OctreeManager::removeNode(OctreeNode& node) {
     // Keep track of which nodes that are loaded and update CPU RAM budget.
     node.isLoaded = false;
-    _cpuRamBudget += nBytes;
-
-    // Clear data
-    node.posData.clear();
-    node.posData.shrink_to_fit();
-    node.colData.clear();
-    node.colData.shrink_to_fit();
-    node.velData.clear();
-    node.velData.shrink_to_fit();
+    _cpuRamBudget += nodeSizeInBytes(node);
+
+    // Return the slab to the pool, where it is reused by the next loaded node
+    _store.stars.release(node.slab);
 }
 
-void OctreeManager::propagateUnloadedNodes(
-                                   std::vector<std::shared_ptr<OctreeNode>> ancestorNodes)
-{
-    std::shared_ptr<OctreeNode> parentNode = ancestorNodes.back();
-    while (parentNode->octreePositionIndex != 8) {
+void OctreeManager::propagateUnloadedNodes(std::vector<uint32_t> ancestorNodes) {
+    uint32_t parentIndex = ancestorNodes.back();
+    while (parentIndex != RootNode) {
+        OctreeNode& parentNode = _store.nodes[parentIndex];
+
         // Check if any children of inner node is still loaded, or has loaded descendants.
-        if (parentNode->Children[0]->isLoaded || parentNode->Children[1]->isLoaded ||
-            parentNode->Children[2]->isLoaded || parentNode->Children[3]->isLoaded ||
-            parentNode->Children[4]->isLoaded || parentNode->Children[5]->isLoaded ||
-            parentNode->Children[6]->isLoaded || parentNode->Children[7]->isLoaded ||
-            parentNode->Children[0]->hasLoadedDescendant ||
-            parentNode->Children[1]->hasLoadedDescendant ||
-            parentNode->Children[2]->hasLoadedDescendant ||
-            parentNode->Children[3]->hasLoadedDescendant ||
-            parentNode->Children[4]->hasLoadedDescendant ||
-            parentNode->Children[5]->hasLoadedDescendant ||
-            parentNode->Children[6]->hasLoadedDescendant ||
-            parentNode->Children[7]->hasLoadedDescendant)
-        {
-            return;
+        for (uint32_t i = 0; i < 8; ++i) {
+            const OctreeNode& child = _store.nodes[parentNode.firstChild + i];
+            if (child.isLoaded || child.hasLoadedDescendant) {
+                return;
+            }
         }
         // Else all children has been unloaded and we can update parent flag.
-        parentNode->hasLoadedDescendant = false;
-        // LINFO("Removed ancestor: " + std::to_string(parentNode->octreePositionIndex));
+        parentNode.hasLoadedDescendant = false;
+        // LINFO("Removed ancestor: " + std::to_string(parentNode.octreePositionIndex));
 
         // Propagate change upwards.
         ancestorNodes.pop_back();
-        parentNode = ancestorNodes.back();
+        parentIndex = ancestorNodes.back();
     }
 }
 
@@ -940,6 +1267,10 @@ bool OctreeManager::isRebuildOngoing() const {
     return _rebuildBuffer;
 }
 
+size_t OctreeManager::memoryInBytes() const {
+    return _store.nodes.capacity() * sizeof(OctreeNode) + _store.stars.bytesReserved();
+}
+
 size_t OctreeManager::getChildIndex(float posX, float posY, float posZ, float origX,
                                     float origY, float origZ)
 {
@@ -956,39 +1287,44 @@ size_t OctreeManager::getChildIndex(float posX, float posY, float posZ, float or
     return index;
 }
 
-bool OctreeManager::insertInNode(OctreeNode& node, const std::vector<float>& starValues,
-                                 int depth)
+bool OctreeManager::insertInNode(uint32_t nodeIndex, const float* starValues, int depth)
 {
-    if (node.isLeaf && node.numStars < MAX_STARS_PER_NODE) {
+    // Observe that creating children may move the nodes, so `_store.nodes[nodeIndex]`
+    // has to be looked up again after every call that might do that.
+    if (_store.nodes[nodeIndex].isLeaf &&
+        _store.nodes[nodeIndex].numStars < MAX_STARS_PER_NODE)
+    {
         // Node is a leaf and it's not yet full -> insert star.
-        storeStarData(node, starValues);
+        storeStarData(_store.stars, _store.nodes[nodeIndex], starValues);
 
         if (depth > static_cast<int>(_totalDepth)) {
             _totalDepth = depth;
         }
         return true;
     }
-    else if (node.isLeaf) {
+    else if (_store.nodes[nodeIndex].isLeaf) {
         // Too many stars in leaf node, subdivide into 8 new nodes.
         // Create children and clean up parent.
-        createNodeChildren(node);
-
-        // Distribute stars from parent node into children.
+        createNodeChildren(nodeIndex);
+
+        // Distribute stars from parent node into children. The slab doesn't move when
+        // the children are filled.
+        const StarSlabPool::Slab slab = _store.nodes[nodeIndex].slab;
+        const float* posData = _store.stars.positions(slab);
+        const float* colData = _store.stars.colors(slab);
+        const float* velData = _store.stars.velocities(slab);
+        std::vector<float> tmpValues(_valuesPerStar);
         for (size_t n = 0; n < MAX_STARS_PER_NODE; ++n) {
-            // Position data.
-            auto posBegin = node.posData.begin() + n * POS_SIZE;
-            auto posEnd = posBegin + POS_SIZE;
-            std::vector<float> tmpValues(posBegin, posEnd);
-            // Color data.
-            auto colBegin = node.colData.begin() + n * COL_SIZE;
-            auto colEnd = colBegin + COL_SIZE;
-            tmpValues.insert(tmpValues.end(), colBegin, colEnd);
-            // Velocity data.
-            auto velBegin = node.velData.begin() + n * VEL_SIZE;
-            auto velEnd = velBegin + VEL_SIZE;
-            tmpValues.insert(tmpValues.end(), velBegin, velEnd);
+            std::copy_n(posData + n * POS_SIZE, POS_SIZE, tmpValues.begin());
+            std::copy_n(colData + n * COL_SIZE, COL_SIZE, tmpValues.begin() + POS_SIZE);
+            std::copy_n(
+                velData + n * VEL_SIZE,
+                VEL_SIZE,
+                tmpValues.begin() + POS_SIZE + COL_SIZE
+            );
 
             // Find out which child that will inherit the data and store it.
+            const OctreeNode& node = _store.nodes[nodeIndex];
             size_t index = getChildIndex(
                 tmpValues[0],
                 tmpValues[1],
@@ -997,16 +1333,21 @@ bool OctreeManager::insertInNode(OctreeNode& node, const std::vector<float>& sta
                 node.originY,
                 node.originZ
             );
-            insertInNode(*node.Children[index], tmpValues, depth);
+            insertInNode(
+                node.firstChild + static_cast<uint32_t>(index),
+                tmpValues.data(),
+                depth
+            );
         }
 
         // Sort magnitudes in inner node.
         // (The last value will be used as comparison for what to store in LOD cache.)
-        std::sort(node.magOrder.begin(), node.magOrder.end());
+        sortStarsByMagnitude(_store.stars, _store.nodes[nodeIndex], MAX_STARS_PER_NODE);
     }
 
     // Node is an inner node, keep recursion going.
     // This will also take care of the new star when a subdivision has taken place.
+    OctreeNode& node = _store.nodes[nodeIndex];
     size_t index = getChildIndex(
         starValues[0],
         starValues[1],
@@ -1018,64 +1359,225 @@ bool OctreeManager::insertInNode(OctreeNode& node, const std::vector<float>& sta
 
     // Determine if new star should be kept in our LOD cache.
     // Keeps track of the brightest nodes in children.
-    if (starValues[POS_SIZE] < node.magOrder[MAX_STARS_PER_NODE - 1].first) {
-        storeStarData(node, starValues);
+    const float* magnitudes = _store.stars.colors(node.slab);
+    if (starValues[POS_SIZE] < magnitudes[(MAX_STARS_PER_NODE - 1) * COL_SIZE]) {
+        storeStarData(_store.stars, node, starValues);
     }
 
-    return insertInNode(*node.Children[index], starValues, ++depth);
+    return insertInNode(
+        node.firstChild + static_cast<uint32_t>(index),
+        starValues,
+        ++depth
+    );
+}
+
+void OctreeManager::insertSequenceInNode(NodeStore& store, uint32_t nodeIndex,
+                                         const std::vector<float>& starValues,
+                                         std::vector<BulkInsertItem> sequence,
+                                         size_t minJobSize, BulkInsertStats& stats,
+                                         std::vector<BulkInsertJob>& deferredJobs)
+{
+    std::array<std::vector<BulkInsertItem>, 8> childSequences;
+
+    for (const BulkInsertItem& item : sequence) {
+        const float* star = starValues.data() + item.starIndex * _valuesPerStar;
+
+        if (store.nodes[nodeIndex].isLeaf &&
+            store.nodes[nodeIndex].numStars < MAX_STARS_PER_NODE)
+        {
+            // Node is a leaf and it's not yet full -> insert star.
+            storeStarData(store.stars, store.nodes[nodeIndex], star);
+            const size_t depth = static_cast<size_t>(item.depth);
+            stats.totalDepth = std::max(stats.totalDepth, depth);
+            continue;
+        }
+        else if (store.nodes[nodeIndex].isLeaf) {
+            // Too many stars in leaf node, subdivide into 8 new nodes.
+            initNodeChildren(store, nodeIndex);
+            stats.numLeafNodes += 7;
+            stats.numInnerNodes++;
+
+            // The stars stored in the leaf are the first ones in the sequence. They are
+            // passed on with the depth of the star that caused the subdivision, just like
+            // `insertInNode()` does.
+            const OctreeNode& node = store.nodes[nodeIndex];
+            for (size_t n = 0; n < MAX_STARS_PER_NODE; ++n) {
+                const BulkInsertItem& stored = sequence[n];
+                const float* s = starValues.data() + stored.starIndex * _valuesPerStar;
+                size_t index = getChildIndex(
+                    s[0],
+                    s[1],
+                    s[2],
+                    node.originX,
+                    node.originY,
+                    node.originZ
+                );
+                childSequences[index].push_back({ stored.starIndex, item.depth });
+            }
+
+            // Sort magnitudes in inner node.
+            sortStarsByMagnitude(store.stars, store.nodes[nodeIndex], MAX_STARS_PER_NODE);
+        }
+
+        OctreeNode& node = store.nodes[nodeIndex];
+        size_t index = getChildIndex(
+            star[0],
+            star[1],
+            star[2],
+            node.originX,
+            node.originY,
+            node.originZ
+        );
+
+        // Determine if new star should be kept in our LOD cache.
+        const float* magnitudes = store.stars.colors(node.slab);
+        if (star[POS_SIZE] < magnitudes[(MAX_STARS_PER_NODE - 1) * COL_SIZE]) {
+            storeStarData(store.stars, node, star);
+        }
+
+        childSequences[index].push_back({ item.starIndex, item.depth + 1 });
+    }
+
+    // Release the sequence before descending, the children hold all of it again
+    sequence.clear();
+    sequence.shrink_to_fit();
+
+    if (store.nodes[nodeIndex].isLeaf) {
+        return;
+    }
+
+    const uint32_t firstChild = store.nodes[nodeIndex].firstChild;
+    for (uint32_t i = 0; i < 8; ++i) {
+        if (childSequences[i].empty()) {
+            continue;
+        }
+
+        if (childSequences[i].size() >= minJobSize) {
+            // The child is still an empty leaf, so it doesn't own any star data yet
+            deferredJobs.push_back({
+                .parentJob = NoBulkInsertJob,
+                .placeholder = firstChild + i,
+                .root = store.nodes[firstChild + i],
+                .sequence = std::move(childSequences[i])
+            });
+        }
+        else {
+            insertSequenceInNode(
+                store,
+                firstChild + i,
+                starValues,
+                std::move(childSequences[i]),
+                minJobSize,
+                stats,
+                deferredJobs
+            );
+        }
+    }
 }
 
 void OctreeManager::sliceNodeLodCache(OctreeNode& node) {
     // Slice stored LOD data in inner nodes.
     if (!node.isLeaf) {
         // Sort by magnitude. Inverse relation (i.e. a lower magnitude means a brighter
-        // star!)
-        std::sort(node.magOrder.begin(), node.magOrder.end());
-        node.magOrder.resize(MAX_STARS_PER_NODE);
-
-        std::vector<float> tmpPos;
-        std::vector<float> tmpCol;
-        std::vector<float> tmpVel;
-        // Ordered map contain the MAX_STARS_PER_NODE brightest stars in all children!
-        for (auto const& [absMag, placement] : node.magOrder) {
-            auto posBegin = node.posData.begin() + placement * POS_SIZE;
-            auto colBegin = node.colData.begin() + placement * COL_SIZE;
-            auto velBegin = node.velData.begin() + placement * VEL_SIZE;
-            tmpPos.insert(tmpPos.end(), posBegin, posBegin + POS_SIZE);
-            tmpCol.insert(tmpCol.end(), colBegin, colBegin + COL_SIZE);
-            tmpVel.insert(tmpVel.end(), velBegin, velBegin + VEL_SIZE);
-        }
-        node.posData = std::move(tmpPos);
-        node.colData = std::move(tmpCol);
-        node.velData = std::move(tmpVel);
-        node.numStars = node.magOrder.size(); // = MAX_STARS_PER_NODE
-
-        for (int i = 0; i < 8; ++i) {
-            sliceNodeLodCache(*node.Children[i]);
-        }
+        // star!) The MAX_STARS_PER_NODE brightest stars in all children are kept.
+        sortStarsByMagnitude(_store.stars, node, MAX_STARS_PER_NODE);
     }
 }
 
-void OctreeManager::storeStarData(OctreeNode& node, const std::vector<float>& starValues)
+void OctreeManager::storeStarData(StarSlabPool& stars, OctreeNode& node,
+                                  const float* starValues)
 {
-    // Insert star data at the back of vectors and store a vector with pairs consisting of
-    // star magnitude and insert index for later sorting and slicing of LOD cache.
-    float mag = starValues[POS_SIZE];
-    node.magOrder.insert(node.magOrder.end(), std::make_pair(mag, node.numStars));
+    // Move the stars to a larger slab if the current one is full. Leaves grow by doubling
+    // their capacity and inner nodes grow into a slab that fits the whole LOD cache right
+    // away, so that a node is only copied a few times while the octree is built. The
+    // slack is trimmed again when the LOD caches are sliced.
+    if (node.numStars >= stars.capacity(node.slab)) {
+        const size_t lodCapacity = 2 * MAX_STARS_PER_NODE + 1;
+        const size_t capacity = node.isLeaf ?
+            std::min<size_t>(std::max<size_t>(2 * node.numStars, 1), lodCapacity) :
+            lodCapacity;
+        resizeSlab(stars, node, capacity);
+    }
+
+    // Insert star data at the back of the slab. The order in which the stars are stored
+    // is used to sort stars with equal magnitude when the LOD cache is sliced.
+    const float* posEnd = starValues + POS_SIZE;
+    const float* colEnd = posEnd + COL_SIZE;
+    const float* velEnd = colEnd + VEL_SIZE;
+    std::copy(starValues, posEnd, stars.positions(node.slab) + node.numStars * POS_SIZE);
+    std::copy(posEnd, colEnd, stars.colors(node.slab) + node.numStars * COL_SIZE);
+    std::copy(colEnd, velEnd, stars.velocities(node.slab) + node.numStars * VEL_SIZE);
     node.numStars++;
 
     // If LOD is growing too large then sort it and resize to [chunk size] to avoid too
     // much RAM usage and increase threshold for adding new stars.
-    if (node.magOrder.size() > MAX_STARS_PER_NODE * 2) {
-        std::sort(node.magOrder.begin(), node.magOrder.end());
-        node.magOrder.resize(MAX_STARS_PER_NODE);
+    if (node.numStars > MAX_STARS_PER_NODE * 2) {
+        sortStarsByMagnitude(stars, node, MAX_STARS_PER_NODE);
+    }
+}
+
+void OctreeManager::sortStarsByMagnitude(StarSlabPool& stars, OctreeNode& node,
+                                         size_t nKeep) const
+{
+    float* posData = stars.positions(node.slab);
+    float* colData = stars.colors(node.slab);
+    float* velData = stars.velocities(node.slab);
+
+    // Sort pairs of star magnitude and insert index
+    std::vector<std::pair<float, uint32_t>> magOrder(node.numStars);
+    for (uint32_t i = 0; i < node.numStars; ++i) {
+        magOrder[i] = std::make_pair(colData[i * COL_SIZE], i);
+    }
+    std::sort(magOrder.begin(), magOrder.end());
+    nKeep = std::min<size_t>(nKeep, node.numStars);
+
+    // Gather the kept stars in order and copy them back to the front of the slab
+    std::vector<float> sorted(nKeep * _valuesPerStar);
+    float* sortedPos = sorted.data();
+    float* sortedCol = sortedPos + nKeep * POS_SIZE;
+    float* sortedVel = sortedCol + nKeep * COL_SIZE;
+    for (size_t i = 0; i < nKeep; ++i) {
+        const uint32_t placement = magOrder[i].second;
+        std::copy_n(posData + placement * POS_SIZE, POS_SIZE, sortedPos + i * POS_SIZE);
+        std::copy_n(colData + placement * COL_SIZE, COL_SIZE, sortedCol + i * COL_SIZE);
+        std::copy_n(velData + placement * VEL_SIZE, VEL_SIZE, sortedVel + i * VEL_SIZE);
+    }
+    std::copy(sortedPos, sortedCol, posData);
+    std::copy(sortedCol, sortedVel, colData);
+    std::copy(sortedVel, sortedVel + nKeep * VEL_SIZE, velData);
+    node.numStars = static_cast<uint32_t>(nKeep);
+}
+
+void OctreeManager::resizeSlab(StarSlabPool& stars, OctreeNode& node,
+                               size_t capacity) const
+{
+    if (capacity > 0 && stars.capacity(node.slab) == stars.capacityFor(capacity)) {
+        return;
+    }
+
+    StarSlabPool::Slab slab;
+    if (capacity > 0) {
+        const size_t nStars = node.slab.isValid() ? node.numStars : 0;
+        slab = stars.copy(stars, node.slab, nStars, capacity);
+    }
+    stars.release(node.slab);
+    node.slab = slab;
+}
+
+void OctreeManager::storeNodeData(OctreeNode& node, const float* posData,
+                                  const float* colData, const float* velData,
+                                  size_t nStars)
+{
+    _store.stars.release(node.slab);
+    node.numStars = static_cast<uint32_t>(nStars);
+    if (nStars == 0) {
+        return;
     }
 
-    auto posEnd = starValues.begin() + POS_SIZE;
-    auto colEnd = posEnd + COL_SIZE;
-    node.posData.insert(node.posData.end(), starValues.begin(), posEnd);
-    node.colData.insert(node.colData.end(), posEnd, colEnd);
-    node.velData.insert(node.velData.end(), colEnd, starValues.end());
+    node.slab = _store.stars.allocate(nStars);
+    std::copy_n(posData, nStars * POS_SIZE, _store.stars.positions(node.slab));
+    std::copy_n(colData, nStars * COL_SIZE, _store.stars.colors(node.slab));
+    std::copy_n(velData, nStars * VEL_SIZE, _store.stars.velocities(node.slab));
 }
 
 std::string OctreeManager::printStarsPerNode(const OctreeNode& node,
@@ -1089,45 +1591,123 @@ std::string OctreeManager::printStarsPerNode(const OctreeNode& node,
         return str + " - [Leaf] \n";
     }
     else {
-        str += fmt::format("LOD: {} - [Parent]\n", node.posData.size() / POS_SIZE);
+        const size_t nLodStars = node.slab.isValid() ? node.numStars : 0;
+        str += fmt::format("LOD: {} - [Parent]\n", nLodStars);
         for (int i = 0; i < 8; ++i) {
             auto pref = prefix + "->" + std::to_string(i);
-            str += printStarsPerNode(*node.Children[i], pref);
+            str += printStarsPerNode(_store.nodes[node.firstChild + i], pref);
         }
         return str;
     }
 }
 
-std::map<int, std::vector<float>> OctreeManager::checkNodeIntersection(OctreeNode& node,
-                                                                    const glm::dmat4& mvp,
-                                                              const glm::vec2& screenSize,
-                                                                          int& deltaStars,
-                                                                    gaia::RenderMode mode)
+size_t OctreeManager::cullOctree(const glm::dmat4& mvp, const glm::vec2& screenSize,
+                                 ThreadPool* pool)
 {
-    std::map<int, std::vector<float>> fetchedData;
+    for (CullingLevel& level : _cullingLevels) {
+        level.nodes.clear();
+        level.actions.clear();
+        level.firstChild.clear();
+    }
+    if (_cullingLevels.empty()) {
+        _cullingLevels.emplace_back();
+    }
+    for (size_t i = _traversedBranchesInRenderCall; i < 8; ++i) {
+        _cullingLevels[0].nodes.push_back(FirstBranch + static_cast<uint32_t>(i));
+    }
 
-    // Calculate the corners of the node.
-    std::vector<glm::dvec4> corners(8);
-    for (int i = 0; i < 8; ++i) {
-        const float x = (i % 2 == 0) ?
-            node.originX + node.halfDimension :
-            node.originX - node.halfDimension;
-        const float y = (i % 4 < 2) ?
-            node.originY + node.halfDimension :
-            node.originY - node.halfDimension;
-        const float z = (i < 4) ?
-            node.originZ + node.halfDimension :
-            node.originZ - node.halfDimension;
-        glm::dvec3 pos = glm::dvec3(x, y, z) * 1000.0 * distanceconstants::Parsec;
-        corners[i] = glm::dvec4(pos, 1.0);
+    size_t nCulledNodes = 0;
+    for (size_t l = 0; !_cullingLevels[l].nodes.empty(); ++l) {
+        if (l + 1 == _cullingLevels.size()) {
+            _cullingLevels.emplace_back();
+        }
+        CullingLevel& level = _cullingLevels[l];
+        CullingLevel& nextLevel = _cullingLevels[l + 1];
+
+        const size_t nNodes = level.nodes.size();
+        const size_t nBatches = (nNodes + OctreeCuller::BatchSize - 1) /
+                                OctreeCuller::BatchSize;
+        const size_t nJobs = (nBatches + CullingBatchesPerJob - 1) / CullingBatchesPerJob;
+        level.actions.resize(nNodes);
+
+        std::atomic_size_t nextJob = 0;
+        auto cullJobs = [&]() {
+            // Lanes after the last node of a batch keep old values, their results are
+            // never read
+            OctreeCuller::NodeBatch batch;
+            OctreeCuller::BatchResult result;
+            for (size_t job = nextJob++; job < nJobs; job = nextJob++) {
+                const size_t lastBatch = std::min(
+                    (job + 1) * CullingBatchesPerJob,
+                    nBatches
+                );
+                for (size_t b = job * CullingBatchesPerJob; b < lastBatch; ++b) {
+                    const size_t first = b * OctreeCuller::BatchSize;
+                    const size_t n = std::min(OctreeCuller::BatchSize, nNodes - first);
+                    for (size_t j = 0; j < n; ++j) {
+                        const OctreeNode& node = _store.nodes[level.nodes[first + j]];
+                        batch.originX[j] = node.originX;
+                        batch.originY[j] = node.originY;
+                        batch.originZ[j] = node.originZ;
+                        batch.halfDimension[j] = node.halfDimension;
+                    }
+
+                    _culler->cullBatch(batch, mvp, screenSize, result);
+
+                    for (size_t j = 0; j < n; ++j) {
+                        level.actions[first + j] = cullingAction(
+                            _store.nodes[level.nodes[first + j]],
+                            result.isVisible[j],
+                            result.totalPixels[j]
+                        );
+                    }
+                }
+            }
+        };
+
+        if (!pool || pool->numThreads() == 0 || nNodes < ParallelCullingThreshold) {
+            cullJobs();
+        }
+        else {
+            // The calling thread takes part in the culling, so we only need helpers for
+            // the remaining jobs
+            const size_t nHelpers = std::min(pool->numThreads(), nJobs - 1);
+            std::latch helpersDone(static_cast<std::ptrdiff_t>(nHelpers));
+            for (size_t i = 0; i < nHelpers; ++i) {
+                pool->enqueue([&cullJobs, &helpersDone]() {
+                    cullJobs();
+                    helpersDone.count_down();
+                });
+            }
+            cullJobs();
+            helpersDone.wait();
+        }
+        nCulledNodes += nNodes;
+
+        // Collect the children of all traversed nodes, which make up the next level.
+        level.firstChild.resize(nNodes);
+        for (size_t i = 0; i < nNodes; ++i) {
+            if (level.actions[i] != CullingAction::Traverse) {
+                continue;
+            }
+            level.firstChild[i] = nextLevel.nodes.size();
+            const uint32_t firstChild = _store.nodes[level.nodes[i]].firstChild;
+            for (uint32_t c = 0; c < 8; ++c) {
+                nextLevel.nodes.push_back(firstChild + c);
+            }
+        }
     }
+    return nCulledNodes;
+}
 
-    // Check if node is visible from camera. If not then return early.
-    if (!(_culler->isVisible(corners, mvp))) {
-        // Check if this node or any of its children existed in cache previously.
-        // If so, then remove them from cache and add those indices to stack.
-        fetchedData = removeNodeFromCache(node, deltaStars);
-        return fetchedData;
+OctreeManager::CullingAction OctreeManager::cullingAction(const OctreeNode& node,
+                                                          bool isVisible,
+                                                          float totalPixels) const
+{
+    // Check if node is visible from camera. If not then remove it and its children from
+    // the cache.
+    if (!isVisible) {
+        return CullingAction::Remove;
     }
 
     // Remove node if it has been unloaded while still in view.
@@ -1135,96 +1715,99 @@ std::map<int, std::vector<float>> OctreeManager::checkNodeIntersection(OctreeNod
     if (node.bufferIndex != DEFAULT_INDEX && !node.isLoaded && _streamOctree &&
         !_datasetFitInMemory)
     {
-        fetchedData = removeNodeFromCache(node, deltaStars);
-        return fetchedData;
+        return CullingAction::Remove;
     }
 
-    // Take care of inner nodes.
-    if (!(node.isLeaf)) {
-        glm::vec2 nodeSize = _culler->getNodeSizeInPixels(corners, mvp, screenSize);
-        float totalPixels = nodeSize.x * nodeSize.y;
+    // Return node data if node is a leaf.
+    if (node.isLeaf) {
+        return CullingAction::Store;
+    }
 
-        // Check if we should return any LOD cache data. If we're streaming a big dataset
-        // from files and inner node is visible and loaded, then it should be rendered
-        // (as long as it doesn't have loaded children because then we should traverse to
-        // lowest loaded level and render it instead)!
-        if ((totalPixels < _minTotalPixelsLod) || (_streamOctree &&
-            !_datasetFitInMemory && node.isLoaded && !node.hasLoadedDescendant))
-        {
-            // Get correct insert index from stack if node didn't exist already. Otherwise
-            // we will overwrite the old data. Key merging is not a problem here.
-            if ((node.bufferIndex == DEFAULT_INDEX) || _rebuildBuffer) {
-                // Return empty if we couldn't claim a buffer stream index.
-                if (!updateBufferIndex(node)) {
-                    return fetchedData;
-                }
+    // Check if we should return any LOD cache data. If we're streaming a big dataset
+    // from files and inner node is visible and loaded, then it should be rendered
+    // (as long as it doesn't have loaded children because then we should traverse to
+    // lowest loaded level and render it instead)!
+    if ((totalPixels < _minTotalPixelsLod) || (_streamOctree &&
+        !_datasetFitInMemory && node.isLoaded && !node.hasLoadedDescendant))
+    {
+        return CullingAction::Store;
+    }
 
-                // We're in an inner node, remove indices from potential children in cache
-                for (int i = 0; i < 8; ++i) {
-                    std::map<int, std::vector<float>> tmpData = removeNodeFromCache(
-                        *node.Children[i],
-                        deltaStars
-                    );
-                    fetchedData.insert(tmpData.begin(), tmpData.end());
-                }
+    return CullingAction::Traverse;
+}
 
-                // Insert data and adjust stars added in this frame.
-                fetchedData[node.bufferIndex] = constructInsertData(
-                    node,
-                    mode,
-                    deltaStars
-                );
-            }
-            return fetchedData;
-        }
+void OctreeManager::checkNodeIntersection(OctreeNode& node, size_t level, size_t index,
+                                          int& deltaStars, gaia::RenderMode mode,
+                                          TraversalData& renderData)
+{
+    const CullingAction action = _cullingLevels[level].actions[index];
+
+    // Check if this node or any of its children existed in cache previously.
+    // If so, then remove them from cache and add those indices to stack.
+    if (action == CullingAction::Remove) {
+        removeNodeFromCache(node, deltaStars, renderData);
+        return;
     }
-    // Return node data if node is a leaf.
-    else {
-        // If node already is in cache then skip it, otherwise store it.
+
+    if (action == CullingAction::Store) {
+        // If node already is in cache then skip it, otherwise store it. For inner nodes
+        // we will overwrite the old data. Key merging is not a problem here.
         if ((node.bufferIndex == DEFAULT_INDEX) || _rebuildBuffer) {
             // Return empty if we couldn't claim a buffer stream index.
             if (!updateBufferIndex(node)) {
-                return fetchedData;
+                return;
             }
 
-            // Insert data and adjust stars added in this frame.
-            fetchedData[node.bufferIndex] = constructInsertData(
-                node,
-                mode,
-                deltaStars
-            );
+            if (node.isLeaf) {
+                // Insert data and adjust stars added in this frame.
+                storeChunk(renderData, node.bufferIndex, &node, mode);
+            }
+            else {
+                // We're in an inner node, remove indices from potential children in
+                // cache
+                const size_t firstChildChunk = renderData.chunks.size();
+                for (uint32_t i = 0; i < 8; ++i) {
+                    removeNodeFromCache(
+                        _store.nodes[node.firstChild + i],
+                        deltaStars,
+                        renderData
+                    );
+                }
+
+                // Insert data and adjust stars added in this frame. This overwrites the
+                // chunk of a removed child that used to have the same index.
+                storeChunk(renderData, node.bufferIndex, &node, mode, firstChildChunk);
+            }
+            deltaStars += static_cast<int>(node.numStars);
         }
-        return fetchedData;
+        return;
     }
 
     // We're in a big, visible inner node -> remove it from cache if it existed.
     // But not its children -> set recursive check to false.
-    fetchedData = removeNodeFromCache(node, deltaStars, false);
+    removeNodeFromCache(node, deltaStars, renderData, false);
 
     // Recursively check if children should be rendered.
+    const size_t firstChild = _cullingLevels[level].firstChild[index];
     for (size_t i = 0; i < 8; ++i) {
-        // Observe that if there exists identical keys in fetchedData then those values in
-        // tmpData will be ignored! Thus we store the removed keys until next render call!
-        std::map<int, std::vector<float>> tmpData = checkNodeIntersection(
-            *node.Children[i],
-            mvp,
-            screenSize,
+        // Observe that if a buffer index already has a chunk then the new data for it
+        // will be ignored! Thus we store the removed keys until next render call!
+        checkNodeIntersection(
+            _store.nodes[node.firstChild + i],
+            level + 1,
+            firstChild + i,
             deltaStars,
-            mode
+            mode,
+            renderData
         );
-        fetchedData.insert(tmpData.begin(), tmpData.end());
     }
-    return fetchedData;
 }
 
-std::map<int, std::vector<float>> OctreeManager::removeNodeFromCache(OctreeNode& node,
-                                                                     int& deltaStars,
-                                                                     bool recursive)
+void OctreeManager::removeNodeFromCache(OctreeNode& node, int& deltaStars,
+                                        TraversalData& renderData, bool recursive)
 {
-    std::map<int, std::vector<float>> keysToRemove;
-
     // If we're in rebuilding mode then there is no need to remove any nodes.
-    //if (_rebuildBuffer) return keysToRemove;
+    //if (_rebuildBuffer) return;
 
     // Check if this node was rendered == had a specified index.
     if (node.bufferIndex != DEFAULT_INDEX) {
@@ -1232,8 +1815,8 @@ std::map<int, std::vector<float>> OctreeManager::removeNodeFromCache(OctreeNode&
         // Reclaim that index. We need to wait until next render call to use it again!
         _removedKeysInPrevCall.insert(node.bufferIndex);
 
-        // Insert dummy node at offset index that should be removed from render.
-        keysToRemove[node.bufferIndex] = std::vector<float>();
+        // Insert empty chunk at offset index that should be removed from render.
+        storeChunk(renderData, node.bufferIndex, nullptr, gaia::RenderMode::Static);
 
         // Reset index and adjust stars removed this frame.
         node.bufferIndex = DEFAULT_INDEX;
@@ -1242,15 +1825,53 @@ std::map<int, std::vector<float>> OctreeManager::removeNodeFromCache(OctreeNode&
 
     // Check children recursively if we're in an inner node.
     if (!(node.isLeaf) && recursive) {
-        for (int i = 0; i < 8; ++i) {
-            std::map<int, std::vector<float>> tmpData = removeNodeFromCache(
-                *node.Children[i],
-                deltaStars
-            );
-            keysToRemove.insert(tmpData.begin(), tmpData.end());
+        for (uint32_t i = 0; i < 8; ++i) {
+            OctreeNode& child = _store.nodes[node.firstChild + i];
+            removeNodeFromCache(child, deltaStars, renderData);
+        }
+    }
+}
+
+void OctreeManager::storeChunk(TraversalData& renderData, int bufferIndex,
+                               const OctreeNode* node, gaia::RenderMode mode,
+                               size_t overwriteFrom)
+{
+    if (bufferIndex >= static_cast<int>(renderData.chunkLookup.size())) {
+        renderData.chunkLookup.resize(bufferIndex + 1, -1);
+    }
+
+    // The first chunk stored for an index is the one that is kept
+    int& lookup = renderData.chunkLookup[bufferIndex];
+    if (lookup != -1 && static_cast<size_t>(lookup) < overwriteFrom) {
+        return;
+    }
+
+    TraversalData::Chunk chunk = {
+        .bufferIndex = bufferIndex,
+        .offset = renderData.values.size(),
+        .nStars = node ? node->numStars : 0
+    };
+    if (chunk.nStars > 0 && node->slab.isValid()) {
+        std::vector<float>& values = renderData.values;
+        const float* posData = _store.stars.positions(node->slab);
+        values.insert(values.end(), posData, posData + chunk.nStars * POS_SIZE);
+        if (mode != gaia::RenderMode::Static) {
+            const float* colData = _store.stars.colors(node->slab);
+            values.insert(values.end(), colData, colData + chunk.nStars * COL_SIZE);
+            if (mode == gaia::RenderMode::Motion) {
+                const float* velData = _store.stars.velocities(node->slab);
+                values.insert(values.end(), velData, velData + chunk.nStars * VEL_SIZE);
+            }
         }
     }
-    return keysToRemove;
+
+    if (lookup != -1) {
+        renderData.chunks[lookup] = chunk;
+    }
+    else {
+        lookup = static_cast<int>(renderData.chunks.size());
+        renderData.chunks.push_back(chunk);
+    }
 }
 
 std::vector<float> OctreeManager::getNodeData(const OctreeNode& node,
@@ -1265,68 +1886,61 @@ std::vector<float> OctreeManager::getNodeData(const OctreeNode& node,
     // If we're not in a leaf, get data from all children recursively.
     std::vector<float> nodeData;
     for (size_t i = 0; i < 8; ++i) {
-        std::vector<float> tmpData = getNodeData(*node.Children[i], mode);
+        std::vector<float> tmpData = getNodeData(_store.nodes[node.firstChild + i], mode);
         nodeData.insert(nodeData.end(), tmpData.begin(), tmpData.end());
     }
     return nodeData;
 }
 
 void OctreeManager::clearNodeData(OctreeNode& node) {
-    // Clear data and its allocated memory.
-    node.posData.clear();
-    node.posData.shrink_to_fit();
-    node.colData.clear();
-    node.colData.shrink_to_fit();
-    node.velData.clear();
-    node.velData.shrink_to_fit();
-
-    // Clear magnitudes as well!
-    //std::vector<std::pair<float, size_t>>().swap(node->magOrder);
-    node.magOrder.clear();
+    // Return the star data to the pool. The number of stars is kept for the structure.
+    _store.stars.release(node.slab);
 
     if (!node.isLeaf) {
         // Remove data from all children recursively.
         for (size_t i = 0; i < 8; ++i) {
-            clearNodeData(*node.Children[i]);
+            clearNodeData(_store.nodes[node.firstChild + i]);
         }
     }
 }
 
-void OctreeManager::createNodeChildren(OctreeNode& node) {
-    for (size_t i = 0; i < 8; ++i) {
-        _numLeafNodes++;
-        node.Children[i] = std::make_shared<OctreeNode>();
-        node.Children[i]->isLeaf = true;
-        node.Children[i]->isLoaded = false;
-        node.Children[i]->hasLoadedDescendant = false;
-        node.Children[i]->bufferIndex = DEFAULT_INDEX;
-        node.Children[i]->octreePositionIndex = (node.octreePositionIndex * 10) + i;
-        node.Children[i]->numStars = 0;
-        node.Children[i]->posData = std::vector<float>();
-        node.Children[i]->colData = std::vector<float>();
-        node.Children[i]->velData = std::vector<float>();
-        node.Children[i]->magOrder = std::vector<std::pair<float, size_t>>();
-        node.Children[i]->halfDimension = node.halfDimension / 2.f;
+void OctreeManager::createNodeChildren(uint32_t nodeIndex) {
+    initNodeChildren(_store, nodeIndex);
+
+    // Eight new leaves replace the one that became an inner node.
+    _numLeafNodes += 7;
+    _numInnerNodes++;
+}
+
+void OctreeManager::initNodeChildren(NodeStore& store, uint32_t nodeIndex) const {
+    // The children are appended to the array, which may move all nodes. That's why the
+    // parent is copied first
+    const OctreeNode parent = store.nodes[nodeIndex];
+    const uint32_t firstChild = static_cast<uint32_t>(store.nodes.size());
+    const float halfDimension = parent.halfDimension / 2.f;
 
+    for (size_t i = 0; i < 8; ++i) {
         // Calculate new origin.
-        node.Children[i]->originX = node.originX;
-        node.Children[i]->originX += (i % 2 == 0) ?
-            node.Children[i]->halfDimension :
-            -node.Children[i]->halfDimension;
-        node.Children[i]->originY = node.originY;
-        node.Children[i]->originY += (i % 4 < 2) ?
-            node.Children[i]->halfDimension :
-            -node.Children[i]->halfDimension;
-        node.Children[i]->originZ = node.originZ;
-        node.Children[i]->originZ += (i < 4) ?
-            node.Children[i]->halfDimension :
-            -node.Children[i]->halfDimension;
+        OctreeNode child = {
+            .originX = parent.originX + ((i % 2 == 0) ? halfDimension : -halfDimension),
+            .originY = parent.originY + ((i % 4 < 2) ? halfDimension : -halfDimension),
+            .originZ = parent.originZ + ((i < 4) ? halfDimension : -halfDimension),
+            .halfDimension = halfDimension,
+            .octreePositionIndex = (parent.octreePositionIndex * 10) + i,
+            .firstChild = 0,
+            .numStars = 0,
+            .bufferIndex = DEFAULT_INDEX,
+            .slab = StarSlabPool::Slab(),
+            .isLeaf = true,
+            .isLoaded = false,
+            .hasLoadedDescendant = false
+        };
+        store.nodes.push_back(child);
     }
 
     // Clean up parent.
-    node.isLeaf = false;
-    _numLeafNodes--;
-    _numInnerNodes++;
+    store.nodes[nodeIndex].firstChild = firstChild;
+    store.nodes[nodeIndex].isLeaf = false;
 }
 
 bool OctreeManager::updateBufferIndex(OctreeNode& node) {
@@ -1335,9 +1949,6 @@ bool OctreeManager::updateBufferIndex(OctreeNode& node) {
         _removedKeysInPrevCall.insert(node.bufferIndex);
     }
 
-    // Make sure node isn't loading/unloading as we're checking isLoaded flag.
-    std::lock_guard lock(node.loadingLock);
-
     // Return false if there are no more spots in our buffer, or if we're streaming and
     // node isn't loaded yet, or if node doesn't have any stars.
     if (_freeSpotsInBuffer.empty() || (_streamOctree && !node.isLoaded) ||
@@ -1369,19 +1980,31 @@ std::vector<float> OctreeManager::constructInsertData(const OctreeNode& node,
         return std::vector<float>();
     }
 
+    // Return early if the data of the node isn't loaded either.
+    if (!node.slab.isValid()) {
+        return std::vector<float>();
+    }
+
     // Fill chunk by appending zeroes to data so we overwrite possible earlier values.
     // And more importantly so our attribute pointers knows where to read!
-    auto insertData = std::vector<float>(node.posData.begin(), node.posData.end());
+    const float* posData = _store.stars.positions(node.slab);
+    const float* colData = _store.stars.colors(node.slab);
+    const float* velData = _store.stars.velocities(node.slab);
+    auto insertData = std::vector<float>(posData, posData + node.numStars * POS_SIZE);
     if (_useVBO) {
         insertData.resize(POS_SIZE * MAX_STARS_PER_NODE, 0.f);
     }
     if (mode != gaia::RenderMode::Static) {
-        insertData.insert(insertData.end(), node.colData.begin(), node.colData.end());
+        insertData.insert(insertData.end(), colData, colData + node.numStars * COL_SIZE);
         if (_useVBO) {
             insertData.resize((POS_SIZE + COL_SIZE) * MAX_STARS_PER_NODE, 0.f);
         }
         if (mode == gaia::RenderMode::Motion) {
-            insertData.insert(insertData.end(), node.velData.begin(), node.velData.end());
+            insertData.insert(
+                insertData.end(),
+                velData,
+                velData + node.numStars * VEL_SIZE
+            );
             if (_useVBO) {
                 insertData.resize(
                     (POS_SIZE + COL_SIZE + VEL_SIZE) * MAX_STARS_PER_NODE, 0.f
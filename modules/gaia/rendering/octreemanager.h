@@ -26,37 +26,81 @@
 #define __OPENSPACE_MODULE_GAIA___OCTREEMANAGER___H__
 
 #include <modules/gaia/rendering/gaiaoptions.h>
+#include <modules/gaia/rendering/octreenodeloader.h>
+#include <modules/gaia/rendering/starslabpool.h>
+#include <modules/globebrowsing/src/lrucache.h>
 #include <ghoul/glm.h>
 #include <ghoul/opengl/ghoul_gl.h>
-#include <map>
-#include <mutex>
-#include <queue>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <set>
+#include <shared_mutex>
 #include <stack>
+#include <unordered_set>
 #include <vector>
 
 namespace openspace {
 
 class OctreeCuller;
+class ThreadPool;
 
 class OctreeManager {
 public:
+    /**
+     * A node of the Octree. All nodes are stored in one array and refer to each other by
+     * their index in it, and their star data is stored in a `StarSlabPool`.
+     */
     struct OctreeNode {
-        std::shared_ptr<OctreeNode> Children[8];
-        std::vector<float> posData;
-        std::vector<float> colData;
-        std::vector<float> velData;
-        std::vector<std::pair<float, size_t>> magOrder;
         float originX;
         float originY;
         float originZ;
         float halfDimension;
-        size_t numStars;
+        unsigned long long octreePositionIndex;
+        /// The index of the first of the eight consecutive children of an inner node
+        uint32_t firstChild;
+        uint32_t numStars;
+        int bufferIndex;
+        /// The star data of the node, if it has any stored
+        StarSlabPool::Slab slab;
         bool isLeaf;
         bool isLoaded;
         bool hasLoadedDescendant;
-        std::mutex loadingLock;
-        int bufferIndex;
-        unsigned long long octreePositionIndex;
+    };
+
+    /**
+     * Render data that changed during one `traverseData()` call. The object is owned
+     * by the caller and reused between calls, so once its vectors have grown to the
+     * working set of the camera no further allocations are made.
+     */
+    struct TraversalData {
+        struct Chunk {
+            /// The index of the chunk in the streaming buffer
+            int bufferIndex;
+            /// The index in `values` where the data of the chunk starts
+            size_t offset;
+            /// The number of stars in the chunk, 0 if the chunk should be emptied
+            size_t nStars;
+        };
+
+        /**
+         * Clears all chunks while keeping the allocated memory.
+         */
+        void clear();
+
+        /// Every buffer index that changed, in no particular order and without duplicates
+        std::vector<Chunk> chunks;
+
+        /// The star data of all chunks. Within each chunk all positions are stored
+        /// first, followed by all colors and all velocities, depending on render mode
+        std::vector<float> values;
+
+        /// The position in `chunks` for each buffer index, or -1 if it is unchanged
+        std::vector<int> chunkLookup;
+
+        /// The number of nodes that were tested against the view frustum
+        size_t nCulledNodes = 0;
     };
 
     OctreeManager() = default;
@@ -85,10 +129,22 @@ public:
      */
     void insert(const std::vector<float>& starValues);
 
+    /**
+     * Inserts all stars in \p starValues, a flat array with the render values of one
+     * star after the other, and builds the resulting subtrees on \p nThreads threads
+     * (all hardware threads if 0). The resulting Octree is identical to the one that is
+     * built by calling `insert()` once per star in the same order. Branches that already
+     * contain stars are filled serially. Internally calls `insertSequenceInNode()`.
+     * May run while `writeToMultipleFiles()` writes another branch.
+     */
+    void insertBulk(const std::vector<float>& starValues, size_t nThreads = 0);
+
     /**
      * Slices LOD data so only the MAX_STARS_PER_NODE brightest stars are stored in inner
-     * nodes. If \p branchIndex is defined then only that branch will be sliced.
-     * Calls `sliceNodeLodCache()` internally.
+     * nodes. If \p branchIndex is defined then only that branch will be sliced. The
+     * inner nodes are sliced in parallel on all hardware threads, after which the stars
+     * of every node are moved to a slab that fits them. Calls `sliceNodeLodCache()`
+     * internally. May run while `writeToMultipleFiles()` writes another branch.
      */
     void sliceLodData(size_t branchIndex = 8);
 
@@ -100,26 +156,29 @@ public:
     void printStarsPerNode() const;
 
     /**
-     * Used while streaming nodes from files. Checks if any nodes need to be loaded or
-     * unloaded. If entire dataset fits in RAM then the whole dataset will be loaded
-     * asynchronously. Otherwise only nodes close to the camera will be fetched.
-     * When RAM stars to fill up least-recently used nodes will start to unload.
+     * Used while streaming nodes from files. Installs the nodes that have been read
+     * since the last call and checks if any nodes need to be loaded or unloaded. If
+     * entire dataset fits in RAM then the whole dataset will be loaded asynchronously.
+     * Otherwise only nodes close to the camera will be fetched. All files are read on
+     * I/O threads, so this function never waits for the disk. When RAM starts to fill up
+     * least-recently used nodes will start to unload.
      * Calls `findAndFetchNeighborNode()` and `removeNodesFromRam()` internally.
      */
-    void fetchSurroundingNodes(const glm::dvec3& cameraPos, size_t chunkSizeInBytes,
+    void fetchSurroundingNodes(const glm::dvec3& cameraPos,
         const glm::ivec2& additionalNodes);
 
     /**
      * Builds render data structure by traversing the Octree and checking for intersection
-     * with view frustum. Every vector in map contains data for one node.
-     * The corresponding integer key is the index where chunk should be inserted into
-     * streaming buffer. Calls `checkNodeIntersection()` for every branch.
+     * with view frustum. \p renderData is cleared and then receives one chunk for every
+     * node whose data should be inserted into, or removed from, the streaming buffer.
+     * Calls `cullOctree()` and then `checkNodeIntersection()` for every branch.
      * \pdeltaStars keeps track of how many stars that were added/removed this render
-     * call.
+     * call. If a \p pool is provided, the culling of large levels is shared with its
+     * threads. The result does not depend on the number of threads.
      */
-    std::map<int, std::vector<float>> traverseData(const glm::dmat4& mvp,
-        const glm::vec2& screenSize, int& deltaStars, gaia::RenderMode mode,
-        float lodPixelThreshold);
+    void traverseData(const glm::dmat4& mvp, const glm::vec2& screenSize,
+        int& deltaStars, gaia::RenderMode mode, float lodPixelThreshold,
+        TraversalData& renderData, ThreadPool* pool = nullptr);
 
     /**
      * Builds full render data structure by traversing all leaves in the Octree.
@@ -134,10 +193,13 @@ public:
 
     /**
      * Write entire Octree structure to a binary file. \param writeData defines if data
-     * should be included or if only structure should be written to the file.
+     * should be included or if only structure should be written to the file. If
+     * \p quantizeData is `true` the data is written in the reduced precision of
+     * gaia::QuantizedStars, which is decoded again when the file is read.
      * Calls `writeNodeToFile()` which recursively writes all nodes.
      */
-    void writeToFile(std::ofstream& outFileStream, bool writeData);
+    void writeToFile(std::ofstream& outFileStream, bool writeData,
+        bool quantizeData = false);
 
     /**
      * Read a constructed Octree from a file. \returns the total number of (distinct)
@@ -153,9 +215,13 @@ public:
      * Write specified part of Octree to multiple files, including all data.
      * \param branchIndex defines which branch to write.
      * Clears specified branch after writing is done.
-     * Calls `writeNodeToMultipleFiles()` for the specified branch.
+     * If \p quantizeData is `true` the data is written in the reduced precision of
+     * gaia::QuantizedStars, which is decoded again when the nodes are streamed.
+     * Calls `writeNodeToMultipleFiles()` for the specified branch. May be called on
+     * another thread while `insertBulk()` and `sliceLodData()` work on other branches.
      */
-    void writeToMultipleFiles(const std::string& outFolderPath, size_t branchIndex);
+    void writeToMultipleFiles(const std::string& outFolderPath, size_t branchIndex,
+        bool quantizeData = false);
 
     /**
      * Getters.
@@ -175,6 +241,12 @@ public:
      */
     long long cpuRamBudget() const;
 
+    /**
+     * \returns the number of bytes that are allocated for the nodes and the star data of
+     * the Octree.
+     */
+    size_t memoryInBytes() const;
+
 private:
     const size_t POS_SIZE = 3;
     const size_t COL_SIZE = 2;
@@ -198,6 +270,66 @@ private:
     const int DEFAULT_INDEX = -1;
     const std::string BINARY_SUFFIX = ".bin";
 
+    struct BulkInsertItem {
+        size_t starIndex;
+        int depth;
+    };
+
+    /**
+     * The nodes of an Octree, or of a subtree that is built on its own thread, together
+     * with their star data. The first node is the root of the (sub)tree.
+     */
+    struct NodeStore {
+        std::vector<OctreeNode> nodes;
+        StarSlabPool stars;
+    };
+
+    static constexpr size_t NoBulkInsertJob = std::numeric_limits<size_t>::max();
+
+    struct BulkInsertJob {
+        /// The job whose store contains the placeholder for the root of this subtree,
+        /// or `NoBulkInsertJob` if the placeholder is a node of the Octree
+        size_t parentJob = 0;
+        /// The index of the placeholder in the store of the parent job
+        uint32_t placeholder = 0;
+        OctreeNode root;
+        std::vector<BulkInsertItem> sequence;
+    };
+
+    /// A subtree that has been built by a `BulkInsertJob`
+    struct BulkInsertResult {
+        size_t parentJob = 0;
+        uint32_t placeholder = 0;
+        NodeStore store;
+    };
+
+    struct BulkInsertStats {
+        size_t totalDepth = 0;
+        size_t numLeafNodes = 0;
+        size_t numInnerNodes = 0;
+    };
+
+    /// What `checkNodeIntersection()` does with a node, as decided by `cullOctree()`
+    enum class CullingAction : uint8_t {
+        /// The node (and its descendants) should be removed from the streaming buffer
+        Remove,
+        /// The data of a leaf or the LOD cache of an inner node should be stored
+        Store,
+        /// The children of the node should be traversed
+        Traverse
+    };
+
+    /**
+     * All nodes of one level of the Octree that are reached in a traversal, in
+     * breadth-first order. The vectors are reused between traversals.
+     */
+    struct CullingLevel {
+        std::vector<uint32_t> nodes;
+        std::vector<CullingAction> actions;
+        /// The index of the first child in the next level if the node is traversed
+        std::vector<size_t> firstChild;
+    };
+
     /**
      * \returns the correct index of child node. Maps [1,1,1] to 0 and [-1,-1,-1] to 7.
      */
@@ -211,13 +343,33 @@ private:
      * If node is an inner node, then star is stores in LOD cache if it is among the
      * brightest stars in all children.
      */
-    bool insertInNode(OctreeNode& node, const std::vector<float>& starValues,
-        int depth = 1);
+    bool insertInNode(uint32_t nodeIndex, const float* starValues, int depth = 1);
+
+    /**
+     * Private help function for `insertBulk()`. Inserts the stars in \p sequence into
+     * the node at \p nodeIndex in \p store in order, exactly as `insertInNode()` would
+     * have done it, but collects the stars that pass through to the children into one
+     * sequence per child instead of recursing star by star. Child sequences with at least
+     * \p minJobSize stars are returned in \p deferredJobs so they can be built on another
+     * thread, all others are built directly. Node counters are accumulated in \p stats
+     * instead of the members.
+     */
+    void insertSequenceInNode(NodeStore& store, uint32_t nodeIndex,
+        const std::vector<float>& starValues, std::vector<BulkInsertItem> sequence,
+        size_t minJobSize, BulkInsertStats& stats,
+        std::vector<BulkInsertJob>& deferredJobs);
+
+    /**
+     * Moves the subtrees that were built by `insertBulk()` into the Octree. The
+     * \p results have to be ordered so that every job comes after its parent job.
+     */
+    void spliceBulkInsertResults(std::vector<BulkInsertResult>& results);
 
     /**
      * Slices LOD cache data in node to the MAX_STARS_PER_NODE brightest stars. This needs
      * to be called after the last star has been inserted into Octree but before it is
-     * saved to file(s). Slices all descendants recursively.
+     * saved to file(s). Only changes the data of \p node, so different nodes can be
+     * sliced at the same time.
      */
     void sliceNodeLodCache(OctreeNode& node);
 
@@ -225,7 +377,26 @@ private:
      * Private help function for `insertInNode()`. Stores star data in node and
      * keeps track of the brightest stars all children.
      */
-    void storeStarData(OctreeNode& node, const std::vector<float>& starValues);
+    void storeStarData(StarSlabPool& stars, OctreeNode& node, const float* starValues);
+
+    /**
+     * Sorts the stars of \p node by magnitude, and by the order in which they were
+     * stored for equal magnitudes, and keeps the first \p nKeep of them. The brightest
+     * star ends up first.
+     */
+    void sortStarsByMagnitude(StarSlabPool& stars, OctreeNode& node, size_t nKeep) const;
+
+    /**
+     * Moves the star data of \p node to a slab with room for at least \p capacity stars.
+     */
+    void resizeSlab(StarSlabPool& stars, OctreeNode& node, size_t capacity) const;
+
+    /**
+     * Replaces the star data of \p node with \p nStars stars, where the positions,
+     * colors and velocities are given in separate arrays.
+     */
+    void storeNodeData(OctreeNode& node, const float* posData, const float* colData,
+        const float* velData, size_t nStars);
 
     /**
      * Private help function for `printStarsPerNode()`.
@@ -236,15 +407,33 @@ private:
         const std::string& prefix) const;
 
     /**
-     * Private help function for `traverseData()`. Recursively checks which
-     * nodes intersect with the view frustum (interpreted as an AABB) and decides if data
-     * should be optimized away or not. Keeps track of which nodes that are visible and
-     * loaded (if streaming). \param deltaStars keeps track of how many stars that were
+     * Private help function for `traverseData()`. Tests the nodes in all branches that
+     * are traversed in this call against the view frustum (interpreted as an AABB), level
+     * by level, and decides the `CullingAction` of every node that will be reached. The
+     * nodes of a level are tested in batches by `OctreeCuller::cullBatch()`, which are
+     * spread over the threads of \p pool if the level is large enough. Only reads the
+     * Octree, the results are stored in `_cullingLevels`.
+     *
+     * \return the number of nodes that were tested
+     */
+    size_t cullOctree(const glm::dmat4& mvp, const glm::vec2& screenSize,
+        ThreadPool* pool);
+
+    /**
+     * Decides what to do with \p node given the results of the frustum culling. Keeps
+     * track of which nodes that are visible and loaded (if streaming).
+     */
+    CullingAction cullingAction(const OctreeNode& node, bool isVisible,
+        float totalPixels) const;
+
+    /**
+     * Private help function for `traverseData()`. Recursively applies the actions that
+     * `cullOctree()` decided for the node at \p index in \p level and its descendants,
+     * in depth-first order. \param deltaStars keeps track of how many stars that were
      * added/removed this render call.
      */
-    std::map<int, std::vector<float>> checkNodeIntersection(OctreeNode& node,
-        const glm::dmat4& mvp, const glm::vec2& screenSize, int& deltaStars,
-        gaia::RenderMode mode);
+    void checkNodeIntersection(OctreeNode& node, size_t level, size_t index,
+        int& deltaStars, gaia::RenderMode mode, TraversalData& renderData);
 
     /**
      * Checks if specified node existed in cache, and removes it if that's the case.
@@ -252,8 +441,18 @@ private:
      * long as \param recursive is not set to false. \param deltaStars keeps track of how
      * many stars that were removed.
      */
-    std::map<int, std::vector<float>> removeNodeFromCache(OctreeNode& node,
-        int& deltaStars, bool recursive = true);
+    void removeNodeFromCache(OctreeNode& node, int& deltaStars,
+        TraversalData& renderData, bool recursive = true);
+
+    /**
+     * Stores a chunk for \p bufferIndex in \p renderData with the data of \p node, or
+     * an empty chunk if \p node is a nullptr. If the index already has a chunk then the
+     * first one is kept, unless it was stored at or after position \p overwriteFrom in
+     * `renderData.chunks`.
+     */
+    void storeChunk(TraversalData& renderData, int bufferIndex, const OctreeNode* node,
+        gaia::RenderMode mode,
+        size_t overwriteFrom = std::numeric_limits<size_t>::max());
 
     /**
      * Get data in node and its descendants regardless if they are visible or not.
@@ -267,8 +466,16 @@ private:
 
     /**
      * Contruct default children nodes for specified node.
+     * Calls `initNodeChildren()` and updates the node counters.
+     */
+    void createNodeChildren(uint32_t nodeIndex);
+
+    /**
+     * Contruct default children nodes for the node at \p nodeIndex in \p store without
+     * touching any members, so it is safe to call for different stores on different
+     * threads. The children are appended to the nodes of \p store.
      */
-    void createNodeChildren(OctreeNode& node);
+    void initNodeChildren(NodeStore& store, uint32_t nodeIndex) const;
 
     /**
      * Checks if node should be inserted into stream or not. \returns true if it should,
@@ -292,55 +499,89 @@ private:
      * or if only structure should be written.
      */
     void writeNodeToFile(std::ofstream& outFileStream, const OctreeNode& node,
-        bool writeData);
+        bool writeData, bool quantizeData);
+
+    /**
+     * Writes the star data of \p node to \p outFileStream, either as floats preceded by
+     * the number of values or as gaia::QuantizedStars if \p quantizeData is `true`.
+     */
+    void writeNodeData(std::ofstream& outFileStream, const OctreeNode& node,
+        bool quantizeData) const;
 
     /**
      * Read a node from file and its potential children. \param readData defines if full
      * data or only structure should be read.
      * \returns accumulated sum of all read stars in node and its descendants.
      */
-    int readNodeFromFile(std::ifstream& inFileStream, OctreeNode& node, bool readData);
+    int readNodeFromFile(std::ifstream& inFileStream, uint32_t nodeIndex, bool readData);
 
     /**
      * Write node data to a file. \param outFilePrefix specifies the accumulated path
      * and name of the file. If \param threadWrites is set to true then one new thread
      * will be created for each child to write its descendents.
      */
-    void writeNodeToMultipleFiles(const std::string& outFilePrefix, OctreeNode& node,
-        bool threadWrites);
+    void writeNodeToMultipleFiles(const std::string& outFilePrefix,
+        const OctreeNode& node, bool threadWrites, bool quantizeData);
 
     /**
      * Finds the neighboring node on the same level (or a higher level if there is no
      * corresponding level) in the specified direction. Also fetches data from found node
      * if it's not already loaded. \param additionalLevelsToFetch determines if any
      * descendants of the found node should be fetched as well (if they exists).
+     * \param cameraPos is the position of the camera in kPc.
      */
     void findAndFetchNeighborNode(unsigned long long firstParentId, int x, int y, int z,
-        int additionalLevelsToFetch);
+        int additionalLevelsToFetch, const glm::vec3& cameraPos);
 
     /**
-     * Fetches data from all children of \param parentNode, as long as it's not already
+     * Requests data for all children of \param parentNode, as long as it's not already
      * fetched, it exists and it can fit in RAM.
      * \param additionalLevelsToFetch determines how many levels of descendants to fetch.
      * If it is set to 0 no additional level will be fetched.
      * If it is set to a negative value then all descendants will be fetched recursively.
-     * Calls `fetchNodeDataFromFile()` for every child that passes the tests.
+     * Calls `requestNodeData()` for every child that isn't loaded yet.
      */
-    void fetchChildrenNodes(OctreeNode& parentNode, int additionalLevelsToFetch);
+    void fetchChildrenNodes(OctreeNode& parentNode, int additionalLevelsToFetch,
+        const glm::vec3& cameraPos);
 
     /**
-     * Fetches data for specified node from file.
+     * Requests the data of \p node from the node loader, or updates the priority of an
+     * earlier request. Nodes that are close to \p cameraPos (in kPc) compared to their
+     * size are loaded first. The RAM for the node is reserved until the request is
+     * either installed or dropped.
      * OBS! Only call if node file exists (i.e. node has any data, node->numStars > 0)
      * and is not already loaded.
      */
-    void fetchNodeDataFromFile(OctreeNode& node);
+    void requestNodeData(OctreeNode& node, const glm::vec3& cameraPos);
 
     /**
-    * Loops though all nodes in \param nodesToRemove and clears them from RAM.
-    * Also checks if any ancestor should change the `hasLoadedDescendant` flag
-    * by calling `propagateUnloadedNodes()` with all ancestors.
-    */
-    void removeNodesFromRam(const std::vector<unsigned long long>& nodesToRemove);
+     * Moves the data of all nodes that the node loader has finished into the Octree and
+     * flags their ancestors as having a loaded descendant.
+     */
+    void installLoadedNodes();
+
+    /**
+     * Unloads the least recently used nodes until a tenth of the CPU RAM budget is free
+     * again. Also checks if any ancestor should change the `hasLoadedDescendant` flag
+     * by calling `propagateUnloadedNodes()` with all ancestors.
+     */
+    void removeNodesFromRam();
+
+    /**
+     * \returns all ancestors of the node with \p octreePositionIndex, starting with the
+     * root and ending with the parent of the node.
+     */
+    std::vector<uint32_t> findAncestors(unsigned long long octreePositionIndex) const;
+
+    /**
+     * \returns the index of the node with \p octreePositionIndex.
+     */
+    uint32_t findNode(unsigned long long octreePositionIndex) const;
+
+    /**
+     * \returns the number of bytes that the data of \p node occupies when it's loaded.
+     */
+    long long nodeSizeInBytes(const OctreeNode& node) const;
 
     /**
      * Removes data in specified node from main memory and updates RAM budget and flags
@@ -353,14 +594,25 @@ private:
      * loaded descendants left. If not, then flag `hasLoadedDescendant` will be
      * set to false for that parent node and next parent in line will be checked.
      */
-    void propagateUnloadedNodes(std::vector<std::shared_ptr<OctreeNode>> ancestorNodes);
+    void propagateUnloadedNodes(std::vector<uint32_t> ancestorNodes);
 
-    std::shared_ptr<OctreeNode> _root;
+    NodeStore _store;
+    // Guards the node array and the star slabs while a branch is written to files on
+    // another thread. Only taken by the functions that may run at the same time.
+    std::shared_mutex _storeMutex;
     std::unique_ptr<OctreeCuller> _culler;
     std::stack<int> _freeSpotsInBuffer;
     std::set<int> _removedKeysInPrevCall;
-    std::queue<unsigned long long> _leastRecentlyFetchedNodes;
-    std::mutex _leastRecentlyFetchedNodesMutex;
+    std::vector<CullingLevel> _cullingLevels;
+
+    // Reads node files while streaming. Requests that have been made but not installed
+    // yet are stored in `_requestedNodes`, and the loaded nodes in recency order
+    std::unique_ptr<OctreeNodeLoader> _nodeLoader;
+    std::unordered_set<unsigned long long> _requestedNodes;
+    using LoadedNodeCache = globebrowsing::cache::LRUCache<
+        unsigned long long, uint32_t, std::hash<unsigned long long>
+    >;
+    LoadedNodeCache _loadedNodes = LoadedNodeCache(std::numeric_limits<size_t>::max());
 
     size_t _totalDepth = 0;
     size_t _numLeafNodes = 0;
@@ -377,7 +629,6 @@ private:
     long long _cpuRamBudget = 0;
     long long _maxCpuRamBudget = 0;
     unsigned long long _parentNodeOfCamera = 8;
-    std::string _streamFolderPath;
     size_t _traversedBranchesInRenderCall = 0;
 
 }; // class OctreeManager
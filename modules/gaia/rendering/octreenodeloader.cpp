@@ -0,0 +1,177 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2023                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/gaia/rendering/octreenodeloader.h>
+
+#include <modules/gaia/rendering/starquantization.h>
+#include <ghoul/fmt.h>
+#include <ghoul/logging/logmanager.h>
+#include <ghoul/misc/assert.h>
+#include <fstream>
+
+namespace {
+    constexpr std::string_view _loggerCat = "OctreeNodeLoader";
+
+    constexpr std::string_view BinarySuffix = ".bin";
+} // namespace
+
+namespace openspace {
+
+OctreeNodeLoader::OctreeNodeLoader(std::string folderPath, size_t posSize,
+                                   size_t colSize, size_t velSize, int nThreads)
+    : _folderPath(std::move(folderPath))
+    , _posSize(posSize)
+    , _colSize(colSize)
+    , _velSize(velSize)
+{
+    ghoul_assert(nThreads > 0, "Need at least one I/O thread");
+
+    for (int i = 0; i < nThreads; ++i) {
+        _workers.emplace_back([this]() { work(); });
+    }
+}
+
+OctreeNodeLoader::~OctreeNodeLoader() {
+    {
+        std::lock_guard lock(_mutex);
+        _stop = true;
+    }
+    _condition.notify_all();
+    for (std::thread& worker : _workers) {
+        worker.join();
+    }
+}
+
+void OctreeNodeLoader::request(unsigned long long octreePositionIndex, float priority) {
+    {
+        std::lock_guard lock(_mutex);
+        ghoul_assert(
+            !_queuedPriorities.contains(octreePositionIndex) &&
+            !_inFlight.contains(octreePositionIndex),
+            "Node must not be requested twice"
+        );
+        _queuedPriorities[octreePositionIndex] = priority;
+        _queue.insert({ priority, octreePositionIndex });
+    }
+    _condition.notify_one();
+}
+
+void OctreeNodeLoader::reprioritize(unsigned long long octreePositionIndex,
+                                    float priority)
+{
+    std::lock_guard lock(_mutex);
+    auto it = _queuedPriorities.find(octreePositionIndex);
+    if (it == _queuedPriorities.end()) {
+        return;
+    }
+
+    // Move the request to its new place in the queue
+    _queue.erase({ it->second, octreePositionIndex });
+    it->second = priority;
+    _queue.insert({ priority, octreePositionIndex });
+}
+
+std::vector<unsigned long long> OctreeNodeLoader::clearQueue() {
+    std::lock_guard lock(_mutex);
+    std::vector<unsigned long long> removed;
+    removed.reserve(_queue.size());
+    for (const std::pair<float, unsigned long long>& request : _queue) {
+        removed.push_back(request.second);
+    }
+    _queue.clear();
+    _queuedPriorities.clear();
+    return removed;
+}
+
+std::optional<OctreeNodeLoader::LoadedNode> OctreeNodeLoader::popFinishedNode() {
+    std::lock_guard lock(_mutex);
+    if (_finished.empty()) {
+        return std::nullopt;
+    }
+    LoadedNode node = std::move(_finished.front());
+    _finished.pop_front();
+    return node;
+}
+
+void OctreeNodeLoader::work() {
+    while (true) {
+        unsigned long long octreePositionIndex = 0;
+        {
+            std::unique_lock lock(_mutex);
+            _condition.wait(lock, [this]() { return _stop || !_queue.empty(); });
+            if (_stop) {
+                return;
+            }
+
+            octreePositionIndex = _queue.begin()->second;
+            _queue.erase(_queue.begin());
+            _queuedPriorities.erase(octreePositionIndex);
+            _inFlight.insert(octreePositionIndex);
+        }
+
+        LoadedNode node = readNode(octreePositionIndex);
+
+        std::lock_guard lock(_mutex);
+        _inFlight.erase(octreePositionIndex);
+        _finished.push_back(std::move(node));
+    }
+}
+
+OctreeNodeLoader::LoadedNode
+OctreeNodeLoader::readNode(unsigned long long octreePositionIndex) const
+{
+    LoadedNode node;
+    node.octreePositionIndex = octreePositionIndex;
+
+    // Remove root ID ("8") from index before loading file.
+    std::string posId = std::to_string(octreePositionIndex);
+    posId.erase(posId.begin());
+
+    std::string inFilePath = fmt::format("{}{}{}", _folderPath, posId, BinarySuffix);
+    std::ifstream inFileStream(inFilePath, std::ifstream::binary);
+    if (!inFileStream.good()) {
+        LERROR(fmt::format("Error opening node data file: {}", inFilePath));
+        return node;
+    }
+
+    // Read node data, which is decoded here if it is quantized.
+    const bool success = gaia::readStarData(
+        inFileStream,
+        _posSize,
+        _colSize,
+        _velSize,
+        node.posData,
+        node.colData,
+        node.velData
+    );
+    if (!success) {
+        LERROR(fmt::format("Error reading node data file: {}", inFilePath));
+        return node;
+    }
+
+    node.isValid = true;
+    return node;
+}
+
+} // namespace openspace
@@ -0,0 +1,115 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2023                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_MODULE_GAIA___OCTREENODELOADER___H__
+#define __OPENSPACE_MODULE_GAIA___OCTREENODELOADER___H__
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace openspace {
+
+/**
+ * Reads the data files of streamed octree nodes on a pool of I/O threads. Requests are
+ * identified by the octree position index of the node and are served in the order of
+ * their priority, where a lower value is more urgent. Quantized node files are decoded
+ * on the I/O threads as well. The loader never touches the nodes themselves; the owner
+ * pops the finished nodes and installs their data on its own thread.
+ */
+class OctreeNodeLoader {
+public:
+    struct LoadedNode {
+        unsigned long long octreePositionIndex;
+        std::vector<float> posData;
+        std::vector<float> colData;
+        std::vector<float> velData;
+        /// `false` if the data file of the node could not be read
+        bool isValid = false;
+    };
+
+    /**
+     * \param folderPath is the prefix that the octree position index of a node (without
+     *        the root ID) is appended to in order to get the path to its data file
+     * \param nThreads is the number of I/O threads
+     */
+    OctreeNodeLoader(std::string folderPath, size_t posSize, size_t colSize,
+        size_t velSize, int nThreads);
+    ~OctreeNodeLoader();
+
+    /**
+     * Queues the node with \p octreePositionIndex with the provided \p priority. The
+     * node must not be queued, read or finished already.
+     */
+    void request(unsigned long long octreePositionIndex, float priority);
+
+    /**
+     * Updates the priority of the node with \p octreePositionIndex if it is still
+     * queued. Does nothing if the node is being read or has already been read.
+     */
+    void reprioritize(unsigned long long octreePositionIndex, float priority);
+
+    /**
+     * Removes all requests that have not been started yet.
+     *
+     * \return the octree position indices of the removed requests
+     */
+    std::vector<unsigned long long> clearQueue();
+
+    /**
+     * \return the next node that has finished loading, if there is any
+     */
+    std::optional<LoadedNode> popFinishedNode();
+
+private:
+    void work();
+    LoadedNode readNode(unsigned long long octreePositionIndex) const;
+
+    const std::string _folderPath;
+    const size_t _posSize;
+    const size_t _colSize;
+    const size_t _velSize;
+
+    mutable std::mutex _mutex;
+    std::condition_variable _condition;
+    // Queued requests ordered by priority, and the priority of every queued request
+    std::set<std::pair<float, unsigned long long>> _queue;
+    std::unordered_map<unsigned long long, float> _queuedPriorities;
+    std::unordered_set<unsigned long long> _inFlight;
+    std::deque<LoadedNode> _finished;
+    bool _stop = false;
+
+    std::vector<std::thread> _workers;
+};
+
+} // namespace openspace
+
+#endif // __OPENSPACE_MODULE_GAIA___OCTREENODELOADER___H__
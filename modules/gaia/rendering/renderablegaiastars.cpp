@@ -25,11 +25,13 @@
 #include <modules/gaia/rendering/renderablegaiastars.h>
 
 #include <modules/fitsfilereader/include/fitsfilereader.h>
+#include <modules/gaia/gaiamodule.h>
 #include <modules/gaia/rendering/gaiaoptions.h>
 #include <modules/gaia/rendering/octreeculler.h>
 #include <openspace/documentation/documentation.h>
 #include <openspace/documentation/verifier.h>
 #include <openspace/engine/globals.h>
+#include <openspace/engine/moduleengine.h>
 #include <openspace/engine/openspaceengine.h>
 #include <openspace/engine/windowdelegate.h>
 #include <openspace/rendering/renderengine.h>
@@ -43,6 +45,7 @@
 #include <ghoul/opengl/texture.h>
 #include <ghoul/opengl/textureunit.h>
 #include <ghoul/systemcapabilities/generalcapabilitiescomponent.h>
+#include <algorithm>
 #include <array>
 #include <fstream>
 #include <cstdint>
@@ -986,23 +989,27 @@ void RenderableGaiaStars::render(const RenderData& data, RendererTasks&) {
     // (if streaming)
     if (_fileReaderOption == gaia::FileReaderOption::StreamOctree) {
         glm::dvec3 cameraPos = data.camera.positionVec3();
-        size_t chunkSizeBytes = _chunkSize * sizeof(GLfloat);
-        _octreeManager.fetchSurroundingNodes(cameraPos, chunkSizeBytes, _additionalNodes);
+        _octreeManager.fetchSurroundingNodes(cameraPos, _additionalNodes);
 
         // Update CPU Budget property.
         _cpuRamBudgetProperty = static_cast<float>(_octreeManager.cpuRamBudget());
     }
 
-    // Traverse Octree and build a map with new nodes to render, uses mvp matrix to decide
+    // Traverse Octree and collect the chunks that changed, uses mvp matrix to decide
     const int renderOption = _renderMode;
     int deltaStars = 0;
-    std::map<int, std::vector<float>> updateData = _octreeManager.traverseData(
+    _octreeManager.traverseData(
         modelViewProjMat,
         screenSize,
         deltaStars,
         gaia::RenderMode(renderOption),
-        _lodPixelThreshold
+        _lodPixelThreshold,
+        _traversalData,
+        global::moduleEngine->module<GaiaModule>()->cullingThreadPool()
     );
+    const std::vector<OctreeManager::TraversalData::Chunk>& updateChunks =
+        _traversalData.chunks;
+    const float* updateValues = _traversalData.values.data();
 
     // Update number of rendered stars.
     _nStarsToRender += deltaStars;
@@ -1029,7 +1036,8 @@ void RenderableGaiaStars::render(const RenderData& data, RendererTasks&) {
         _accumulatedIndices.resize(nChunksToRender + 1, lastValue);
 
         // Update vector with accumulated indices.
-        for (const auto& [offset, subData] : updateData) {
+        for (const OctreeManager::TraversalData::Chunk& chunk : updateChunks) {
+            const int offset = chunk.bufferIndex;
             if (offset >= _accumulatedIndices.size() - 1) {
                 // @TODO(2023-03-08, alebo) We want to redo the whole rendering pipeline
                 // anyway, so right now we just bail out early if we get an invalid index
@@ -1037,8 +1045,7 @@ void RenderableGaiaStars::render(const RenderData& data, RendererTasks&) {
                 continue;
             }
 
-            int newValue = static_cast<int>(subData.size() / _nRenderValuesPerStar) +
-                           _accumulatedIndices[offset];
+            int newValue = static_cast<int>(chunk.nStars) + _accumulatedIndices[offset];
             int changeInValue = newValue - _accumulatedIndices[offset + 1];
             _accumulatedIndices[offset + 1] = newValue;
             // Propagate change.
@@ -1074,16 +1081,16 @@ void RenderableGaiaStars::render(const RenderData& data, RendererTasks&) {
         );
 
         // Update SSBO with one insert per chunk/node.
-        // The key in map holds the offset index.
-        for (const auto& [offset, subData] : updateData) {
+        // The buffer index of the chunk holds the offset index.
+        for (const OctreeManager::TraversalData::Chunk& chunk : updateChunks) {
             // We don't need to fill chunk with zeros for SSBOs!
             // Just check if we have any values to update.
-            if (!subData.empty()) {
+            if (chunk.nStars > 0) {
                 glBufferSubData(
                     GL_SHADER_STORAGE_BUFFER,
-                    offset * _chunkSize * sizeof(GLfloat),
-                    subData.size() * sizeof(GLfloat),
-                    subData.data()
+                    chunk.bufferIndex * _chunkSize * sizeof(GLfloat),
+                    chunk.nStars * _nRenderValuesPerStar * sizeof(GLfloat),
+                    updateValues + chunk.offset
                 );
             }
         }
@@ -1114,18 +1121,16 @@ void RenderableGaiaStars::render(const RenderData& data, RendererTasks&) {
         );
 
         // Update buffer with one insert per chunk/node.
-        //The key in map holds the offset index.
-        for (const auto& [offset, subData] : updateData) {
+        // The buffer index of the chunk holds the offset index.
+        for (const OctreeManager::TraversalData::Chunk& chunk : updateChunks) {
             // Fill chunk by appending zeroes so we overwrite possible earlier values.
-            // Only required when removing nodes because chunks are filled up in octree
-            // fetch on add.
-            std::vector<float> vectorData(subData.begin(), subData.end());
-            vectorData.resize(posChunkSize, 0.f);
+            const float* data = updateValues + chunk.offset;
+            fillVboChunkData(data, chunk.nStars * PositionSize, posChunkSize);
             glBufferSubData(
                 GL_ARRAY_BUFFER,
-                offset * posChunkSize * sizeof(GLfloat),
+                chunk.bufferIndex * posChunkSize * sizeof(GLfloat),
                 posChunkSize * sizeof(GLfloat),
-                vectorData.data()
+                _vboChunkData.data()
             );
         }
 
@@ -1147,16 +1152,17 @@ void RenderableGaiaStars::render(const RenderData& data, RendererTasks&) {
             );
 
             // Update buffer with one insert per chunk/node.
-            //The key in map holds the offset index.
-            for (const auto& [offset, subData] : updateData) {
+            // The buffer index of the chunk holds the offset index.
+            for (const OctreeManager::TraversalData::Chunk& chunk : updateChunks) {
                 // Fill chunk by appending zeroes so we overwrite possible earlier values.
-                std::vector<float> vectorData(subData.begin(), subData.end());
-                vectorData.resize(posChunkSize + colChunkSize, 0.f);
+                const float* data =
+                    updateValues + chunk.offset + chunk.nStars * PositionSize;
+                fillVboChunkData(data, chunk.nStars * ColorSize, colChunkSize);
                 glBufferSubData(
                     GL_ARRAY_BUFFER,
-                    offset * colChunkSize * sizeof(GLfloat),
+                    chunk.bufferIndex * colChunkSize * sizeof(GLfloat),
                     colChunkSize * sizeof(GLfloat),
-                    vectorData.data() + posChunkSize
+                    _vboChunkData.data()
                 );
             }
 
@@ -1179,16 +1185,17 @@ void RenderableGaiaStars::render(const RenderData& data, RendererTasks&) {
                 );
 
                 // Update buffer with one insert per chunk/node.
-                //The key in map holds the offset index.
-                for (const auto& [offset, subData] : updateData) {
+                // The buffer index of the chunk holds the offset index.
+                for (const OctreeManager::TraversalData::Chunk& chunk : updateChunks) {
                     // Fill chunk by appending zeroes.
-                    std::vector<float> vectorData(subData.begin(), subData.end());
-                    vectorData.resize(_chunkSize, 0.f);
+                    const float* data = updateValues + chunk.offset +
+                        chunk.nStars * (PositionSize + ColorSize);
+                    fillVboChunkData(data, chunk.nStars * VelocitySize, velChunkSize);
                     glBufferSubData(
                         GL_ARRAY_BUFFER,
-                        offset * velChunkSize * sizeof(GLfloat),
+                        chunk.bufferIndex * velChunkSize * sizeof(GLfloat),
                         velChunkSize * sizeof(GLfloat),
-                        vectorData.data() + posChunkSize + colChunkSize
+                        _vboChunkData.data()
                     );
                 }
             }
@@ -1383,6 +1390,15 @@ void RenderableGaiaStars::checkGlErrors(const std::string& identifier) const {
     }
 }
 
+void RenderableGaiaStars::fillVboChunkData(const float* data, size_t nValues,
+                                           size_t chunkSize)
+{
+    // Only grows the first time a chunk size is used, after that the memory is reused
+    _vboChunkData.resize(chunkSize);
+    std::copy(data, data + nValues, _vboChunkData.begin());
+    std::fill(_vboChunkData.begin() + nValues, _vboChunkData.end(), 0.f);
+}
+
 void RenderableGaiaStars::update(const UpdateData&) {
     const int shaderOption = _shaderOption;
     const int renderOption = _renderMode;
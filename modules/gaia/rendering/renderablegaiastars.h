@@ -115,6 +115,12 @@ private:
      */
     void checkGlErrors(const std::string& identifier) const;
 
+    /**
+     * Copies \p nValues values from \p data into _vboChunkData and pads it with zeroes
+     * up to \p chunkSize values, so that a full VBO chunk can be uploaded from it.
+     */
+    void fillVboChunkData(const float* data, size_t nValues, size_t chunkSize);
+
     properties::StringProperty _filePath;
     std::unique_ptr<ghoul::filesystem::File> _dataFile;
     bool _dataIsDirty = true;
@@ -182,6 +188,8 @@ private:
     std::unique_ptr<ghoul::opengl::Texture> _fboTexture;
 
     OctreeManager _octreeManager;
+    OctreeManager::TraversalData _traversalData;
+    std::vector<float> _vboChunkData;
     std::unique_ptr<ghoul::opengl::BufferBinding<
         ghoul::opengl::bufferbinding::Buffer::ShaderStorage>> _ssboIdxBinding;
     std::unique_ptr<ghoul::opengl::BufferBinding<
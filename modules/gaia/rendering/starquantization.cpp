@@ -0,0 +1,207 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2023                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/gaia/rendering/starquantization.h>
+
+#include <ghoul/glm.h>
+#include <glm/gtc/packing.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    constexpr float PositionSteps = 32767.f;
+
+    // Half floats can hold values up to 65504. The largest value of a node is divided by
+    // a power of two so that it ends up below this limit, which doesn't lose any bits
+    constexpr int LargestHalfExponent = 14;
+
+    int8_t exponentFor(const float* values, size_t nValues) {
+        float largest = 0.f;
+        for (size_t i = 0; i < nValues; ++i) {
+            if (std::isfinite(values[i])) {
+                largest = std::max(largest, std::abs(values[i]));
+            }
+        }
+        if (largest < std::ldexp(1.f, LargestHalfExponent + 1)) {
+            return 0;
+        }
+        return static_cast<int8_t>(
+            std::min(std::ilogb(largest) - LargestHalfExponent, 127)
+        );
+    }
+
+    void toHalf(const float* values, size_t nValues, int exponent,
+                std::vector<uint16_t>& result)
+    {
+        result.resize(nValues);
+        for (size_t i = 0; i < nValues; ++i) {
+            result[i] = glm::packHalf1x16(std::ldexp(values[i], -exponent));
+        }
+    }
+
+    void fromHalf(const std::vector<uint16_t>& values, int exponent, float* result) {
+        for (size_t i = 0; i < values.size(); ++i) {
+            result[i] = std::ldexp(glm::unpackHalf1x16(values[i]), exponent);
+        }
+    }
+
+    template <typename T>
+    void writeValues(std::ostream& stream, const std::vector<T>& values) {
+        stream.write(
+            reinterpret_cast<const char*>(values.data()),
+            values.size() * sizeof(T)
+        );
+    }
+
+    template <typename T>
+    void readValues(std::istream& stream, size_t nValues, std::vector<T>& values) {
+        values.resize(nValues);
+        stream.read(reinterpret_cast<char*>(values.data()), nValues * sizeof(T));
+    }
+} // namespace
+
+namespace openspace::gaia {
+
+QuantizedStars quantizeStars(const float* positions, const float* colors,
+                             const float* velocities, size_t nStars, size_t colorSize,
+                             size_t velocitySize, float originX, float originY,
+                             float originZ, float halfDimension)
+{
+    QuantizedStars result;
+    result.nStars = static_cast<int32_t>(nStars);
+    result.colorSize = static_cast<uint8_t>(colorSize);
+    result.velocitySize = static_cast<uint8_t>(velocitySize);
+    result.originX = originX;
+    result.originY = originY;
+    result.originZ = originZ;
+
+    // Stars are supposed to lie within their node, but stars beyond the radius of the
+    // octree end up in its outermost nodes
+    const float origin[3] = { originX, originY, originZ };
+    float scale = halfDimension;
+    for (size_t i = 0; i < nStars * 3; ++i) {
+        scale = std::max(scale, std::abs(positions[i] - origin[i % 3]));
+    }
+    result.scale = scale > 0.f ? scale : 1.f;
+
+    result.positions.resize(nStars * 3);
+    for (size_t i = 0; i < nStars * 3; ++i) {
+        const float offset = (positions[i] - origin[i % 3]) / result.scale;
+        result.positions[i] = static_cast<int16_t>(
+            std::clamp(std::round(offset * PositionSteps), -PositionSteps, PositionSteps)
+        );
+    }
+
+    result.colorExponent = exponentFor(colors, nStars * colorSize);
+    toHalf(colors, nStars * colorSize, result.colorExponent, result.colors);
+    result.velocityExponent = exponentFor(velocities, nStars * velocitySize);
+    toHalf(velocities, nStars * velocitySize, result.velocityExponent, result.velocities);
+    return result;
+}
+
+void dequantizeStars(const QuantizedStars& stars, float* positions, float* colors,
+                     float* velocities)
+{
+    const float origin[3] = { stars.originX, stars.originY, stars.originZ };
+    const float step = stars.scale / PositionSteps;
+    for (size_t i = 0; i < stars.positions.size(); ++i) {
+        positions[i] = origin[i % 3] + stars.positions[i] * step;
+    }
+
+    fromHalf(stars.colors, stars.colorExponent, colors);
+    fromHalf(stars.velocities, stars.velocityExponent, velocities);
+}
+
+void writeQuantizedStars(std::ostream& stream, const QuantizedStars& stars) {
+    stream.write(reinterpret_cast<const char*>(&QuantizedStarsMarker), sizeof(int32_t));
+    stream.write(reinterpret_cast<const char*>(&stars.nStars), sizeof(int32_t));
+    stream.write(reinterpret_cast<const char*>(&stars.colorSize), sizeof(uint8_t));
+    stream.write(reinterpret_cast<const char*>(&stars.velocitySize), sizeof(uint8_t));
+    stream.write(reinterpret_cast<const char*>(&stars.colorExponent), sizeof(int8_t));
+    stream.write(reinterpret_cast<const char*>(&stars.velocityExponent), sizeof(int8_t));
+    stream.write(reinterpret_cast<const char*>(&stars.originX), sizeof(float));
+    stream.write(reinterpret_cast<const char*>(&stars.originY), sizeof(float));
+    stream.write(reinterpret_cast<const char*>(&stars.originZ), sizeof(float));
+    stream.write(reinterpret_cast<const char*>(&stars.scale), sizeof(float));
+
+    writeValues(stream, stars.positions);
+    writeValues(stream, stars.colors);
+    writeValues(stream, stars.velocities);
+}
+
+bool readQuantizedStars(std::istream& stream, QuantizedStars& stars) {
+    stream.read(reinterpret_cast<char*>(&stars.nStars), sizeof(int32_t));
+    stream.read(reinterpret_cast<char*>(&stars.colorSize), sizeof(uint8_t));
+    stream.read(reinterpret_cast<char*>(&stars.velocitySize), sizeof(uint8_t));
+    stream.read(reinterpret_cast<char*>(&stars.colorExponent), sizeof(int8_t));
+    stream.read(reinterpret_cast<char*>(&stars.velocityExponent), sizeof(int8_t));
+    stream.read(reinterpret_cast<char*>(&stars.originX), sizeof(float));
+    stream.read(reinterpret_cast<char*>(&stars.originY), sizeof(float));
+    stream.read(reinterpret_cast<char*>(&stars.originZ), sizeof(float));
+    stream.read(reinterpret_cast<char*>(&stars.scale), sizeof(float));
+    if (!stream.good() || stars.nStars < 0) {
+        return false;
+    }
+
+    const size_t nStars = static_cast<size_t>(stars.nStars);
+    readValues(stream, nStars * 3, stars.positions);
+    readValues(stream, nStars * stars.colorSize, stars.colors);
+    readValues(stream, nStars * stars.velocitySize, stars.velocities);
+    return stream.good();
+}
+
+bool readStarData(std::istream& stream, size_t positionSize, size_t colorSize,
+                  size_t velocitySize, std::vector<float>& positions,
+                  std::vector<float>& colors, std::vector<float>& velocities)
+{
+    int32_t nDataSize = 0;
+    stream.read(reinterpret_cast<char*>(&nDataSize), sizeof(int32_t));
+    if (!stream.good()) {
+        return false;
+    }
+
+    if (nDataSize == QuantizedStarsMarker) {
+        QuantizedStars stars;
+        const bool success = readQuantizedStars(stream, stars) && positionSize == 3 &&
+            stars.colorSize == colorSize && stars.velocitySize == velocitySize;
+        if (!success) {
+            return false;
+        }
+
+        positions.resize(stars.nStars * positionSize);
+        colors.resize(stars.nStars * colorSize);
+        velocities.resize(stars.nStars * velocitySize);
+        dequantizeStars(stars, positions.data(), colors.data(), velocities.data());
+        return true;
+    }
+
+    const size_t nStars =
+        std::max(nDataSize, 0) / (positionSize + colorSize + velocitySize);
+    readValues(stream, nStars * positionSize, positions);
+    readValues(stream, nStars * colorSize, colors);
+    readValues(stream, nStars * velocitySize, velocities);
+    return stream.good();
+}
+
+} // namespace openspace::gaia
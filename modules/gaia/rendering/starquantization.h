@@ -0,0 +1,122 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2023                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_MODULE_GAIA___STARQUANTIZATION___H__
+#define __OPENSPACE_MODULE_GAIA___STARQUANTIZATION___H__
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+namespace openspace::gaia {
+
+/**
+ * Written in place of the number of values in front of the star data of a node when the
+ * data is quantized. Unquantized data starts with the (non-negative) number of floats.
+ */
+constexpr int32_t QuantizedStarsMarker = -1;
+
+/**
+ * The stars of one octree node in a reduced precision, which takes half the space of
+ * the full 32-bit floats:
+ *
+ *  - Positions are stored as signed 16-bit offsets from the origin of the node, relative
+ *    to the `scale` of the node, which is its half dimension. If any star lies outside
+ *    of the node the scale is grown to include it. The error of each coordinate is at
+ *    most `scale / 65534` (plus the float rounding of the decoded value), i.e. for a
+ *    node at depth `d` in an octree with radius `MAX_DIST` it is `MAX_DIST / (2^d *
+ *    65534)`.
+ *  - Colors and velocities are stored as IEEE 754 half floats after they have been
+ *    divided by `2^colorExponent` or `2^velocityExponent` respectively, which is chosen
+ *    so that the largest value of the node fits. The relative error of a value `v` is at
+ *    most `2^-11`, and the absolute error is at most `2^(exponent - 25)` for values with
+ *    `|v| < 2^(exponent - 14)`. With the default exponent of 0, a magnitude of 20 is
+ *    stored with an error of at most 0.0078.
+ *
+ * As for the floats, all positions come first, followed by all colors and then all
+ * velocities.
+ */
+struct QuantizedStars {
+    int32_t nStars = 0;
+    uint8_t colorSize = 0;
+    uint8_t velocitySize = 0;
+    int8_t colorExponent = 0;
+    int8_t velocityExponent = 0;
+    float originX = 0.f;
+    float originY = 0.f;
+    float originZ = 0.f;
+    float scale = 1.f;
+
+    std::vector<int16_t> positions;
+    std::vector<uint16_t> colors;
+    std::vector<uint16_t> velocities;
+};
+
+/**
+ * Quantizes \p nStars stars of a node with the provided \p originX, \p originY,
+ * \p originZ and \p halfDimension. Every star has three position values, \p colorSize
+ * color values and \p velocitySize velocity values.
+ */
+QuantizedStars quantizeStars(const float* positions, const float* colors,
+    const float* velocities, size_t nStars, size_t colorSize, size_t velocitySize,
+    float originX, float originY, float originZ, float halfDimension);
+
+/**
+ * Decodes \p stars into \p positions, \p colors and \p velocities, which must have room
+ * for all values of all stars.
+ */
+void dequantizeStars(const QuantizedStars& stars, float* positions, float* colors,
+    float* velocities);
+
+/**
+ * Writes \p stars to \p stream, starting with the #QuantizedStarsMarker.
+ */
+void writeQuantizedStars(std::ostream& stream, const QuantizedStars& stars);
+
+/**
+ * Reads quantized stars from \p stream, whose #QuantizedStarsMarker has already been
+ * read.
+ *
+ * \return `false` if the stream ended before all stars were read
+ */
+bool readQuantizedStars(std::istream& stream, QuantizedStars& stars);
+
+/**
+ * Reads the data of a node's stars from \p stream, which is either stored as floats
+ * (preceded by the number of values) or as quantized stars (preceded by the
+ * #QuantizedStarsMarker). The values are decoded into \p positions, \p colors and
+ * \p velocities, where each star has \p positionSize, \p colorSize and
+ * \p velocitySize values.
+ *
+ * \return `false` if the data could not be read or if quantized stars have a different
+ *         number of values per star
+ */
+bool readStarData(std::istream& stream, size_t positionSize, size_t colorSize,
+    size_t velocitySize, std::vector<float>& positions, std::vector<float>& colors,
+    std::vector<float>& velocities);
+
+} // namespace openspace::gaia
+
+#endif // __OPENSPACE_MODULE_GAIA___STARQUANTIZATION___H__
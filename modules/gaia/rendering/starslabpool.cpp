@@ -0,0 +1,199 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2023                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/gaia/rendering/starslabpool.h>
+
+#include <ghoul/misc/assert.h>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    // The size of the pages that slabs are carved out of. Larger slabs get one page each
+    constexpr size_t PageBytes = 1 << 20;
+} // namespace
+
+namespace openspace {
+
+bool StarSlabPool::Slab::isValid() const {
+    return sizeClass != NoSizeClass;
+}
+
+void StarSlabPool::configure(size_t maxStarsPerNode, size_t posSize, size_t colSize,
+                             size_t velSize)
+{
+    clear();
+    _posSize = posSize;
+    _colSize = colSize;
+    _velSize = velSize;
+    _valuesPerStar = posSize + colSize + velSize;
+
+    std::vector<size_t> capacities;
+    for (size_t c = 1; c < maxStarsPerNode; c += std::max<size_t>(c / 4, 1)) {
+        capacities.push_back(c);
+    }
+    // Full nodes are the most common ones, so they get a slab that fits exactly. The LOD
+    // cache of an inner node holds up to twice as many stars (plus one) while building.
+    capacities.push_back(maxStarsPerNode);
+    capacities.push_back(2 * maxStarsPerNode + 1);
+    ghoul_assert(capacities.size() < NoSizeClass, "Too many slab sizes");
+
+    for (size_t capacity : capacities) {
+        const size_t slabBytes = capacity * _valuesPerStar * sizeof(float);
+        SizeClass sizeClass;
+        sizeClass.capacity = capacity;
+        sizeClass.slabsPerPage = std::max<size_t>(PageBytes / slabBytes, 1);
+        _sizeClasses.push_back(std::move(sizeClass));
+    }
+}
+
+void StarSlabPool::clear() {
+    _sizeClasses.clear();
+    _bytesInUse = 0;
+    _bytesReserved = 0;
+}
+
+StarSlabPool::Slab StarSlabPool::allocate(size_t nStars) {
+    ghoul_assert(nStars > 0, "Slabs need room for at least one star");
+
+    Slab slab;
+    slab.sizeClass = sizeClassFor(nStars);
+    SizeClass& sizeClass = _sizeClasses[slab.sizeClass];
+    if (!sizeClass.freeSlabs.empty()) {
+        slab.index = sizeClass.freeSlabs.back();
+        sizeClass.freeSlabs.pop_back();
+    }
+    else {
+        if (sizeClass.nSlabs == sizeClass.pages.size() * sizeClass.slabsPerPage) {
+            const size_t nValues =
+                sizeClass.slabsPerPage * sizeClass.capacity * _valuesPerStar;
+            sizeClass.pages.push_back(std::unique_ptr<float[]>(new float[nValues]));
+            _bytesReserved += nValues * sizeof(float);
+        }
+        slab.index = sizeClass.nSlabs;
+        sizeClass.nSlabs++;
+    }
+
+    _bytesInUse += sizeClass.capacity * _valuesPerStar * sizeof(float);
+    return slab;
+}
+
+void StarSlabPool::release(Slab& slab) {
+    if (!slab.isValid()) {
+        return;
+    }
+
+    SizeClass& sizeClass = _sizeClasses[slab.sizeClass];
+    sizeClass.freeSlabs.push_back(slab.index);
+    _bytesInUse -= sizeClass.capacity * _valuesPerStar * sizeof(float);
+    slab = Slab();
+}
+
+StarSlabPool::Slab StarSlabPool::copy(const StarSlabPool& source, Slab slab,
+                                      size_t nStars, size_t capacity)
+{
+    ghoul_assert(nStars <= capacity, "Copied stars must fit in the new slab");
+
+    Slab result = allocate(capacity);
+    if (nStars > 0) {
+        std::memcpy(
+            positions(result),
+            source.positions(slab),
+            nStars * _posSize * sizeof(float)
+        );
+        std::memcpy(
+            colors(result),
+            source.colors(slab),
+            nStars * _colSize * sizeof(float)
+        );
+        std::memcpy(
+            velocities(result),
+            source.velocities(slab),
+            nStars * _velSize * sizeof(float)
+        );
+    }
+    return result;
+}
+
+size_t StarSlabPool::capacity(Slab slab) const {
+    return slab.isValid() ? _sizeClasses[slab.sizeClass].capacity : 0;
+}
+
+size_t StarSlabPool::capacityFor(size_t nStars) const {
+    return _sizeClasses[sizeClassFor(nStars)].capacity;
+}
+
+float* StarSlabPool::positions(Slab slab) {
+    return slabData(slab);
+}
+
+const float* StarSlabPool::positions(Slab slab) const {
+    return slabData(slab);
+}
+
+float* StarSlabPool::colors(Slab slab) {
+    return slabData(slab) + capacity(slab) * _posSize;
+}
+
+const float* StarSlabPool::colors(Slab slab) const {
+    return slabData(slab) + capacity(slab) * _posSize;
+}
+
+float* StarSlabPool::velocities(Slab slab) {
+    return slabData(slab) + capacity(slab) * (_posSize + _colSize);
+}
+
+const float* StarSlabPool::velocities(Slab slab) const {
+    return slabData(slab) + capacity(slab) * (_posSize + _colSize);
+}
+
+size_t StarSlabPool::bytesInUse() const {
+    return _bytesInUse;
+}
+
+size_t StarSlabPool::bytesReserved() const {
+    return _bytesReserved;
+}
+
+uint8_t StarSlabPool::sizeClassFor(size_t nStars) const {
+    auto it = std::lower_bound(
+        _sizeClasses.begin(),
+        _sizeClasses.end(),
+        nStars,
+        [](const SizeClass& sizeClass, size_t n) { return sizeClass.capacity < n; }
+    );
+    ghoul_assert(it != _sizeClasses.end(), "No slab is large enough");
+    return static_cast<uint8_t>(std::distance(_sizeClasses.begin(), it));
+}
+
+float* StarSlabPool::slabData(Slab slab) const {
+    ghoul_assert(slab.isValid(), "Slab must be valid");
+
+    const SizeClass& sizeClass = _sizeClasses[slab.sizeClass];
+    const size_t page = slab.index / sizeClass.slabsPerPage;
+    const size_t slabInPage = slab.index % sizeClass.slabsPerPage;
+    return sizeClass.pages[page].get() +
+           slabInPage * sizeClass.capacity * _valuesPerStar;
+}
+
+} // namespace openspace
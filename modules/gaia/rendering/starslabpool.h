@@ -0,0 +1,138 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2023                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_MODULE_GAIA___STARSLABPOOL___H__
+#define __OPENSPACE_MODULE_GAIA___STARSLABPOOL___H__
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace openspace {
+
+/**
+ * Stores the star data of octree nodes in slabs of a few fixed sizes. A slab holds the
+ * data of up to `capacity()` stars as a structure of arrays, with all positions first,
+ * followed by all colors and all velocities. The capacities grow by a quarter from one
+ * size to the next up to the maximum number of stars per node, so a slab is never much
+ * larger than the node it belongs to. The size after that fits the LOD cache of an
+ * inner node while the octree is being built.
+ *
+ * Slabs of the same size are carved out of pages that are never moved or freed until
+ * the pool is cleared, and released slabs are reused by the next node of the same size.
+ * Pointers to the data of a slab therefore stay valid until the slab is released. The
+ * pool is not thread-safe.
+ */
+class StarSlabPool {
+public:
+    static constexpr uint8_t NoSizeClass = 255;
+
+    struct Slab {
+        uint32_t index = 0;
+        uint8_t sizeClass = NoSizeClass;
+
+        bool isValid() const;
+    };
+
+    /**
+     * Releases all slabs and sets up the slab sizes for octree nodes with at most
+     * \p maxStarsPerNode stars, where each star has \p posSize position values,
+     * \p colSize color values and \p velSize velocity values.
+     */
+    void configure(size_t maxStarsPerNode, size_t posSize, size_t colSize,
+        size_t velSize);
+
+    /**
+     * Releases all slabs and frees all memory.
+     */
+    void clear();
+
+    /**
+     * \return a slab with room for at least \p nStars stars, which has to be larger than
+     *         0 and at most the capacity of the largest slab size
+     */
+    Slab allocate(size_t nStars);
+
+    /**
+     * Returns \p slab to the pool and invalidates it. Does nothing if \p slab isn't
+     * valid.
+     */
+    void release(Slab& slab);
+
+    /**
+     * \return a slab in this pool with room for at least \p capacity stars, that holds a
+     *         copy of the first \p nStars stars of \p slab in \p source. \p source may be
+     *         this pool
+     */
+    Slab copy(const StarSlabPool& source, Slab slab, size_t nStars, size_t capacity);
+
+    size_t capacity(Slab slab) const;
+
+    /**
+     * \return the capacity of the slabs that are allocated for \p nStars stars
+     */
+    size_t capacityFor(size_t nStars) const;
+
+    float* positions(Slab slab);
+    const float* positions(Slab slab) const;
+    float* colors(Slab slab);
+    const float* colors(Slab slab) const;
+    float* velocities(Slab slab);
+    const float* velocities(Slab slab) const;
+
+    /**
+     * \return the number of bytes of all slabs that are currently in use
+     */
+    size_t bytesInUse() const;
+
+    /**
+     * \return the number of bytes that are allocated by the pool
+     */
+    size_t bytesReserved() const;
+
+private:
+    struct SizeClass {
+        size_t capacity = 0;
+        size_t slabsPerPage = 0;
+        std::vector<std::unique_ptr<float[]>> pages;
+        /// The number of slabs that have been carved out of the pages so far
+        uint32_t nSlabs = 0;
+        std::vector<uint32_t> freeSlabs;
+    };
+
+    uint8_t sizeClassFor(size_t nStars) const;
+    float* slabData(Slab slab) const;
+
+    std::vector<SizeClass> _sizeClasses;
+    size_t _posSize = 0;
+    size_t _colSize = 0;
+    size_t _velSize = 0;
+    size_t _valuesPerStar = 0;
+    size_t _bytesInUse = 0;
+    size_t _bytesReserved = 0;
+};
+
+} // namespace openspace
+
+#endif // __OPENSPACE_MODULE_GAIA___STARSLABPOOL___H__
@@ -59,6 +59,13 @@ namespace {
         // folder and output multiple files for the Octree
         std::optional<bool> singleFileInput;
 
+        // If true then the positions of the stars are stored as 16-bit offsets within
+        // their node and colors and velocities as 16-bit floats, which halves the size of
+        // the data files. Positions keep a precision of at least 1/65534 of the half
+        // dimension of their node and all other values a relative precision of 2^-11.
+        // The data is decoded when it is read
+        std::optional<bool> quantizeStarData;
+
         // If defined then only stars with Position X values between [min, max] will be
         // inserted into Octree (if min is set to 0.0 it is read as -Inf, if max is set to
         // 0.0 it is read as +Inf). If min = max then all values equal min|max will be
@@ -216,6 +223,7 @@ ConstructOctreeTask::ConstructOctreeTask(const ghoul::Dictionary& dictionary) {
     _maxDist = p.maxDist.value_or(_maxDist);
     _maxStarsPerNode = p.maxStarsPerNode.value_or(_maxStarsPerNode);
     _singleFileInput = p.singleFileInput.value_or(_singleFileInput);
+    _quantizeStarData = p.quantizeStarData.value_or(_quantizeStarData);
 
     _octreeManager = std::make_shared<OctreeManager>();
     _indexOctreeManager = std::make_shared<OctreeManager>();
@@ -386,12 +394,14 @@ void ConstructOctreeTask::constructOctreeFromSingleFile(
         progressCallback(0.3f);
         LINFO("Constructing Octree");
 
-        // Insert star into octree. We assume the data already is in correct order.
+        // Collect render values of all stars that pass the filters. We assume the data
+        // already is in correct order.
+        std::vector<float> renderValues;
+        renderValues.reserve(static_cast<size_t>(nTotalStars) * RENDER_VALUES);
         for (size_t i = 0; i < fullData.size(); i += nValuesPerStar) {
             auto first = fullData.begin() + i;
             auto last = fullData.begin() + i + nValuesPerStar;
             std::vector<float> filterValues(first, last);
-            std::vector<float> renderValues(first, first + RENDER_VALUES);
 
             // Filter data by parameters.
             if (checkAllFilters(filterValues)) {
@@ -399,10 +409,16 @@ void ConstructOctreeTask::constructOctreeFromSingleFile(
                 continue;
             }
 
-            // If all filters passed then insert render values into Octree.
-            _octreeManager->insert(renderValues);
+            renderValues.insert(renderValues.end(), first, first + RENDER_VALUES);
         }
         inFileStream.close();
+
+        // Free the raw data before the Octree starts to grow.
+        fullData.clear();
+        fullData.shrink_to_fit();
+
+        // Insert all stars into Octree, building the branches in parallel.
+        _octreeManager->insertBulk(renderValues);
     }
     else {
         LERROR(fmt::format(
@@ -420,7 +436,7 @@ void ConstructOctreeTask::constructOctreeFromSingleFile(
         if (nValues == 0) {
             LERROR("Error writing file - No values were read from file");
         }
-        _octreeManager->writeToFile(outFileStream, true);
+        _octreeManager->writeToFile(outFileStream, true, _quantizeStarData);
 
         outFileStream.close();
     }
@@ -464,6 +480,7 @@ void ConstructOctreeTask::constructOctreeFromFolder(
     }
 
     std::vector<float> filterValues;
+    std::vector<float> renderValues;
     auto writeThreads = std::vector<std::thread>(8);
 
     _indexOctreeManager->initOctree(0, _maxDist, _maxStarsPerNode);
@@ -505,13 +522,12 @@ void ConstructOctreeTask::constructOctreeFromFolder(
                 //    continue;
                 //}
 
-                // If all filters passed then insert render values into Octree.
-                std::vector<float> renderValues(
+                // If all filters passed then collect render values for the Octree.
+                renderValues.insert(
+                    renderValues.end(),
                     filterValues.begin(),
                     filterValues.begin() + RENDER_VALUES
                 );
-
-                _indexOctreeManager->insert(renderValues);
                 nStarsInfile++;
 
                 //float maxVal = fmax(fmax(fabs(renderValues[0]), fabs(renderValues[1])),
@@ -541,6 +557,10 @@ void ConstructOctreeTask::constructOctreeFromFolder(
             ));
         }
 
+        // Insert all stars of the file into Octree, building the branches in parallel.
+        _indexOctreeManager->insertBulk(renderValues);
+        renderValues.clear();
+
         // Slice LOD data.
         LINFO("Slicing LOD data");
         _indexOctreeManager->sliceLodData(idx);
@@ -562,7 +582,8 @@ void ConstructOctreeTask::constructOctreeFromFolder(
             &OctreeManager::writeToMultipleFiles,
             _indexOctreeManager,
             _outFileOrFolderPath.string(),
-            idx
+            idx,
+            _quantizeStarData
         );
         writeThreads[idx] = std::move(t);
     }
@@ -22,87 +22,53 @@
  * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
  ****************************************************************************************/
 
-#include <modules/gaia/tasks/readfilejob.h>
+#include <modules/gaia/tasks/fitsstarconversion.h>
 
-#include <openspace/util/distanceconversion.h>
-#include <ghoul/misc/dictionary.h>
-#include <ghoul/logging/logmanager.h>
-#include <ghoul/fmt.h>
-
-namespace {
-    constexpr std::string_view _loggerCat = "ReadFileJob";
-} // namespace
+#include <ghoul/glm.h>
+#include <cmath>
 
 namespace openspace::gaia {
 
-ReadFileJob::ReadFileJob(std::string filePath, std::vector<std::string> allColumns,
-                         int firstRow, int lastRow, size_t nDefaultCols,
-                         int nValuesPerStar, std::shared_ptr<FitsFileReader> fitsReader)
-    : _inFilePath(std::move(filePath))
-    , _firstRow(firstRow)
-    , _lastRow(lastRow)
-    , _nDefaultCols(nDefaultCols)
-    , _nValuesPerStar(nValuesPerStar)
-    , _allColumns(std::move(allColumns))
-    , _fitsFileReader(std::move(fitsReader))
-    , _octants(8)
-{}
+int convertStarsToOctants(const TableChunk& chunk, size_t nDefaultCols,
+                          int nValuesPerStar, std::vector<std::vector<float>>& octants)
+{
+    const std::vector<std::vector<float>>& columns = chunk.columns;
 
-void ReadFileJob::execute() {
-    // Read columns from FITS file. If rows aren't specified then full table will be read.
-    std::shared_ptr<TableData<float>> table = _fitsFileReader->readTable<float>(
-        _inFilePath,
-        _allColumns,
-        _firstRow,
-        _lastRow
+    // Default columns parameters.
+    const std::vector<float>& ra = columns[0];
+    const std::vector<float>& ra_err = columns[1];
+    const std::vector<float>& dec = columns[2];
+    const std::vector<float>& dec_err = columns[3];
+    const std::vector<float>& parallax = columns[4];
+    const std::vector<float>& parallax_err = columns[5];
+    const std::vector<float>& pmraCol = columns[6];
+    const std::vector<float>& pmra_err = columns[7];
+    const std::vector<float>& pmdecCol = columns[8];
+    const std::vector<float>& pmdec_err = columns[9];
+    const std::vector<float>& meanMagG = columns[10];
+    const std::vector<float>& meanMagBp = columns[11];
+    const std::vector<float>& meanMagRp = columns[12];
+    const std::vector<float>& bp_rp = columns[13];
+    const std::vector<float>& bp_g = columns[14];
+    const std::vector<float>& g_rp = columns[15];
+    const std::vector<float>& radialVelCol = columns[16];
+    const std::vector<float>& radial_vel_err = columns[17];
+
+    // Convert ICRS Equatorial Ra and Dec to Galactic latitude and longitude.
+    const glm::mat3 aPrimG = glm::mat3(
+        // Col 0
+        glm::vec3(-0.0548755604162154, 0.4941094278755837, -0.8676661490190047),
+        // Col 1
+        glm::vec3(-0.8734370902348850, -0.4448296299600112, -0.1980763734312015),
+        // Col 2
+        glm::vec3(-0.4838350155487132, 0.7469822444972189, 0.4559837761750669)
     );
 
-    if (!table) {
-        throw ghoul::RuntimeError(
-            fmt::format("Failed to open Fits file '{}'", _inFilePath
-        ));
-    }
-
-    int nStars = table->readRows - _firstRow + 1;
-
     int nNullArr = 0;
-    size_t nColumnsRead = _allColumns.size();
-    if (nColumnsRead != _nDefaultCols) {
-        LINFO(
-            "Additional columns will be read! Consider add column in code for "
-            "significant speedup"
-        );
-    }
-
-    // Copy columns to local variables.
-    std::unordered_map<std::string, std::vector<float>>& tableContent = table->contents;
-
-    // Default columns parameters.
-    //std::vector<float> l_longitude = std::move(tableContent[_allColumns[0]]);
-    //std::vector<float> b_latitude = std::move(tableContent[_allColumns[1]]);
-    std::vector<float> ra = std::move(tableContent[_allColumns[0]]);
-    std::vector<float> ra_err = std::move(tableContent[_allColumns[1]]);
-    std::vector<float> dec = std::move(tableContent[_allColumns[2]]);
-    std::vector<float> dec_err = std::move(tableContent[_allColumns[3]]);
-    std::vector<float> parallax = std::move(tableContent[_allColumns[4]]);
-    std::vector<float> parallax_err = std::move(tableContent[_allColumns[5]]);
-    std::vector<float> pmra = std::move(tableContent[_allColumns[6]]);
-    std::vector<float> pmra_err = std::move(tableContent[_allColumns[7]]);
-    std::vector<float> pmdec = std::move(tableContent[_allColumns[8]]);
-    std::vector<float> pmdec_err = std::move(tableContent[_allColumns[9]]);
-    std::vector<float> meanMagG = std::move(tableContent[_allColumns[10]]);
-    std::vector<float> meanMagBp = std::move(tableContent[_allColumns[11]]);
-    std::vector<float> meanMagRp = std::move(tableContent[_allColumns[12]]);
-    std::vector<float> bp_rp = std::move(tableContent[_allColumns[13]]);
-    std::vector<float> bp_g = std::move(tableContent[_allColumns[14]]);
-    std::vector<float> g_rp = std::move(tableContent[_allColumns[15]]);
-    std::vector<float> radial_vel = std::move(tableContent[_allColumns[16]]);
-    std::vector<float> radial_vel_err = std::move(tableContent[_allColumns[17]]);
-
+    std::vector<float> values(nValuesPerStar);
 
     // Construct data array. OBS: ORDERING IS IMPORTANT! This is where slicing happens.
-    for (int i = 0; i < nStars; ++i) {
-        std::vector<float> values(_nValuesPerStar);
+    for (size_t i = 0; i < static_cast<size_t>(chunk.nRows); ++i) {
         size_t idx = 0;
 
         // Default order for rendering:
@@ -127,28 +93,9 @@ void ReadFileJob::execute() {
             // Parallax is in milliArcseconds -> distance in kiloParsecs
             // https://gea.esac.esa.int/archive/documentation/GDR2/Gaia_archive/
             // chap_datamodel/sec_dm_main_tables/ssec_dm_gaia_source.html
-            //LINFO("Parallax: " + std::to_string(parallax[i]));
             radiusInKiloParsec = 1.f / parallax[i];
         }
-        /*// Convert to Galactic Coordinates from Galactic Lon & Lat.
-        // https://gea.esac.esa.int/archive/documentation/GDR2/Data_processing/
-        // chap_cu3ast/sec_cu3ast_intro/ssec_cu3ast_intro_tansforms.html#SSS1
-        values[idx++] = radiusInKiloParsec * cos(glm::radians(b_latitude[i])) *
-            cos(glm::radians(l_longitude[i])); // Pos X
-        values[idx++] = radiusInKiloParsec * cos(glm::radians(b_latitude[i])) *
-            sin(glm::radians(l_longitude[i])); // Pos Y
-        values[idx++] = radiusInKiloParsec * sin(glm::radians(b_latitude[i])); // Pos Z
-        */
 
-        // Convert ICRS Equatorial Ra and Dec to Galactic latitude and longitude.
-        glm::mat3 aPrimG = glm::mat3(
-            // Col 0
-            glm::vec3(-0.0548755604162154, 0.4941094278755837, -0.8676661490190047),
-            // Col 1
-            glm::vec3(-0.8734370902348850, -0.4448296299600112, -0.1980763734312015),
-            // Col 2
-            glm::vec3(-0.4838350155487132, 0.7469822444972189, 0.4559837761750669)
-        );
         glm::vec3 rICRS = glm::vec3(
             cos(glm::radians(ra[i])) * cos(glm::radians(dec[i])),
             sin(glm::radians(ra[i])) * cos(glm::radians(dec[i])),
@@ -159,35 +106,23 @@ void ReadFileJob::execute() {
         values[idx++] = radiusInKiloParsec * rGal.y; // Pos Y
         values[idx++] = radiusInKiloParsec * rGal.z; // Pos Z
 
-        /*if (abs(rGal.x - values[0]) > 1e-5 || abs(rGal.y - values[1]) > 1e-5 ||
-        abs(rGal.z - values[2]) > 1e-5) {
-        LINFO("rGal: " + std::to_string(rGal) +
-        " - LB: [" + std::to_string(values[0]) + ", " + std::to_string(values[1]) +
-        ", " + std::to_string(values[2]) + "]");
-        }*/
-
         // Store magnitude render value. (Set default to high mag = low brightness)
         values[idx++] = std::isnan(meanMagG[i]) ? 20.f : meanMagG[i]; // Mean G-band Mag
 
         // Store color render value. (Default value is bluish stars)
         values[idx++] = std::isnan(bp_rp[i]) ? 0.f : bp_rp[i]; // Bp-Rp Color
 
-
         // Store velocity.
-        if (std::isnan(pmra[i])) {
-            pmra[i] = 0.f;
-        }
-        if (std::isnan(pmdec[i])) {
-            pmdec[i] = 0.f;
-        }
+        const float pmra = std::isnan(pmraCol[i]) ? 0.f : pmraCol[i];
+        const float pmdec = std::isnan(pmdecCol[i]) ? 0.f : pmdecCol[i];
 
         // Convert Proper Motion from ICRS [Ra,Dec] to Galactic Tanget Vector [l,b].
         glm::vec3 uICRS = glm::vec3(
-            -sin(glm::radians(ra[i])) * pmra[i] -
-                cos(glm::radians(ra[i])) * sin(glm::radians(dec[i])) * pmdec[i],
-            cos(glm::radians(ra[i])) * pmra[i] -
-                sin(glm::radians(ra[i])) * sin(glm::radians(dec[i])) * pmdec[i],
-            cos(glm::radians(dec[i]))  * pmdec[i]
+            -sin(glm::radians(ra[i])) * pmra -
+                cos(glm::radians(ra[i])) * sin(glm::radians(dec[i])) * pmdec,
+            cos(glm::radians(ra[i])) * pmra -
+                sin(glm::radians(ra[i])) * sin(glm::radians(dec[i])) * pmdec,
+            cos(glm::radians(dec[i])) * pmdec
         );
         glm::vec3 pmVecGal = aPrimG * uICRS;
 
@@ -197,12 +132,13 @@ void ReadFileJob::execute() {
         float tanVelZ = 1000.f * 4.74f * radiusInKiloParsec * pmVecGal.z;
 
         // Calculate True Space Velocity [m/s] if we have the radial velocity
-        if (!std::isnan(radial_vel[i])) {
+        float radialVel = radialVelCol[i];
+        if (!std::isnan(radialVel)) {
             // Calculate Radial Velocity in the direction of the star.
             // radial_vel is given in [km/s] -> convert to [m/s].
-            float radVelX = 1000.f * radial_vel[i] * rGal.x;
-            float radVelY = 1000.f * radial_vel[i] * rGal.y;
-            float radVelZ = 1000.f * radial_vel[i] * rGal.z;
+            float radVelX = 1000.f * radialVel * rGal.x;
+            float radVelY = 1000.f * radialVel * rGal.y;
+            float radVelZ = 1000.f * radialVel * rGal.z;
 
             // Use Pythagoras theorem for the final Space Velocity [m/s].
             values[idx++] = static_cast<float>(
@@ -217,7 +153,7 @@ void ReadFileJob::execute() {
         }
         // Otherwise use the vector [m/s] we got from proper motion.
         else {
-            radial_vel[i] = 0.f;
+            radialVel = 0.f;
             values[idx++] = tanVelX; // Vel X [U]
             values[idx++] = tanVelY; // Vel Y [V]
             values[idx++] = tanVelZ; // Vel Z [W]
@@ -234,17 +170,16 @@ void ReadFileJob::execute() {
         values[idx++] = std::isnan(dec_err[i]) ? 0.f : dec_err[i];
         values[idx++] = std::isnan(parallax[i]) ? 0.f : parallax[i];
         values[idx++] = std::isnan(parallax_err[i]) ? 0.f : parallax_err[i];
-        values[idx++] = pmra[i];
+        values[idx++] = pmra;
         values[idx++] = std::isnan(pmra_err[i]) ? 0.f : pmra_err[i];
-        values[idx++] = pmdec[i];
+        values[idx++] = pmdec;
         values[idx++] = std::isnan(pmdec_err[i]) ? 0.f : pmdec_err[i];
-        values[idx++] = radial_vel[i];
+        values[idx++] = radialVel;
         values[idx++] = std::isnan(radial_vel_err[i]) ? 0.f : radial_vel_err[i];
 
-        // Read extra columns, if any. This will slow down the sorting tremendously!
-        for (size_t col = _nDefaultCols; col < nColumnsRead; ++col) {
-            std::vector<float> vecData = std::move(tableContent[_allColumns[col]]);
-            values[idx++] = std::isnan(vecData[col]) ? 0.f : vecData[col];
+        // Store extra columns, if any.
+        for (size_t col = nDefaultCols; col < columns.size(); ++col) {
+            values[idx++] = std::isnan(columns[col][i]) ? 0.f : columns[col][i];
         }
 
         size_t index = 0;
@@ -258,14 +193,10 @@ void ReadFileJob::execute() {
             index += 4;
         }
 
-        _octants[index].insert(_octants[index].end(), values.begin(), values.end());
+        octants[index].insert(octants[index].end(), values.begin(), values.end());
     }
 
-    // LINFO(fmt::format("{} out of {} read stars were nullArrays", nNullArr, nStars));
-}
-
-std::vector<std::vector<float>> ReadFileJob::product() {
-    return _octants;
+    return nNullArr;
 }
 
-} // namespace openspace::gaiamission
+} // namespace openspace::gaia
@@ -22,50 +22,28 @@
  * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
  ****************************************************************************************/
 
-#ifndef __OPENSPACE_MODULE_GAIA___READFILEJOB___H__
-#define __OPENSPACE_MODULE_GAIA___READFILEJOB___H__
-
-#include <openspace/util/concurrentjobmanager.h>
+#ifndef __OPENSPACE_MODULE_GAIA___FITSSTARCONVERSION___H__
+#define __OPENSPACE_MODULE_GAIA___FITSSTARCONVERSION___H__
 
 #include <modules/fitsfilereader/include/fitsfilereader.h>
+#include <vector>
 
 namespace openspace::gaia {
 
-struct ReadFileJob : public Job<std::vector<std::vector<float>>> {
-    /**
-     * Constructs a Job that will read a single FITS file in a concurrent thread and
-     * divide the star data into 8 octants depending on position.
-     * \param allColumns define which columns that will be read, it should correspond
-     * to the pre-defined order in the job. If additional columns are defined they will
-     * be read but slow down the process.
-     * Proper conversions of positions and velocities will take place and all values
-     * will be checked for NaNs.
-     * If \param firstRow is < 1 then reading will begin at first row in table.
-     * If \param lastRow < firstRow then entire table will be read.
-     * \param nValuesPerStar defines how many values that will be stored per star.
-     */
-    ReadFileJob(std::string filePath, std::vector<std::string> allColumns, int firstRow,
-        int lastRow, size_t nDefaultCols, int nValuesPerStar,
-        std::shared_ptr<FitsFileReader> fitsReader);
-
-    ~ReadFileJob() override = default;
-
-    void execute() override;
-
-    std::vector<std::vector<float>> product() override;
-
-private:
-    std::string _inFilePath;
-    int _firstRow;
-    int _lastRow;
-    size_t _nDefaultCols;
-    int _nValuesPerStar;
-    std::vector<std::string> _allColumns;
-
-    std::shared_ptr<FitsFileReader> _fitsFileReader;
-    std::vector<std::vector<float>> _octants;
-};
-
-} // namespace openspace::gaiamission
-
-#endif // __OPENSPACE_MODULE_GAIA___READFILEJOB___H__
+/**
+ * Converts the stars in \p chunk into the values that are stored for each star and
+ * divides them into 8 \p octants depending on position.
+ * The columns of \p chunk have to be in the pre-defined order of the default columns,
+ * followed by any additional columns (\p nDefaultCols is the number of default columns).
+ * Proper conversions of positions and velocities will take place and all values
+ * will be checked for NaNs. Stars without a measured position are skipped.
+ * \param nValuesPerStar defines how many values that will be stored per star.
+ *
+ * \return the number of stars that were skipped
+ */
+int convertStarsToOctants(const TableChunk& chunk, size_t nDefaultCols,
+    int nValuesPerStar, std::vector<std::vector<float>>& octants);
+
+} // namespace openspace::gaia
+
+#endif // __OPENSPACE_MODULE_GAIA___FITSSTARCONVERSION___H__
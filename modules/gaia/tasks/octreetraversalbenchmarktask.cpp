@@ -0,0 +1,344 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2023                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/gaia/tasks/octreetraversalbenchmarktask.h>
+
+#include <modules/gaia/rendering/octreeculler.h>
+#include <modules/gaia/rendering/octreemanager.h>
+#include <openspace/documentation/documentation.h>
+#include <openspace/documentation/verifier.h>
+#include <openspace/util/distanceconstants.h>
+#include <openspace/util/threadpool.h>
+#include <ghoul/fmt.h>
+#include <ghoul/filesystem/filesystem.h>
+#include <ghoul/logging/logmanager.h>
+#include <ghoul/misc/dictionary.h>
+#include <ghoul/misc/dictionaryjsonformatter.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <numeric>
+#include <thread>
+
+namespace {
+    constexpr std::string_view _loggerCat = "OctreeTraversalBenchmarkTask";
+
+    bool isEqual(const openspace::OctreeManager::TraversalData& a,
+                 const openspace::OctreeManager::TraversalData& b)
+    {
+        if (a.chunks.size() != b.chunks.size() || a.values != b.values) {
+            return false;
+        }
+        for (size_t i = 0; i < a.chunks.size(); ++i) {
+            if (a.chunks[i].bufferIndex != b.chunks[i].bufferIndex ||
+                a.chunks[i].offset != b.chunks[i].offset ||
+                a.chunks[i].nStars != b.chunks[i].nStars)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    double percentile(const std::vector<double>& sorted, double p) {
+        if (sorted.empty()) {
+            return 0.0;
+        }
+        const size_t i = static_cast<size_t>(p * static_cast<double>(sorted.size() - 1));
+        return sorted[i];
+    }
+
+    struct [[codegen::Dictionary(OctreeTraversalBenchmarkTask)]] Parameters {
+        // The path to a binary file with a full octree, as written by the
+        // ConstructOctreeTask with SingleFileInput set to true
+        std::filesystem::path inFilePath;
+
+        // The number of traversals, which are evenly spread over one revolution of the
+        // camera
+        std::optional<int> frames [[codegen::greater(0)]];
+
+        // The render mode, which determines how many values per star are collected
+        std::optional<std::string> renderMode [[codegen::inlist("Static", "Color",
+            "Motion")]];
+
+        // The minimum number of pixels a node has to cover on screen before its
+        // children are traversed instead of its LOD cache
+        std::optional<float> lodPixelThreshold [[codegen::greaterequal(0.f)]];
+
+        // The size of the simulated screen in pixels
+        std::optional<glm::ivec2> screenSize;
+
+        // The vertical field of view of the camera in degrees
+        std::optional<double> fieldOfView [[codegen::inrange(1.0, 179.0)]];
+
+        // The number of nodes that fit in the streaming buffer. If this value is not
+        // specified, every node of the octree fits
+        std::optional<int> maxNodesInStream [[codegen::greater(0)]];
+
+        // The number of threads that help the calling thread with the culling. If this
+        // value is not specified, one thread fewer than the number of cores is used
+        std::optional<int> threads [[codegen::greaterequal(0)]];
+
+        // If this value is true, a second copy of the octree is traversed on the calling
+        // thread only and every frame is checked to produce the same chunks as the
+        // threaded traversal
+        std::optional<bool> verify;
+
+        // If this value is specified, the results are also written as JSON to this file
+        std::optional<std::string> output [[codegen::annotation("A valid filepath")]];
+    };
+#include "octreetraversalbenchmarktask_codegen.cpp"
+} // namespace
+
+namespace openspace {
+
+documentation::Documentation OctreeTraversalBenchmarkTask::Documentation() {
+    return codegen::doc<Parameters>("gaiamission_octreetraversalbenchmark");
+}
+
+OctreeTraversalBenchmarkTask::OctreeTraversalBenchmarkTask(
+                                                      const ghoul::Dictionary& dictionary)
+{
+    const Parameters p = codegen::bake<Parameters>(dictionary);
+
+    _inFilePath = absPath(p.inFilePath);
+    if (p.output.has_value()) {
+        _output = absPath(*p.output);
+    }
+    _nFrames = p.frames.value_or(720);
+
+    const std::string renderMode = p.renderMode.value_or("Motion");
+    if (renderMode == "Static") {
+        _renderMode = gaia::RenderMode::Static;
+    }
+    else if (renderMode == "Color") {
+        _renderMode = gaia::RenderMode::Color;
+    }
+    else {
+        _renderMode = gaia::RenderMode::Motion;
+    }
+
+    _lodPixelThreshold = p.lodPixelThreshold.value_or(250.f);
+    _screenSize = glm::max(p.screenSize.value_or(glm::ivec2(1920, 1080)), glm::ivec2(1));
+    _fieldOfView = p.fieldOfView.value_or(60.0);
+    _maxNodesInStream = p.maxNodesInStream;
+    _nThreads = p.threads.value_or(
+        std::max(static_cast<int>(std::thread::hardware_concurrency()) - 1, 0)
+    );
+    _verify = p.verify.value_or(false);
+}
+
+std::string OctreeTraversalBenchmarkTask::description() {
+    return fmt::format("Measure the traversal of the octree in {}", _inFilePath);
+}
+
+void OctreeTraversalBenchmarkTask::perform(const Task::ProgressCallback& onProgress) {
+    onProgress(0.f);
+
+    OctreeManager octreeManager;
+    octreeManager.initOctree();
+
+    std::ifstream inFileStream(_inFilePath, std::ifstream::binary);
+    if (!inFileStream.good()) {
+        LERROR(fmt::format("Error opening file {} for loading octree", _inFilePath));
+        return;
+    }
+    const int nStars = octreeManager.readFromFile(inFileStream, true);
+    inFileStream.close();
+
+    const long long maxNodes = _maxNodesInStream.value_or(
+        static_cast<int>(octreeManager.totalNodes())
+    );
+    octreeManager.initBufferIndexStack(maxNodes, false, true);
+    LINFO(fmt::format(
+        "Read {} stars in {} nodes, streaming buffer fits {} nodes",
+        nStars, octreeManager.totalNodes(), maxNodes
+    ));
+    const size_t memoryInBytes = octreeManager.memoryInBytes();
+    LINFO(fmt::format(
+        "Octree uses {:.1f} MB for its nodes and star data",
+        memoryInBytes / (1024.0 * 1024.0)
+    ));
+
+    // The reference traversal needs its own octree, as traversing changes the nodes
+    OctreeManager referenceManager;
+    if (_verify) {
+        referenceManager.initOctree();
+        inFileStream.open(_inFilePath, std::ifstream::binary);
+        referenceManager.readFromFile(inFileStream, true);
+        inFileStream.close();
+        referenceManager.initBufferIndexStack(maxNodes, false, true);
+    }
+    onProgress(0.1f);
+
+    ThreadPool pool(_nThreads);
+
+    const glm::vec2 screenSize = glm::vec2(_screenSize);
+    const double kiloParsec = 1000.0 * distanceconstants::Parsec;
+    const glm::dmat4 projection = glm::perspective(
+        glm::radians(_fieldOfView),
+        static_cast<double>(screenSize.x) / static_cast<double>(screenSize.y),
+        1e-6 * kiloParsec,
+        1e3 * kiloParsec
+    );
+
+    OctreeManager::TraversalData renderData;
+    OctreeManager::TraversalData referenceData;
+    std::vector<double> frameTimes;
+    frameTimes.reserve(_nFrames);
+    size_t nCulledNodes = 0;
+    int nMismatchingFrames = 0;
+    size_t nChunks = 0;
+    size_t nChangedStars = 0;
+    int nGrowingFrames = 0;
+    int lastGrowingFrame = -1;
+    int nRenderedStars = 0;
+
+    for (int i = 0; i < _nFrames; ++i) {
+        const double angle = glm::two_pi<double>() * i / _nFrames;
+        const glm::dvec3 forward = glm::dvec3(std::sin(angle), 0.0, -std::cos(angle));
+        const glm::dmat4 mvp = projection *
+            glm::lookAt(glm::dvec3(0.0), forward, glm::dvec3(0.0, 1.0, 0.0));
+
+        const size_t chunkCapacity = renderData.chunks.capacity();
+        const size_t valueCapacity = renderData.values.capacity();
+        const size_t lookupCapacity = renderData.chunkLookup.capacity();
+
+        int deltaStars = 0;
+        const auto start = std::chrono::steady_clock::now();
+        octreeManager.traverseData(
+            mvp,
+            screenSize,
+            deltaStars,
+            _renderMode,
+            _lodPixelThreshold,
+            renderData,
+            &pool
+        );
+        const std::chrono::duration<double, std::milli> d =
+            std::chrono::steady_clock::now() - start;
+        frameTimes.push_back(d.count());
+        nCulledNodes += renderData.nCulledNodes;
+
+        if (_verify) {
+            int referenceDeltaStars = 0;
+            referenceManager.traverseData(
+                mvp,
+                screenSize,
+                referenceDeltaStars,
+                _renderMode,
+                _lodPixelThreshold,
+                referenceData
+            );
+            if (referenceDeltaStars != deltaStars ||
+                !isEqual(renderData, referenceData))
+            {
+                nMismatchingFrames++;
+            }
+        }
+
+        if (renderData.chunks.capacity() != chunkCapacity ||
+            renderData.values.capacity() != valueCapacity ||
+            renderData.chunkLookup.capacity() != lookupCapacity)
+        {
+            nGrowingFrames++;
+            lastGrowingFrame = i;
+        }
+        nChunks += renderData.chunks.size();
+        for (const OctreeManager::TraversalData::Chunk& chunk : renderData.chunks) {
+            nChangedStars += chunk.nStars;
+        }
+        nRenderedStars += deltaStars;
+
+        onProgress(0.1f + 0.9f * static_cast<float>(i + 1) / _nFrames);
+    }
+
+    const double totalTime = std::accumulate(frameTimes.begin(), frameTimes.end(), 0.0);
+    std::sort(frameTimes.begin(), frameTimes.end());
+    const double mean = totalTime / _nFrames;
+    const double p50 = percentile(frameTimes, 0.5);
+    const double p99 = percentile(frameTimes, 0.99);
+    const double chunksPerFrame = static_cast<double>(nChunks) / _nFrames;
+    const double starsPerFrame = static_cast<double>(nChangedStars) / _nFrames;
+    const double nodesPerFrame = static_cast<double>(nCulledNodes) / _nFrames;
+    const double nodesPerSecond = static_cast<double>(nCulledNodes) /
+                                  (totalTime / 1000.0);
+
+    LINFO(fmt::format(
+        "Traversed octree {} times: mean {:.3f} ms, p50 {:.3f} ms, p99 {:.3f} ms",
+        _nFrames, mean, p50, p99
+    ));
+    LINFO(fmt::format(
+        "Changed per frame: {:.1f} chunks, {:.0f} stars. Stars in view at the end: {}",
+        chunksPerFrame, starsPerFrame, nRenderedStars
+    ));
+    LINFO(fmt::format(
+        "Culled {:.1f} nodes per frame with {} helper threads: {:.0f} nodes/s",
+        nodesPerFrame, _nThreads, nodesPerSecond
+    ));
+    LINFO(fmt::format(
+        "Traversal buffers grew in {} frames, the last time in frame {}",
+        nGrowingFrames, lastGrowingFrame
+    ));
+    if (_verify) {
+        if (nMismatchingFrames == 0) {
+            LINFO("All frames matched the single-threaded traversal");
+        }
+        else {
+            LERROR(fmt::format(
+                "{} frames differed from the single-threaded traversal",
+                nMismatchingFrames
+            ));
+        }
+    }
+
+    if (_output.has_value()) {
+        ghoul::Dictionary result;
+        result.setValue("Frames", _nFrames);
+        result.setValue("Nodes", static_cast<int>(octreeManager.totalNodes()));
+        result.setValue("Stars", nStars);
+        result.setValue("TraversalMean", mean);
+        result.setValue("TraversalP50", p50);
+        result.setValue("TraversalP99", p99);
+        result.setValue("ChunksPerFrame", chunksPerFrame);
+        result.setValue("StarsPerFrame", starsPerFrame);
+        result.setValue("Threads", _nThreads);
+        result.setValue("NodesPerFrame", nodesPerFrame);
+        result.setValue("NodesPerSecond", nodesPerSecond);
+        result.setValue("GrowingFrames", nGrowingFrames);
+        result.setValue("MemoryInBytes", static_cast<double>(memoryInBytes));
+        result.setValue("LastGrowingFrame", lastGrowingFrame);
+        if (_verify) {
+            result.setValue("MismatchingFrames", nMismatchingFrames);
+        }
+
+        std::ofstream output(*_output);
+        output << ghoul::formatJson(result);
+    }
+
+    onProgress(1.f);
+}
+
+} // namespace openspace
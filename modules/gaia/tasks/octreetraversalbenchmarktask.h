@@ -0,0 +1,72 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2023                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_MODULE_GAIA___OCTREETRAVERSALBENCHMARKTASK___H__
+#define __OPENSPACE_MODULE_GAIA___OCTREETRAVERSALBENCHMARKTASK___H__
+
+#include <openspace/util/task.h>
+
+#include <modules/gaia/rendering/gaiaoptions.h>
+#include <ghoul/glm.h>
+#include <filesystem>
+#include <optional>
+
+namespace openspace {
+
+namespace documentation { struct Documentation; }
+
+/**
+ * Loads a pre-constructed octree file and measures `OctreeManager::traverseData` without
+ * rendering anything. The camera is placed in the origin and turns a full revolution
+ * around the y-axis, so that nodes continuously enter and leave the view frustum.
+ * Reports the time per traversal, the number of culled nodes per second, the number of
+ * changed chunks and stars per frame and how often the reused traversal buffers had to
+ * grow. Optionally checks that the threaded culling gives the same chunks as culling on
+ * a single thread.
+ */
+class OctreeTraversalBenchmarkTask : public Task {
+public:
+    OctreeTraversalBenchmarkTask(const ghoul::Dictionary& dictionary);
+    ~OctreeTraversalBenchmarkTask() override = default;
+
+    std::string description() override;
+    void perform(const Task::ProgressCallback& onProgress) override;
+    static documentation::Documentation Documentation();
+
+private:
+    std::filesystem::path _inFilePath;
+    std::optional<std::filesystem::path> _output;
+    int _nFrames;
+    gaia::RenderMode _renderMode;
+    float _lodPixelThreshold;
+    glm::ivec2 _screenSize;
+    double _fieldOfView;
+    std::optional<int> _maxNodesInStream;
+    int _nThreads;
+    bool _verify;
+};
+
+} // namespace openspace
+
+#endif // __OPENSPACE_MODULE_GAIA___OCTREETRAVERSALBENCHMARKTASK___H__
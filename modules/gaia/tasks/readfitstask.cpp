@@ -24,7 +24,7 @@
 
 #include <modules/gaia/tasks/readfitstask.h>
 
-#include <modules/gaia/tasks/readfilejob.h>
+#include <modules/gaia/tasks/fitsstarconversion.h>
 #include <openspace/documentation/documentation.h>
 #include <openspace/documentation/verifier.h>
 
@@ -34,6 +34,7 @@
 #include <ghoul/fmt.h>
 #include <filesystem>
 #include <fstream>
+#include <mutex>
 #include <set>
 #include <optional>
 
@@ -42,6 +43,10 @@ namespace {
 
     constexpr std::string_view _loggerCat = "ReadFitsTask";
 
+    // Number of rows each reading thread converts at a time. With the 18 default
+    // columns this is about 4.7 MB of column data per thread
+    constexpr long long RowsPerChunk = 1 << 16;
+
     struct [[codegen::Dictionary(ReadFitsTask)]] Parameters {
         // If SingleFileProcess is set to true then this specifies the path to a single
         // FITS file that will be read. Otherwise it specifies the path to a folder with
@@ -58,7 +63,8 @@ namespace {
         // multiple files sorted by location
         std::optional<bool> singleFileProcess;
 
-        // Defines how many threads to use when reading from multiple files
+        // Defines how many threads are used to read row chunks of each FITS file when
+        // reading from multiple files
         std::optional<int> threadsToUse [[codegen::greater(1)]];
 
         // Defines the first row that will be read from the specified FITS file(s). If not
@@ -170,18 +176,16 @@ void ReadFitsTask::readSingleFitsFile(const Task::ProgressCallback& progressCall
     }
 }
 
-void ReadFitsTask::readAllFitsFilesFromFolder(const Task::ProgressCallback&) {
+void ReadFitsTask::readAllFitsFilesFromFolder(
+                                          const Task::ProgressCallback& progressCallback)
+{
     std::vector<std::vector<float>> octants(8);
     std::vector<bool> isFirstWrite(8, true);
-    size_t finishedJobs = 0;
     int totalStars = 0;
 
     _firstRow = std::max(_firstRow, 1);
 
-    // Create Threadpool and JobManager.
-    LINFO("Threads in pool: " + std::to_string(_threadsToUse));
-    ThreadPool threadPool(_threadsToUse);
-    ConcurrentJobManager<std::vector<std::vector<float>>> jobManager(threadPool);
+    LINFO("Threads reading each file: " + std::to_string(_threadsToUse));
 
     // Get all files in specified folder.
     std::vector<std::filesystem::path> allInputFiles;
@@ -239,61 +243,69 @@ void ReadFitsTask::readAllFitsFilesFromFolder(const Task::ProgressCallback&) {
     LINFO(allNames);
 
     // Declare how many values to save for each star.
-    int32_t nValuesPerStar = 24;
-    size_t nDefaultColumns = defaultColumnNames.size();
-    auto fitsFileReader = std::make_shared<FitsFileReader>(false);
-
-    // Divide all files into ReadFilejobs and then delegate them onto several threads!
-    while (!allInputFiles.empty()) {
-        std::filesystem::path fileToRead = allInputFiles.back();
-        allInputFiles.erase(allInputFiles.end() - 1);
-
-        // Add reading of file to jobmanager, which will distribute it to our threadpool.
-        auto readFileJob = std::make_shared<gaia::ReadFileJob>(
-            fileToRead.string(),
-            _allColumnNames,
-            _firstRow,
-            _lastRow,
-            nDefaultColumns,
-            nValuesPerStar,
-            fitsFileReader
-        );
-        jobManager.enqueueJob(readFileJob);
-    }
-
-    LINFO("All files added to queue");
-
-    // Check for finished jobs.
-    while (finishedJobs < nInputFiles) {
-        if (jobManager.numFinishedJobs() > 0) {
-            std::vector<std::vector<float>> newOctant =
-                jobManager.popFinishedJob()->product();
-
-            finishedJobs++;
-
-            for (int i = 0; i < 8; ++i) {
-                // Add read values to global octant and check if it's time to write!
-                octants[i].insert(
-                    octants[i].end(),
-                    newOctant[i].begin(),
-                    newOctant[i].end()
+    const int32_t nValuesPerStar =
+        24 + static_cast<int32_t>(_filterColumnNames.size());
+    const size_t nDefaultColumns = defaultColumnNames.size();
+    FitsFileReader fitsFileReader(false);
+
+    // The chunk callback is invoked concurrently from the reading threads. Each chunk
+    // is converted into local octants first so that the lock is only held while the
+    // converted stars are appended to the shared octants.
+    std::mutex octantMutex;
+    auto onChunk = [&](const TableChunk& chunk) {
+        std::vector<std::vector<float>> chunkOctants(8);
+        gaia::convertStarsToOctants(chunk, nDefaultColumns, nValuesPerStar, chunkOctants);
+
+        std::lock_guard lock(octantMutex);
+        for (int i = 0; i < 8; ++i) {
+            // Add read values to global octant and check if it's time to write!
+            octants[i].insert(
+                octants[i].end(),
+                chunkOctants[i].begin(),
+                chunkOctants[i].end()
+            );
+            if (octants[i].size() > MAX_SIZE_BEFORE_WRITE) {
+                totalStars += writeOctantToFile(
+                    octants[i],
+                    i,
+                    isFirstWrite,
+                    nValuesPerStar
                 );
-                if ((octants[i].size() > MAX_SIZE_BEFORE_WRITE) ||
-                    (finishedJobs == nInputFiles))
-                {
-                    // Write to file!
-                    totalStars += writeOctantToFile(
-                        octants[i],
-                        i,
-                        isFirstWrite,
-                        nValuesPerStar
-                    );
-
-                    octants[i].clear();
-                    octants[i].shrink_to_fit();
-                }
+                octants[i].clear();
             }
         }
+    };
+
+    // Files are read one after another, each with several threads reading row chunks
+    // of the projected columns. Memory use is thereby bounded by the chunks in flight
+    // and the accumulated octants, independent of the size of the input files.
+    for (size_t f = 0; f < nInputFiles; ++f) {
+        const std::filesystem::path& file = allInputFiles[f];
+        try {
+            const long long nRows = fitsFileReader.readTableInChunks(
+                file,
+                _allColumnNames,
+                onChunk,
+                _firstRow,
+                _lastRow,
+                RowsPerChunk,
+                static_cast<int>(_threadsToUse)
+            );
+            LDEBUG(fmt::format("Read {} rows from '{}'", nRows, file));
+        }
+        catch (const ghoul::RuntimeError& e) {
+            LERROR(fmt::format("Failed to read Fits file '{}': {}", file, e.message));
+        }
+        progressCallback(static_cast<float>(f + 1) / static_cast<float>(nInputFiles));
+    }
+
+    // Write what is left of the octants.
+    if (nInputFiles > 0) {
+        for (int i = 0; i < 8; ++i) {
+            totalStars += writeOctantToFile(octants[i], i, isFirstWrite, nValuesPerStar);
+            octants[i].clear();
+            octants[i].shrink_to_fit();
+        }
     }
     LINFO(fmt::format("A total of {} stars were written to binary files", totalStars));
 }
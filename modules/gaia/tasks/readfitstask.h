@@ -27,8 +27,6 @@
 
 #include <openspace/util/task.h>
 
-#include <openspace/util/threadpool.h>
-#include <openspace/util/concurrentjobmanager.h>
 #include <modules/fitsfilereader/include/fitsfilereader.h>
 #include <filesystem>
 
@@ -55,8 +53,8 @@ private:
     void readSingleFitsFile(const Task::ProgressCallback& progressCallback);
 
     /**
-     * Reads all FITS files in a folder with multiple threads and stores ordered star
-     * data into 8 binary files.
+     * Reads all FITS files in a folder, each in row chunks with multiple threads, and
+     * stores ordered star data into 8 binary files.
      */
     void readAllFitsFilesFromFolder(const Task::ProgressCallback& progressCallback);
 
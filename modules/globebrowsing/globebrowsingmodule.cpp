@@ -40,6 +40,8 @@
 #include <modules/globebrowsing/src/layermanager.h>
 #include <modules/globebrowsing/src/memoryawaretilecache.h>
 #include <modules/globebrowsing/src/renderableglobe.h>
+#include <modules/globebrowsing/src/tilediskcache.h>
+#include <modules/globebrowsing/src/tilejobscheduler.h>
 #include <modules/globebrowsing/src/tileprovider/defaulttileprovider.h>
 #include <modules/globebrowsing/src/tileprovider/imagesequencetileprovider.h>
 #include <modules/globebrowsing/src/tileprovider/singleimagetileprovider.h>
@@ -50,6 +52,8 @@
 #include <modules/globebrowsing/src/tileprovider/tileprovider.h>
 #include <modules/globebrowsing/src/tileprovider/tileproviderbyindex.h>
 #include <modules/globebrowsing/src/tileprovider/tileproviderbylevel.h>
+#include <modules/globebrowsing/tasks/mrfcachegenerationtask.h>
+#include <modules/globebrowsing/tasks/tilepipelinebenchmarktask.h>
 #include <openspace/camera/camera.h>
 #include <openspace/documentation/verifier.h>
 #include <openspace/engine/globals.h>
@@ -65,6 +69,8 @@
 #include <openspace/scene/scenegraphnode.h>
 #include <openspace/scripting/lualibrary.h>
 #include <openspace/util/factorymanager.h>
+#include <openspace/util/task.h>
+#include <openspace/util/threadpool.h>
 #include <openspace/util/updatestructures.h>
 #include <ghoul/filesystem/filesystem.h>
 #include <ghoul/logging/logmanager.h>
@@ -73,6 +79,8 @@
 #include <ghoul/misc/templatefactory.h>
 #include <ghoul/misc/profiling.h>
 #include <ghoul/systemcapabilities/generalcapabilitiescomponent.h>
+#include <algorithm>
+#include <thread>
 #include <vector>
 
 #include <gdal.h>
@@ -192,6 +200,23 @@ namespace {
 
         // [[codegen::verbatim(MRFCacheLocationInfo.description)]]
         std::optional<std::string> mrfCacheLocation [[codegen::key("MRFCacheLocation")]];
+
+        // Determines whether tiles are stored in a persistent cache on disk after they
+        // have been read and preprocessed. If they are, tiles that were loaded in a
+        // previous run are read from this cache rather than from the original dataset
+        std::optional<bool> tileDiskCacheEnabled;
+
+        // The location of the root folder for the persistent tile cache
+        std::optional<std::string> tileDiskCacheLocation;
+
+        // The maximum size of the persistent tile cache in MB. If the cache grows beyond
+        // this size, the least recently used tiles are removed
+        std::optional<int> tileDiskCacheSize [[codegen::greater(0)]];
+
+        // The number of threads that are used to load tiles for all globes. If this
+        // value is not specified, twice the number of hardware threads is used, as most
+        // of the time is typically spent waiting for the disk or the network
+        std::optional<int> tileLoadThreads [[codegen::inrange(1, 256)]];
     };
 #include "globebrowsingmodule_codegen.cpp"
 } // namespace
@@ -243,6 +268,31 @@ void GlobeBrowsingModule::internalInitialize(const ghoul::Dictionary& dict) {
     _mrfCacheEnabled = p.mrfCacheEnabled.value_or(_mrfCacheEnabled);
     _mrfCacheLocation = p.mrfCacheLocation.value_or(_mrfCacheLocation);
 
+    if (p.tileDiskCacheEnabled.value_or(false)) {
+        const std::filesystem::path location = absPath(
+            p.tileDiskCacheLocation.value_or("${BASE}/cache_tiles")
+        );
+        const size_t sizeMB = static_cast<size_t>(p.tileDiskCacheSize.value_or(4096));
+        _tileDiskCache = std::make_unique<cache::TileDiskCache>(
+            location,
+            sizeMB * 1024 * 1024
+        );
+    }
+
+    const int nThreads = p.tileLoadThreads.value_or(
+        2 * std::max(static_cast<int>(std::thread::hardware_concurrency()), 1)
+    );
+    _tileJobScheduler = std::make_unique<TileJobScheduler>(nThreads);
+    addPropertySubOwner(_tileJobScheduler.get());
+
+    // The thread that renders the globes takes part in the chunk evaluation, so one
+    // thread fewer than the number of cores is needed
+    const int nChunkThreads = std::max(
+        static_cast<int>(std::thread::hardware_concurrency()) - 1,
+        0
+    );
+    _chunkThreadPool = std::make_unique<ThreadPool>(nChunkThreads);
+
     // Initialize
     global::callback::initializeGL->emplace_back([this]() {
         ZoneScopedN("GlobeBrowsingModule");
@@ -271,12 +321,19 @@ void GlobeBrowsingModule::internalInitialize(const ghoul::Dictionary& dict) {
         ZoneScopedN("GlobeBrowsingModule");
 
         _tileCache->update();
+        _tileJobScheduler->update();
     });
 
     // Deinitialize
-    global::callback::deinitialize->emplace_back([]() {
+    global::callback::deinitialize->emplace_back([this]() {
         ZoneScopedN("GlobeBrowsingModule");
 
+        // Jobs that are still waiting hold on to their readers, which have to be
+        // destroyed before GDAL is
+        removePropertySubOwner(_tileJobScheduler.get());
+        _tileJobScheduler = nullptr;
+        _chunkThreadPool = nullptr;
+
         GdalWrapper::destroy();
     });
 
@@ -317,12 +374,29 @@ void GlobeBrowsingModule::internalInitialize(const ghoul::Dictionary& dict) {
     ghoul_assert(fDashboard, "Dashboard factory was not created");
 
     fDashboard->registerClass<DashboardItemGlobeLocation>("DashboardItemGlobeLocation");
+
+    ghoul::TemplateFactory<Task>* fTask = FactoryManager::ref().factory<Task>();
+    ghoul_assert(fTask, "Task factory was not created");
+    fTask->registerClass<MRFCacheGenerationTask>("MRFCacheGenerationTask");
+    fTask->registerClass<TilePipelineBenchmarkTask>("TilePipelineBenchmarkTask");
 }
 
 globebrowsing::cache::MemoryAwareTileCache* GlobeBrowsingModule::tileCache() {
     return _tileCache.get();
 }
 
+globebrowsing::cache::TileDiskCache* GlobeBrowsingModule::tileDiskCache() {
+    return _tileDiskCache.get();
+}
+
+globebrowsing::TileJobScheduler* GlobeBrowsingModule::tileJobScheduler() {
+    return _tileJobScheduler.get();
+}
+
+ThreadPool* GlobeBrowsingModule::chunkThreadPool() {
+    return _chunkThreadPool.get();
+}
+
 std::vector<documentation::Documentation> GlobeBrowsingModule::documentations() const {
     return {
         globebrowsing::Layer::Documentation(),
@@ -342,6 +416,8 @@ std::vector<documentation::Documentation> GlobeBrowsingModule::documentations()
         globebrowsing::GeoJsonManager::Documentation(),
         globebrowsing::GeoJsonComponent::Documentation(),
         globebrowsing::GeoJsonProperties::Documentation(),
+        globebrowsing::MRFCacheGenerationTask::Documentation(),
+        globebrowsing::TilePipelineBenchmarkTask::Documentation(),
         GlobeLabelsComponent::Documentation(),
         RingsComponent::Documentation(),
         ShadowComponent::Documentation()
@@ -40,12 +40,18 @@ namespace openspace::globebrowsing {
     struct Geodetic2;
     struct Geodetic3;
 
-    namespace cache { class MemoryAwareTileCache; }
+    class TileJobScheduler;
+
+    namespace cache {
+        class MemoryAwareTileCache;
+        class TileDiskCache;
+    } // namespace cache
 } // namespace openspace::globebrowsing
 
 namespace openspace {
 
 class Camera;
+class ThreadPool;
 
 class GlobeBrowsingModule : public OpenSpaceModule {
 public:
@@ -66,6 +72,23 @@ public:
     glm::dvec3 geoPosition() const;
 
     globebrowsing::cache::MemoryAwareTileCache* tileCache();
+
+    /**
+     * Returns the persistent tile cache on disk or `nullptr` if the disk cache is
+     * disabled.
+     */
+    globebrowsing::cache::TileDiskCache* tileDiskCache();
+
+    /**
+     * Returns the scheduler that executes the tile load jobs of all tile providers.
+     */
+    globebrowsing::TileJobScheduler* tileJobScheduler();
+
+    /**
+     * Returns the thread pool that is used to evaluate the chunk trees of all globes.
+     */
+    ThreadPool* chunkThreadPool();
+
     scripting::LuaLibrary luaLibrary() const override;
     std::vector<documentation::Documentation> documentations() const override;
 
@@ -121,6 +144,9 @@ private:
     properties::StringProperty _mrfCacheLocation;
 
     std::unique_ptr<globebrowsing::cache::MemoryAwareTileCache> _tileCache;
+    std::unique_ptr<globebrowsing::cache::TileDiskCache> _tileDiskCache;
+    std::unique_ptr<globebrowsing::TileJobScheduler> _tileJobScheduler;
+    std::unique_ptr<ThreadPool> _chunkThreadPool;
 
     // name -> capabilities
     std::map<std::string, std::future<Capabilities>> _inFlightCapabilitiesMap;
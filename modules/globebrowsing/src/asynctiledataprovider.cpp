@@ -24,6 +24,7 @@
 
 #include <modules/globebrowsing/src/asynctiledataprovider.h>
 
+#include <modules/globebrowsing/globebrowsingmodule.h>
 #include <modules/globebrowsing/src/memoryawaretilecache.h>
 #include <modules/globebrowsing/src/rawtiledatareader.h>
 #include <modules/globebrowsing/src/tileloadjob.h>
@@ -32,24 +33,38 @@
 #include <ghoul/logging/logmanager.h>
 #include <ghoul/misc/profiling.h>
 #include <ghoul/opengl/ghoul_gl.h>
+#include <algorithm>
 
 namespace openspace::globebrowsing {
 
 namespace {
     constexpr std::string_view _loggerCat = "AsyncTileDataProvider";
+
+    // The maximum number of jobs of each priority that can be waiting or running for a
+    // single provider, in addition to the jobs that can be running concurrently. If more
+    // jobs are enqueued, the least recently requested one is cancelled
+    constexpr size_t MaxEnqueuedRequests = 10;
 } // namespace
 
 AsyncTileDataProvider::AsyncTileDataProvider(std::string name,
                                     std::unique_ptr<RawTileDataReader> rawTileDataReader)
     : _name(std::move(name))
     , _rawTileDataReader(std::move(rawTileDataReader))
-    , _concurrentJobManager(LRUThreadPool<TileIndex::TileHashKey>(1, 10))
+    , _scheduler(*global::moduleEngine->module<GlobeBrowsingModule>()->tileJobScheduler())
+    // Allow as many concurrent jobs as there are dataset handles so that the reader can
+    // be saturated without any worker thread waiting for a handle
+    , _client(_scheduler.createClient(_rawTileDataReader->numDatasetHandles()))
+    , _finishedJobs(std::make_shared<ConcurrentQueue<std::shared_ptr<TileLoadJob>>>())
 {
     ZoneScoped;
 
     performReset(ResetRawTileDataReader::No);
 }
 
+AsyncTileDataProvider::~AsyncTileDataProvider() {
+    endEnqueuedJobs();
+}
+
 const RawTileDataReader& AsyncTileDataProvider::rawTileDataReader() const {
     return *_rawTileDataReader;
 }
@@ -57,89 +72,171 @@ const RawTileDataReader& AsyncTileDataProvider::rawTileDataReader() const {
 bool AsyncTileDataProvider::enqueueTileIO(const TileIndex& tileIndex) {
     ZoneScoped;
 
-    if (_resetMode == ResetMode::ShouldNotReset && satisfiesEnqueueCriteria(tileIndex)) {
-        auto job = std::make_unique<TileLoadJob>(*_rawTileDataReader, tileIndex);
-        _concurrentJobManager.enqueueJob(std::move(job), tileIndex.hashKey());
-        _enqueuedTileRequests.insert(tileIndex.hashKey());
-        return true;
+    if (_resetMode != ResetMode::ShouldNotReset) {
+        return false;
+    }
+
+    Request* request = _enqueuedTileRequests.find(tileIndex.hashKey());
+    if (request) {
+        // The tile is already requested, so we only bump it to the top. If it was a
+        // prefetch request, it is now needed and gets promoted to a regular request
+        request->lastRequested = ++_requestCounter;
+        request->priority = TileJobScheduler::Priority::Regular;
+        _scheduler.bump(*_client, request->jobKey, request->priority);
+        return false;
     }
-    return false;
+
+    enqueue(tileIndex, TileJobScheduler::Priority::Regular);
+    return true;
 }
 
-void AsyncTileDataProvider::clearTiles() {
-    std::optional<RawTile> finishedJob = popFinishedRawTile();
-    while (finishedJob) {
-        finishedJob = popFinishedRawTile();
+bool AsyncTileDataProvider::enqueueTilePrefetch(const TileIndex& tileIndex) {
+    ZoneScoped;
+
+    // An already enqueued job is not bumped, as that would change the order of the
+    // regular requests
+    if (_resetMode != ResetMode::ShouldNotReset || isEnqueued(tileIndex)) {
+        return false;
     }
+
+    enqueue(tileIndex, TileJobScheduler::Priority::Low);
+    return true;
 }
 
-std::optional<RawTile> AsyncTileDataProvider::popFinishedRawTile() {
-    if (_concurrentJobManager.numFinishedJobs() > 0) {
-        // Now the tile load job looses ownerwhip of the data pointer
-        RawTile product = _concurrentJobManager.popFinishedJob()->product();
+void AsyncTileDataProvider::enqueue(const TileIndex& tileIndex,
+                                    TileJobScheduler::Priority priority)
+{
+    ZoneScoped;
 
-        const TileIndex::TileHashKey key = product.tileIndex.hashKey();
-        // No longer enqueued. Remove from set of enqueued tiles
-        _enqueuedTileRequests.erase(key);
-        // Pbo is still mapped. Set the id for the raw tile
-        if (product.error != RawTile::ReadError::None) {
-            product.imageData = nullptr;
-            return std::nullopt;
+    // A cancelled job might still be waiting in the scheduler when the same tile is
+    // requested again, so every job gets its own key instead of using the tile's key
+    const uint64_t jobKey = ++_requestCounter;
+    std::shared_ptr<CancellationToken> token = std::make_shared<CancellationToken>();
+    std::shared_ptr<TileLoadJob> job = std::make_shared<TileLoadJob>(
+        _rawTileDataReader,
+        tileIndex,
+        token
+    );
+    _scheduler.enqueue(
+        _client,
+        jobKey,
+        priority,
+        [job, finishedJobs = _finishedJobs]() {
+            job->execute();
+            finishedJobs->push(job);
+        },
+        token
+    );
+    _nJobsInFlight++;
+    _counters.enqueued++;
+    _counters.inFlight = _nJobsInFlight;
+    _enqueuedTileRequests.insertOrAssign(
+        tileIndex.hashKey(),
+        Request {
+            .token = std::move(token),
+            .jobKey = jobKey,
+            .priority = priority,
+            .lastRequested = jobKey
         }
+    );
 
-        return product;
-    }
-    else {
-        return std::nullopt;
+    // Cancel the least recently requested job of the same priority if there are too
+    // many of them. These are most likely for chunks that are not visible anymore
+    const size_t nHandles = static_cast<size_t>(_rawTileDataReader->numDatasetHandles());
+    const size_t maxRequests = MaxEnqueuedRequests + nHandles;
+    size_t nRequests = 0;
+    TileIndex::TileHashKey leastRecentKey = 0;
+    Request* leastRecent = nullptr;
+    _enqueuedTileRequests.forEach(
+        [&](TileIndex::TileHashKey key, Request& request) {
+            if (request.priority != priority) {
+                return;
+            }
+            nRequests++;
+            if (!leastRecent || request.lastRequested < leastRecent->lastRequested) {
+                leastRecentKey = key;
+                leastRecent = &request;
+            }
+        }
+    );
+    if (nRequests > maxRequests) {
+        leastRecent->token->cancel();
+        _enqueuedTileRequests.erase(leastRecentKey);
+        _counters.dropped++;
     }
 }
 
-bool AsyncTileDataProvider::satisfiesEnqueueCriteria(const TileIndex& tileIndex) {
-    ZoneScoped;
+size_t AsyncTileDataProvider::cancelTilePrefetches() {
+    const size_t nCancelled = _enqueuedTileRequests.eraseIf(
+        [](TileIndex::TileHashKey, const Request& request) {
+            if (request.priority != TileJobScheduler::Priority::Low) {
+                return false;
+            }
+            request.token->cancel();
+            return true;
+        }
+    );
+    _counters.dropped += nCancelled;
+    return nCancelled;
+}
 
-    // Only satisfies if it is not already enqueued. Also bumps the request to the top.
-    const bool alreadyEnqueued = _concurrentJobManager.touch(tileIndex.hashKey());
-    // Early out so we don't need to check the already enqueued requests
-    if (alreadyEnqueued) {
-        return false;
+bool AsyncTileDataProvider::isEnqueued(const TileIndex& tileIndex) const {
+    return _enqueuedTileRequests.contains(tileIndex.hashKey());
+}
+
+void AsyncTileDataProvider::clearTiles() {
+    while (!_finishedJobs->empty()) {
+        popFinishedRawTile();
     }
+}
+
+std::optional<RawTile> AsyncTileDataProvider::popFinishedRawTile() {
+    while (!_finishedJobs->empty()) {
+        std::shared_ptr<TileLoadJob> job = _finishedJobs->pop();
+        _nJobsInFlight--;
+        _counters.inFlight = _nJobsInFlight;
 
-    // Concurrent job manager can start jobs which will pop them from enqueued, however
-    // they are still in _enqueuedTileRequests until finished
-    const auto it = _enqueuedTileRequests.find(tileIndex.hashKey());
-    const bool notFoundAmongEnqueued = it == _enqueuedTileRequests.end();
+        // The request of a cancelled job has already been removed and the tile might
+        // have been requested again in the meantime
+        if (job->isCancelled()) {
+            continue;
+        }
 
-    return !alreadyEnqueued && notFoundAmongEnqueued;
-}
+        // Now the tile load job looses ownerwhip of the data pointer
+        RawTile product = job->product();
+
+        // No longer enqueued. Remove from set of enqueued tiles
+        _enqueuedTileRequests.erase(product.tileIndex.hashKey());
+        _counters.completed++;
+        _counters.readTime.add(product.readTime);
+        _counters.decodeTime.add(product.decodeTime);
 
-void AsyncTileDataProvider::endUnfinishedJobs() {
-    std::vector<TileIndex::TileHashKey> unfinishedJobs =
-        _concurrentJobManager.keysToUnfinishedJobs();
-    for (const TileIndex::TileHashKey& unfinishedJob : unfinishedJobs) {
-        // When erasing the job before
-        _enqueuedTileRequests.erase(unfinishedJob);
+        // Pbo is still mapped. Set the id for the raw tile
+        if (product.error != RawTile::ReadError::None) {
+            product.imageData = nullptr;
+        }
+
+        return product;
     }
+    return std::nullopt;
 }
 
 void AsyncTileDataProvider::endEnqueuedJobs() {
-    std::vector<TileIndex::TileHashKey> enqueuedJobs =
-        _concurrentJobManager.keysToEnqueuedJobs();
-    for (const TileIndex::TileHashKey& enqueuedJob : enqueuedJobs) {
-        // When erasing the job before
-        _enqueuedTileRequests.erase(enqueuedJob);
-    }
+    _counters.dropped += _enqueuedTileRequests.size();
+    _enqueuedTileRequests.forEach(
+        [](TileIndex::TileHashKey, Request& request) { request.token->cancel(); }
+    );
+    _enqueuedTileRequests.clear();
 }
 
 void AsyncTileDataProvider::update() {
-    endUnfinishedJobs();
-
     // May reset
     switch (_resetMode) {
         case ResetMode::ShouldResetAll:
             // Clean all finished jobs
             clearTiles();
             // Only allow resetting if there are no jobs currently running
-            if (_enqueuedTileRequests.empty()) {
+            if (_nJobsInFlight == 0) {
                 performReset(ResetRawTileDataReader::Yes);
                 LINFO(fmt::format("Tile data reader '{}' reset successfully", _name));
             }
@@ -148,7 +245,7 @@ void AsyncTileDataProvider::update() {
             // Clean all finished jobs
             clearTiles();
             // Only allow resetting if there are no jobs currently running
-            if (_enqueuedTileRequests.empty()) {
+            if (_nJobsInFlight == 0) {
                 performReset(ResetRawTileDataReader::No);
                 LINFO(fmt::format("Tile data reader '{}' reset successfully", _name));
             }
@@ -157,7 +254,7 @@ void AsyncTileDataProvider::update() {
             // Clean all finished jobs
             clearTiles();
             // Only allow resetting if there are no jobs currently running
-            if (_enqueuedTileRequests.empty()) {
+            if (_nJobsInFlight == 0) {
                 _shouldBeDeleted = true;
             }
             break;
@@ -168,8 +265,8 @@ void AsyncTileDataProvider::update() {
 }
 
 void AsyncTileDataProvider::reset() {
-    // Can not clear concurrent job manager in case there are threads running. therefore
-    // we need to wait until _enqueuedTileRequests is empty before finishing up.
+    // Can not reset the reader in case there are jobs running. Therefore we cancel all
+    // jobs and wait until all of them have finished before finishing up
     _resetMode = ResetMode::ShouldResetAll;
     endEnqueuedJobs();
     LINFO(fmt::format("Prepairing for resetting of tile reader '{}'", _name));
@@ -187,7 +284,7 @@ bool AsyncTileDataProvider::shouldBeDeleted() {
 void AsyncTileDataProvider::performReset(ResetRawTileDataReader resetRawTileDataReader) {
     ZoneScoped;
 
-    ghoul_assert(_enqueuedTileRequests.empty(), "No enqueued requests left");
+    ghoul_assert(_nJobsInFlight == 0, "No jobs left");
 
     // Reset raw tile data reader
     if (resetRawTileDataReader == ResetRawTileDataReader::Yes) {
@@ -198,6 +295,10 @@ void AsyncTileDataProvider::performReset(ResetRawTileDataReader resetRawTileData
     _resetMode = ResetMode::ShouldNotReset;
 }
 
+const TilePipelineCounters& AsyncTileDataProvider::counters() const {
+    return _counters;
+}
+
 float AsyncTileDataProvider::noDataValueAsFloat() const {
     return _rawTileDataReader->noDataValueAsFloat();
 }
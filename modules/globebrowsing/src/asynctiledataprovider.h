@@ -25,22 +25,22 @@
 #ifndef __OPENSPACE_MODULE_GLOBEBROWSING___ASYNC_TILE_DATAPROVIDER___H__
 #define __OPENSPACE_MODULE_GLOBEBROWSING___ASYNC_TILE_DATAPROVIDER___H__
 
-#include <modules/globebrowsing/src/prioritizingconcurrentjobmanager.h>
+#include <modules/globebrowsing/src/flathashmap.h>
 #include <modules/globebrowsing/src/rawtiledatareader.h>
 #include <modules/globebrowsing/src/tileindex.h>
+#include <modules/globebrowsing/src/tilejobscheduler.h>
+#include <modules/globebrowsing/src/tilepipelinetelemetry.h>
+#include <openspace/util/concurrentqueue.h>
 #include <ghoul/misc/boolean.h>
-#include <map>
+#include <functional>
+#include <memory>
 #include <optional>
-#include <set>
 
 namespace openspace::globebrowsing {
 
 struct RawTile;
+struct TileLoadJob;
 
-/**
- * The responsibility of this class is to enqueue tile requests and fetching finished
- * `RawTile`s that has been asynchronously loaded.
- */
 class AsyncTileDataProvider {
 public:
     /**
@@ -51,12 +51,43 @@ public:
         std::unique_ptr<RawTileDataReader> rawTileDataReader);
 
     /**
-     * Creates a job which asynchronously loads a raw tile. This job is enqueued.
+     * Cancels all jobs of this provider. Jobs that are currently running keep the
+     * RawTileDataReader alive until they are finished.
+     */
+    ~AsyncTileDataProvider();
+
+    /**
+     * Creates a job which asynchronously loads a raw tile. This job is enqueued. If the
+     * tile is already enqueued, the job is bumped to the front of the queue instead.
      */
     bool enqueueTileIO(const TileIndex& tileIndex);
 
     /**
-     * Get one finished job.
+     * Creates a job which asynchronously loads a raw tile that is expected to be needed
+     * in the near future. The job is only executed if there are no regular jobs waiting.
+     * If the tile is requested through #enqueueTileIO before the job was started, it is
+     * promoted to a regular job.
+     *
+     * \return `true` if a new job was enqueued
+     */
+    bool enqueueTilePrefetch(const TileIndex& tileIndex);
+
+    /**
+     * Cancels all prefetch jobs, including the ones that are currently running.
+     *
+     * \return the number of jobs that were cancelled
+     */
+    size_t cancelTilePrefetches();
+
+    /**
+     * \return `true` if the tile of index \p tileIndex is currently being loaded or is
+     *         waiting to be loaded
+     */
+    bool isEnqueued(const TileIndex& tileIndex) const;
+
+    /**
+     * Get one finished job. A tile that could not be read is returned as well, with its
+     * RawTile::error set and without any image data.
      */
     std::optional<RawTile> popFinishedRawTile();
 
@@ -69,6 +100,12 @@ public:
     const RawTileDataReader& rawTileDataReader() const;
     float noDataValueAsFloat() const;
 
+    /**
+     * \return the counters of all requests of this provider. The cache hits and misses
+     *         are not counted as the provider is not aware of the tile cache
+     */
+    const TilePipelineCounters& counters() const;
+
 protected:
     BooleanType(ResetRawTileDataReader);
 
@@ -80,32 +117,53 @@ protected:
     };
 
     /**
-     * \returns true if tile of index `tileIndex` is not already enqueued.
-     */
-    bool satisfiesEnqueueCriteria(const TileIndex& tileIndex);
-
-    /**
-     * An unfinished job is a load tile job that has been popped from the thread pool due
-     * to its low priority. Once it has been popped, it is marked as unfinished and needs
-     * to be explicitly ended.
+     * Enqueues a new job for the \p tileIndex with the provided \p priority and cancels
+     * the least recently requested job of the same kind if there are too many of them.
      */
-    void endUnfinishedJobs();
+    void enqueue(const TileIndex& tileIndex, TileJobScheduler::Priority priority);
 
     void clearTiles();
 
+    /**
+     * Cancels all jobs of this provider. The cancelled jobs still have to finish before
+     * the provider can be reset.
+     */
     void endEnqueuedJobs();
 
     void performReset(ResetRawTileDataReader resetRawTileDataReader);
 
 private:
+    struct Request {
+        std::shared_ptr<CancellationToken> token;
+        /// The key that identifies the job in the TileJobScheduler
+        uint64_t jobKey = 0;
+        TileJobScheduler::Priority priority = TileJobScheduler::Priority::Regular;
+        /// Used to find the least recently requested job
+        uint64_t lastRequested = 0;
+    };
+
     const std::string _name;
     /// The reader used for asynchronous reading
-    std::unique_ptr<RawTileDataReader> _rawTileDataReader;
+    std::shared_ptr<RawTileDataReader> _rawTileDataReader;
+
+    TileJobScheduler& _scheduler;
+    std::shared_ptr<TileJobScheduler::Client> _client;
+
+    /// Jobs push themselves in here when they are finished. The queue is shared with the
+    /// jobs so that it can outlive this provider
+    std::shared_ptr<ConcurrentQueue<std::shared_ptr<TileLoadJob>>> _finishedJobs;
+
+    /// All requests that have not been cancelled and whose tiles have not been popped yet
+    cache::FlatHashMap<
+        TileIndex::TileHashKey, Request, std::hash<TileIndex::TileHashKey>
+    > _enqueuedTileRequests;
+    uint64_t _requestCounter = 0;
 
-    PrioritizingConcurrentJobManager<RawTile, TileIndex::TileHashKey>
-        _concurrentJobManager;
+    TilePipelineCounters _counters;
 
-    std::set<TileIndex::TileHashKey> _enqueuedTileRequests;
+    /// The number of jobs that were enqueued and not yet popped from _finishedJobs,
+    /// including the ones that were cancelled
+    size_t _nJobsInFlight = 0;
 
     ResetMode _resetMode = ResetMode::ShouldResetAllButRawTileDataReader;
     bool _shouldBeDeleted = false;
@@ -0,0 +1,394 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2023                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/globebrowsing/src/chunk.h>
+
+#include <modules/globebrowsing/src/ellipsoid.h>
+#include <openspace/util/threadpool.h>
+#include <ghoul/misc/profiling.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <latch>
+#include <limits>
+
+namespace {
+    // The number of chunks that a thread evaluates before picking up the next batch
+    constexpr size_t ChunkBatchSize = 64;
+
+    // Below this number of chunks, the overhead of waking up the worker threads is larger
+    // than the time it takes to evaluate the chunks on the calling thread
+    constexpr size_t ParallelChunkThreshold = 4 * ChunkBatchSize;
+} // namespace
+
+namespace openspace::globebrowsing {
+
+Chunk::Chunk(const TileIndex& ti)
+    : tileIndex(ti)
+    , surfacePatch(ti)
+    , status(Status::DoNothing)
+{}
+
+std::array<glm::dvec4, 8> boundingCornersForChunk(const Chunk& chunk,
+                                                  const Ellipsoid& ellipsoid,
+                                                  const BoundingHeights& heights)
+{
+    ZoneScoped;
+
+    // assume worst case
+    const double patchCenterRadius = ellipsoid.maximumRadius();
+
+    const double maxCenterRadius = patchCenterRadius + heights.max;
+    Geodetic2 halfSize = chunk.surfacePatch.halfSize();
+
+    // As the patch is curved, the maximum height offsets at the corners must be long
+    // enough to cover large enough to cover a heights.max at the center of the
+    // patch.
+    // Approximating scaleToCoverCenter by assuming the latitude and longitude angles
+    // of "halfSize" are equal to the angles they create from the center of the
+    // globe to the patch corners. This is true for the longitude direction when
+    // the ellipsoid can be approximated as a sphere and for the latitude for patches
+    // close to the equator. Close to the pole this will lead to a bigger than needed
+    // value for scaleToCoverCenter. However, this is a simple calculation and a good
+    // Approximation.
+    const double y1 = tan(halfSize.lat);
+    const double y2 = tan(halfSize.lon);
+    const double scaleToCoverCenter = sqrt(1 + pow(y1, 2) + pow(y2, 2));
+
+    const double maxCornerHeight = maxCenterRadius * scaleToCoverCenter -
+        patchCenterRadius;
+
+    const bool chunkIsNorthOfEquator = chunk.surfacePatch.isNorthern();
+
+    // The minimum height offset, however, we can simply
+    const double minCornerHeight = heights.min;
+    std::array<glm::dvec4, 8> corners;
+
+    const double latCloseToEquator = chunk.surfacePatch.edgeLatitudeNearestEquator();
+    const Geodetic3 p1Geodetic = {
+        { latCloseToEquator, chunk.surfacePatch.minLon() },
+        maxCornerHeight
+    };
+    const Geodetic3 p2Geodetic = {
+        { latCloseToEquator, chunk.surfacePatch.maxLon() },
+        maxCornerHeight
+    };
+
+    const glm::vec3 p1 = ellipsoid.cartesianPosition(p1Geodetic);
+    const glm::vec3 p2 = ellipsoid.cartesianPosition(p2Geodetic);
+    const glm::vec3 p = 0.5f * (p1 + p2);
+    const Geodetic2 pGeodetic = ellipsoid.cartesianToGeodetic2(p);
+    const double latDiff = latCloseToEquator - pGeodetic.lat;
+
+    for (size_t i = 0; i < 8; ++i) {
+        const Quad q = static_cast<Quad>(i % 4);
+        const double cornerHeight = i < 4 ? minCornerHeight : maxCornerHeight;
+        Geodetic3 cornerGeodetic = { chunk.surfacePatch.corner(q), cornerHeight };
+
+        const bool cornerIsNorthern = !((i / 2) % 2);
+        const bool cornerCloseToEquator = chunkIsNorthOfEquator ^ cornerIsNorthern;
+        if (cornerCloseToEquator) {
+            cornerGeodetic.geodetic2.lat += latDiff;
+        }
+
+        corners[i] = glm::dvec4(ellipsoid.cartesianPosition(cornerGeodetic), 1.0);
+    }
+
+    return corners;
+}
+
+bool isCullableByFrustum(const Chunk& chunk, const glm::dmat4& mvp) {
+    ZoneScoped;
+
+    // The corners are transformed into clipping space one component at a time, which
+    // lets the compiler process the eight corners with vector instructions
+    std::array<double, 8> x;
+    std::array<double, 8> y;
+    std::array<double, 8> z;
+    std::array<double, 8> w;
+    for (size_t i = 0; i < 8; ++i) {
+        const glm::dvec4& c = chunk.corners[i];
+        x[i] = mvp[0][0] * c.x + mvp[1][0] * c.y + mvp[2][0] * c.z + mvp[3][0] * c.w;
+        y[i] = mvp[0][1] * c.x + mvp[1][1] * c.y + mvp[2][1] * c.z + mvp[3][1] * c.w;
+        z[i] = mvp[0][2] * c.x + mvp[1][2] * c.y + mvp[2][2] * c.z + mvp[3][2] * c.w;
+        w[i] = mvp[0][3] * c.x + mvp[1][3] * c.y + mvp[2][3] * c.z + mvp[3][3] * c.w;
+    }
+
+    // Create a bounding box in normalized device coordinates that fits the corners
+    glm::dvec3 min = glm::dvec3(std::numeric_limits<double>::max());
+    glm::dvec3 max = glm::dvec3(-std::numeric_limits<double>::max());
+    for (size_t i = 0; i < 8; ++i) {
+        const double invW = 1.0 / std::abs(w[i]);
+        min.x = std::min(min.x, x[i] * invW);
+        max.x = std::max(max.x, x[i] * invW);
+        min.y = std::min(min.y, y[i] * invW);
+        max.y = std::max(max.y, y[i] * invW);
+        min.z = std::min(min.z, z[i] * invW);
+        max.z = std::max(max.z, z[i] * invW);
+    }
+
+    // The culling frustum spans [-1, 1] in x and y and everything in front of the camera
+    const bool intersectsFrustum =
+        (min.x <= 1.0) && (max.x >= -1.0) &&
+        (min.y <= 1.0) && (max.y >= -1.0) &&
+        (min.z <= 1e35) && (max.z >= 0.0);
+    return !intersectsFrustum;
+}
+
+bool isCullableByHorizon(const Chunk& chunk, const Ellipsoid& ellipsoid,
+                         const ChunkView& view, const BoundingHeights& heights)
+{
+    ZoneScoped;
+
+    const GeodeticPatch& patch = chunk.surfacePatch;
+    const float maxHeight = heights.max;
+    const glm::dvec3 globePos = glm::dvec3(0.0, 0.0, 0.0); // In model space it is 0
+    const double minimumGlobeRadius = ellipsoid.minimumRadius();
+
+    const glm::dvec3& cameraPos = view.cameraPosition;
+
+    const Geodetic2 closestPatchPoint = patch.closestPoint(view.cameraGeodetic);
+    glm::dvec3 objectPos = ellipsoid.cartesianSurfacePosition(closestPatchPoint);
+
+    // objectPosition is closest in latlon space but not guaranteed to be closest in
+    // castesian coordinates. Therefore we compare it to the corners and pick the
+    // real closest point,
+    std::array<glm::dvec3, 4> corners = {
+        ellipsoid.cartesianSurfacePosition(patch.corner(NORTH_WEST)),
+        ellipsoid.cartesianSurfacePosition(patch.corner(NORTH_EAST)),
+        ellipsoid.cartesianSurfacePosition(patch.corner(SOUTH_WEST)),
+        ellipsoid.cartesianSurfacePosition(patch.corner(SOUTH_EAST))
+    };
+
+    for (int i = 0; i < 4; ++i) {
+        const double distance = glm::length(cameraPos - corners[i]);
+        if (distance < glm::length(cameraPos - objectPos)) {
+            objectPos = corners[i];
+        }
+    }
+
+    const double objectP = pow(length(objectPos - globePos), 2);
+    const double horizonP = pow(minimumGlobeRadius - maxHeight, 2);
+    if (objectP < horizonP) {
+        return false;
+    }
+
+    const double cameraP = pow(length(cameraPos - globePos), 2);
+    const double minR = pow(minimumGlobeRadius, 2);
+    if (cameraP < minR) {
+        return false;
+    }
+
+    const double minimumAllowedDistanceToObjectFromHorizon = sqrt(objectP - horizonP);
+    const double distanceToHorizon = sqrt(cameraP - minR);
+
+    // Minimum allowed for the object to be occluded
+    const double minimumAllowedDistanceToObjectSquared =
+        pow(distanceToHorizon + minimumAllowedDistanceToObjectFromHorizon, 2) +
+        pow(maxHeight, 2);
+
+    const double distanceToObjectSquared = pow(
+        length(objectPos - cameraPos),
+        2
+    );
+    return distanceToObjectSquared > minimumAllowedDistanceToObjectSquared;
+}
+
+int desiredLevelByDistance(const Chunk& chunk, const Ellipsoid& ellipsoid,
+                           const ChunkView& view, const BoundingHeights& heights)
+{
+    ZoneScoped;
+
+    const Geodetic2 pointOnPatch = chunk.surfacePatch.closestPoint(view.cameraGeodetic);
+    const glm::dvec3 patchNormal = ellipsoid.geodeticSurfaceNormal(pointOnPatch);
+    glm::dvec3 patchPosition = ellipsoid.cartesianSurfacePosition(pointOnPatch);
+
+    const double heightToChunk = heights.min;
+
+    // Offset position according to height
+    patchPosition += patchNormal * heightToChunk;
+
+    const glm::dvec3 cameraToChunk = patchPosition - view.cameraPosition;
+
+    // Calculate desired level based on distance
+    const double distanceToPatch = glm::length(cameraToChunk);
+    const double distance = distanceToPatch;
+
+    const double scaleFactor = view.lodScaleFactor * ellipsoid.minimumRadius();
+    const double projectedScaleFactor = scaleFactor / distance;
+    const int desiredLevel = static_cast<int>(ceil(log2(projectedScaleFactor)));
+    return desiredLevel;
+}
+
+int desiredLevelByProjectedArea(const Chunk& chunk, const Ellipsoid& ellipsoid,
+                                const ChunkView& view, const BoundingHeights& heights)
+{
+    ZoneScoped;
+
+    // Approach:
+    // The projected area of the chunk will be calculated based on a small area that
+    // is close to the camera, and the scaled up to represent the full area.
+    // The advantage of doing this is that it will better handle the cases where the
+    // full patch is very curved (e.g. stretches from latitude 0 to 90 deg).
+
+    const Geodetic2 closestCorner = chunk.surfacePatch.closestCorner(view.cameraGeodetic);
+
+    //  Camera
+    //  |
+    //  V
+    //
+    //  oo
+    // [  ]<
+    //                     *geodetic space*
+    //
+    //   closestCorner
+    //    +-----------------+  <-- north east corner
+    //    |                 |
+    //    |      center     |
+    //    |                 |
+    //    +-----------------+  <-- south east corner
+
+    const Geodetic2 center = chunk.surfacePatch.center();
+    const Geodetic3 c = { center, heights.min };
+    const Geodetic3 c1 = { Geodetic2{ center.lat, closestCorner.lon }, heights.min };
+    const Geodetic3 c2 = { Geodetic2{ closestCorner.lat, center.lon }, heights.min };
+
+    //  Camera
+    //  |
+    //  V
+    //
+    //  oo
+    // [  ]<
+    //                     *geodetic space*
+    //
+    //    +--------c2-------+  <-- north east corner
+    //    |                 |
+    //    c1       c        |
+    //    |                 |
+    //    +-----------------+  <-- south east corner
+
+
+    // Go from geodetic to cartesian space and project onto unit sphere
+    const glm::dvec3 camToCenter = -view.cameraPosition;
+    const glm::dvec3 A = glm::normalize(camToCenter + ellipsoid.cartesianPosition(c));
+    const glm::dvec3 B = glm::normalize(camToCenter + ellipsoid.cartesianPosition(c1));
+    const glm::dvec3 C = glm::normalize(camToCenter + ellipsoid.cartesianPosition(c2));
+
+    // Camera                      *cartesian space*
+    // |                    +--------+---+
+    // V             __--''   __--''    /
+    //              C-------A--------- +
+    // oo          /       /          /
+    //[  ]<       +-------B----------+
+    //
+
+    // If the geodetic patch is small (i.e. has small width), that means the patch in
+    // cartesian space will be almost flat, and in turn, the triangle ABC will roughly
+    // correspond to 1/8 of the full area
+    const glm::dvec3 AB = B - A;
+    const glm::dvec3 AC = C - A;
+    const double areaABC = 0.5 * glm::length(glm::cross(AC, AB));
+    const double projectedChunkAreaApprox = 8 * areaABC;
+
+    const double scaledArea = view.lodScaleFactor * projectedChunkAreaApprox;
+    return chunk.tileIndex.level + static_cast<int>(round(scaledArea - 1));
+}
+
+void evaluateChunk(ChunkEvaluation& evaluation, const Ellipsoid& ellipsoid,
+                   const ChunkView& view)
+{
+    ZoneScoped;
+
+    Chunk& chunk = *evaluation.chunk;
+    const BoundingHeights& heights = evaluation.heights;
+
+    if (view.updateCorners) {
+        chunk.corners = boundingCornersForChunk(chunk, ellipsoid, heights);
+    }
+
+    const bool isCullable =
+        (view.performHorizonCulling &&
+            isCullableByHorizon(chunk, ellipsoid, view, heights)) ||
+        (view.performFrustumCulling &&
+            isCullableByFrustum(chunk, view.modelViewProjection));
+    chunk.isVisible = !isCullable;
+
+    int desiredLevel = view.levelByProjectedArea ?
+        desiredLevelByProjectedArea(chunk, ellipsoid, view, heights) :
+        desiredLevelByDistance(chunk, ellipsoid, view, heights);
+    if (evaluation.levelByAvailableData.has_value()) {
+        desiredLevel = std::min(desiredLevel, *evaluation.levelByAvailableData);
+    }
+    desiredLevel = std::clamp(desiredLevel, view.minLevel, view.maxLevel);
+
+    if (desiredLevel < chunk.tileIndex.level) {
+        chunk.status = Chunk::Status::WantMerge;
+    }
+    else if (chunk.tileIndex.level < desiredLevel) {
+        chunk.status = Chunk::Status::WantSplit;
+    }
+    else {
+        chunk.status = Chunk::Status::DoNothing;
+    }
+}
+
+void evaluateChunks(std::vector<ChunkEvaluation>& chunks, const Ellipsoid& ellipsoid,
+                    const ChunkView& view, ThreadPool* pool)
+{
+    ZoneScoped;
+
+    if (!pool || pool->numThreads() == 0 || chunks.size() < ParallelChunkThreshold) {
+        for (ChunkEvaluation& evaluation : chunks) {
+            evaluateChunk(evaluation, ellipsoid, view);
+        }
+        return;
+    }
+
+    const size_t nBatches = (chunks.size() + ChunkBatchSize - 1) / ChunkBatchSize;
+    std::atomic_size_t nextBatch = 0;
+    auto evaluateBatches = [&]() {
+        for (size_t b = nextBatch++; b < nBatches; b = nextBatch++) {
+            const size_t end = std::min((b + 1) * ChunkBatchSize, chunks.size());
+            for (size_t i = b * ChunkBatchSize; i < end; ++i) {
+                evaluateChunk(chunks[i], ellipsoid, view);
+            }
+        }
+    };
+
+    // The calling thread takes part in the evaluation, so we only need helpers for the
+    // remaining batches. If the pool is busy, the calling thread will process the batches
+    // on its own and the helpers find no more work once they are started
+    const size_t nHelpers = std::min(pool->numThreads(), nBatches - 1);
+    std::latch helpersDone(static_cast<std::ptrdiff_t>(nHelpers));
+    for (size_t i = 0; i < nHelpers; ++i) {
+        pool->enqueue([&evaluateBatches, &helpersDone]() {
+            evaluateBatches();
+            helpersDone.count_down();
+        });
+    }
+    evaluateBatches();
+    helpersDone.wait();
+}
+
+} // namespace openspace::globebrowsing
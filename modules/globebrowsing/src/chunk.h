@@ -0,0 +1,139 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2023                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_MODULE_GLOBEBROWSING___CHUNK___H__
+#define __OPENSPACE_MODULE_GLOBEBROWSING___CHUNK___H__
+
+#include <modules/globebrowsing/src/basictypes.h>
+#include <modules/globebrowsing/src/geodeticpatch.h>
+#include <modules/globebrowsing/src/tileindex.h>
+#include <ghoul/glm.h>
+#include <array>
+#include <optional>
+#include <vector>
+
+namespace openspace { class ThreadPool; }
+
+namespace openspace::globebrowsing {
+
+class Ellipsoid;
+
+struct BoundingHeights {
+    float min;
+    float max;
+    bool available;
+    bool tileOK;
+};
+
+struct Chunk {
+    enum class Status : uint8_t {
+        DoNothing,
+        WantMerge,
+        WantSplit
+    };
+
+    Chunk(const TileIndex& tileIndex);
+
+    const TileIndex tileIndex;
+    const GeodeticPatch surfacePatch;
+
+    Status status;
+
+    bool isVisible = true;
+    bool colorTileOK = false;
+    bool heightTileOK = false;
+
+    std::array<glm::dvec4, 8> corners;
+    std::array<Chunk*, 4> children = { { nullptr, nullptr, nullptr, nullptr } };
+};
+
+/**
+ * The view dependent information that is shared by all chunks of a globe in a frame. All
+ * positions are in the model space of the globe.
+ */
+struct ChunkView {
+    glm::dmat4 modelViewProjection = glm::dmat4(1.0);
+    glm::dvec3 cameraPosition = glm::dvec3(0.0);
+
+    /// The camera position projected onto the surface of the ellipsoid
+    Geodetic2 cameraGeodetic;
+
+    /// The current level of detail scale factor of the globe
+    double lodScaleFactor = 1.0;
+
+    bool levelByProjectedArea = false;
+    bool performHorizonCulling = true;
+    bool performFrustumCulling = true;
+
+    /// If `true`, the bounding corners of the chunks are recalculated
+    bool updateCorners = false;
+
+    int minLevel = 2;
+    int maxLevel = 22;
+};
+
+/**
+ * A Chunk together with the information about it that has to be gathered from the tile
+ * providers. The tile providers must only be accessed from the main thread, so this has
+ * to happen before the chunks are passed to #evaluateChunks.
+ */
+struct ChunkEvaluation {
+    Chunk* chunk = nullptr;
+    BoundingHeights heights;
+
+    /// The highest level for which data is available, if it is known
+    std::optional<int> levelByAvailableData;
+};
+
+std::array<glm::dvec4, 8> boundingCornersForChunk(const Chunk& chunk,
+    const Ellipsoid& ellipsoid, const BoundingHeights& heights);
+
+bool isCullableByFrustum(const Chunk& chunk, const glm::dmat4& mvp);
+bool isCullableByHorizon(const Chunk& chunk, const Ellipsoid& ellipsoid,
+    const ChunkView& view, const BoundingHeights& heights);
+
+int desiredLevelByDistance(const Chunk& chunk, const Ellipsoid& ellipsoid,
+    const ChunkView& view, const BoundingHeights& heights);
+int desiredLevelByProjectedArea(const Chunk& chunk, const Ellipsoid& ellipsoid,
+    const ChunkView& view, const BoundingHeights& heights);
+
+/**
+ * Updates the visibility and the split/merge status of a single chunk and, if requested
+ * by the \p view, its bounding corners.
+ */
+void evaluateChunk(ChunkEvaluation& evaluation, const Ellipsoid& ellipsoid,
+    const ChunkView& view);
+
+/**
+ * Evaluates all \p chunks using #evaluateChunk. If there are enough chunks, they are
+ * split into batches that are evaluated on the threads of the \p pool, with the calling
+ * thread participating. The function returns when all chunks have been evaluated. Each
+ * chunk must only occur once in the list.
+ */
+void evaluateChunks(std::vector<ChunkEvaluation>& chunks, const Ellipsoid& ellipsoid,
+    const ChunkView& view, ThreadPool* pool = nullptr);
+
+} // namespace openspace::globebrowsing
+
+#endif // __OPENSPACE_MODULE_GLOBEBROWSING___CHUNK___H__
@@ -0,0 +1,136 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2023                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_MODULE_GLOBEBROWSING___COST_AWARE_CACHE___H__
+#define __OPENSPACE_MODULE_GLOBEBROWSING___COST_AWARE_CACHE___H__
+
+#include <modules/globebrowsing/src/flathashmap.h>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace openspace::globebrowsing::cache {
+
+/**
+ * Templated cache in which every item has a size and a cost. The cache itself does not
+ * have a capacity, instead the owner is responsible for calling #popVictim until the
+ * #totalSize of the cache fits within its budget. Which item is the victim is determined
+ * by the eviction Policy:
+ *   - LeastRecentlyUsed: The item that was put or accessed the longest time ago
+ *   - GreedyDualSize: The item with the lowest cost per size, aged by the priority of
+ *     the previously evicted items so that items that are not accessed anymore are
+ *     eventually evicted regardless of their cost
+ *
+ * The items are stored in a flat array and the eviction order is kept in an indexed
+ * binary heap of array positions, so that no memory is allocated for reordering items.
+ * The keys are mapped to the array positions by a FlatHashMap.
+ */
+template <typename KeyType, typename ValueType, typename HasherType>
+class CostAwareCache {
+public:
+    enum class Policy {
+        LeastRecentlyUsed = 0,
+        GreedyDualSize
+    };
+
+    using Item = std::pair<KeyType, ValueType>;
+
+    explicit CostAwareCache(Policy policy = Policy::LeastRecentlyUsed);
+
+    /**
+     * Adds the \p value with the provided \p size and \p cost to the cache. If an item
+     * with the same \p key already exists, it is replaced.
+     */
+    void put(KeyType key, ValueType value, size_t size, double cost = 1.0);
+
+    bool exist(const KeyType& key) const;
+
+    /**
+     * Returns a pointer to the value stored for \p key and marks the item as accessed,
+     * or `nullptr` if no such item exists. The pointer is invalidated by the next
+     * modification of the cache.
+     */
+    ValueType* get(const KeyType& key);
+
+    /**
+     * Removes and returns the item that should be evicted first according to the policy.
+     */
+    Item popVictim();
+
+    void clear();
+    bool isEmpty() const;
+
+    /**
+     * \return The number of items in the cache
+     */
+    size_t size() const;
+
+    /**
+     * \return The sum of the sizes of all items in the cache
+     */
+    size_t totalSize() const;
+
+    Policy policy() const;
+
+    /**
+     * Changes the eviction policy. The order of the items that are currently cached is
+     * preserved as far as possible.
+     */
+    void setPolicy(Policy policy);
+
+private:
+    struct Node {
+        KeyType key;
+        ValueType value;
+        size_t size;
+        double cost;
+        double priority;
+        uint32_t heapIndex;
+    };
+
+    double priority(const Node& node);
+    void siftUp(uint32_t heapIndex);
+    void siftDown(uint32_t heapIndex);
+    void swapHeap(uint32_t a, uint32_t b);
+    void removeNode(uint32_t nodeIndex);
+
+    std::vector<Node> _nodes;
+    /// Min-heap of indices into _nodes ordered by the priority of the node
+    std::vector<uint32_t> _heap;
+    FlatHashMap<KeyType, uint32_t, HasherType> _nodeMap;
+
+    Policy _policy;
+    size_t _totalSize = 0;
+    /// Logical clock that is incremented on every access for the LRU policy
+    double _clock = 0.0;
+    /// Priority of the last evicted item for the GreedyDualSize policy
+    double _inflation = 0.0;
+};
+
+} // namespace openspace::globebrowsing::cache
+
+#include <modules/globebrowsing/src/costawarecache.inl>
+
+#endif // __OPENSPACE_MODULE_GLOBEBROWSING___COST_AWARE_CACHE___H__
@@ -0,0 +1,248 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2023                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <ghoul/misc/assert.h>
+#include <ghoul/misc/exception.h>
+#include <algorithm>
+
+namespace openspace::globebrowsing::cache {
+
+template <typename KeyType, typename ValueType, typename HasherType>
+CostAwareCache<KeyType, ValueType, HasherType>::CostAwareCache(Policy policy)
+    : _policy(policy)
+{}
+
+template <typename KeyType, typename ValueType, typename HasherType>
+void CostAwareCache<KeyType, ValueType, HasherType>::put(KeyType key, ValueType value,
+                                                         size_t size, double cost)
+{
+    const uint32_t* existing = _nodeMap.find(key);
+    if (existing) {
+        removeNode(*existing);
+    }
+
+    const uint32_t nodeIndex = static_cast<uint32_t>(_nodes.size());
+    const uint32_t heapIndex = static_cast<uint32_t>(_heap.size());
+    _nodes.push_back({ key, std::move(value), size, cost, 0.0, heapIndex });
+    _nodes.back().priority = priority(_nodes.back());
+    _heap.push_back(nodeIndex);
+    _nodeMap.insertOrAssign(std::move(key), nodeIndex);
+    _totalSize += size;
+    siftUp(heapIndex);
+}
+
+template <typename KeyType, typename ValueType, typename HasherType>
+bool CostAwareCache<KeyType, ValueType, HasherType>::exist(const KeyType& key) const {
+    return _nodeMap.contains(key);
+}
+
+template <typename KeyType, typename ValueType, typename HasherType>
+ValueType* CostAwareCache<KeyType, ValueType, HasherType>::get(const KeyType& key) {
+    const uint32_t* nodeIndex = _nodeMap.find(key);
+    if (!nodeIndex) {
+        return nullptr;
+    }
+
+    Node& node = _nodes[*nodeIndex];
+    // The priority of an accessed item can only increase in both policies
+    node.priority = priority(node);
+    siftDown(node.heapIndex);
+    return &node.value;
+}
+
+template <typename KeyType, typename ValueType, typename HasherType>
+typename CostAwareCache<KeyType, ValueType, HasherType>::Item
+CostAwareCache<KeyType, ValueType, HasherType>::popVictim()
+{
+    ghoul_assert(!_heap.empty(), "Cannot pop from cache. Ensure cache is not empty");
+
+    const uint32_t nodeIndex = _heap.front();
+    Node& node = _nodes[nodeIndex];
+    if (_policy == Policy::GreedyDualSize) {
+        _inflation = node.priority;
+    }
+    // The key is still needed to remove the node from the map
+    Item result = { node.key, std::move(node.value) };
+    removeNode(nodeIndex);
+    return result;
+}
+
+template <typename KeyType, typename ValueType, typename HasherType>
+void CostAwareCache<KeyType, ValueType, HasherType>::clear() {
+    _nodes.clear();
+    _heap.clear();
+    _nodeMap.clear();
+    _totalSize = 0;
+    _clock = 0.0;
+    _inflation = 0.0;
+}
+
+template <typename KeyType, typename ValueType, typename HasherType>
+bool CostAwareCache<KeyType, ValueType, HasherType>::isEmpty() const {
+    return _nodes.empty();
+}
+
+template <typename KeyType, typename ValueType, typename HasherType>
+size_t CostAwareCache<KeyType, ValueType, HasherType>::size() const {
+    return _nodes.size();
+}
+
+template <typename KeyType, typename ValueType, typename HasherType>
+size_t CostAwareCache<KeyType, ValueType, HasherType>::totalSize() const {
+    return _totalSize;
+}
+
+template <typename KeyType, typename ValueType, typename HasherType>
+typename CostAwareCache<KeyType, ValueType, HasherType>::Policy
+CostAwareCache<KeyType, ValueType, HasherType>::policy() const
+{
+    return _policy;
+}
+
+template <typename KeyType, typename ValueType, typename HasherType>
+void CostAwareCache<KeyType, ValueType, HasherType>::setPolicy(Policy policy) {
+    if (policy == _policy) {
+        return;
+    }
+    _policy = policy;
+
+    // Recompute the priorities in the current eviction order so that the items that
+    // would have been evicted first under the old policy get the lowest new priorities
+    std::vector<uint32_t> order = _heap;
+    std::sort(
+        order.begin(),
+        order.end(),
+        [this](uint32_t lhs, uint32_t rhs) {
+            return _nodes[lhs].priority < _nodes[rhs].priority;
+        }
+    );
+    _clock = 0.0;
+    _inflation = 0.0;
+    for (uint32_t nodeIndex : order) {
+        _nodes[nodeIndex].priority = priority(_nodes[nodeIndex]);
+    }
+
+    // A sorted array is a valid min-heap
+    std::sort(
+        order.begin(),
+        order.end(),
+        [this](uint32_t lhs, uint32_t rhs) {
+            return _nodes[lhs].priority < _nodes[rhs].priority;
+        }
+    );
+    _heap = std::move(order);
+    for (uint32_t i = 0; i < _heap.size(); i++) {
+        _nodes[_heap[i]].heapIndex = i;
+    }
+}
+
+template <typename KeyType, typename ValueType, typename HasherType>
+double CostAwareCache<KeyType, ValueType, HasherType>::priority(const Node& node) {
+    switch (_policy) {
+        case Policy::LeastRecentlyUsed:
+            _clock += 1.0;
+            return _clock;
+        case Policy::GreedyDualSize:
+        {
+            const double size = static_cast<double>(std::max<size_t>(node.size, 1));
+            return _inflation + node.cost / size;
+        }
+        default:
+            throw ghoul::MissingCaseException();
+    }
+}
+
+template <typename KeyType, typename ValueType, typename HasherType>
+void CostAwareCache<KeyType, ValueType, HasherType>::siftUp(uint32_t heapIndex) {
+    while (heapIndex > 0) {
+        const uint32_t parent = (heapIndex - 1) / 2;
+        if (_nodes[_heap[parent]].priority <= _nodes[_heap[heapIndex]].priority) {
+            break;
+        }
+        swapHeap(parent, heapIndex);
+        heapIndex = parent;
+    }
+}
+
+template <typename KeyType, typename ValueType, typename HasherType>
+void CostAwareCache<KeyType, ValueType, HasherType>::siftDown(uint32_t heapIndex) {
+    const uint32_t n = static_cast<uint32_t>(_heap.size());
+    while (true) {
+        const uint32_t left = 2 * heapIndex + 1;
+        const uint32_t right = left + 1;
+        uint32_t smallest = heapIndex;
+        if (left < n &&
+            _nodes[_heap[left]].priority < _nodes[_heap[smallest]].priority)
+        {
+            smallest = left;
+        }
+        if (right < n &&
+            _nodes[_heap[right]].priority < _nodes[_heap[smallest]].priority)
+        {
+            smallest = right;
+        }
+        if (smallest == heapIndex) {
+            break;
+        }
+        swapHeap(heapIndex, smallest);
+        heapIndex = smallest;
+    }
+}
+
+template <typename KeyType, typename ValueType, typename HasherType>
+void CostAwareCache<KeyType, ValueType, HasherType>::swapHeap(uint32_t a, uint32_t b) {
+    std::swap(_heap[a], _heap[b]);
+    _nodes[_heap[a]].heapIndex = a;
+    _nodes[_heap[b]].heapIndex = b;
+}
+
+template <typename KeyType, typename ValueType, typename HasherType>
+void CostAwareCache<KeyType, ValueType, HasherType>::removeNode(uint32_t nodeIndex) {
+    // Remove the node from the heap by replacing it with the last heap element
+    const uint32_t heapIndex = _nodes[nodeIndex].heapIndex;
+    const uint32_t lastHeapIndex = static_cast<uint32_t>(_heap.size() - 1);
+    if (heapIndex != lastHeapIndex) {
+        swapHeap(heapIndex, lastHeapIndex);
+        _heap.pop_back();
+        siftDown(heapIndex);
+        siftUp(heapIndex);
+    }
+    else {
+        _heap.pop_back();
+    }
+
+    _totalSize -= _nodes[nodeIndex].size;
+    _nodeMap.erase(_nodes[nodeIndex].key);
+
+    // Keep the node array dense by moving the last node into the freed slot
+    const uint32_t lastNodeIndex = static_cast<uint32_t>(_nodes.size() - 1);
+    if (nodeIndex != lastNodeIndex) {
+        _nodes[nodeIndex] = std::move(_nodes[lastNodeIndex]);
+        _heap[_nodes[nodeIndex].heapIndex] = nodeIndex;
+        _nodeMap[_nodes[nodeIndex].key] = nodeIndex;
+    }
+    _nodes.pop_back();
+}
+
+} // namespace openspace::globebrowsing::cache
@@ -0,0 +1,113 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2023                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_MODULE_GLOBEBROWSING___FLAT_HASH_MAP___H__
+#define __OPENSPACE_MODULE_GLOBEBROWSING___FLAT_HASH_MAP___H__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace openspace::globebrowsing::cache {
+
+/**
+ * Hash map that stores its items in a single flat array using open addressing with
+ * linear probing. Removed items are filled by shifting the following items of the same
+ * probe sequence backwards, so no tombstones are left behind and lookups never have to
+ * skip over removed items. The value of the `HasherType` is mixed before it is used, so
+ * hashers that return the key itself, such as the packed tile keys, are sufficient.
+ *
+ * `KeyType` and `ValueType` need to be default constructible. Pointers to the values
+ * are invalidated by every insertion and removal.
+ */
+template <typename KeyType, typename ValueType, typename HasherType>
+class FlatHashMap {
+public:
+    /**
+     * \return A pointer to the value that is stored for \p key or `nullptr` if the key
+     *         does not exist in the map
+     */
+    ValueType* find(const KeyType& key);
+    const ValueType* find(const KeyType& key) const;
+    bool contains(const KeyType& key) const;
+
+    /**
+     * Returns the value stored for \p key, which is default constructed and inserted
+     * first if the key does not exist in the map.
+     */
+    ValueType& operator[](const KeyType& key);
+
+    /**
+     * Stores the \p value for the \p key, replacing the previous value if the key
+     * already existed. Returns `true` if the key was newly inserted.
+     */
+    bool insertOrAssign(KeyType key, ValueType value);
+
+    /**
+     * Removes the \p key from the map and returns whether it existed.
+     */
+    bool erase(const KeyType& key);
+
+    /**
+     * Removes all items for which \p predicate, which is called with the key and the
+     * value of every item, returns `true`. Returns the number of removed items.
+     */
+    template <typename Predicate>
+    size_t eraseIf(Predicate&& predicate);
+
+    /**
+     * Calls \p function with the key and the value of every item in an unspecified
+     * order. The map must not be modified from within \p function.
+     */
+    template <typename Function>
+    void forEach(Function&& function);
+
+    void clear();
+    void reserve(size_t size);
+
+    size_t size() const;
+    bool isEmpty() const;
+
+private:
+    struct Slot {
+        KeyType key = KeyType();
+        ValueType value = ValueType();
+        bool isOccupied = false;
+    };
+
+    size_t idealSlot(const KeyType& key) const;
+    size_t findSlot(const KeyType& key) const;
+    size_t insertSlot(KeyType key);
+    void eraseSlot(size_t slot);
+    void rehash(size_t capacity);
+
+    std::vector<Slot> _slots;
+    size_t _size = 0;
+};
+
+} // namespace openspace::globebrowsing::cache
+
+#include <modules/globebrowsing/src/flathashmap.inl>
+
+#endif // __OPENSPACE_MODULE_GLOBEBROWSING___FLAT_HASH_MAP___H__
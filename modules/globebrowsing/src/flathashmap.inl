@@ -0,0 +1,242 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2023                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <ghoul/misc/assert.h>
+#include <algorithm>
+#include <utility>
+
+namespace openspace::globebrowsing::cache {
+
+template <typename KeyType, typename ValueType, typename HasherType>
+ValueType* FlatHashMap<KeyType, ValueType, HasherType>::find(const KeyType& key) {
+    const size_t slot = findSlot(key);
+    return slot != _slots.size() ? &_slots[slot].value : nullptr;
+}
+
+template <typename KeyType, typename ValueType, typename HasherType>
+const ValueType* FlatHashMap<KeyType, ValueType, HasherType>::find(
+                                                                const KeyType& key) const
+{
+    const size_t slot = findSlot(key);
+    return slot != _slots.size() ? &_slots[slot].value : nullptr;
+}
+
+template <typename KeyType, typename ValueType, typename HasherType>
+bool FlatHashMap<KeyType, ValueType, HasherType>::contains(const KeyType& key) const {
+    return findSlot(key) != _slots.size();
+}
+
+template <typename KeyType, typename ValueType, typename HasherType>
+ValueType& FlatHashMap<KeyType, ValueType, HasherType>::operator[](const KeyType& key) {
+    const size_t slot = findSlot(key);
+    if (slot != _slots.size()) {
+        return _slots[slot].value;
+    }
+    return _slots[insertSlot(key)].value;
+}
+
+template <typename KeyType, typename ValueType, typename HasherType>
+bool FlatHashMap<KeyType, ValueType, HasherType>::insertOrAssign(KeyType key,
+                                                                 ValueType value)
+{
+    const size_t slot = findSlot(key);
+    if (slot != _slots.size()) {
+        _slots[slot].value = std::move(value);
+        return false;
+    }
+    _slots[insertSlot(std::move(key))].value = std::move(value);
+    return true;
+}
+
+template <typename KeyType, typename ValueType, typename HasherType>
+bool FlatHashMap<KeyType, ValueType, HasherType>::erase(const KeyType& key) {
+    const size_t slot = findSlot(key);
+    if (slot == _slots.size()) {
+        return false;
+    }
+    eraseSlot(slot);
+    return true;
+}
+
+template <typename KeyType, typename ValueType, typename HasherType>
+template <typename Predicate>
+size_t FlatHashMap<KeyType, ValueType, HasherType>::eraseIf(Predicate&& predicate) {
+    if (_size == 0) {
+        return 0;
+    }
+
+    // Start the iteration after an empty slot. Removing an item only moves items of the
+    // same probe sequence backwards and no probe sequence extends past an empty slot, so
+    // every item is visited exactly once even though items are moved during the loop
+    const size_t mask = _slots.size() - 1;
+    size_t start = 0;
+    while (_slots[start].isOccupied) {
+        start++;
+    }
+
+    size_t nErased = 0;
+    for (size_t i = 1; i < _slots.size(); i++) {
+        const size_t slot = (start + i) & mask;
+        while (_slots[slot].isOccupied &&
+               predicate(std::as_const(_slots[slot].key), _slots[slot].value))
+        {
+            eraseSlot(slot);
+            nErased++;
+        }
+    }
+    return nErased;
+}
+
+template <typename KeyType, typename ValueType, typename HasherType>
+template <typename Function>
+void FlatHashMap<KeyType, ValueType, HasherType>::forEach(Function&& function) {
+    for (Slot& slot : _slots) {
+        if (slot.isOccupied) {
+            function(std::as_const(slot.key), slot.value);
+        }
+    }
+}
+
+template <typename KeyType, typename ValueType, typename HasherType>
+void FlatHashMap<KeyType, ValueType, HasherType>::clear() {
+    if (_size == 0) {
+        return;
+    }
+
+    // Keep the allocated slots as the map is most likely filled again
+    for (Slot& slot : _slots) {
+        slot = Slot();
+    }
+    _size = 0;
+}
+
+template <typename KeyType, typename ValueType, typename HasherType>
+void FlatHashMap<KeyType, ValueType, HasherType>::reserve(size_t size) {
+    size_t capacity = std::max<size_t>(_slots.size(), 16);
+    while (size * 4 > capacity * 3) {
+        capacity *= 2;
+    }
+    if (capacity != _slots.size()) {
+        rehash(capacity);
+    }
+}
+
+template <typename KeyType, typename ValueType, typename HasherType>
+size_t FlatHashMap<KeyType, ValueType, HasherType>::size() const {
+    return _size;
+}
+
+template <typename KeyType, typename ValueType, typename HasherType>
+bool FlatHashMap<KeyType, ValueType, HasherType>::isEmpty() const {
+    return _size == 0;
+}
+
+template <typename KeyType, typename ValueType, typename HasherType>
+size_t FlatHashMap<KeyType, ValueType, HasherType>::idealSlot(const KeyType& key) const {
+    // Finalizer of MurmurHash3, which spreads keys that only differ in a few bits over
+    // the entire table
+    uint64_t h = static_cast<uint64_t>(HasherType()(key));
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return static_cast<size_t>(h) & (_slots.size() - 1);
+}
+
+template <typename KeyType, typename ValueType, typename HasherType>
+size_t FlatHashMap<KeyType, ValueType, HasherType>::findSlot(const KeyType& key) const {
+    if (_size == 0) {
+        return _slots.size();
+    }
+
+    const size_t mask = _slots.size() - 1;
+    for (size_t slot = idealSlot(key); ; slot = (slot + 1) & mask) {
+        if (!_slots[slot].isOccupied) {
+            return _slots.size();
+        }
+        if (_slots[slot].key == key) {
+            return slot;
+        }
+    }
+}
+
+template <typename KeyType, typename ValueType, typename HasherType>
+size_t FlatHashMap<KeyType, ValueType, HasherType>::insertSlot(KeyType key) {
+    // Keep the load factor below 3/4 so that the probe sequences stay short
+    if ((_size + 1) * 4 > _slots.size() * 3) {
+        rehash(std::max<size_t>(2 * _slots.size(), 16));
+    }
+
+    const size_t mask = _slots.size() - 1;
+    size_t slot = idealSlot(key);
+    while (_slots[slot].isOccupied) {
+        slot = (slot + 1) & mask;
+    }
+    _slots[slot].key = std::move(key);
+    _slots[slot].isOccupied = true;
+    _size++;
+    return slot;
+}
+
+template <typename KeyType, typename ValueType, typename HasherType>
+void FlatHashMap<KeyType, ValueType, HasherType>::eraseSlot(size_t slot) {
+    ghoul_assert(_slots[slot].isOccupied, "Slot must be occupied");
+
+    const size_t mask = _slots.size() - 1;
+    size_t hole = slot;
+    size_t next = (hole + 1) & mask;
+    for (; _slots[next].isOccupied; next = (next + 1) & mask) {
+        // The item can fill the hole if the hole lies on its probe sequence, that is if
+        // the hole is not further away from the item than the item's ideal slot
+        const size_t ideal = idealSlot(_slots[next].key);
+        if (((next - ideal) & mask) >= ((next - hole) & mask)) {
+            _slots[hole].key = std::move(_slots[next].key);
+            _slots[hole].value = std::move(_slots[next].value);
+            hole = next;
+        }
+    }
+    _slots[hole] = Slot();
+    _size--;
+}
+
+template <typename KeyType, typename ValueType, typename HasherType>
+void FlatHashMap<KeyType, ValueType, HasherType>::rehash(size_t capacity) {
+    ghoul_assert((capacity & (capacity - 1)) == 0, "Capacity must be a power of two");
+
+    std::vector<Slot> slots = std::move(_slots);
+    _slots = std::vector<Slot>(capacity);
+    const size_t mask = capacity - 1;
+    for (Slot& s : slots) {
+        if (s.isOccupied) {
+            size_t slot = idealSlot(s.key);
+            while (_slots[slot].isOccupied) {
+                slot = (slot + 1) & mask;
+            }
+            _slots[slot] = std::move(s);
+        }
+    }
+}
+
+} // namespace openspace::globebrowsing::cache
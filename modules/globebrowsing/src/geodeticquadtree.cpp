@@ -0,0 +1,143 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2023                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/globebrowsing/src/geodeticquadtree.h>
+
+#include <ghoul/misc/assert.h>
+#include <ghoul/misc/profiling.h>
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+namespace openspace::globebrowsing {
+
+void GeodeticQuadtree::build(std::span<const Geodetic2> coordinates,
+                             std::span<const glm::dvec3> positions)
+{
+    ZoneScoped;
+
+    ghoul_assert(
+        coordinates.size() == positions.size(),
+        "Coordinates and positions must have the same size"
+    );
+
+    _nodes.clear();
+    _indices.resize(coordinates.size());
+    std::iota(_indices.begin(), _indices.end(), 0);
+
+    if (_indices.empty()) {
+        return;
+    }
+
+    Node root;
+    root.count = static_cast<uint32_t>(_indices.size());
+    _nodes.push_back(root);
+
+    const Geodetic2 min = { -glm::half_pi<double>(), -glm::pi<double>() };
+    const Geodetic2 max = { glm::half_pi<double>(), glm::pi<double>() };
+    buildNode(0, min, max, 0, coordinates, positions);
+}
+
+void GeodeticQuadtree::buildNode(uint32_t nodeIndex, const Geodetic2& min,
+                                 const Geodetic2& max, int level,
+                                 std::span<const Geodetic2> coordinates,
+                                 std::span<const glm::dvec3> positions)
+{
+    const auto begin = _indices.begin() + _nodes[nodeIndex].first;
+    const auto end = begin + _nodes[nodeIndex].count;
+
+    // The bounding sphere is centered on the bounding box of the points
+    glm::dvec3 lower = glm::dvec3(std::numeric_limits<double>::max());
+    glm::dvec3 upper = glm::dvec3(std::numeric_limits<double>::lowest());
+    for (auto it = begin; it != end; it++) {
+        lower = glm::min(lower, positions[*it]);
+        upper = glm::max(upper, positions[*it]);
+    }
+    const glm::dvec3 center = 0.5 * (lower + upper);
+    double radius = 0.0;
+    for (auto it = begin; it != end; it++) {
+        radius = std::max(radius, glm::distance(center, positions[*it]));
+    }
+    _nodes[nodeIndex].center = center;
+    _nodes[nodeIndex].radius = radius;
+
+    if (_nodes[nodeIndex].count <= MaxPointsPerLeaf || level == MaxLevel) {
+        return;
+    }
+
+    // Sort the points into the four quadrants of the node
+    const Geodetic2 mid = { 0.5 * (min.lat + max.lat), 0.5 * (min.lon + max.lon) };
+    auto isSouth = [&](uint32_t i) { return coordinates[i].lat < mid.lat; };
+    auto isWest = [&](uint32_t i) { return coordinates[i].lon < mid.lon; };
+    const auto north = std::partition(begin, end, isSouth);
+    const auto southEast = std::partition(begin, north, isWest);
+    const auto northEast = std::partition(north, end, isWest);
+
+    struct Quadrant {
+        std::vector<uint32_t>::iterator begin;
+        std::vector<uint32_t>::iterator end;
+        Geodetic2 min;
+        Geodetic2 max;
+    };
+    const std::array<Quadrant, 4> quadrants = {
+        Quadrant{ begin, southEast, min, mid },
+        Quadrant{ southEast, north, { min.lat, mid.lon }, { mid.lat, max.lon } },
+        Quadrant{ north, northEast, { mid.lat, min.lon }, { max.lat, mid.lon } },
+        Quadrant{ northEast, end, mid, max }
+    };
+
+    // Only the quadrants that contain points become children
+    const uint32_t firstChild = static_cast<uint32_t>(_nodes.size());
+    uint32_t nChildren = 0;
+    for (const Quadrant& q : quadrants) {
+        if (q.begin == q.end) {
+            continue;
+        }
+        Node child;
+        child.first = static_cast<uint32_t>(q.begin - _indices.begin());
+        child.count = static_cast<uint32_t>(q.end - q.begin);
+        _nodes.push_back(child);
+        nChildren++;
+    }
+    _nodes[nodeIndex].firstChild = firstChild;
+    _nodes[nodeIndex].nChildren = nChildren;
+
+    uint32_t child = firstChild;
+    for (const Quadrant& q : quadrants) {
+        if (q.begin != q.end) {
+            buildNode(child, q.min, q.max, level + 1, coordinates, positions);
+            child++;
+        }
+    }
+}
+
+size_t GeodeticQuadtree::numNodes() const {
+    return _nodes.size();
+}
+
+size_t GeodeticQuadtree::numPoints() const {
+    return _indices.size();
+}
+
+} // namespace openspace::globebrowsing
@@ -0,0 +1,129 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2023                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_MODULE_GLOBEBROWSING___GEODETIC_QUADTREE___H__
+#define __OPENSPACE_MODULE_GLOBEBROWSING___GEODETIC_QUADTREE___H__
+
+#include <modules/globebrowsing/src/basictypes.h>
+#include <ghoul/glm.h>
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace openspace::globebrowsing {
+
+/**
+ * Spatial index for points on the surface of a globe. The latitude-longitude rectangle
+ * of the globe is recursively split into four quadrants until every leaf contains at
+ * most #MaxPointsPerLeaf points. Every node stores the bounding sphere of its points in
+ * model space, which is used to reject all points in a node with a single test.
+ *
+ * The nodes are stored in a flat array and the points of every node are a contiguous
+ * range in the array of point indices, so the tree has to be rebuilt as a whole whenever
+ * the points change.
+ */
+class GeodeticQuadtree {
+public:
+    static constexpr uint32_t MaxPointsPerLeaf = 32;
+    static constexpr int MaxLevel = 16;
+
+    /**
+     * Builds the tree for the points at the \p coordinates, whose model space positions
+     * are provided as \p positions. Both spans must have the same size. The indices that
+     * are returned by #query refer to the position of the points in these spans.
+     */
+    void build(std::span<const Geodetic2> coordinates,
+        std::span<const glm::dvec3> positions);
+
+    /**
+     * Calls \p visit with the index of every point in the nodes that pass the
+     * \p isVisible test. \p isVisible is called with the center and the radius of the
+     * bounding sphere of a node and must return `false` only if none of the points
+     * inside the sphere can be visible. The points that are passed to \p visit still
+     * have to be tested individually.
+     */
+    template <typename NodeTest, typename Visitor>
+    void query(NodeTest&& isVisible, Visitor&& visit) const;
+
+    size_t numNodes() const;
+    size_t numPoints() const;
+
+private:
+    struct Node {
+        // Bounding sphere of all points in the node
+        glm::dvec3 center = glm::dvec3(0.0);
+        double radius = 0.0;
+
+        // Range of the point indices in _indices
+        uint32_t first = 0;
+        uint32_t count = 0;
+
+        // Index of the first child in _nodes and the number of children. The children
+        // of a node are stored next to each other
+        uint32_t firstChild = 0;
+        uint32_t nChildren = 0;
+    };
+
+    void buildNode(uint32_t nodeIndex, const Geodetic2& min, const Geodetic2& max,
+        int level, std::span<const Geodetic2> coordinates,
+        std::span<const glm::dvec3> positions);
+
+    std::vector<Node> _nodes;
+    std::vector<uint32_t> _indices;
+};
+
+template <typename NodeTest, typename Visitor>
+void GeodeticQuadtree::query(NodeTest&& isVisible, Visitor&& visit) const {
+    if (_nodes.empty()) {
+        return;
+    }
+
+    // Every level of the tree adds at most three more nodes to the stack than it removes
+    std::array<uint32_t, 3 * MaxLevel + 2> stack;
+    size_t stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while (stackSize > 0) {
+        const Node& node = _nodes[stack[--stackSize]];
+        if (!isVisible(node.center, node.radius)) {
+            continue;
+        }
+
+        if (node.nChildren == 0) {
+            for (uint32_t i = node.first; i < node.first + node.count; i++) {
+                visit(_indices[i]);
+            }
+        }
+        else {
+            for (uint32_t i = 0; i < node.nChildren; i++) {
+                stack[stackSize++] = node.firstChild + i;
+            }
+        }
+    }
+}
+
+} // namespace openspace::globebrowsing
+
+#endif // __OPENSPACE_MODULE_GLOBEBROWSING___GEODETIC_QUADTREE___H__
@@ -39,12 +39,17 @@
 #include <ghoul/filesystem/filesystem.h>
 #include <ghoul/fmt.h>
 #include <ghoul/logging/logmanager.h>
+#include <ghoul/misc/profiling.h>
 #include <ghoul/opengl/openglstatecache.h>
 #include <ghoul/opengl/programobject.h>
+#include <algorithm>
+#include <chrono>
 #include <filesystem>
 #include <fstream>
 #include <functional>
+#include <memory>
 #include <optional>
+#include <thread>
 
 namespace geos_nlohmann = nlohmann;
 #include <geos/geom/Geometry.h>
@@ -58,6 +63,10 @@ namespace {
     constexpr std::string_view KeyName = "Name";
     constexpr std::string_view KeyDesc = "Description";
 
+    // The time per frame that is spent on adding loaded features and uploading their
+    // geometry to the GPU. At least one feature is handled per frame
+    constexpr std::chrono::milliseconds UploadTimeBudget(4);
+
     constexpr openspace::properties::Property::PropertyInfo EnabledInfo = {
         "Enabled",
         "Enabled",
@@ -239,6 +248,53 @@ namespace {
             [[codegen::reference("core_light_source")]];
     };
 #include "geojsoncomponent_codegen.cpp"
+
+    template <typename T>
+    bool isReady(const std::future<T>& f) {
+        return f.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+
+    using GlobeGeometryFeature = openspace::globebrowsing::GlobeGeometryFeature;
+
+    // Creates the geometry of all provided features on as many threads as there are
+    // hardware threads. The features are handed out one at a time as they can differ
+    // vastly in their complexity
+    std::vector<std::future<void>> createGeometryAsync(
+                                             std::vector<GlobeGeometryFeature*> features,
+                                         GlobeGeometryFeature::GeometrySettings settings,
+                                                          const std::atomic_bool& cancel)
+    {
+        struct Work {
+            std::vector<GlobeGeometryFeature*> features;
+            GlobeGeometryFeature::GeometrySettings settings;
+            std::atomic<size_t> next = 0;
+        };
+        auto work = std::make_shared<Work>();
+        work->features = std::move(features);
+        work->settings = settings;
+
+        const size_t nThreads = std::min<size_t>(
+            std::max(std::thread::hardware_concurrency(), 1u),
+            work->features.size()
+        );
+        std::vector<std::future<void>> jobs;
+        jobs.reserve(nThreads);
+        for (size_t i = 0; i < nThreads; i++) {
+            jobs.push_back(std::async(
+                std::launch::async,
+                [work, &cancel]() {
+                    ZoneScopedN("GeoJson Geometry");
+                    size_t j = work->next++;
+                    while (j < work->features.size() && !cancel) {
+                        work->features[j]->createGeometry(work->settings);
+                        j = work->next++;
+                    }
+                }
+            ));
+        }
+        return jobs;
+    }
+
 } // namespace
 
 namespace openspace::globebrowsing {
@@ -338,7 +394,8 @@ GeoJsonComponent::GeoJsonComponent(const ghoul::Dictionary& dictionary,
     );
 
     _heightOffset = p.heightOffset.value_or(_heightOffset);
-    _heightOffset.onChange([this]() { _heightOffsetIsDirty = true; });
+    // The height offset is applied in the shader and does not require the geometry to
+    // be recreated
     constexpr float MinRadiusFactor = -0.9f;
     constexpr float MaxRadiusFactor = 5.f;
     _heightOffset.setMinValue(MinRadiusFactor * minGlobeRadius);
@@ -420,7 +477,18 @@ GeoJsonComponent::GeoJsonComponent(const ghoul::Dictionary& dictionary,
     _deletePropertyOwner.addProperty(_deleteThisComponent);
     addPropertySubOwner(_deletePropertyOwner);
 
-    readFile();
+    // Reading the file and creating the geometry can take a long time for large files,
+    // so that is done in the background and the features are added once they are ready
+    LoadSettings loadSettings = {
+        .identifier = identifier(),
+        .file = p.file,
+        .ignoreHeights = _ignoreHeightsFromFile,
+        .geometry = geometrySettings()
+    };
+    _loadingFeatures = std::async(
+        std::launch::async,
+        [this, settings = std::move(loadSettings)]() { return readFile(settings); }
+    );
 
     if (p.lightSources.has_value()) {
         std::vector<ghoul::Dictionary> lightsources = *p.lightSources;
@@ -448,7 +516,15 @@ GeoJsonComponent::GeoJsonComponent(const ghoul::Dictionary& dictionary,
     addPropertySubOwner(_featuresPropertyOwner);
 }
 
-GeoJsonComponent::~GeoJsonComponent() {}
+GeoJsonComponent::~GeoJsonComponent() {
+    _cancelBackgroundWork = true;
+    if (_loadingFeatures.valid()) {
+        _loadingFeatures.wait();
+    }
+    for (const std::future<void>& job : _geometryJobs) {
+        job.wait();
+    }
+}
 
 bool GeoJsonComponent::enabled() const {
     return _enabled;
@@ -562,10 +638,28 @@ void GeoJsonComponent::render(const RenderData& data) {
 }
 
 void GeoJsonComponent::update() {
+    ZoneScoped;
+
+    if (_loadingFeatures.valid() && isReady(_loadingFeatures)) {
+        _loadedFeatures = _loadingFeatures.get();
+        _nAddedFeatures = 0;
+
+        if (_loadedFeatures.empty()) {
+            LWARNING(fmt::format(
+                "No GeoJson features could be successfully created for GeoJson layer "
+                "with identifier '{}'. Disabling layer.", identifier()
+            ));
+            _enabled = false;
+        }
+    }
+
     if (!_enabled || !isVisible()) {
         return;
     }
 
+    addLoadedFeatures();
+    updateGeometry();
+
     glm::vec3 offsets = glm::vec3(_latLongOffset.value(), _heightOffset);
 
     for (size_t i = 0; i < _geometryFeatures.size(); ++i) {
@@ -574,36 +668,37 @@ void GeoJsonComponent::update() {
         }
         GlobeGeometryFeature& g = _geometryFeatures[i];
 
-        if (_dataIsDirty || _heightOffsetIsDirty) {
-            g.setOffsets(offsets);
-        }
+        g.setOffsets(offsets);
 
         if (_textureIsDirty) {
             g.updateTexture();
         }
 
-        g.update(_dataIsDirty, _preventUpdatesFromHeightMap);
+        g.update(_preventUpdatesFromHeightMap);
     }
 
     _textureIsDirty = false;
-    _dataIsDirty = false;
 }
 
-void GeoJsonComponent::readFile() {
-    std::ifstream file(_geoJsonFile);
+std::vector<GeoJsonComponent::LoadedFeature> GeoJsonComponent::readFile(
+                                                              LoadSettings settings) const
+{
+    ZoneScoped;
+
+    std::ifstream file(settings.file);
 
     if (!file.good()) {
-        LERROR(fmt::format("Failed to open GeoJSON file: {}", _geoJsonFile.value()));
-        return;
+        LERROR(fmt::format("Failed to open GeoJSON file: {}", settings.file));
+        return {};
     }
 
-    _geometryFeatures.clear();
-
     std::string content(
         (std::istreambuf_iterator<char>(file)),
         (std::istreambuf_iterator<char>())
     );
 
+    std::vector<LoadedFeature> result;
+
     // Parse GeoJSON string into GeoJSON objects
     using namespace geos::io;
     GeoJSONReader reader;
@@ -613,31 +708,42 @@ void GeoJsonComponent::readFile() {
 
         int count = 1;
         for (const GeoJSONFeature& feature : fc.getFeatures()) {
-            parseSingleFeature(feature, count);
+            if (_cancelBackgroundWork) {
+                return {};
+            }
+            parseSingleFeature(feature, count, settings, result);
             count++;
         }
-
-        if (_geometryFeatures.empty()) {
-            LWARNING(fmt::format(
-                "No GeoJson features could be successfully created for GeoJson layer "
-                "with identifier '{}'. Disabling layer.", identifier()
-            ));
-            _enabled = false;
-        }
     }
     catch (const geos::util::GEOSException& e) {
         LERROR(fmt::format(
             "Error creating GeoJson layer with identifier '{}'. Problem reading "
-            "GeoJson file '{}'. Error: '{}'", identifier(), _geoJsonFile.value(), e.what()
+            "GeoJson file '{}'. Error: '{}'", settings.identifier, settings.file, e.what()
         ));
     }
 
-    computeMainFeatureMetaPropeties();
+    std::vector<GlobeGeometryFeature*> features;
+    features.reserve(result.size());
+    for (LoadedFeature& f : result) {
+        features.push_back(&f.feature);
+    }
+    std::vector<std::future<void>> jobs = createGeometryAsync(
+        std::move(features),
+        settings.geometry,
+        _cancelBackgroundWork
+    );
+    for (std::future<void>& job : jobs) {
+        job.get();
+    }
+
+    return result;
 }
 
 void GeoJsonComponent::parseSingleFeature(const geos::io::GeoJSONFeature& feature,
-                                          int indexInFile
-) {
+                                          int indexInFile,
+                                          const LoadSettings& settings,
+                                          std::vector<LoadedFeature>& result) const
+{
     // Read the geometry
     const geos::geom::Geometry* geom = feature.getGeometry();
 
@@ -649,7 +755,7 @@ void GeoJsonComponent::parseSingleFeature(const geos::io::GeoJSONFeature& featur
         // Null geometry => no geometries to add
         LWARNING(fmt::format(
             "Feature {} in GeoJson file '{}' is a null geometry and will not be loaded",
-            indexInFile, _geoJsonFile.value()
+            indexInFile, settings.file
         ));
         // @TODO (emmbr26) We should eventually support features with null geometry
     }
@@ -671,38 +777,19 @@ void GeoJsonComponent::parseSingleFeature(const geos::io::GeoJSONFeature& featur
     // Split other collection features into multiple individual rendered components
 
     for (const geos::geom::Geometry* geometry : geomsToAdd) {
-        const int index = static_cast<int>(_geometryFeatures.size());
+        const int index = static_cast<int>(result.size());
         try {
             GlobeGeometryFeature g(_globeNode, _defaultProperties, propsFromFile);
-            g.createFromSingleGeosGeometry(geometry, index, _ignoreHeightsFromFile);
-            g.initializeGL(_pointsProgram.get(), _linesAndPolygonsProgram.get());
-            _geometryFeatures.push_back(std::move(g));
-
-            std::string name = _geometryFeatures.back().key();
-            std::string identifier = makeIdentifier(name);
-
-            // If there is already an owner with that name as an identifier, make a
-            // unique one
-            if (_featuresPropertyOwner.hasPropertySubOwner(identifier)) {
-                identifier = fmt::format("Feature{}-", index, identifier);
-            }
-
-            properties::PropertyOwner::PropertyOwnerInfo info = {
-                identifier,
-                name
-                // @TODO: Use description from file, if any
-            };
-            _features.push_back(std::make_unique<SubFeatureProps>(info));
-
-            addMetaPropertiesToFeature(*_features.back(), index, geometry);
-
-            _featuresPropertyOwner.addPropertySubOwner(_features.back().get());
+            g.createFromSingleGeosGeometry(geometry, index, settings.ignoreHeights);
+            LoadedFeature loaded = { .feature = std::move(g) };
+            computeMetaData(loaded, geometry);
+            result.push_back(std::move(loaded));
         }
         catch (const ghoul::RuntimeError& error) {
             LERROR(fmt::format(
                 "Error creating GeoJson layer with identifier '{}'. Problem reading "
                 "feature {} in GeoJson file '{}'.",
-                identifier(), indexInFile, _geoJsonFile.value()
+                settings.identifier, indexInFile, settings.file
             ));
             LERRORC(error.component, error.message);
             // Do nothing
@@ -710,8 +797,126 @@ void GeoJsonComponent::parseSingleFeature(const geos::io::GeoJSONFeature& featur
     }
 }
 
-void GeoJsonComponent::addMetaPropertiesToFeature(SubFeatureProps& feature, int index,
-                                                  const geos::geom::Geometry* geometry)
+void GeoJsonComponent::addLoadedFeatures() {
+    if (_loadedFeatures.empty()) {
+        return;
+    }
+
+    ZoneScoped;
+
+    const auto start = std::chrono::steady_clock::now();
+    while (_nAddedFeatures < _loadedFeatures.size()) {
+        LoadedFeature& loaded = _loadedFeatures[_nAddedFeatures];
+        const int index = static_cast<int>(_geometryFeatures.size());
+
+        GlobeGeometryFeature& g = _geometryFeatures.emplace_back(
+            std::move(loaded.feature)
+        );
+        g.initializeGL(_pointsProgram.get(), _linesAndPolygonsProgram.get());
+        g.setOffsets(glm::vec3(_latLongOffset.value(), _heightOffset));
+        g.uploadGeometry();
+
+        std::string name = g.key();
+        std::string identifier = makeIdentifier(name);
+
+        // If there is already an owner with that name as an identifier, make a
+        // unique one
+        if (_featuresPropertyOwner.hasPropertySubOwner(identifier)) {
+            identifier = fmt::format("Feature{}-", index, identifier);
+        }
+
+        properties::PropertyOwner::PropertyOwnerInfo info = {
+            identifier,
+            name
+            // @TODO: Use description from file, if any
+        };
+        _features.push_back(std::make_unique<SubFeatureProps>(info));
+
+        addMetaPropertiesToFeature(*_features.back(), index, loaded);
+
+        _featuresPropertyOwner.addPropertySubOwner(_features.back().get());
+
+        _nAddedFeatures++;
+        if (std::chrono::steady_clock::now() - start > UploadTimeBudget) {
+            break;
+        }
+    }
+
+    if (_nAddedFeatures == _loadedFeatures.size()) {
+        _loadedFeatures.clear();
+        _nAddedFeatures = 0;
+        computeMainFeatureMetaPropeties();
+    }
+}
+
+void GeoJsonComponent::updateGeometry() {
+    const bool isLoading = _loadingFeatures.valid() || !_loadedFeatures.empty();
+    const bool isBusy = !_geometryJobs.empty() || _nextGeometryUpload.has_value();
+
+    // The geometry is recreated for all features at once, so we have to wait for all
+    // features to be loaded and for any previous recreation to be finished
+    if (_dataIsDirty && !isLoading && !isBusy) {
+        std::vector<GlobeGeometryFeature*> features;
+        features.reserve(_geometryFeatures.size());
+        for (GlobeGeometryFeature& g : _geometryFeatures) {
+            features.push_back(&g);
+        }
+        _geometryJobs = createGeometryAsync(
+            std::move(features),
+            geometrySettings(),
+            _cancelBackgroundWork
+        );
+        _dataIsDirty = false;
+    }
+
+    if (!_geometryJobs.empty()) {
+        const bool isFinished = std::all_of(
+            _geometryJobs.begin(),
+            _geometryJobs.end(),
+            [](const std::future<void>& job) { return isReady(job); }
+        );
+        if (!isFinished) {
+            return;
+        }
+
+        for (std::future<void>& job : _geometryJobs) {
+            job.get();
+        }
+        _geometryJobs.clear();
+        _nextGeometryUpload = 0;
+    }
+
+    if (_nextGeometryUpload.has_value()) {
+        ZoneScopedN("Upload Geometry");
+
+        const auto start = std::chrono::steady_clock::now();
+        size_t& i = *_nextGeometryUpload;
+        while (i < _geometryFeatures.size()) {
+            _geometryFeatures[i].uploadGeometry();
+            i++;
+            if (std::chrono::steady_clock::now() - start > UploadTimeBudget) {
+                break;
+            }
+        }
+
+        if (i == _geometryFeatures.size()) {
+            _nextGeometryUpload = std::nullopt;
+        }
+    }
+}
+
+GlobeGeometryFeature::GeometrySettings GeoJsonComponent::geometrySettings() const {
+    return {
+        .latLongOffset = _latLongOffset.value(),
+        .tessellationEnabled = _defaultProperties.tessellation.enabled,
+        .useTessellationLevel = _defaultProperties.tessellation.useLevel,
+        .tessellationLevel = _defaultProperties.tessellation.level,
+        .tessellationDistance = _defaultProperties.tessellation.distance
+    };
+}
+
+void GeoJsonComponent::computeMetaData(LoadedFeature& feature,
+                                       const geos::geom::Geometry* geometry) const
 {
     std::unique_ptr<geos::geom::Point> centroid = geometry->getCentroid();
     // Using `auto` here as on MacOS `getCoordinate` returns:
@@ -761,6 +966,14 @@ void GeoJsonComponent::addMetaPropertiesToFeature(SubFeatureProps& feature, int
     feature.boundingBoxDiagonal = static_cast<float>(
         std::abs(_globeNode.ellipsoid().greatCircleDistance(pos0, pos1))
     );
+}
+
+void GeoJsonComponent::addMetaPropertiesToFeature(SubFeatureProps& feature, int index,
+                                                  const LoadedFeature& loadedFeature)
+{
+    feature.centroidLatLong = loadedFeature.centroidLatLong;
+    feature.boundingboxLatLong = loadedFeature.boundingboxLatLong;
+    feature.boundingBoxDiagonal = loadedFeature.boundingBoxDiagonal;
 
     feature.flyToFeature.onChange([this, index]() { flyToFeature(index); });
 }
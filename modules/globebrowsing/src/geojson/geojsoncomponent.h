@@ -42,6 +42,9 @@
 #include <openspace/rendering/helper.h>
 #include <ghoul/opengl/ghoul_gl.h>
 #include <ghoul/glm.h>
+#include <atomic>
+#include <filesystem>
+#include <future>
 #include <optional>
 #include <vector>
 
@@ -97,15 +100,72 @@ private:
         float boundingBoxDiagonal = 0.f;
     };
 
-    void readFile();
-    void parseSingleFeature(const geos::io::GeoJSONFeature& feature, int indexInFile);
+    /**
+     * A geometry feature that has been read from the file and whose geometry has been
+     * created on a worker thread, together with the meta information that is needed to
+     * create its SubFeatureProps on the main thread
+     */
+    struct LoadedFeature {
+        GlobeGeometryFeature feature;
+        glm::vec2 centroidLatLong = glm::vec2(0.f);
+        glm::vec4 boundingboxLatLong = glm::vec4(0.f);
+        float boundingBoxDiagonal = 0.f;
+    };
+
+    /**
+     * A copy of all values that are needed to load the GeoJson file. It is created on the
+     * main thread before the loading starts, so that the worker thread never reads the
+     * properties of the component while they might be changed
+     */
+    struct LoadSettings {
+        std::string identifier;
+        std::filesystem::path file;
+        bool ignoreHeights = false;
+        GlobeGeometryFeature::GeometrySettings geometry;
+    };
+
+    /**
+     * Reads the GeoJson file and creates the geometry of all features in it using the
+     * provided \p settings. This function is executed on a worker thread and must not
+     * access anything that is modified on the main thread.
+     */
+    std::vector<LoadedFeature> readFile(LoadSettings settings) const;
+
+    void parseSingleFeature(const geos::io::GeoJSONFeature& feature, int indexInFile,
+        const LoadSettings& settings, std::vector<LoadedFeature>& result) const;
+
+    /**
+     * Compute the meta information of the feature, such as its centroid and bounding
+     * box, from its \p geometry
+     */
+    void computeMetaData(LoadedFeature& feature,
+        const geos::geom::Geometry* geometry) const;
+
+    /**
+     * Adds the features that have been loaded on the worker thread to the component.
+     * Only as many features as fit into the time budget are added per frame, so that
+     * loading large files does not stall the rendering
+     */
+    void addLoadedFeatures();
+
+    /**
+     * Recreates the geometry of all features on worker threads and uploads the results
+     * to the GPU over the following frames
+     */
+    void updateGeometry();
+
+    /**
+     * Returns the current values of the properties that determine the geometry of the
+     * features
+     */
+    GlobeGeometryFeature::GeometrySettings geometrySettings() const;
 
     /**
      * Add meta properties to the feature, to allow things like flying to it,
      * identifying its location, etc
      */
     void addMetaPropertiesToFeature(SubFeatureProps& feature, int index,
-        const geos::geom::Geometry* geometry);
+        const LoadedFeature& loadedFeature);
 
     void computeMainFeatureMetaPropeties();
 
@@ -139,8 +199,7 @@ private:
 
     bool _ignoreHeightsFromFile = false;
 
-    bool _dataIsDirty = true;
-    bool _heightOffsetIsDirty = false;
+    bool _dataIsDirty = false;
     bool _dataIsInitialized = false;
     bool _textureIsDirty = false;
 
@@ -162,6 +221,19 @@ private:
 
     std::unique_ptr<ghoul::opengl::ProgramObject> _linesAndPolygonsProgram = nullptr;
     std::unique_ptr<ghoul::opengl::ProgramObject> _pointsProgram = nullptr;
+
+    // Features that have been loaded on the worker thread but not yet been added
+    std::vector<LoadedFeature> _loadedFeatures;
+    size_t _nAddedFeatures = 0;
+    // Index of the next feature whose recreated geometry should be uploaded, or
+    // std::nullopt if no recreated geometry is waiting to be uploaded
+    std::optional<size_t> _nextGeometryUpload;
+
+    // The background work is declared last so that it is finished before any of the
+    // other members are destroyed
+    std::atomic_bool _cancelBackgroundWork = false;
+    std::future<std::vector<LoadedFeature>> _loadingFeatures;
+    std::vector<std::future<void>> _geometryJobs;
 };
 
 } // namespace openspace::globebrowsing
@@ -37,6 +37,7 @@
 #include <ghoul/filesystem/filesystem.h>
 #include <ghoul/fmt.h>
 #include <ghoul/logging/logmanager.h>
+#include <ghoul/misc/profiling.h>
 #include <ghoul/opengl/openglstatecache.h>
 #include <ghoul/opengl/programobject.h>
 #include <geos/util/GEOSException.h>
@@ -508,53 +509,90 @@ bool GlobeGeometryFeature::shouldUpdateDueToHeightMapChange() const {
     return false;
 }
 
-void GlobeGeometryFeature::update(bool dataIsDirty, bool preventHeightUpdates) {
+void GlobeGeometryFeature::update(bool preventHeightUpdates) {
     if (!preventHeightUpdates && shouldUpdateDueToHeightMapChange()) {
         updateHeightsFromHeightMap();
     }
-    else if (dataIsDirty) {
-        updateGeometry();
-    }
 
     if (_pointTexture) {
         _pointTexture->update();
     }
 }
 
-void GlobeGeometryFeature::updateGeometry() {
-    // Update vertex data and compute model coordinates based on globe
-    _renderFeatures.clear();
+void GlobeGeometryFeature::updateHeightsFromHeightMap() {
+    // @TODO: do the updating piece by piece, not all in one frame
+    for (RenderFeature& f : _renderFeatures) {
+        f.heights = geometryhelper::heightMapHeightsFromGeodetic2List(
+            _globe,
+            f.vertices
+        );
+        bufferDynamicHeightData(f);
+    }
+
+    _lastHeightUpdateTime = std::chrono::system_clock::now();
+}
+
+void GlobeGeometryFeature::createGeometry(const GeometrySettings& settings) {
+    ZoneScoped;
+
+    // Compute model coordinates based on globe
+    _createdGeometry.clear();
 
     if (_type == GeometryType::Point) {
-        createPointGeometry();
+        createPointGeometry(settings);
     }
     else {
-        std::vector<std::vector<glm::vec3>> edgeVertices = createLineGeometry();
+        std::vector<std::vector<glm::vec3>> edgeVertices = createLineGeometry(settings);
         createExtrudedGeometry(edgeVertices);
-        createPolygonGeometry();
+        createPolygonGeometry(settings);
     }
-
-    // Compute new heights - to see if height map changed
-    _lastControlHeights = getCurrentReferencePointsHeights();
 }
 
-void GlobeGeometryFeature::updateHeightsFromHeightMap() {
-    // @TODO: do the updating piece by piece, not all in one frame
-    for (RenderFeature& f : _renderFeatures) {
-        f.heights = geometryhelper::heightMapHeightsFromGeodetic2List(
+void GlobeGeometryFeature::uploadGeometry() {
+    ZoneScoped;
+
+    for (const RenderFeature& r : _renderFeatures) {
+        glDeleteVertexArrays(1, &r.vaoId);
+        glDeleteBuffers(1, &r.vboId);
+    }
+    _renderFeatures.clear();
+    _renderFeatures.reserve(_createdGeometry.size());
+
+    for (RenderFeatureGeometry& geometry : _createdGeometry) {
+        RenderFeature feature;
+        feature.type = geometry.type;
+        feature.nVertices = geometry.vertices.size();
+        feature.isExtrusionFeature = geometry.isExtrusionFeature;
+
+        // Get height map heights
+        feature.vertices = std::move(geometry.geodeticVertices);
+        feature.heights = geometryhelper::heightMapHeightsFromGeodetic2List(
             _globe,
-            f.vertices
+            feature.vertices
         );
-        bufferDynamicHeightData(f);
+
+        // Generate buffers and buffer data
+        feature.initializeBuffers();
+        bufferVertexData(feature, geometry.vertices);
+        _renderFeatures.push_back(std::move(feature));
     }
+    _createdGeometry.clear();
 
-    _lastHeightUpdateTime = std::chrono::system_clock::now();
+    // Compute new heights - to see if height map changed
+    _lastControlHeights = getCurrentReferencePointsHeights();
 }
 
-std::vector<std::vector<glm::vec3>> GlobeGeometryFeature::createLineGeometry() {
+std::vector<std::vector<glm::vec3>> GlobeGeometryFeature::createLineGeometry(
+                                                        const GeometrySettings& settings)
+{
     std::vector<std::vector<glm::vec3>> resultPositions;
     resultPositions.reserve(_geoCoordinates.size());
 
+    const bool tessellate = isTessellationEnabled(settings);
+    // Determine the step size for the tessellation (larger features will not be
+    // tesselated)
+    const float stepSize = tessellationStepSize(settings);
+
     for (size_t i = 0; i < _geoCoordinates.size(); ++i) {
         std::vector<Vertex> vertices;
         std::vector<glm::vec3> positions;
@@ -571,8 +609,8 @@ std::vector<std::vector<glm::vec3>> GlobeGeometryFeature::createLineGeometry() {
             glm::dvec3 v = geometryhelper::computeOffsetedModelCoordinate(
                 geodetic,
                 _globe,
-                _offsets.x,
-                _offsets.y
+                settings.latLongOffset.x,
+                settings.latLongOffset.y
             );
 
             auto addLinePos = [&vertices, &positions](glm::vec3 pos) {
@@ -588,12 +626,8 @@ std::vector<std::vector<glm::vec3>> GlobeGeometryFeature::createLineGeometry() {
                 continue;
             }
 
-            if (_properties.tessellationEnabled()) {
-                // Tessellate.
-                // But first, determine the step size for the tessellation (larger
-                // features will not be tesselated)
-                float stepSize = tessellationStepSize();
-
+            if (tessellate) {
+                // Tessellate
                 std::vector<geometryhelper::PosHeightPair> subdividedPositions =
                     geometryhelper::subdivideLine(
                         lastPos,
@@ -619,12 +653,7 @@ std::vector<std::vector<glm::vec3>> GlobeGeometryFeature::createLineGeometry() {
         }
 
         vertices.shrink_to_fit();
-
-        RenderFeature feature;
-        feature.nVertices = vertices.size();
-        feature.type = RenderType::Lines;
-        initializeRenderFeature(feature, vertices);
-        _renderFeatures.push_back(std::move(feature));
+        addRenderFeatureGeometry(RenderType::Lines, false, std::move(vertices));
 
         positions.shrink_to_fit();
         resultPositions.push_back(std::move(positions));
@@ -634,7 +663,7 @@ std::vector<std::vector<glm::vec3>> GlobeGeometryFeature::createLineGeometry() {
     return resultPositions;
 }
 
-void GlobeGeometryFeature::createPointGeometry() {
+void GlobeGeometryFeature::createPointGeometry(const GeometrySettings& settings) {
     if (_type != GeometryType::Point) {
         return;
     }
@@ -650,8 +679,8 @@ void GlobeGeometryFeature::createPointGeometry() {
             glm::dvec3 v = geometryhelper::computeOffsetedModelCoordinate(
                 geodetic,
                 _globe,
-                _offsets.x,
-                _offsets.y
+                settings.latLongOffset.x,
+                settings.latLongOffset.y
             );
 
             glm::vec3 vf = static_cast<glm::vec3>(v);
@@ -668,19 +697,14 @@ void GlobeGeometryFeature::createPointGeometry() {
         vertices.shrink_to_fit();
         extrudedLineVertices.shrink_to_fit();
 
-        RenderFeature feature;
-        feature.nVertices = vertices.size();
-        feature.type = RenderType::Points;
-        initializeRenderFeature(feature, vertices);
-        _renderFeatures.push_back(std::move(feature));
+        addRenderFeatureGeometry(RenderType::Points, false, std::move(vertices));
 
         // Create extrusion feature
-        RenderFeature extrudeFeature;
-        extrudeFeature.nVertices = extrudedLineVertices.size();
-        extrudeFeature.type = RenderType::Lines;
-        extrudeFeature.isExtrusionFeature = true;
-        initializeRenderFeature(extrudeFeature, extrudedLineVertices);
-        _renderFeatures.push_back(std::move(extrudeFeature));
+        addRenderFeatureGeometry(
+            RenderType::Lines,
+            true,
+            std::move(extrudedLineVertices)
+        );
     }
 }
 
@@ -694,21 +718,21 @@ void GlobeGeometryFeature::createExtrudedGeometry(
     std::vector<Vertex> vertices =
         geometryhelper::createExtrudedGeometryVertices(edgeVertices);
 
-    RenderFeature feature;
-    feature.type = RenderType::Polygon;
-    feature.nVertices = vertices.size();
-    feature.isExtrusionFeature = true;
-    initializeRenderFeature(feature, vertices);
-    _renderFeatures.push_back(std::move(feature));
+    addRenderFeatureGeometry(RenderType::Polygon, true, std::move(vertices));
 }
 
-void GlobeGeometryFeature::createPolygonGeometry() {
+void GlobeGeometryFeature::createPolygonGeometry(const GeometrySettings& settings) {
     if (_triangleCoordinates.empty()) {
         return;
     }
 
     std::vector<Vertex> polyVertices;
 
+    const bool tessellate = isTessellationEnabled(settings);
+    // Determine the step size for the tessellation (larger features will not be
+    // tesselated)
+    const float stepSize = tessellationStepSize(settings);
+
     // Create polygon vertices from the triangle coordinates
     int triIndex = 0;
     std::array<glm::vec3, 3> triPositions;
@@ -717,8 +741,8 @@ void GlobeGeometryFeature::createPolygonGeometry() {
         const glm::vec3 vert = geometryhelper::computeOffsetedModelCoordinate(
             geodetic,
             _globe,
-            _offsets.x,
-            _offsets.y
+            settings.latLongOffset.x,
+            settings.latLongOffset.y
         );
         triPositions[triIndex] = vert;
         triHeights[triIndex] = geodetic.height;
@@ -736,11 +760,7 @@ void GlobeGeometryFeature::createPolygonGeometry() {
             double h1 = triHeights[1];
             double h2 = triHeights[2];
 
-            if (_properties.tessellationEnabled()) {
-                // First determine the step size for the tessellation (larger features
-                // will not be tesselated)
-                float stepSize = tessellationStepSize();
-
+            if (tessellate) {
                 std::vector<Vertex> verts = geometryhelper::subdivideTriangle(
                     v0, v1, v2,
                     h0, h1, h2,
@@ -759,52 +779,68 @@ void GlobeGeometryFeature::createPolygonGeometry() {
         }
     }
 
-    RenderFeature triFeature;
-    triFeature.type = RenderType::Polygon;
-    triFeature.nVertices = polyVertices.size();
-    initializeRenderFeature(triFeature, polyVertices);
-    _renderFeatures.push_back(std::move(triFeature));
+    addRenderFeatureGeometry(RenderType::Polygon, false, std::move(polyVertices));
 }
 
-void GlobeGeometryFeature::initializeRenderFeature(RenderFeature& feature,
-                                                   const std::vector<Vertex>& vertices)
+void GlobeGeometryFeature::addRenderFeatureGeometry(RenderType type,
+                                                    bool isExtrusionFeature,
+                                                    std::vector<Vertex> vertices)
 {
-    // Get height map heights
-    feature.vertices = geometryhelper::geodetic2FromVertexList(_globe, vertices);
-    feature.heights = geometryhelper::heightMapHeightsFromGeodetic2List(
-        _globe,
-        feature.vertices
-    );
+    RenderFeatureGeometry geometry;
+    geometry.type = type;
+    geometry.isExtrusionFeature = isExtrusionFeature;
+    // Store the geodetic coordinates so that the heights can be sampled when uploading
+    geometry.geodeticVertices = geometryhelper::geodetic2FromVertexList(_globe, vertices);
+    geometry.vertices = std::move(vertices);
+    _createdGeometry.push_back(std::move(geometry));
+}
 
-    // Generate buffers and buffer data
-    feature.initializeBuffers();
-    bufferVertexData(feature, vertices);
+bool GlobeGeometryFeature::isTessellationEnabled(
+                                                  const GeometrySettings& settings) const
+{
+    return _properties.overrideValues.tessellationEnabled.value_or(
+        settings.tessellationEnabled
+    );
 }
 
-float GlobeGeometryFeature::tessellationStepSize() const {
-    float distance = _properties.tessellationDistance();
-    bool shouldDivideDistance = _properties.useTessellationLevel() &&
-        _properties.tessellationLevel() > 0;
+float GlobeGeometryFeature::tessellationStepSize(const GeometrySettings& settings) const {
+    float distance = _properties.overrideValues.tessellationDistance.value_or(
+        settings.tessellationDistance
+    );
+    const bool useLevel = _properties.overrideValues.useTessellationLevel.value_or(
+        settings.useTessellationLevel
+    );
+    const int level = _properties.overrideValues.tessellationLevel.value_or(
+        settings.tessellationLevel
+    );
+    bool shouldDivideDistance = useLevel && level > 0;
 
     if (shouldDivideDistance) {
-        distance /= static_cast<float>(_properties.tessellationLevel());
+        distance /= static_cast<float>(level);
     }
 
     return distance;
 }
 
 std::vector<double> GlobeGeometryFeature::getCurrentReferencePointsHeights() const {
-    std::vector<double> newHeights;
-    newHeights.reserve(_heightUpdateReferencePoints.size());
+    std::vector<glm::dvec3> positions;
+    positions.reserve(_heightUpdateReferencePoints.size());
     for (const Geodetic3& geo : _heightUpdateReferencePoints) {
-        const glm::dvec3 p = geometryhelper::computeOffsetedModelCoordinate(
+        positions.push_back(geometryhelper::computeOffsetedModelCoordinate(
             geo,
             _globe,
             _offsets.x,
             _offsets.y
-        );
-        const SurfacePositionHandle handle = _globe.calculateSurfacePositionHandle(p);
-        newHeights.push_back(handle.heightToSurface);
+        ));
+    }
+
+    std::vector<float> heights = std::vector<float>(positions.size());
+    _globe.getHeights(positions, heights);
+
+    std::vector<double> newHeights;
+    newHeights.reserve(heights.size());
+    for (float h : heights) {
+        newHeights.push_back(std::isnan(h) ? 0.0 : h);
     }
     return newHeights;
 }
@@ -105,6 +105,29 @@ public:
         std::vector<float> heights;
     };
 
+    // The vertices of a render feature that have been created but not yet uploaded to the
+    // GPU
+    struct RenderFeatureGeometry {
+        RenderType type = RenderType::Uninitialized;
+        bool isExtrusionFeature = false;
+        std::vector<Vertex> vertices;
+        std::vector<Geodetic2> geodeticVertices;
+    };
+
+    /**
+     * The values of the properties of the owning component that determine the shape of
+     * the geometry. A copy of these is passed to #createGeometry so that the geometry can
+     * be created on a worker thread while the properties are changed on the main thread.
+     * The tessellation values are only used if they are not overridden by the feature
+     */
+    struct GeometrySettings {
+        glm::vec2 latLongOffset = glm::vec2(0.f);
+        bool tessellationEnabled = true;
+        bool useTessellationLevel = false;
+        int tessellationLevel = 10;
+        float tessellationDistance = 0.f;
+    };
+
     // Some extra data that we need for doing the rendering
     struct ExtraRenderData {
         float pointSizeScale;
@@ -135,10 +158,25 @@ public:
 
     bool shouldUpdateDueToHeightMapChange() const;
 
-    void update(bool dataIsDirty, bool preventHeightUpdates);
-    void updateGeometry();
+    void update(bool preventHeightUpdates);
     void updateHeightsFromHeightMap();
 
+    /**
+     * Creates the vertices of all render features using the provided \p settings. This
+     * function does not access any OpenGL state or the height layers of the globe and may
+     * thus be called from a worker thread, as long as no other function is called on this
+     * feature concurrently except for #render. The created geometry is used after the
+     * next call to #uploadGeometry.
+     */
+    void createGeometry(const GeometrySettings& settings);
+
+    /**
+     * Replaces the render features with the geometry that was created in the last call
+     * to #createGeometry, uploads the vertices to the GPU and samples the heights of the
+     * height map for them. Has to be called on the main thread.
+     */
+    void uploadGeometry();
+
 private:
     void renderPoints(const RenderFeature& feature, const RenderData& renderData,
         const PointRenderMode& renderMode, float sizeScale) const;
@@ -152,13 +190,14 @@ private:
      * Create the vertex information for any line parts of the feature.
      * Returns the resulting vertex positions, so we can use them for extrusion
      */
-    std::vector<std::vector<glm::vec3>> createLineGeometry();
+    std::vector<std::vector<glm::vec3>> createLineGeometry(
+        const GeometrySettings& settings);
 
     /**
      * Create the vertex information for any point parts of the feature. Also creates
      * the features for extruded lines for the points
      */
-    void createPointGeometry();
+    void createPointGeometry(const GeometrySettings& settings);
 
     /**
      * Create the triangle geometry for the extruded edges of lines/polygons
@@ -169,13 +208,16 @@ private:
      * Create the triangle geometry for the polygon part of the feature (the area
      * contained by the shape)
      */
-    void createPolygonGeometry();
+    void createPolygonGeometry(const GeometrySettings& settings);
+
+    void addRenderFeatureGeometry(RenderType type, bool isExtrusionFeature,
+        std::vector<Vertex> vertices);
 
-    void initializeRenderFeature(RenderFeature& feature,
-        const std::vector<Vertex>& vertices);
+    /// Whether the geometry shall be tessellated, based on the properties
+    bool isTessellationEnabled(const GeometrySettings& settings) const;
 
     /// Get the distance that shall be used for tessellation, based on the properties
-    float tessellationStepSize() const;
+    float tessellationStepSize(const GeometrySettings& settings) const;
 
     /// Compute the heights to the surface at the reference points
     std::vector<double> getCurrentReferencePointsHeights() const;
@@ -199,6 +241,7 @@ private:
     std::vector<Geodetic3> _triangleCoordinates;
 
     std::vector<RenderFeature> _renderFeatures;
+    std::vector<RenderFeatureGeometry> _createdGeometry;
 
     // lat, long, distance (meters). Passed from parent on property change
     glm::vec3 _offsets = glm::vec3(0.f);
@@ -82,11 +82,16 @@ std::vector<Geodetic2> geodetic2FromVertexList(const RenderableGlobe& globe,
 std::vector<float> heightMapHeightsFromGeodetic2List(const RenderableGlobe& globe,
                                                      const std::vector<Geodetic2>& list)
 {
-    std::vector<float> res;
-    res.reserve(list.size());
+    std::vector<glm::dvec3> positions;
+    positions.reserve(list.size());
     for (const Geodetic2& geo : list) {
-        float h = static_cast<float>(getHeightToReferenceSurface(geo, globe));
-        res.push_back(h);
+        positions.push_back(globe.ellipsoid().cartesianSurfacePosition(geo));
+    }
+
+    std::vector<float> res = std::vector<float>(list.size());
+    globe.getHeights(positions, res);
+    for (float& h : res) {
+        h = std::isnan(h) ? 0.f : h;
     }
     return res;
 }
@@ -41,6 +41,7 @@
 #include <ghoul/misc/dictionary.h>
 #include <ghoul/misc/profiling.h>
 #include <ghoul/opengl/programobject.h>
+#include <algorithm>
 #include <cstdlib>
 #include <filesystem>
 #include <fstream>
@@ -52,6 +53,8 @@ namespace {
 
     constexpr double LabelFadeOutLimitAltitudeMeters = 25000.0;
     constexpr float MinOpacityValueConst = 0.009f;
+    // Radius around each label position that is taken into account when culling
+    constexpr double LabelRadius = 1.0;
 
     enum LabelRenderingAlignmentType {
         Horizontally = 0,
@@ -274,6 +277,7 @@ void GlobeLabelsComponent::initialize(const ghoul::Dictionary& dictionary,
     if (!loadSuccess) {
         return;
     }
+    buildLabelIndex();
 
     Fadeable::_opacity = p.opacity.value_or(Fadeable::_opacity);
 
@@ -490,6 +494,21 @@ bool GlobeLabelsComponent::saveCachedFile(const std::filesystem::path& file) con
     return fileStream.good();
 }
 
+void GlobeLabelsComponent::buildLabelIndex() {
+    ZoneScoped;
+
+    std::vector<globebrowsing::Geodetic2> coordinates;
+    coordinates.reserve(_labels.labelsArray.size());
+    std::vector<glm::dvec3> positions;
+    positions.reserve(_labels.labelsArray.size());
+    for (const LabelEntry& lEntry : _labels.labelsArray) {
+        const glm::dvec3 position = glm::dvec3(lEntry.geoPosition);
+        coordinates.push_back(_globe->ellipsoid().cartesianToGeodetic2(position));
+        positions.push_back(position);
+    }
+    _labelIndex.build(coordinates, positions);
+}
+
 void GlobeLabelsComponent::draw(const RenderData& data) {
     if (!_enabled) {
         return;
@@ -575,7 +594,34 @@ void GlobeLabelsComponent::renderLabels(const RenderData& data,
     }
     glm::dvec3 orthoUp = glm::normalize(glm::cross(orthoRight, cameraViewDirectionObj));
 
-    for (const LabelEntry& lEntry : _labels.labelsArray) {
+    const glm::dmat4& modelTransform = _globe->modelTransform();
+    const glm::dvec3 cameraPositionWorld = data.camera.positionVec3();
+    // The bounding spheres of the label index are given in model space
+    const double modelScale = std::max({
+        glm::length(glm::dvec3(modelTransform[0])),
+        glm::length(glm::dvec3(modelTransform[1])),
+        glm::length(glm::dvec3(modelTransform[2]))
+    });
+
+    // Uses the same criteria as the individual labels below, but rejects a node only if
+    // none of the labels inside its bounding sphere can pass them
+    auto isNodeVisible = [&](const glm::dvec3& center, double radius) {
+        if (_disableCulling) {
+            return true;
+        }
+
+        const glm::dvec3 centerWorld =
+            glm::dvec3(modelTransform * glm::dvec4(center, 1.0));
+        const double radiusWorld = modelScale * radius;
+        const double minDistanceCameraToLabelWorld =
+            glm::length(centerWorld - cameraPositionWorld) - radiusWorld;
+
+        return (distToCamera > (minDistanceCameraToLabelWorld + _distanceEPS)) &&
+            isLabelInFrustum(VP, centerWorld, radiusWorld + LabelRadius);
+    };
+
+    auto renderLabel = [&](uint32_t index) {
+        const LabelEntry& lEntry = _labels.labelsArray[index];
         glm::vec3 position = lEntry.geoPosition;
         glm::dvec3 locationPositionWorld =
             glm::dvec3(_globe->modelTransform() * glm::dvec4(position, 1.0));
@@ -584,7 +630,7 @@ void GlobeLabelsComponent::renderLabels(const RenderData& data,
 
         if (_disableCulling ||
             ((distToCamera > (distanceCameraToLabelWorld + _distanceEPS)) &&
-            isLabelInFrustum(VP, locationPositionWorld)))
+            isLabelInFrustum(VP, locationPositionWorld, LabelRadius)))
         {
             if (_alignmentOption == Circularly) {
                 glm::dvec3 labelNormalObj = glm::dvec3(
@@ -640,11 +686,13 @@ void GlobeLabelsComponent::renderLabels(const RenderData& data,
                 labelInfo
             );
         }
-    }
+    };
+    _labelIndex.query(isNodeVisible, renderLabel);
 }
 
 bool GlobeLabelsComponent::isLabelInFrustum(const glm::dmat4& MVMatrix,
-                                            const glm::dvec3& position) const
+                                            const glm::dvec3& position,
+                                            double radius) const
 {
     // Frustum Planes
     glm::dvec3 col1(MVMatrix[0][0], MVMatrix[1][0], MVMatrix[2][0]);
@@ -692,20 +740,19 @@ bool GlobeLabelsComponent::isLabelInFrustum(const glm::dmat4& MVMatrix,
     farNormal *= invMagFar;
     // farDistance *= invMagFar;
 
-    constexpr float Radius = 1.0;
-    if ((glm::dot(leftNormal, position) + leftDistance) < -Radius) {
+    if ((glm::dot(leftNormal, position) + leftDistance) < -radius) {
         return false;
     }
-    else if ((glm::dot(rightNormal, position) + rightDistance) < -Radius) {
+    else if ((glm::dot(rightNormal, position) + rightDistance) < -radius) {
         return false;
     }
-    else if ((glm::dot(bottomNormal, position) + bottomDistance) < -Radius) {
+    else if ((glm::dot(bottomNormal, position) + bottomDistance) < -radius) {
         return false;
     }
-    else if ((glm::dot(topNormal, position) + topDistance) < -Radius) {
+    else if ((glm::dot(topNormal, position) + topDistance) < -radius) {
         return false;
     }
-    else if ((glm::dot(nearNormal, position) + nearDistance) < -Radius) {
+    else if ((glm::dot(nearNormal, position) + nearDistance) < -radius) {
         return false;
     }
 
@@ -28,6 +28,7 @@
 #include <openspace/properties/propertyowner.h>
 #include <openspace/rendering/fadeable.h>
 
+#include <modules/globebrowsing/src/geodeticquadtree.h>
 #include <openspace/properties/optionproperty.h>
 #include <openspace/properties/scalar/boolproperty.h>
 #include <openspace/properties/scalar/floatproperty.h>
@@ -67,9 +68,11 @@ private:
     bool readLabelsFile(const std::filesystem::path& file);
     bool loadCachedFile(const std::filesystem::path& file);
     bool saveCachedFile(const std::filesystem::path& file) const;
+    void buildLabelIndex();
     void renderLabels(const RenderData& data, const glm::dmat4& modelViewProjectionMatrix,
         float distToCamera, float fadeInVariable);
-    bool isLabelInFrustum(const glm::dmat4& MVMatrix, const glm::dvec3& position) const;
+    bool isLabelInFrustum(const glm::dmat4& MVMatrix, const glm::dvec3& position,
+        double radius) const;
 
     // Labels Structures
     struct LabelEntry {
@@ -100,6 +103,9 @@ private:
 
     Labels _labels;
 
+    // Spatial index over the labels, built once the labels have been loaded
+    globebrowsing::GeodeticQuadtree _labelIndex;
+
     // Font
     std::shared_ptr<ghoul::fontrendering::Font> _font;
 
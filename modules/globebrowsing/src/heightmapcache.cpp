@@ -0,0 +1,92 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2023                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/globebrowsing/src/heightmapcache.h>
+
+#include <ghoul/misc/profiling.h>
+#include <ghoul/opengl/texture.h>
+#include <cstring>
+
+namespace openspace::globebrowsing::cache {
+
+HeightmapCache::HeightmapCache(size_t maximumSize)
+    : _maximumSize(maximumSize)
+{}
+
+const Heightmap* HeightmapCache::get(const ProviderTileKey& key) {
+    return _cache.get(key);
+}
+
+const Heightmap* HeightmapCache::put(const ProviderTileKey& key,
+                                     const ghoul::opengl::Texture& texture)
+{
+    ZoneScoped;
+
+    if (!texture.pixelData()) {
+        return nullptr;
+    }
+
+    Heightmap heightmap;
+    heightmap.dimensions = glm::uvec2(texture.dimensions());
+    const size_t nTexels =
+        static_cast<size_t>(heightmap.dimensions.x) * heightmap.dimensions.y;
+    heightmap.values.resize(nTexels);
+
+    if (texture.dataType() == GL_FLOAT &&
+        texture.format() == ghoul::opengl::Texture::Format::Red)
+    {
+        // This is the format that is used for all height layers, so the values can be
+        // copied without having to convert every texel
+        std::memcpy(
+            heightmap.values.data(),
+            texture.pixelData(),
+            nTexels * sizeof(float)
+        );
+    }
+    else {
+        for (unsigned int y = 0; y < heightmap.dimensions.y; y++) {
+            for (unsigned int x = 0; x < heightmap.dimensions.x; x++) {
+                heightmap.values[y * heightmap.dimensions.x + x] =
+                    texture.texelAsFloat(glm::uvec2(x, y)).x;
+            }
+        }
+    }
+
+    const size_t size = nTexels * sizeof(float);
+    while (!_cache.isEmpty() && _cache.totalSize() + size > _maximumSize) {
+        _cache.popVictim();
+    }
+    _cache.put(key, std::move(heightmap), size);
+    return _cache.get(key);
+}
+
+void HeightmapCache::clear() {
+    _cache.clear();
+}
+
+size_t HeightmapCache::totalSize() const {
+    return _cache.totalSize();
+}
+
+} // namespace openspace::globebrowsing::cache
@@ -0,0 +1,89 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2023                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_MODULE_GLOBEBROWSING___HEIGHTMAP_CACHE___H__
+#define __OPENSPACE_MODULE_GLOBEBROWSING___HEIGHTMAP_CACHE___H__
+
+#include <modules/globebrowsing/src/costawarecache.h>
+#include <modules/globebrowsing/src/memoryawaretilecache.h>
+#include <ghoul/glm.h>
+#include <vector>
+
+namespace ghoul::opengl { class Texture; }
+
+namespace openspace::globebrowsing::cache {
+
+/**
+ * The values of a height tile that have been decoded into floating point values on the
+ * CPU. The values are stored row by row, starting with the first row of the texture.
+ */
+struct Heightmap {
+    float texel(const glm::uvec2& position) const {
+        return values[position.y * dimensions.x + position.x];
+    }
+
+    glm::uvec2 dimensions = glm::uvec2(0);
+    std::vector<float> values;
+};
+
+/**
+ * Cache for the decoded heightmaps that are used to sample heights on the CPU. The
+ * heightmaps are kept independently of the tile textures in the MemoryAwareTileCache,
+ * so that the heights of a tile can still be sampled after its texture has been evicted
+ * from the GPU. The cache is limited by a budget of bytes and evicts the least recently
+ * used heightmaps once the budget is exhausted.
+ */
+class HeightmapCache {
+public:
+    explicit HeightmapCache(size_t maximumSize);
+
+    /**
+     * Returns the heightmap for the \p key, or `nullptr` if it has not been cached. The
+     * pointer is invalidated by the next call to #put or #clear.
+     */
+    const Heightmap* get(const ProviderTileKey& key);
+
+    /**
+     * Decodes the CPU-side data of the \p texture and stores it for the \p key. Returns
+     * the cached heightmap or `nullptr` if the \p texture does not have its data on the
+     * CPU. The pointer is invalidated by the next call to #put or #clear.
+     */
+    const Heightmap* put(const ProviderTileKey& key,
+        const ghoul::opengl::Texture& texture);
+
+    void clear();
+
+    /**
+     * \return The number of bytes that are used by the cached heightmaps
+     */
+    size_t totalSize() const;
+
+private:
+    CostAwareCache<ProviderTileKey, Heightmap, ProviderTileHasher> _cache;
+    const size_t _maximumSize;
+};
+
+} // namespace openspace::globebrowsing::cache
+
+#endif // __OPENSPACE_MODULE_GLOBEBROWSING___HEIGHTMAP_CACHE___H__
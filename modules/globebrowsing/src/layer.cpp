@@ -369,6 +369,7 @@ Layer::Layer(layers::Group::ID id, const ghoul::Dictionary& layerDict, LayerGrou
 
     addPropertySubOwner(_renderSettings);
     addPropertySubOwner(_layerAdjustment);
+    addPropertySubOwner(_telemetry);
 }
 
 void Layer::initialize() {
@@ -461,6 +462,12 @@ void Layer::update() {
 
     if (_tileProvider) {
         _tileProvider->update();
+
+        if (_telemetry.isUpdateDue()) {
+            TilePipelineCounters counters;
+            _tileProvider->collectPipelineCounters(counters);
+            _telemetry.update(counters);
+        }
     }
 }
 
@@ -31,6 +31,7 @@
 #include <modules/globebrowsing/src/basictypes.h>
 #include <modules/globebrowsing/src/layeradjustment.h>
 #include <modules/globebrowsing/src/layerrendersettings.h>
+#include <modules/globebrowsing/src/tilepipelinetelemetry.h>
 #include <modules/globebrowsing/src/tileprovider/tileprovider.h>
 #include <openspace/properties/optionproperty.h>
 #include <openspace/properties/scalar/boolproperty.h>
@@ -91,6 +92,7 @@ private:
     properties::Vec3Property _solidColor;
     LayerRenderSettings _renderSettings;
     LayerAdjustment _layerAdjustment;
+    TilePipelineTelemetry _telemetry;
 
     const layers::Group::ID _layerGroupId;
 
@@ -25,8 +25,8 @@
 #ifndef __OPENSPACE_MODULE_GLOBEBROWSING___LRU_CACHE___H__
 #define __OPENSPACE_MODULE_GLOBEBROWSING___LRU_CACHE___H__
 
-#include <list>
-#include <unordered_map>
+#include <modules/globebrowsing/src/flathashmap.h>
+#include <cstdint>
 #include <vector>
 
 namespace openspace::globebrowsing::cache {
@@ -34,12 +34,15 @@ namespace openspace::globebrowsing::cache {
 /**
  * Templated class implementing a Least-Recently-Used Cache.
  * `KeyType` needs to be an enumerable type.
+ *
+ * The items are stored in a dense array and are linked into the recency order through
+ * indices that are stored in the items themselves, so that bumping an item does not
+ * allocate any memory. The keys are mapped to the array positions by a FlatHashMap.
  */
 template <typename KeyType, typename ValueType, typename HasherType>
 class LRUCache {
 public:
     using Item = std::pair<KeyType, ValueType>;
-    using Items = std::list<Item>;
 
     /**
      * \param size is the maximum size of the cache given in number of cached items.
@@ -72,13 +75,32 @@ public:
     size_t maximumCacheSize() const;
 
 private:
+    static constexpr uint32_t NoNode = ~0u;
+
+    struct Node {
+        KeyType key;
+        ValueType value;
+        /// The next more recently used node
+        uint32_t previous;
+        /// The next less recently used node
+        uint32_t next;
+    };
+
     void putWithoutCleaning(KeyType key, ValueType value);
     void clean();
 
     std::vector<Item> cleanAndFetchPopped();
 
-    Items _itemList;
-    std::unordered_map<KeyType, typename Items::const_iterator, HasherType> _itemMap;
+    void link(uint32_t nodeIndex);
+    void unlink(uint32_t nodeIndex);
+    Item removeNode(uint32_t nodeIndex);
+
+    std::vector<Node> _nodes;
+    FlatHashMap<KeyType, uint32_t, HasherType> _nodeMap;
+    /// The most recently used node
+    uint32_t _head = NoNode;
+    /// The least recently used node
+    uint32_t _tail = NoNode;
 
     size_t _maximumCacheSize;
 };
@@ -34,8 +34,10 @@ LRUCache<KeyType, ValueType, HasherType>::LRUCache(size_t size)
 
 template<typename KeyType, typename ValueType, typename HasherType>
 void LRUCache<KeyType, ValueType, HasherType>::clear() {
-    _itemList.clear();
-    _itemMap.clear();
+    _nodes.clear();
+    _nodeMap.clear();
+    _head = NoNode;
+    _tail = NoNode;
 }
 
 template<typename KeyType, typename ValueType, typename HasherType>
@@ -54,76 +56,56 @@ LRUCache<KeyType, ValueType, HasherType>::putAndFetchPopped(KeyType key, ValueTy
 
 template<typename KeyType, typename ValueType, typename HasherType>
 bool LRUCache<KeyType, ValueType, HasherType>::exist(const KeyType& key) const {
-    return (_itemMap.count(key) > 0);
+    return _nodeMap.contains(key);
 }
 
 template<typename KeyType, typename ValueType, typename HasherType>
 bool LRUCache<KeyType, ValueType, HasherType>::touch(const KeyType& key) {
     ZoneScoped;
 
-    const auto it = _itemMap.find(key);
-    if (it != _itemMap.end()) {
-        // @TODO (abock, 2020-08-14) Instead of removing the iterator from the previous
-        // position and then readding it at the front, it might make more sense to move
-        // them around?  That would prevent the dynamic memoray allocation that is
-        // happening here
-
-        // Found in cache
-        ValueType value = it->second->second;
-        // Remove from current position
-        _itemList.erase(it->second);
-        _itemMap.erase(it);
-        // Bump to front
-        _itemList.emplace_front(key, value);
-        _itemMap.emplace(key, _itemList.begin());
-
-        return true;
-    }
-    else {
+    const uint32_t* nodeIndex = _nodeMap.find(key);
+    if (!nodeIndex) {
         return false;
     }
+
+    // Bump to front
+    unlink(*nodeIndex);
+    link(*nodeIndex);
+    return true;
 }
 
 template<typename KeyType, typename ValueType, typename HasherType>
 bool LRUCache<KeyType, ValueType, HasherType>::isEmpty() const {
-    return (_itemMap.size() == 0);
+    return _nodes.empty();
 }
 
 template<typename KeyType, typename ValueType, typename HasherType>
 ValueType LRUCache<KeyType, ValueType, HasherType>::get(const KeyType& key) {
-    const auto it = _itemMap.find(key);
-    // Move list iterator pointing to value
-    _itemList.splice(_itemList.begin(), _itemList, it->second);
-    ValueType res = it->second->second;
-    return res;
+    const uint32_t* nodeIndex = _nodeMap.find(key);
+    ghoul_assert(nodeIndex, "Key must exist in the cache");
+
+    unlink(*nodeIndex);
+    link(*nodeIndex);
+    return _nodes[*nodeIndex].value;
 }
 
 template<typename KeyType, typename ValueType, typename HasherType>
 std::pair<KeyType, ValueType> LRUCache<KeyType, ValueType, HasherType>::popMRU() {
-    ghoul_assert(!_itemList.empty(), "Cannot pop LRU cache. Ensure cache is not empty");
+    ghoul_assert(!_nodes.empty(), "Cannot pop LRU cache. Ensure cache is not empty");
 
-    auto first_it = _itemList.begin();
-    _itemMap.erase(first_it->first);
-    std::pair<KeyType, ValueType> toReturn = _itemList.front();
-    _itemList.pop_front();
-    return toReturn;
+    return removeNode(_head);
 }
 
 template<typename KeyType, typename ValueType, typename HasherType>
 std::pair<KeyType, ValueType> LRUCache<KeyType, ValueType, HasherType>::popLRU() {
-    ghoul_assert(!_itemList.empty(), "Cannot pop LRU cache. Ensure cache is not empty");
+    ghoul_assert(!_nodes.empty(), "Cannot pop LRU cache. Ensure cache is not empty");
 
-    auto lastIt = _itemList.end();
-    lastIt--;
-    _itemMap.erase(lastIt->first);
-    std::pair<KeyType, ValueType> toReturn = _itemList.back();
-    _itemList.pop_back();
-    return toReturn;
+    return removeNode(_tail);
 }
 
 template<typename KeyType, typename ValueType, typename HasherType>
 size_t LRUCache<KeyType, ValueType, HasherType>::size() const {
-    return _itemMap.size();
+    return _nodes.size();
 }
 
 template<typename KeyType, typename ValueType, typename HasherType>
@@ -135,22 +117,25 @@ template<typename KeyType, typename ValueType, typename HasherType>
 void LRUCache<KeyType, ValueType, HasherType>::putWithoutCleaning(KeyType key,
                                                                   ValueType value)
 {
-    const auto it = _itemMap.find(key);
-    if (it != _itemMap.end()) {
-        _itemList.erase(it->second);
-        _itemMap.erase(it);
+    const uint32_t* existing = _nodeMap.find(key);
+    if (existing) {
+        const uint32_t nodeIndex = *existing;
+        _nodes[nodeIndex].value = std::move(value);
+        unlink(nodeIndex);
+        link(nodeIndex);
+        return;
     }
-    _itemList.emplace_front(key, std::move(value));
-    _itemMap.emplace(std::move(key), _itemList.begin());
+
+    const uint32_t nodeIndex = static_cast<uint32_t>(_nodes.size());
+    _nodes.push_back({ key, std::move(value), NoNode, NoNode });
+    _nodeMap.insertOrAssign(std::move(key), nodeIndex);
+    link(nodeIndex);
 }
 
 template<typename KeyType, typename ValueType, typename HasherType>
 void LRUCache<KeyType, ValueType, HasherType>::clean() {
-    while (_itemMap.size() > _maximumCacheSize) {
-        auto lastIt = _itemList.end();
-        lastIt--;
-        _itemMap.erase(lastIt->first);
-        _itemList.pop_back();
+    while (_nodes.size() > _maximumCacheSize) {
+        removeNode(_tail);
     }
 }
 
@@ -159,14 +144,74 @@ std::vector<std::pair<KeyType, ValueType>>
 LRUCache<KeyType, ValueType, HasherType>::cleanAndFetchPopped()
 {
     std::vector<std::pair<KeyType, ValueType>> toReturn;
-    while (_itemMap.size() > _maximumCacheSize) {
-        auto lastIt = _itemList.end();
-        lastIt--;
-        _itemMap.erase(lastIt->first);
-        toReturn.push_back(_itemList.back());
-        _itemList.pop_back();
+    while (_nodes.size() > _maximumCacheSize) {
+        toReturn.push_back(removeNode(_tail));
     }
     return toReturn;
 }
 
+template<typename KeyType, typename ValueType, typename HasherType>
+void LRUCache<KeyType, ValueType, HasherType>::link(uint32_t nodeIndex) {
+    Node& node = _nodes[nodeIndex];
+    node.previous = NoNode;
+    node.next = _head;
+    if (_head != NoNode) {
+        _nodes[_head].previous = nodeIndex;
+    }
+    else {
+        _tail = nodeIndex;
+    }
+    _head = nodeIndex;
+}
+
+template<typename KeyType, typename ValueType, typename HasherType>
+void LRUCache<KeyType, ValueType, HasherType>::unlink(uint32_t nodeIndex) {
+    const Node& node = _nodes[nodeIndex];
+    if (node.previous != NoNode) {
+        _nodes[node.previous].next = node.next;
+    }
+    else {
+        _head = node.next;
+    }
+    if (node.next != NoNode) {
+        _nodes[node.next].previous = node.previous;
+    }
+    else {
+        _tail = node.previous;
+    }
+}
+
+template<typename KeyType, typename ValueType, typename HasherType>
+std::pair<KeyType, ValueType>
+LRUCache<KeyType, ValueType, HasherType>::removeNode(uint32_t nodeIndex)
+{
+    unlink(nodeIndex);
+    _nodeMap.erase(_nodes[nodeIndex].key);
+    Node& node = _nodes[nodeIndex];
+    Item result = { std::move(node.key), std::move(node.value) };
+
+    // Keep the node array dense by moving the last node into the freed slot and
+    // redirecting its neighbors and its map entry to the new position
+    const uint32_t lastNodeIndex = static_cast<uint32_t>(_nodes.size() - 1);
+    if (nodeIndex != lastNodeIndex) {
+        _nodes[nodeIndex] = std::move(_nodes[lastNodeIndex]);
+        const Node& moved = _nodes[nodeIndex];
+        if (moved.previous != NoNode) {
+            _nodes[moved.previous].next = nodeIndex;
+        }
+        else {
+            _head = nodeIndex;
+        }
+        if (moved.next != NoNode) {
+            _nodes[moved.next].previous = nodeIndex;
+        }
+        else {
+            _tail = nodeIndex;
+        }
+        _nodeMap[moved.key] = nodeIndex;
+    }
+    _nodes.pop_back();
+    return result;
+}
+
 } // namespace openspace::globebrowsing::cache
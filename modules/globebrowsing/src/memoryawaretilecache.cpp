@@ -30,6 +30,8 @@
 #include <ghoul/logging/logmanager.h>
 #include <ghoul/systemcapabilities/generalcapabilitiescomponent.h>
 #include <ghoul/systemcapabilities/openglcapabilitiescomponent.h>
+#include <algorithm>
+#include <limits>
 #include <numeric>
 
 namespace {
@@ -72,6 +74,54 @@ namespace {
         openspace::properties::Property::Visibility::AdvancedUser
     };
 
+    constexpr openspace::properties::Property::PropertyInfo EvictionPolicyInfo = {
+        "EvictionPolicy",
+        "Eviction policy",
+        "Determines which tiles are removed from the cache when the tile cache size is "
+        "exceeded. 'Least Recently Used' removes the tiles that have not been used for "
+        "the longest time. 'Greedy Dual Size' prefers to remove large tiles that are "
+        "cheap to recreate and ages tiles that are not used anymore",
+        openspace::properties::Property::Visibility::AdvancedUser
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo NumberOfTilesInfo = {
+        "NumberOfTiles",
+        "Number of tiles",
+        "The number of tiles that are currently stored in the tile cache",
+        openspace::properties::Property::Visibility::Developer
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo HitsInfo = {
+        "Hits",
+        "Hits",
+        "The number of requests for tiles that were found in the tile cache",
+        openspace::properties::Property::Visibility::Developer
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo MissesInfo = {
+        "Misses",
+        "Misses",
+        "The number of requests for tiles that were not found in the tile cache",
+        openspace::properties::Property::Visibility::Developer
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo EvictionsInfo = {
+        "Evictions",
+        "Evictions",
+        "The number of tiles that have been removed from the tile cache to make room for "
+        "other tiles",
+        openspace::properties::Property::Visibility::Developer
+    };
+
+    // The cost of a tile that was created in no measurable time, in milliseconds
+    constexpr double MinimumTileCost = 0.001;
+
+    int clampToInt(uint64_t value) {
+        return static_cast<int>(
+            std::min<uint64_t>(value, std::numeric_limits<int>::max())
+        );
+    }
+
     GLenum toGlTextureFormat(GLenum glType, ghoul::opengl::Texture::Format format) {
         switch (format) {
             case ghoul::opengl::Texture::Format::Red:
@@ -193,71 +243,102 @@ namespace {
 
 namespace openspace::globebrowsing::cache {
 
+double tileCost(std::chrono::microseconds duration) {
+    return std::max(static_cast<double>(duration.count()) / 1000.0, MinimumTileCost);
+}
+
+double tileCost(const RawTile& rawTile) {
+    return tileCost(rawTile.readTime + rawTile.decodeTime);
+}
+
 //
 // TextureContainer
 //
-MemoryAwareTileCache::TextureContainer::TextureContainer(TileTextureInitData initData,
-                                                         size_t numTextures)
+MemoryAwareTileCache::TextureContainer::TextureContainer(TileTextureInitData initData)
     : _initData(std::move(initData))
-    , _numTextures(numTextures)
-{
-    ZoneScoped;
-
-    _textures.reserve(_numTextures);
-    reset();
-}
+{}
 
 void MemoryAwareTileCache::TextureContainer::reset() {
     ZoneScoped;
 
     _textures.clear();
-    _freeTexture = 0;
+    _freeTextures.clear();
+    _textureInfos.clear();
+    _bytesAllocatedOnCPU = 0;
+}
+
+void MemoryAwareTileCache::TextureContainer::releaseAll() {
+    _freeTextures.clear();
+    for (const std::unique_ptr<ghoul::opengl::Texture>& texture : _textures) {
+        _freeTextures.push_back(texture.get());
+    }
+}
+
+ghoul::opengl::Texture* MemoryAwareTileCache::TextureContainer::getTextureIfFree() {
+    if (!_freeTextures.empty()) {
+        ghoul::opengl::Texture* texture = _freeTextures.back();
+        _freeTextures.pop_back();
+        return texture;
+    }
+    else {
+        return nullptr;
+    }
+}
+
+ghoul::opengl::Texture* MemoryAwareTileCache::TextureContainer::allocateTexture() {
+    ZoneScoped;
 
     using namespace ghoul::systemcapabilities;
+    using namespace ghoul::opengl;
 
-    ghoul::opengl::Texture::FilterMode mode =
+    Texture::FilterMode mode =
         OpenGLCap.gpuVendor() == OpenGLCapabilitiesComponent::Vendor::AmdATI ?
-        ghoul::opengl::Texture::FilterMode::Linear :
-        ghoul::opengl::Texture::FilterMode::AnisotropicMipMap;
-
-    for (size_t i = 0; i < _numTextures; ++i) {
-        using namespace ghoul::opengl;
-
-        std::unique_ptr<Texture> tex = std::make_unique<Texture>(
-            _initData.dimensions,
-            GL_TEXTURE_2D,
-            _initData.ghoulTextureFormat,
-            toGlTextureFormat(_initData.glType, _initData.ghoulTextureFormat),
-            _initData.glType,
-            mode,
-            Texture::WrappingMode::ClampToEdge,
-            Texture::AllocateData(_initData.shouldAllocateDataOnCPU)
-        );
+        Texture::FilterMode::Linear :
+        Texture::FilterMode::AnisotropicMipMap;
+
+    std::unique_ptr<Texture> tex = std::make_unique<Texture>(
+        _initData.dimensions,
+        GL_TEXTURE_2D,
+        _initData.ghoulTextureFormat,
+        toGlTextureFormat(_initData.glType, _initData.ghoulTextureFormat),
+        _initData.glType,
+        mode,
+        Texture::WrappingMode::ClampToEdge,
+        Texture::AllocateData(_initData.shouldAllocateDataOnCPU)
+    );
 
-        tex->setDataOwnership(Texture::TakeOwnership::Yes);
-        tex->uploadTexture();
-        tex->setFilter(mode);
+    tex->setDataOwnership(Texture::TakeOwnership::Yes);
+    tex->uploadTexture();
+    tex->setFilter(mode);
 
-        _textures.push_back(std::move(tex));
-    }
+    _textureInfos[tex.get()] = { _textures.size(), 0 };
+    _textures.push_back(std::move(tex));
+    return _textures.back().get();
 }
 
-void MemoryAwareTileCache::TextureContainer::reset(size_t numTextures) {
-    ZoneScoped;
+void MemoryAwareTileCache::TextureContainer::deleteTexture(
+                                                         ghoul::opengl::Texture* texture)
+{
+    const auto it = _textureInfos.find(texture);
+    ghoul_assert(it != _textureInfos.end(), "Texture must belong to this container");
 
-    _numTextures = numTextures;
-    reset();
-}
+    const size_t index = it->second.index;
+    _bytesAllocatedOnCPU -= it->second.bytesAllocatedOnCPU;
+    _textureInfos.erase(it);
 
-ghoul::opengl::Texture* MemoryAwareTileCache::TextureContainer::getTextureIfFree() {
-    if (_freeTexture < _textures.size()) {
-        ghoul::opengl::Texture* texture = _textures[_freeTexture].get();
-        _freeTexture++;
-        return texture;
+    // Move the last texture into the place of the deleted one
+    if (index != _textures.size() - 1) {
+        std::swap(_textures[index], _textures.back());
+        _textureInfos[_textures[index].get()].index = index;
     }
-    else {
-        return nullptr;
+    _textures.pop_back();
+}
+
+void MemoryAwareTileCache::TextureContainer::deleteUnusedTextures() {
+    for (ghoul::opengl::Texture* texture : _freeTextures) {
+        deleteTexture(texture);
     }
+    _freeTextures.clear();
 }
 
 const TileTextureInitData&
@@ -270,18 +351,44 @@ size_t MemoryAwareTileCache::TextureContainer::size() const {
     return _textures.size();
 }
 
+size_t MemoryAwareTileCache::TextureContainer::bytesPerTexture() const {
+    // Textures that keep a copy of their data on the CPU occupy the memory twice
+    return _initData.shouldAllocateDataOnCPU ?
+        2 * _initData.totalNumBytes :
+        _initData.totalNumBytes;
+}
+
+void MemoryAwareTileCache::TextureContainer::addBytesAllocatedOnCPU(
+                                                    const ghoul::opengl::Texture* texture,
+                                                    size_t nBytes)
+{
+    const auto it = _textureInfos.find(texture);
+    ghoul_assert(it != _textureInfos.end(), "Texture must belong to this container");
+
+    it->second.bytesAllocatedOnCPU += nBytes;
+    _bytesAllocatedOnCPU += nBytes;
+}
+
+size_t MemoryAwareTileCache::TextureContainer::bytesAllocatedOnCPU() const {
+    return _bytesAllocatedOnCPU;
+}
+
 //
 // MemoryAwareTileCache
 //
 
 MemoryAwareTileCache::MemoryAwareTileCache(int tileCacheSize)
     : PropertyOwner({ "TileCache", "Tile Cache" })
-    , _numTextureBytesAllocatedOnCPU(0)
     , _cpuAllocatedTileData(CpuAllocatedDataInfo, tileCacheSize, 128, 16384, 1)
     , _gpuAllocatedTileData(GpuAllocatedDataInfo, tileCacheSize, 128, 16384, 1)
     , _tileCacheSize(TileCacheSizeInfo, tileCacheSize, 128, 16384, 1)
     , _applyTileCacheSize(ApplyTileCacheInfo)
     , _clearTileCache(ClearTileCacheInfo)
+    , _evictionPolicy(EvictionPolicyInfo)
+    , _numberOfTiles(NumberOfTilesInfo, 0, 0, std::numeric_limits<int>::max())
+    , _hits(HitsInfo, 0, 0, std::numeric_limits<int>::max())
+    , _misses(MissesInfo, 0, 0, std::numeric_limits<int>::max())
+    , _evictions(EvictionsInfo, 0, 0, std::numeric_limits<int>::max())
 {
     ZoneScoped;
 
@@ -312,17 +419,36 @@ MemoryAwareTileCache::MemoryAwareTileCache(int tileCacheSize)
     );
     addProperty(_tileCacheSize);
 
+    _evictionPolicy.addOptions({
+        { static_cast<int>(TileCache::Policy::LeastRecentlyUsed), "Least Recently Used" },
+        { static_cast<int>(TileCache::Policy::GreedyDualSize), "Greedy Dual Size" }
+    });
+    _evictionPolicy = static_cast<int>(TileCache::Policy::LeastRecentlyUsed);
+    _evictionPolicy.onChange([this]() {
+        _tileCache.setPolicy(static_cast<TileCache::Policy>(_evictionPolicy.value()));
+    });
+    addProperty(_evictionPolicy);
+
+    _numberOfTiles.setReadOnly(true);
+    addProperty(_numberOfTiles);
+    _hits.setReadOnly(true);
+    addProperty(_hits);
+    _misses.setReadOnly(true);
+    addProperty(_misses);
+    _evictions.setReadOnly(true);
+    addProperty(_evictions);
+
     setSizeEstimated(uint64_t(_tileCacheSize) * 1024ul * 1024ul);
 }
 
 void MemoryAwareTileCache::clear() {
     LINFO("Clearing tile cache");
-    _numTextureBytesAllocatedOnCPU = 0;
-    using K = TileTextureInitData::HashKey;
-    using V = TextureContainerTileCache;
-    for (std::pair<const K, V>& p : _textureContainerMap) {
-        p.second.first->reset();
-        p.second.second->clear();
+    _tileCache.clear();
+    for (std::pair<const TileTextureInitData::HashKey,
+                   std::unique_ptr<TextureContainer>>& p : _textureContainerMap)
+    {
+        // Keep the textures around as they will likely be needed again right away
+        p.second->releaseAll();
     }
     LINFO("Tile cache cleared");
 }
@@ -343,84 +469,82 @@ void MemoryAwareTileCache::assureTextureContainerExists(
 
     TileTextureInitData::HashKey initDataKey = initData.hashKey;
     if (_textureContainerMap.find(initDataKey) == _textureContainerMap.end()) {
-        // For now create 500 textures of this type
-        _textureContainerMap.emplace(initDataKey,
-            TextureContainerTileCache(
-                std::make_unique<TextureContainer>(initData, 500),
-                std::make_unique<TileCache>(std::numeric_limits<std::size_t>::max())
-            )
+        _textureContainerMap.emplace(
+            initDataKey,
+            std::make_unique<TextureContainer>(initData)
         );
     }
 }
 
 void MemoryAwareTileCache::setSizeEstimated(size_t estimatedSize) {
     ZoneScoped;
-    ghoul_assert(!_textureContainerMap.empty(), "Texture containers must exist");
 
     LDEBUG("Resetting tile cache size");
+    _budget = estimatedSize;
+    makeRoom(0);
+    LINFO("Tile cache size was reset");
+}
 
-    const size_t sumTextureTypeSize = std::accumulate(
+size_t MemoryAwareTileCache::allocatedBytes() const {
+    return std::accumulate(
         _textureContainerMap.cbegin(),
         _textureContainerMap.cend(),
         size_t(0),
         [](size_t s, const std::pair<const TileTextureInitData::HashKey,
-                                     TextureContainerTileCache>& p)
+                                     std::unique_ptr<TextureContainer>>& p)
         {
-            return s + p.second.first->tileTextureInitData().totalNumBytes;
+            return s + p.second->bytesPerTexture() * p.second->size();
         }
     );
-
-    if (sumTextureTypeSize > 0) {
-        const size_t numTexturesPerType = estimatedSize / sumTextureTypeSize;
-        resetTextureContainerSize(numTexturesPerType);
-    }
-    else {
-        resetTextureContainerSize(0);
-    }
-    LINFO("Tile cache size was reset");
 }
 
-void MemoryAwareTileCache::resetTextureContainerSize(size_t numTexturesPerTextureType) {
+ghoul::opengl::Texture* MemoryAwareTileCache::makeRoom(size_t requiredBytes,
+                                  std::optional<TileTextureInitData::HashKey> reuseKey)
+{
     ZoneScoped;
 
-    _numTextureBytesAllocatedOnCPU = 0;
+    if (allocatedBytes() + requiredBytes <= _budget) {
+        return nullptr;
+    }
+
+    // Textures that are not used by any tile are the cheapest to get rid of
     for (std::pair<const TileTextureInitData::HashKey,
-        TextureContainerTileCache>& p : _textureContainerMap)
+                   std::unique_ptr<TextureContainer>>& p : _textureContainerMap)
     {
-        p.second.first->reset(numTexturesPerTextureType);
-        p.second.second->clear();
+        p.second->deleteUnusedTextures();
     }
+
+    size_t allocated = allocatedBytes();
+    while (allocated + requiredBytes > _budget && !_tileCache.isEmpty()) {
+        CachedTile victim = _tileCache.popVictim().second;
+        _nEvictions++;
+
+        if (reuseKey.has_value() && victim.initDataKey == *reuseKey) {
+            // The evicted tile has the same format as the requested texture
+            return victim.tile.texture;
+        }
+
+        TextureContainer& container = *_textureContainerMap[victim.initDataKey];
+        container.deleteTexture(victim.tile.texture);
+        allocated -= container.bytesPerTexture();
+    }
+    return nullptr;
 }
 
 bool MemoryAwareTileCache::exist(const ProviderTileKey& key) const {
-    const TextureContainerMap::const_iterator result = std::find_if(
-        _textureContainerMap.cbegin(),
-        _textureContainerMap.cend(),
-        [&key](const std::pair<const TileTextureInitData::HashKey,
-                               TextureContainerTileCache>& p)
-        {
-            return p.second.second->exist(key);
-        }
-    );
-    return result != _textureContainerMap.cend();
+    return _tileCache.exist(key);
 }
 
 Tile MemoryAwareTileCache::get(const ProviderTileKey& key) {
     ZoneScoped;
 
-    const TextureContainerMap::const_iterator it = std::find_if(
-        _textureContainerMap.cbegin(),
-        _textureContainerMap.cend(),
-        [&key](const std::pair<const TileTextureInitData::HashKey,
-                               TextureContainerTileCache>& p)
-        {
-            return p.second.second->exist(key);
-        }
-    );
-    if (it != _textureContainerMap.cend()) {
-        return it->second.second->get(key);
+    CachedTile* cachedTile = _tileCache.get(key);
+    if (cachedTile) {
+        _nHits++;
+        return cachedTile->tile;
     }
     else {
+        _nMisses++;
         return Tile();
     }
 }
@@ -431,20 +555,29 @@ ghoul::opengl::Texture* MemoryAwareTileCache::texture(const TileTextureInitData&
     // it needs to be created
     TileTextureInitData::HashKey initDataKey = initData.hashKey;
     assureTextureContainerExists(initData);
-    // Now we know that the texture container exists,
-    // check if there are any unused textures
-    ghoul::opengl::Texture* texture =
-        _textureContainerMap[initDataKey].first->getTextureIfFree();
-    // Second option. No more textures available. Pop from the LRU cache
-    if (!texture) {
-        Tile oldTile = _textureContainerMap[initDataKey].second->popLRU().second;
-        // Use the old tile's texture
-        texture = oldTile.texture;
+    TextureContainer& container = *_textureContainerMap[initDataKey];
+
+    // First option. Use a texture that is not used by any tile
+    ghoul::opengl::Texture* texture = container.getTextureIfFree();
+    if (texture) {
+        return texture;
     }
-    return texture;
+
+    // Second option. Evict tiles until the new texture fits into the budget, which
+    // might free up a texture of the requested type along the way
+    texture = makeRoom(container.bytesPerTexture(), initDataKey);
+    if (texture) {
+        return texture;
+    }
+
+    // Third option. Create a new texture. If the cache was empty and the budget is
+    // smaller than a single texture, this will exceed the budget for this one texture
+    return container.allocateTexture();
 }
 
-void MemoryAwareTileCache::createTileAndPut(ProviderTileKey key, RawTile rawTile) {
+void MemoryAwareTileCache::createTileAndPut(ProviderTileKey key, RawTile rawTile,
+                                            double cost)
+{
     using ghoul::opengl::Texture;
 
     if (rawTile.error != RawTile::ReadError::None) {
@@ -453,13 +586,14 @@ void MemoryAwareTileCache::createTileAndPut(ProviderTileKey key, RawTile rawTile
     else {
         const TileTextureInitData& initData = *rawTile.textureInitData;
         Texture* tex = texture(initData);
+        TextureContainer& container = *_textureContainerMap[initData.hashKey];
 
         // Re-upload texture, either using PBO or by using RAM data
         if (rawTile.pbo != 0) {
             tex->reUploadTextureFromPBO(rawTile.pbo);
             if (initData.shouldAllocateDataOnCPU) {
                 if (!tex->dataOwnership()) {
-                    _numTextureBytesAllocatedOnCPU += initData.totalNumBytes;
+                    container.addBytesAllocatedOnCPU(tex, initData.totalNumBytes);
                 }
                 tex->setPixelData(
                     rawTile.imageData.release(),
@@ -479,7 +613,7 @@ void MemoryAwareTileCache::createTileAndPut(ProviderTileKey key, RawTile rawTile
             [[ maybe_unused ]] size_t expectedDataSize = tex->expectedPixelDataSize();
             const size_t numBytes = rawTile.textureInitData->totalNumBytes;
             ghoul_assert(expectedDataSize == numBytes, "Pixel data size is incorrect");
-            _numTextureBytesAllocatedOnCPU += numBytes - previousExpectedDataSize;
+            container.addBytesAllocatedOnCPU(tex, numBytes - previousExpectedDataSize);
             tex->reUploadTexture();
         }
         // Hi there, I know someone will be tempted to change this to a Linear filtering
@@ -493,16 +627,28 @@ void MemoryAwareTileCache::createTileAndPut(ProviderTileKey key, RawTile rawTile
 
         tex->setFilter(mode);
         Tile tile{ tex, std::move(rawTile.tileMetaData), Tile::Status::OK };
-        TileTextureInitData::HashKey initDataKey = initData.hashKey;
-        _textureContainerMap[initDataKey].second->put(std::move(key), std::move(tile));
+        put(key, initData.hashKey, std::move(tile), cost);
     }
 }
 
 void MemoryAwareTileCache::put(const ProviderTileKey& key,
                                const TileTextureInitData::HashKey& initDataKey,
-                               Tile tile)
+                               Tile tile, double cost)
 {
-    _textureContainerMap[initDataKey].second->put(key, std::move(tile));
+    ghoul_assert(
+        _textureContainerMap.find(initDataKey) != _textureContainerMap.end(),
+        "Texture container must exist"
+    );
+    CachedTile* previous = _tileCache.get(key);
+    if (previous && previous->tile.texture != tile.texture) {
+        // The texture of the replaced tile would otherwise be orphaned
+        _textureContainerMap[previous->initDataKey]->deleteTexture(
+            previous->tile.texture
+        );
+    }
+
+    const size_t size = _textureContainerMap[initDataKey]->bytesPerTexture();
+    _tileCache.put(key, { std::move(tile), initDataKey }, size, cost);
 }
 
 void MemoryAwareTileCache::update() {
@@ -513,6 +659,11 @@ void MemoryAwareTileCache::update() {
 
     _cpuAllocatedTileData = static_cast<int>(dataSizeCPU / ByteToMegaByte);
     _gpuAllocatedTileData = static_cast<int>(dataSizeGPU / ByteToMegaByte);
+
+    _numberOfTiles = clampToInt(_tileCache.size());
+    _hits = clampToInt(_nHits);
+    _misses = clampToInt(_nMisses);
+    _evictions = clampToInt(_nEvictions);
 }
 
 size_t MemoryAwareTileCache::gpuAllocatedDataSize() const {
@@ -521,9 +672,9 @@ size_t MemoryAwareTileCache::gpuAllocatedDataSize() const {
         _textureContainerMap.cend(),
         size_t(0),
         [](size_t s, const std::pair<const TileTextureInitData::HashKey,
-        TextureContainerTileCache>& p)
+                                     std::unique_ptr<TextureContainer>>& p)
         {
-            const TextureContainer& textureContainer = *p.second.first;
+            const TextureContainer& textureContainer = *p.second;
             const size_t nBytes = textureContainer.tileTextureInitData().totalNumBytes;
             return s + nBytes * textureContainer.size();
         }
@@ -536,18 +687,19 @@ size_t MemoryAwareTileCache::cpuAllocatedDataSize() const {
         _textureContainerMap.cend(),
         size_t(0),
         [](size_t s, const std::pair<const TileTextureInitData::HashKey,
-        TextureContainerTileCache>& p)
+                                     std::unique_ptr<TextureContainer>>& p)
         {
-            const TextureContainer& textureContainer = *p.second.first;
+            const TextureContainer& textureContainer = *p.second;
             const TileTextureInitData& initData = textureContainer.tileTextureInitData();
+            const size_t recorded = textureContainer.bytesAllocatedOnCPU();
             if (initData.shouldAllocateDataOnCPU) {
                 size_t bytesPerTexture = initData.totalNumBytes;
-                return s + bytesPerTexture * textureContainer.size();
+                return s + bytesPerTexture * textureContainer.size() + recorded;
             }
-            return s;
+            return s + recorded;
         }
     );
-    return dataSize + _numTextureBytesAllocatedOnCPU;
+    return dataSize;
 }
 
 } // namespace openspace::globebrowsing::cache
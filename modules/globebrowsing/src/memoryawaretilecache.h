@@ -25,21 +25,23 @@
 #ifndef __OPENSPACE_MODULE_GLOBEBROWSING___MEMORY_AWARE_TILE_CACHE___H__
 #define __OPENSPACE_MODULE_GLOBEBROWSING___MEMORY_AWARE_TILE_CACHE___H__
 
-#include <modules/globebrowsing/src/lrucache.h>
+#include <modules/globebrowsing/src/basictypes.h>
+#include <modules/globebrowsing/src/costawarecache.h>
 #include <modules/globebrowsing/src/tileindex.h>
 #include <modules/globebrowsing/src/tiletextureinitdata.h>
+#include <openspace/properties/optionproperty.h>
 #include <openspace/properties/propertyowner.h>
 #include <openspace/properties/scalar/boolproperty.h>
 #include <openspace/properties/scalar/intproperty.h>
 #include <openspace/properties/triggerproperty.h>
+#include <ghoul/misc/assert.h>
+#include <chrono>
 #include <memory>
+#include <optional>
 #include <unordered_map>
 #include <vector>
 
-namespace openspace::globebrowsing {
-    struct RawTile;
-    class Tile;
-} // namespace openspace::globebrowsing
+namespace openspace::globebrowsing { struct RawTile; }
 
 namespace openspace::globebrowsing::cache {
 
@@ -53,35 +55,60 @@ struct ProviderTileKey {
 };
 
 struct ProviderTileHasher {
+    /// The highest tile level for which the keys are guaranteed to be unique
+    static constexpr uint8_t MaxLevel = 23;
+
     /**
-     * Creates a hash which can be used as key in hash maps.
-     * First set the bits to be unique for all tiles.
-     * +-------+------------+-------+------------+
-     * | USAGE | BIT RANGE  | #BITS | MAX VALUE  |
-     * +-------+------------+-------+------------+
-     * | level |   0 -  5   |   5   |         31 |
-     * |     x |   5 - 35   |  30   | 1073741824 |
-     * |     y |  35 - 64   |  29   |  536870912 |
-     * +-------+------------+-------+------------+
-     *
-     * Bits are then shifted depending on the tile provider used.
-    */
-    unsigned long long operator()(const ProviderTileKey& t) const {
-        unsigned long long key = 0;
-        key |= static_cast<unsigned long long>(t.tileIndex.level);
-        key |= static_cast<unsigned long long>(t.tileIndex.x) << 5ULL;
-        key |= static_cast<unsigned long long>(t.tileIndex.y) << 35ULL;
-        // Now the key is unique for all tiles, however not for all tile providers.
-        // Add to the key depending on the tile provider to avoid some hash collisions.
-        // (All hash collisions can not be avoided due to the limit in 64 bit for the
-        // hash key)
-        // Idea: make some offset in the place of the bits for the x value. Lesser chance
-        // of having different x-value than having different tile provider ids.
-        key += static_cast<unsigned long long>(t.providerID) << 25ULL;
+     * Creates a key which can be used in hash maps and which is unique for all tiles of
+     * all tile providers up to level #MaxLevel. As a tile on level `L` has an x value
+     * below `2^(L+1)` and a y value below `2^L`, they are packed into the lowest `2L+1`
+     * bits. The level is encoded implicitly by setting the bit above them, which
+     * separates the levels from each other.
+     * +----------+-------------+---------+
+     * | USAGE    | BIT RANGE   | #BITS   |
+     * +----------+-------------+---------+
+     * | x        |  0 - L+1    |   L+1   |
+     * | y        |  L+1 - 2L+1 |   L     |
+     * | level    |  2L+1       |   1     |
+     * | unused   |  2L+2 - 48  | 46-2L   |
+     * | provider | 48 - 64     |  16     |
+     * +----------+-------------+---------+
+     */
+    uint64_t operator()(const ProviderTileKey& t) const {
+        const TileIndex& ti = t.tileIndex;
+        ghoul_assert(ti.level <= MaxLevel, "Tile level too high for a unique key");
+        ghoul_assert(ti.x < (2ULL << ti.level), "Tile x out of range for its level");
+        ghoul_assert(ti.y < (1ULL << ti.level), "Tile y out of range for its level");
+
+        uint64_t key = 1ULL << (2 * ti.level + 1);
+        key |= static_cast<uint64_t>(ti.y) << (ti.level + 1);
+        key |= static_cast<uint64_t>(ti.x);
+        key |= static_cast<uint64_t>(t.providerID) << 48;
         return key;
     }
 };
 
+/**
+ * Returns the cost of recreating a tile whose creation took \p duration, in
+ * milliseconds. A tile that was created almost instantly still gets a small cost, so that
+ * the GreedyDualSize eviction policy orders such tiles by their size.
+ */
+double tileCost(std::chrono::microseconds duration);
+
+/**
+ * Returns the cost of recreating the \p rawTile, which is the time that was spent on
+ * reading and decoding it.
+ */
+double tileCost(const RawTile& rawTile);
+
+/**
+ * Cache for the tiles that have been uploaded to the GPU. The cache is limited by a
+ * budget of bytes that is shared by tiles of all texture formats, where the size of each
+ * tile is the number of bytes that its texture occupies on the GPU and, if applicable,
+ * on the CPU. When the budget is exhausted, tiles are evicted according to the selected
+ * eviction policy and their textures are either reused for the new tile or deleted to
+ * make room for a texture of a different format.
+ */
 class MemoryAwareTileCache : public properties::PropertyOwner {
 public:
     explicit MemoryAwareTileCache(int tileCacheSize = 1024);
@@ -91,9 +118,22 @@ public:
     bool exist(const ProviderTileKey& key) const;
     Tile get(const ProviderTileKey& key);
     ghoul::opengl::Texture* texture(const TileTextureInitData& initData);
-    void createTileAndPut(ProviderTileKey key, RawTile rawTile);
+
+    /**
+     * Uploads the \p rawTile into a texture and stores it in the cache. The \p cost is
+     * the cost of recreating the tile as returned by #tileCost, which is used by the
+     * GreedyDualSize eviction policy to keep expensive tiles longer than cheap tiles of
+     * the same size.
+     */
+    void createTileAndPut(ProviderTileKey key, RawTile rawTile, double cost);
+
+    /**
+     * Stores the \p tile, whose texture has been created by #texture with the
+     * TileTextureInitData described by \p initDataKey, in the cache. The \p cost is the
+     * cost of recreating the tile as returned by #tileCost.
+     */
     void put(const ProviderTileKey& key,
-        const TileTextureInitData::HashKey& initDataKey, Tile tile);
+        const TileTextureInitData::HashKey& initDataKey, Tile tile, double cost);
     void update();
 
     size_t gpuAllocatedDataSize() const;
@@ -102,28 +142,52 @@ public:
 private:
     /**
      * Owner of texture data used for tiles. Instead of dynamically allocating textures
-     * one by one, they are created once and reused.
+     * for every tile, the textures of evicted tiles are reused for new tiles of the same
+     * format.
      */
     class TextureContainer {
     public:
         /**
          * \param initData is the description of the texture type.
-         * \param numTextures is the number of textures to allocate.
          */
-        TextureContainer(TileTextureInitData initData, size_t numTextures);
+        explicit TextureContainer(TileTextureInitData initData);
 
         ~TextureContainer() = default;
 
+        /**
+         * Deletes all textures of this container.
+         */
         void reset();
-        void reset(size_t numTextures);
 
         /**
-         * \return A pointer to a texture if there is one texture never used before. If
-         *         there are no textures left, nullptr is returned. TextureContainer still
-         *         owns the texture so no delete should be called on the raw pointer.
+         * Marks all textures of this container as unused without deleting them.
+         */
+        void releaseAll();
+
+        /**
+         * \return A pointer to a texture that is currently unused or nullptr if all
+         *         textures are in use. TextureContainer still owns the texture so no
+         *         delete should be called on the raw pointer.
          */
         ghoul::opengl::Texture* getTextureIfFree();
 
+        /**
+         * Creates a new texture in this container and returns it. TextureContainer
+         * owns the texture so no delete should be called on the raw pointer.
+         */
+        ghoul::opengl::Texture* allocateTexture();
+
+        /**
+         * Deletes the \p texture, which must be owned by this container, together with
+         * the CPU bytes that were recorded for it.
+         */
+        void deleteTexture(ghoul::opengl::Texture* texture);
+
+        /**
+         * Deletes all textures that are currently not in use.
+         */
+        void deleteUnusedTextures();
+
         const TileTextureInitData& tileTextureInitData() const;
 
         /**
@@ -131,31 +195,75 @@ private:
          */
         size_t size() const;
 
+        /**
+         * \return the number of bytes that each texture of this container occupies on
+         *         the GPU and CPU
+         */
+        size_t bytesPerTexture() const;
+
+        /**
+         * Records that the pixel data of \p texture occupies \p nBytes more on the CPU
+         * than accounted for by #bytesPerTexture.
+         */
+        void addBytesAllocatedOnCPU(const ghoul::opengl::Texture* texture,
+            size_t nBytes);
+
+        /**
+         * \return the number of bytes recorded through #addBytesAllocatedOnCPU for the
+         *         textures that currently belong to this container
+         */
+        size_t bytesAllocatedOnCPU() const;
+
     private:
+        struct TextureInfo {
+            /// The location of the texture in #_textures
+            size_t index = 0;
+            size_t bytesAllocatedOnCPU = 0;
+        };
+
         std::vector<std::unique_ptr<ghoul::opengl::Texture>> _textures;
+        std::vector<ghoul::opengl::Texture*> _freeTextures;
+        std::unordered_map<const ghoul::opengl::Texture*, TextureInfo> _textureInfos;
+        size_t _bytesAllocatedOnCPU = 0;
 
         const TileTextureInitData _initData;
-        size_t _freeTexture = 0;
-        size_t _numTextures;
     };
 
+    struct CachedTile {
+        Tile tile;
+        TileTextureInitData::HashKey initDataKey;
+    };
 
     void createDefaultTextureContainers();
     void assureTextureContainerExists(const TileTextureInitData& initData);
-    void resetTextureContainerSize(size_t numTexturesPerTextureType);
 
-    using TileCache = LRUCache<ProviderTileKey, Tile, ProviderTileHasher>;
-    using TextureContainerTileCache = std::pair<
-        std::unique_ptr<TextureContainer>,
-        std::unique_ptr<TileCache>
-    >;
+    /**
+     * Returns the number of bytes that are occupied by all textures of all containers.
+     */
+    size_t allocatedBytes() const;
+
+    /**
+     * Evicts tiles and deletes their textures until at least \p requiredBytes are left
+     * in the budget or the cache is empty. If a tile with a texture that is described by
+     * \p reuseKey is evicted in the process, its texture is returned instead of being
+     * deleted, as it can be used for the new tile directly.
+     */
+    ghoul::opengl::Texture* makeRoom(size_t requiredBytes,
+        std::optional<TileTextureInitData::HashKey> reuseKey = std::nullopt);
+
+    using TileCache = CostAwareCache<ProviderTileKey, CachedTile, ProviderTileHasher>;
     using TextureContainerMap = std::unordered_map<
         TileTextureInitData::HashKey,
-        TextureContainerTileCache
+        std::unique_ptr<TextureContainer>
     >;
 
     TextureContainerMap _textureContainerMap;
-    size_t _numTextureBytesAllocatedOnCPU;
+    TileCache _tileCache;
+    size_t _budget = 0;
+
+    uint64_t _nHits = 0;
+    uint64_t _nMisses = 0;
+    uint64_t _nEvictions = 0;
 
     // Properties
     properties::IntProperty _cpuAllocatedTileData;
@@ -163,6 +271,11 @@ private:
     properties::IntProperty _tileCacheSize;
     properties::TriggerProperty _applyTileCacheSize;
     properties::TriggerProperty _clearTileCache;
+    properties::OptionProperty _evictionPolicy;
+    properties::IntProperty _numberOfTiles;
+    properties::IntProperty _hits;
+    properties::IntProperty _misses;
+    properties::IntProperty _evictions;
 };
 
 } // namespace openspace::globebrowsing::cache
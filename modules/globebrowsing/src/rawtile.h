@@ -30,6 +30,7 @@
 #include <modules/globebrowsing/src/tiletextureinitdata.h>
 #include <ghoul/glm.h>
 #include <ghoul/opengl/ghoul_gl.h>
+#include <chrono>
 #include <cstddef>
 #include <memory>
 #include <optional>
@@ -44,7 +45,8 @@ struct RawTile {
         Debug,    // = CE_Debug
         Warning,  // = CE_Warning
         Failure,  // = CE_Failure
-        Fatal     // = CE_Fatal
+        Fatal,    // = CE_Fatal
+        Cancelled // The read was cancelled before it finished
     };
 
     std::unique_ptr<std::byte[]> imageData;
@@ -53,6 +55,11 @@ struct RawTile {
     TileIndex tileIndex = TileIndex(0, 0, 0);
     ReadError error = ReadError::None;
     GLuint pbo = 0;
+
+    /// The time spent reading the tile from the dataset or the disk cache
+    std::chrono::microseconds readTime = std::chrono::microseconds(0);
+    /// The time spent computing the tile's metadata and checking it for errors
+    std::chrono::microseconds decodeTime = std::chrono::microseconds(0);
 };
 
 } // namespace openspace::globebrowsing
@@ -26,12 +26,16 @@
 
 #include <modules/globebrowsing/globebrowsingmodule.h>
 #include <modules/globebrowsing/src/geodeticpatch.h>
+#include <modules/globebrowsing/src/tilediskcache.h>
+#include <modules/globebrowsing/src/tilejobscheduler.h>
+#include <modules/globebrowsing/src/tilemetadata.h>
 #include <openspace/engine/globals.h>
 #include <openspace/engine/moduleengine.h>
 #include <ghoul/fmt.h>
 #include <ghoul/filesystem/file.h>
 #include <ghoul/filesystem/filesystem.h>
 #include <ghoul/logging/logmanager.h>
+#include <ghoul/misc/defer.h>
 #include <ghoul/misc/exception.h>
 #include <ghoul/misc/profiling.h>
 
@@ -52,6 +56,7 @@
 #endif // _MSC_VER
 
 #include <algorithm>
+#include <chrono>
 #include <fstream>
 #include <filesystem>
 #include <system_error>
@@ -68,30 +73,6 @@ enum class Side {
     Bottom
 };
 
-float interpretFloat(GLenum glType, const std::byte* src) {
-    switch (glType) {
-        case GL_UNSIGNED_BYTE:
-            return static_cast<float>(*reinterpret_cast<const GLubyte*>(src));
-        case GL_UNSIGNED_SHORT:
-            return static_cast<float>(*reinterpret_cast<const GLushort*>(src));
-        case GL_SHORT:
-            return static_cast<float>(*reinterpret_cast<const GLshort*>(src));
-        case GL_UNSIGNED_INT:
-            return static_cast<float>(*reinterpret_cast<const GLuint*>(src));
-        case GL_INT:
-            return static_cast<float>(*reinterpret_cast<const GLint*>(src));
-        case GL_HALF_FLOAT:
-            return static_cast<float>(*reinterpret_cast<const GLhalf*>(src));
-        case GL_FLOAT:
-            return static_cast<float>(*reinterpret_cast<const GLfloat*>(src));
-        case GL_DOUBLE:
-            return static_cast<float>(*reinterpret_cast<const GLdouble*>(src));
-        default:
-            ghoul_assert(false, "Unknown data type");
-            throw ghoul::MissingCaseException();
-    }
-}
-
 GDALDataType toGDALDataType(GLenum glType) {
     switch (glType) {
         case GL_UNSIGNED_BYTE:
@@ -361,17 +342,47 @@ RawTile::ReadError postProcessErrorCheck(const RawTile& rawTile,
     return RawTile::ReadError::None;
 }
 
+// Identifies the tiles of a dataset in the disk cache. If the dataset is a local file,
+// its size and modification time are included so that replacing the file does not keep
+// serving the tiles of the old file
+uint64_t diskCacheHash(const std::string& filePath, const TileTextureInitData& initData,
+                       bool preprocess)
+{
+    uint64_t hash = std::hash<std::string>{}(filePath) ^
+        (initData.hashKey * 31) ^
+        (preprocess ? 0x9e3779b97f4a7c15ULL : 0);
+
+    std::error_code ec;
+    if (std::filesystem::is_regular_file(filePath, ec)) {
+        const uintmax_t size = std::filesystem::file_size(filePath, ec);
+        if (!ec) {
+            hash ^= std::hash<uintmax_t>{}(size) * 0x100000001b3ULL;
+        }
+        const std::filesystem::file_time_type time =
+            std::filesystem::last_write_time(filePath, ec);
+        if (!ec) {
+            hash ^= std::hash<int64_t>{}(
+                static_cast<int64_t>(time.time_since_epoch().count())
+            ) * 0xc2b2ae3d27d4eb4fULL;
+        }
+    }
+    return hash;
+}
+
 } // namespace
 
 
 RawTileDataReader::RawTileDataReader(std::string filePath,
                                      TileTextureInitData initData,
                                      TileCacheProperties cacheProperties,
-                                     PerformPreprocessing preprocess)
+                                     PerformPreprocessing preprocess,
+                                     UseDiskCache useDiskCache)
     : _datasetFilePath(std::move(filePath))
     , _initData(std::move(initData))
     , _cacheProperties(std::move(cacheProperties))
     , _preprocess(preprocess)
+    , _useDiskCache(useDiskCache)
+    , _diskCacheHash(diskCacheHash(_datasetFilePath, _initData, _preprocess))
 {
     ZoneScoped;
 
@@ -380,10 +391,7 @@ RawTileDataReader::RawTileDataReader(std::string filePath,
 
 RawTileDataReader::~RawTileDataReader() {
     std::lock_guard lockGuard(_datasetLock);
-    if (_dataset) {
-        GDALClose(_dataset);
-        _dataset = nullptr;
-    }
+    closeDatasets();
 }
 
 std::optional<std::string> RawTileDataReader::mrfCache() {
@@ -516,19 +524,25 @@ void RawTileDataReader::initialize() {
         }
     }
 
+    _datasetOpenPath = content;
+    _maxDatasets = std::max(_cacheProperties.nDatasetHandles, 1);
+
+    GDALDataset* dataset = nullptr;
     {
         ZoneScopedN("GDALOpen");
-        _dataset = static_cast<GDALDataset*>(GDALOpen(content.c_str(), GA_ReadOnly));
-        if (!_dataset) {
+        dataset = static_cast<GDALDataset*>(GDALOpen(content.c_str(), GA_ReadOnly));
+        if (!dataset) {
             throw ghoul::RuntimeError(fmt::format(
                 "Failed to load dataset: {}. GDAL Error: {}",
                 _datasetFilePath, CPLGetLastErrorMsg()
             ));
         }
     }
+    _datasets.push_back(dataset);
+    _availableDatasets.push_back(dataset);
 
     // Assume all raster bands have the same data type
-    _rasterCount = _dataset->GetRasterCount();
+    _rasterCount = dataset->GetRasterCount();
 
     // calculateTileDepthTransform
     unsigned long long maximumValue = [](GLenum t) {
@@ -547,27 +561,27 @@ void RawTileDataReader::initialize() {
 
 
     _depthTransform.scale = static_cast<float>(
-        _dataset->GetRasterBand(1)->GetScale() * maximumValue
+        dataset->GetRasterBand(1)->GetScale() * maximumValue
     );
     _depthTransform.offset = static_cast<float>(
-        _dataset->GetRasterBand(1)->GetOffset()
+        dataset->GetRasterBand(1)->GetOffset()
     );
-    _rasterXSize = _dataset->GetRasterXSize();
-    _rasterYSize = _dataset->GetRasterYSize();
-    _noDataValue = static_cast<float>(_dataset->GetRasterBand(1)->GetNoDataValue());
+    _rasterXSize = dataset->GetRasterXSize();
+    _rasterYSize = dataset->GetRasterYSize();
+    _noDataValue = static_cast<float>(dataset->GetRasterBand(1)->GetNoDataValue());
     _dataType = toGDALDataType(_initData.glType);
 
-    CPLErr error = _dataset->GetGeoTransform(_padfTransform.data());
+    CPLErr error = dataset->GetGeoTransform(_padfTransform.data());
     if (error == CE_Failure) {
         _padfTransform = geoTransform(_rasterXSize, _rasterYSize);
     }
 
     double tileLevelDifference = calculateTileLevelDifference(
-        _dataset,
+        dataset,
         _initData.dimensions.x
     );
 
-    const int numOverviews = _dataset->GetRasterBand(1)->GetOverviewCount();
+    const int numOverviews = dataset->GetRasterBand(1)->GetOverviewCount();
     _maxChunkLevel = static_cast<int>(-tileLevelDifference);
     if (numOverviews > 0) {
         _maxChunkLevel += numOverviews;
@@ -578,14 +592,72 @@ void RawTileDataReader::initialize() {
 void RawTileDataReader::reset() {
     std::lock_guard lockGuard(_datasetLock);
     _maxChunkLevel = -1;
-    if (_dataset) {
-        GDALClose(_dataset);
-        _dataset = nullptr;
-    }
+    closeDatasets();
     initialize();
 }
 
-RawTile::ReadError RawTileDataReader::rasterRead(int rasterBand,
+void RawTileDataReader::closeDatasets() {
+    ghoul_assert(
+        _availableDatasets.size() == _datasets.size(),
+        "All datasets must be released before closing them"
+    );
+
+    for (GDALDataset* dataset : _datasets) {
+        GDALClose(dataset);
+    }
+    _datasets.clear();
+    _availableDatasets.clear();
+}
+
+GDALDataset* RawTileDataReader::acquireDataset() const {
+    ZoneScoped;
+
+    std::unique_lock lock(_datasetLock);
+    while (true) {
+        if (!_availableDatasets.empty()) {
+            GDALDataset* dataset = _availableDatasets.back();
+            _availableDatasets.pop_back();
+            return dataset;
+        }
+
+        if (static_cast<int>(_datasets.size()) < _maxDatasets) {
+            // All existing handles are busy, but we are allowed to open another one.
+            // GDAL datasets must not be shared between threads, so every concurrent read
+            // needs its own handle
+            ZoneScopedN("GDALOpen");
+            GDALDataset* dataset = static_cast<GDALDataset*>(
+                GDALOpen(_datasetOpenPath.c_str(), GA_ReadOnly)
+            );
+            if (dataset) {
+                _datasets.push_back(dataset);
+                return dataset;
+            }
+
+            LWARNING(fmt::format(
+                "Failed to open additional handle for dataset: {}. GDAL Error: {}",
+                _datasetFilePath, CPLGetLastErrorMsg()
+            ));
+            // Don't try again and make do with the handles that we already have
+            _maxDatasets = static_cast<int>(_datasets.size());
+        }
+
+        _datasetAvailable.wait(lock);
+    }
+}
+
+void RawTileDataReader::releaseDataset(GDALDataset* dataset) const {
+    {
+        std::lock_guard lock(_datasetLock);
+        _availableDatasets.push_back(dataset);
+    }
+    _datasetAvailable.notify_one();
+}
+
+int RawTileDataReader::numDatasetHandles() const {
+    return std::max(_cacheProperties.nDatasetHandles, 1);
+}
+
+RawTile::ReadError RawTileDataReader::rasterRead(GDALDataset* dataset, int rasterBand,
                                                  const IODescription& io,
                                                  char* dataDestination) const
 {
@@ -612,7 +684,7 @@ RawTile::ReadError RawTileDataReader::rasterRead(int rasterBand,
     dataDest -= io.write.region.start.y * io.write.bytesPerLine;
     dataDest += io.write.region.start.x * _initData.bytesPerPixel;
 
-    GDALRasterBand* gdalRasterBand = _dataset->GetRasterBand(rasterBand);
+    GDALRasterBand* gdalRasterBand = dataset->GetRasterBand(rasterBand);
     CPLErr readError = CE_Failure;
     readError = gdalRasterBand->RasterIO(
         GF_Read,
@@ -639,7 +711,45 @@ RawTile::ReadError RawTileDataReader::rasterRead(int rasterBand,
     }
 }
 
-RawTile RawTileDataReader::readTileData(TileIndex tileIndex) const {
+RawTile RawTileDataReader::readTileData(TileIndex tileIndex,
+                                        const CancellationToken* token) const
+{
+    auto isCancelled = [token]() { return token && token->isCancelled(); };
+    auto cancelledTile = [this](TileIndex index) {
+        RawTile rawTile;
+        rawTile.error = RawTile::ReadError::Cancelled;
+        rawTile.tileIndex = std::move(index);
+        rawTile.textureInitData = _initData;
+        return rawTile;
+    };
+
+    if (isCancelled()) {
+        return cancelledTile(std::move(tileIndex));
+    }
+
+    cache::TileDiskCache* diskCache = _useDiskCache ?
+        global::moduleEngine->module<GlobeBrowsingModule>()->tileDiskCache() :
+        nullptr;
+    using Clock = std::chrono::steady_clock;
+    auto elapsedSince = [](Clock::time_point start) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            Clock::now() - start
+        );
+    };
+
+    if (diskCache) {
+        const Clock::time_point cacheStart = Clock::now();
+        std::optional<RawTile> cached = diskCache->get(
+            _diskCacheHash,
+            tileIndex,
+            _initData
+        );
+        if (cached.has_value()) {
+            cached->readTime = elapsedSince(cacheStart);
+            return std::move(*cached);
+        }
+    }
+
     size_t numBytes = _initData.totalNumBytes;
 
     RawTile rawTile;
@@ -648,24 +758,53 @@ RawTile RawTileDataReader::readTileData(TileIndex tileIndex) const {
 
     IODescription io = ioDescription(tileIndex);
     RawTile::ReadError worstError = RawTile::ReadError::None;
-    readImageData(io, worstError, reinterpret_cast<char*>(rawTile.imageData.get()));
+    {
+        GDALDataset* dataset = acquireDataset();
+        defer { releaseDataset(dataset); };
+
+        // Waiting for a free dataset handle might have taken a while
+        if (isCancelled()) {
+            return cancelledTile(std::move(tileIndex));
+        }
+
+        // The time spent waiting for the dataset handle is not part of the read time
+        const Clock::time_point readStart = Clock::now();
+        readImageData(
+            dataset,
+            io,
+            worstError,
+            reinterpret_cast<char*>(rawTile.imageData.get())
+        );
+        rawTile.readTime = elapsedSince(readStart);
+    }
+
+    if (isCancelled()) {
+        return cancelledTile(std::move(tileIndex));
+    }
 
     rawTile.error = worstError;
     rawTile.tileIndex = std::move(tileIndex);
     rawTile.textureInitData = _initData;
 
     if (_preprocess) {
+        const Clock::time_point decodeStart = Clock::now();
         rawTile.tileMetaData = tileMetaData(rawTile, io.write.region);
         rawTile.error = std::max(
             rawTile.error,
             postProcessErrorCheck(rawTile, _initData.nRasters, noDataValueAsFloat())
         );
+        rawTile.decodeTime = elapsedSince(decodeStart);
+    }
+
+    if (diskCache) {
+        diskCache->put(_diskCacheHash, rawTile);
     }
 
     return rawTile;
 }
 
-void RawTileDataReader::readImageData(IODescription& io, RawTile::ReadError& worstError,
+void RawTileDataReader::readImageData(GDALDataset* dataset, IODescription& io,
+                                      RawTile::ReadError& worstError,
                                       char* imageDataDest) const
 {
     // Only read the minimum number of rasters
@@ -674,7 +813,7 @@ void RawTileDataReader::readImageData(IODescription& io, RawTile::ReadError& wor
     switch (_initData.ghoulTextureFormat) {
         case ghoul::opengl::Texture::Format::Red: {
             char* dest = imageDataDest;
-            const RawTile::ReadError err = rasterRead(1, io, dest);
+            const RawTile::ReadError err = rasterRead(dataset, 1, io, dest);
             worstError = std::max(worstError, err);
             break;
         }
@@ -686,7 +825,7 @@ void RawTileDataReader::readImageData(IODescription& io, RawTile::ReadError& wor
                     // The final destination pointer is offsetted by one datum byte size
                     // for every raster (or data channel, i.e. R in RGB)
                     char* dest = imageDataDest + (i * _initData.bytesPerDatum);
-                    const RawTile::ReadError err = rasterRead(1, io, dest);
+                    const RawTile::ReadError err = rasterRead(dataset, 1, io, dest);
                     worstError = std::max(worstError, err);
                 }
             }
@@ -695,12 +834,12 @@ void RawTileDataReader::readImageData(IODescription& io, RawTile::ReadError& wor
                     // The final destination pointer is offsetted by one datum byte size
                     // for every raster (or data channel, i.e. R in RGB)
                     char* dest = imageDataDest + (i * _initData.bytesPerDatum);
-                    const RawTile::ReadError err = rasterRead(1, io, dest);
+                    const RawTile::ReadError err = rasterRead(dataset, 1, io, dest);
                     worstError = std::max(worstError, err);
                 }
                 // Last read is the alpha channel
                 char* dest = imageDataDest + (3 * _initData.bytesPerDatum);
-                const RawTile::ReadError err = rasterRead(2, io, dest);
+                const RawTile::ReadError err = rasterRead(dataset, 2, io, dest);
                 worstError = std::max(worstError, err);
             }
             else { // Three or more rasters
@@ -708,7 +847,7 @@ void RawTileDataReader::readImageData(IODescription& io, RawTile::ReadError& wor
                     // The final destination pointer is offsetted by one datum byte size
                     // for every raster (or data channel, i.e. R in RGB)
                     char* dest = imageDataDest + (i * _initData.bytesPerDatum);
-                    const RawTile::ReadError err = rasterRead(i + 1, io, dest);
+                    const RawTile::ReadError err = rasterRead(dataset, i + 1, io, dest);
                     worstError = std::max(worstError, err);
                 }
             }
@@ -721,7 +860,7 @@ void RawTileDataReader::readImageData(IODescription& io, RawTile::ReadError& wor
                     // The final destination pointer is offsetted by one datum byte size
                     // for every raster (or data channel, i.e. R in RGB)
                     char* dest = imageDataDest + (i * _initData.bytesPerDatum);
-                    const RawTile::ReadError err = rasterRead(1, io, dest);
+                    const RawTile::ReadError err = rasterRead(dataset, 1, io, dest);
                     worstError = std::max(worstError, err);
                 }
             }
@@ -730,12 +869,12 @@ void RawTileDataReader::readImageData(IODescription& io, RawTile::ReadError& wor
                     // The final destination pointer is offsetted by one datum byte size
                     // for every raster (or data channel, i.e. R in RGB)
                     char* dest = imageDataDest + (i * _initData.bytesPerDatum);
-                    const RawTile::ReadError err = rasterRead(1, io, dest);
+                    const RawTile::ReadError err = rasterRead(dataset, 1, io, dest);
                     worstError = std::max(worstError, err);
                 }
                 // Last read is the alpha channel
                 char* dest = imageDataDest + (3 * _initData.bytesPerDatum);
-                const RawTile::ReadError err = rasterRead(2, io, dest);
+                const RawTile::ReadError err = rasterRead(dataset, 2, io, dest);
                 worstError = std::max(worstError, err);
             }
             else { // Three or more rasters
@@ -743,14 +882,14 @@ void RawTileDataReader::readImageData(IODescription& io, RawTile::ReadError& wor
                     // The final destination pointer is offsetted by one datum byte size
                     // for every raster (or data channel, i.e. R in RGB)
                     char* dest = imageDataDest + (i * _initData.bytesPerDatum);
-                    const RawTile::ReadError err = rasterRead(3 - i, io, dest);
+                    const RawTile::ReadError err = rasterRead(dataset, 3 - i, io, dest);
                     worstError = std::max(worstError, err);
                 }
             }
             if (nRastersToRead > 3) { // Alpha channel exists
                 // Last read is the alpha channel
                 char* dest = imageDataDest + (3 * _initData.bytesPerDatum);
-                const RawTile::ReadError err = rasterRead(4, io, dest);
+                const RawTile::ReadError err = rasterRead(dataset, 4, io, dest);
                 worstError = std::max(worstError, err);
             }
             break;
@@ -800,50 +939,17 @@ glm::ivec2 RawTileDataReader::fullPixelSize() const {
 TileMetaData RawTileDataReader::tileMetaData(RawTile& rawTile,
                                              const PixelRegion& region) const
 {
-    const size_t bytesPerLine = _initData.bytesPerPixel * region.numPixels.x;
-
-    TileMetaData ppData;
     ghoul_assert(_initData.nRasters <= 4, "Unexpected number of rasters");
-    ppData.nValues = static_cast<uint8_t>(_initData.nRasters);
-
-    std::fill(ppData.maxValues.begin(), ppData.maxValues.end(), -FLT_MAX);
-    std::fill(ppData.minValues.begin(), ppData.minValues.end(), FLT_MAX);
-    std::fill(ppData.hasMissingData.begin(), ppData.hasMissingData.end(), false);
 
     bool allIsMissing = true;
-    for (int y = 0; y < region.numPixels.y; ++y) {
-        const size_t yi =
-            (static_cast<unsigned long long>(region.numPixels.y) - 1 - y) * bytesPerLine;
-        size_t i = 0;
-        for (int x = 0; x < region.numPixels.x; ++x) {
-            for (size_t raster = 0; raster < _initData.nRasters; ++raster) {
-                const float noDataValue = noDataValueAsFloat();
-                const float val = interpretFloat(
-                    _initData.glType,
-                    &(rawTile.imageData.get()[yi + i])
-                );
-                if (val != noDataValue && val == val) {
-                    ppData.maxValues[raster] = std::max(
-                        val,
-                        ppData.maxValues[raster]
-                    );
-                    ppData.minValues[raster] = std::min(
-                        val,
-                        ppData.minValues[raster]
-                    );
-                    allIsMissing = false;
-                }
-                else {
-                    ppData.hasMissingData[raster] = true;
-                    float& floatToRewrite = reinterpret_cast<float&>(
-                        rawTile.imageData[yi + i]
-                    );
-                    floatToRewrite = -std::numeric_limits<float>::max();
-                }
-                i += _initData.bytesPerDatum;
-            }
-        }
-    }
+    TileMetaData ppData = calculateTileMetaData(
+        rawTile.imageData.get(),
+        static_cast<size_t>(region.numPixels.x) * static_cast<size_t>(region.numPixels.y),
+        _initData.glType,
+        _initData.nRasters,
+        noDataValueAsFloat(),
+        allIsMissing
+    );
 
     if (allIsMissing) {
         rawTile.error = RawTile::ReadError::Failure;
@@ -30,8 +30,10 @@
 #include <modules/globebrowsing/src/tiletextureinitdata.h>
 #include <modules/globebrowsing/src/tilecacheproperties.h>
 #include <ghoul/misc/boolean.h>
+#include <condition_variable>
 #include <string>
 #include <mutex>
+#include <vector>
 #include <gdal.h>
 
 class GDALDataset;
@@ -39,11 +41,13 @@ class GDALRasterBand;
 
 namespace openspace::globebrowsing {
 
+class CancellationToken;
 class GeodeticPatch;
 
 class RawTileDataReader {
 public:
     BooleanType(PerformPreprocessing);
+    BooleanType(UseDiskCache);
 
     /**
      * Opens a GDALDataset in readonly mode and calculates meta data required for
@@ -52,37 +56,77 @@ public:
      * \param filePath, a path to a specific file GDAL can read
      * \param config, Configuration used for initialization
      * \param baseDirectory, the base directory to use in future loading operations
+     * \param useDiskCache, whether the tiles are read from and stored in the tile disk
+     *        cache of the GlobeBrowsingModule, if that cache is enabled
      */
     RawTileDataReader(std::string filePath, TileTextureInitData initData,
         TileCacheProperties cacheProperties,
-        PerformPreprocessing preprocess = PerformPreprocessing::No);
+        PerformPreprocessing preprocess = PerformPreprocessing::No,
+        UseDiskCache useDiskCache = UseDiskCache::Yes);
     ~RawTileDataReader();
 
     void reset();
     int maxChunkLevel() const;
     float noDataValueAsFloat() const;
 
-    RawTile readTileData(TileIndex tileIndex) const;
+    /**
+     * Reads the tile with the provided \p tileIndex. This function is thread-safe and up
+     * to #numDatasetHandles calls can read from the underlying dataset concurrently. If
+     * the optional \p token is cancelled while the tile is read, the reading stops as
+     * early as possible and the returned tile has the RawTile::ReadError::Cancelled
+     * error.
+     */
+    RawTile readTileData(TileIndex tileIndex,
+        const CancellationToken* token = nullptr) const;
     const TileDepthTransform& depthTransform() const;
     glm::ivec2 fullPixelSize() const;
 
+    /**
+     * Returns the maximum number of GDAL datasets that are opened for this reader, which
+     * is also the maximum number of tiles that can be read concurrently.
+     */
+    int numDatasetHandles() const;
+
 private:
     std::optional<std::string> mrfCache();
 
     void initialize();
 
-    RawTile::ReadError rasterRead(int rasterBand, const IODescription& io,
-        char* dataDestination) const;
+    /**
+     * Closes all dataset handles. The caller must ensure that no handle is currently in
+     * use by any thread.
+     */
+    void closeDatasets();
+
+    /**
+     * Returns a dataset handle that is exclusively used by the calling thread until it is
+     * returned by calling #releaseDataset. If no handle is available and the maximum
+     * number of handles are already opened, this function blocks until another thread
+     * releases its handle.
+     */
+    GDALDataset* acquireDataset() const;
+    void releaseDataset(GDALDataset* dataset) const;
+
+    RawTile::ReadError rasterRead(GDALDataset* dataset, int rasterBand,
+        const IODescription& io, char* dataDestination) const;
 
-    void readImageData(IODescription& io, RawTile::ReadError& worstError,
-        char* imageDataDest) const;
+    void readImageData(GDALDataset* dataset, IODescription& io,
+        RawTile::ReadError& worstError, char* imageDataDest) const;
 
     IODescription ioDescription(const TileIndex& tileIndex) const;
 
     TileMetaData tileMetaData(RawTile& rawTile, const PixelRegion& region) const;
 
     const std::string _datasetFilePath;
-    GDALDataset* _dataset = nullptr;
+    /// The path that is passed to GDAL, which is either the file path or the MRF cache
+    std::string _datasetOpenPath;
+
+    /// All datasets that have been opened on the same file. The first dataset is opened
+    /// during initialization, the remaining ones are opened on demand
+    mutable std::vector<GDALDataset*> _datasets;
+    /// The subset of _datasets that are currently not used by any reading thread
+    mutable std::vector<GDALDataset*> _availableDatasets;
+    mutable int _maxDatasets = 1;
 
     // Dataset parameters
     int _rasterCount;
@@ -96,9 +140,13 @@ private:
     const TileTextureInitData _initData;
     const TileCacheProperties _cacheProperties;
     const PerformPreprocessing _preprocess;
+    const UseDiskCache _useDiskCache;
+    /// Identifies the tiles of this reader in the persistent tile disk cache
+    const uint64_t _diskCacheHash;
     TileDepthTransform _depthTransform = { .scale = 0.f, .offset = 0.f };
 
     mutable std::mutex _datasetLock;
+    mutable std::condition_variable _datasetAvailable;
 };
 
 } // namespace openspace::globebrowsing
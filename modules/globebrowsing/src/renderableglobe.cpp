@@ -25,16 +25,22 @@
 #include <modules/globebrowsing/src/renderableglobe.h>
 
 #include <modules/debugging/rendering/debugrenderer.h>
+#include <modules/globebrowsing/globebrowsingmodule.h>
 #include <modules/globebrowsing/src/basictypes.h>
 #include <modules/globebrowsing/src/gpulayergroup.h>
 #include <modules/globebrowsing/src/layer.h>
 #include <modules/globebrowsing/src/layergroup.h>
 #include <modules/globebrowsing/src/renderableglobe.h>
+#include <modules/globebrowsing/src/tileprovider/defaulttileprovider.h>
 #include <modules/globebrowsing/src/tileprovider/tileprovider.h>
 #include <openspace/documentation/documentation.h>
 #include <openspace/documentation/verifier.h>
+#include <openspace/camera/camera.h>
 #include <openspace/engine/globals.h>
+#include <openspace/engine/moduleengine.h>
+#include <openspace/engine/windowdelegate.h>
 #include <openspace/interaction/sessionrecording.h>
+#include <openspace/navigation/navigationhandler.h>
 #include <openspace/rendering/renderengine.h>
 #include <openspace/scene/scenegraphnode.h>
 #include <openspace/scene/scene.h>
@@ -51,6 +57,9 @@
 #include <ghoul/opengl/openglstatecache.h>
 #include <ghoul/opengl/programobject.h>
 #include <ghoul/systemcapabilities/openglcapabilitiescomponent.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <numeric>
 #include <queue>
 #include <vector>
@@ -82,10 +91,6 @@ namespace {
         bool isShadowing = false;
     };
 
-    const openspace::globebrowsing::AABB3 CullingFrustum{
-        glm::vec3(-1.f, -1.f, 0.f),
-        glm::vec3( 1.f,  1.f, 1e35f)
-    };
     constexpr float DefaultHeight = 0.f;
 
     // I tried reducing this to 16, but it left the rendering with artifacts when the
@@ -270,6 +275,82 @@ namespace {
         openspace::properties::Property::Visibility::User
     };
 
+    constexpr openspace::properties::Property::PropertyInfo PrefetchEnabledInfo = {
+        "Enabled",
+        "Enabled",
+        "If this value is enabled, the movement of the camera is extrapolated and tiles "
+        "that are likely to be needed in the near future are loaded in the background "
+        "before they are requested by the globe",
+        openspace::properties::Property::Visibility::AdvancedUser
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo PrefetchBudgetInfo = {
+        "Budget",
+        "Budget",
+        "The maximum number of tile requests that are issued for prefetching per frame. "
+        "Prefetch requests are only worked on if there are no regular requests pending",
+        openspace::properties::Property::Visibility::AdvancedUser
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo PrefetchLookAheadInfo = {
+        "LookAhead",
+        "Look ahead (seconds)",
+        "The number of seconds into the future for which the camera position is "
+        "extrapolated when determining which tiles to prefetch",
+        openspace::properties::Property::Visibility::AdvancedUser
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo PrefetchRequestsInfo = {
+        "Requests",
+        "Requests",
+        "The number of tiles that have been requested for prefetching by the active "
+        "layers of this globe",
+        openspace::properties::Property::Visibility::Developer
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo PrefetchHitsInfo = {
+        "Hits",
+        "Hits",
+        "The number of prefetched tiles that were used by the globe before they were "
+        "removed from the tile cache",
+        openspace::properties::Property::Visibility::Developer
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo PrefetchWasteInfo = {
+        "Waste",
+        "Waste",
+        "The number of prefetched tiles that were cancelled or removed from the tile "
+        "cache without being used by the globe",
+        openspace::properties::Property::Visibility::Developer
+    };
+
+    // If the direction of the camera movement deviates more than this from the direction
+    // in the previous frame, the outstanding prefetch requests are cancelled (cos 30 deg)
+    constexpr double CourseChangeThreshold = 0.866;
+
+    // The smoothing factor that is applied to the measured camera velocity to avoid
+    // jumping predictions due to uneven frame times
+    constexpr double VelocitySmoothing = 0.5;
+
+    openspace::globebrowsing::TileIndex tileIndexAt(
+                                           const openspace::globebrowsing::Geodetic2& pos,
+                                                                                int level)
+    {
+        // The inverse of the mapping in GeodeticPatch(const TileIndex&)
+        const double delta = (2.0 * glm::pi<double>()) / static_cast<double>(1 << level);
+        const int nX = 1 << level;
+        const int nY = 1 << (level - 1);
+        const int x = static_cast<int>(std::floor((pos.lon + glm::pi<double>()) / delta));
+        const int y = static_cast<int>(
+            std::floor((glm::half_pi<double>() - pos.lat) / delta)
+        );
+        return openspace::globebrowsing::TileIndex(
+            static_cast<uint32_t>(std::clamp(x, 0, nX - 1)),
+            static_cast<uint32_t>(std::clamp(y, 0, nY - 1)),
+            static_cast<uint8_t>(level)
+        );
+    }
+
     struct [[codegen::Dictionary(RenderableGlobe)]] Parameters {
         // Specifies the radii for this planet. If the Double version of this is used, all
         // three radii are assumed to be equal
@@ -453,93 +534,13 @@ bool colorAvailableForChunk(const Chunk& chunk, const LayerManager& lm) {
     return true;
 }
 
-std::array<glm::dvec4, 8> boundingCornersForChunk(const Chunk& chunk,
-                                                  const Ellipsoid& ellipsoid,
-                                                  const BoundingHeights& heights)
-{
-    ZoneScoped;
-
-    // assume worst case
-    const double patchCenterRadius = ellipsoid.maximumRadius();
-
-    const double maxCenterRadius = patchCenterRadius + heights.max;
-    Geodetic2 halfSize = chunk.surfacePatch.halfSize();
-
-    // As the patch is curved, the maximum height offsets at the corners must be long
-    // enough to cover large enough to cover a heights.max at the center of the
-    // patch.
-    // Approximating scaleToCoverCenter by assuming the latitude and longitude angles
-    // of "halfSize" are equal to the angles they create from the center of the
-    // globe to the patch corners. This is true for the longitude direction when
-    // the ellipsoid can be approximated as a sphere and for the latitude for patches
-    // close to the equator. Close to the pole this will lead to a bigger than needed
-    // value for scaleToCoverCenter. However, this is a simple calculation and a good
-    // Approximation.
-    const double y1 = tan(halfSize.lat);
-    const double y2 = tan(halfSize.lon);
-    const double scaleToCoverCenter = sqrt(1 + pow(y1, 2) + pow(y2, 2));
-
-    const double maxCornerHeight = maxCenterRadius * scaleToCoverCenter -
-        patchCenterRadius;
-
-    const bool chunkIsNorthOfEquator = chunk.surfacePatch.isNorthern();
-
-    // The minimum height offset, however, we can simply
-    const double minCornerHeight = heights.min;
-    std::array<glm::dvec4, 8> corners;
-
-    const double latCloseToEquator = chunk.surfacePatch.edgeLatitudeNearestEquator();
-    const Geodetic3 p1Geodetic = {
-        { latCloseToEquator, chunk.surfacePatch.minLon() },
-        maxCornerHeight
-    };
-    const Geodetic3 p2Geodetic = {
-        { latCloseToEquator, chunk.surfacePatch.maxLon() },
-        maxCornerHeight
-    };
-
-    const glm::vec3 p1 = ellipsoid.cartesianPosition(p1Geodetic);
-    const glm::vec3 p2 = ellipsoid.cartesianPosition(p2Geodetic);
-    const glm::vec3 p = 0.5f * (p1 + p2);
-    const Geodetic2 pGeodetic = ellipsoid.cartesianToGeodetic2(p);
-    const double latDiff = latCloseToEquator - pGeodetic.lat;
-
-    for (size_t i = 0; i < 8; ++i) {
-        const Quad q = static_cast<Quad>(i % 4);
-        const double cornerHeight = i < 4 ? minCornerHeight : maxCornerHeight;
-        Geodetic3 cornerGeodetic = { chunk.surfacePatch.corner(q), cornerHeight };
-
-        const bool cornerIsNorthern = !((i / 2) % 2);
-        const bool cornerCloseToEquator = chunkIsNorthOfEquator ^ cornerIsNorthern;
-        if (cornerCloseToEquator) {
-            cornerGeodetic.geodetic2.lat += latDiff;
-        }
-
-        corners[i] = glm::dvec4(ellipsoid.cartesianPosition(cornerGeodetic), 1.0);
-    }
-
-    return corners;
-}
-
 void expand(AABB3& bb, const glm::vec3& p) {
     bb.min = glm::min(bb.min, p);
     bb.max = glm::max(bb.max, p);
 }
 
-bool intersects(const AABB3& bb, const AABB3& o) {
-    return (bb.min.x <= o.max.x) && (o.min.x <= bb.max.x)
-        && (bb.min.y <= o.max.y) && (o.min.y <= bb.max.y)
-        && (bb.min.z <= o.max.z) && (o.min.z <= bb.max.z);
-}
-
 } // namespace
 
-Chunk::Chunk(const TileIndex& ti)
-    : tileIndex(ti)
-    , surfacePatch(ti)
-    , status(Status::DoNothing)
-{}
-
 documentation::Documentation RenderableGlobe::Documentation() {
     return codegen::doc<Parameters>("globebrowsing_renderableglobe");
 }
@@ -571,6 +572,15 @@ RenderableGlobe::RenderableGlobe(const ghoul::Dictionary& dictionary)
     })
     , _debugPropertyOwner({ "Debug" })
     , _shadowMappingPropertyOwner({ "ShadowMapping" })
+    , _prefetchProperties({
+        BoolProperty(PrefetchEnabledInfo, true),
+        IntProperty(PrefetchBudgetInfo, 8, 0, 128),
+        FloatProperty(PrefetchLookAheadInfo, 1.f, 0.1f, 10.f),
+        IntProperty(PrefetchRequestsInfo, 0, 0, std::numeric_limits<int>::max()),
+        IntProperty(PrefetchHitsInfo, 0, 0, std::numeric_limits<int>::max()),
+        IntProperty(PrefetchWasteInfo, 0, 0, std::numeric_limits<int>::max())
+    })
+    , _prefetchPropertyOwner({ "Prefetching" })
     , _grid(DefaultSkirtedGridSegments, DefaultSkirtedGridSegments)
     , _leftRoot(Chunk(LeftHemisphereIndex))
     , _rightRoot(Chunk(RightHemisphereIndex))
@@ -671,13 +681,30 @@ RenderableGlobe::RenderableGlobe(const ghoul::Dictionary& dictionary)
     _debugProperties.showChunkEdges.onChange(notifyShaderRecompilation);
 
     _layerManager.onChange([this](Layer* l) {
+        _heightmapCache.clear();
         _shadersNeedRecompilation = true;
         _chunkCornersDirty = true;
         _nLayersIsDirty = true;
         _lastChangedLayer = l;
     });
 
+    _prefetchProperties.enabled.onChange([this]() {
+        if (!_prefetchProperties.enabled) {
+            cancelPrefetches();
+        }
+    });
+    _prefetchPropertyOwner.addProperty(_prefetchProperties.enabled);
+    _prefetchPropertyOwner.addProperty(_prefetchProperties.budget);
+    _prefetchPropertyOwner.addProperty(_prefetchProperties.lookAhead);
+    _prefetchProperties.requests.setReadOnly(true);
+    _prefetchPropertyOwner.addProperty(_prefetchProperties.requests);
+    _prefetchProperties.hits.setReadOnly(true);
+    _prefetchPropertyOwner.addProperty(_prefetchProperties.hits);
+    _prefetchProperties.waste.setReadOnly(true);
+    _prefetchPropertyOwner.addProperty(_prefetchProperties.waste);
+
     addPropertySubOwner(_debugPropertyOwner);
+    addPropertySubOwner(_prefetchPropertyOwner);
     addPropertySubOwner(_layerManager);
 
     _globalChunkBuffer.resize(2048);
@@ -738,6 +765,7 @@ void RenderableGlobe::initializeGL() {
 }
 
 void RenderableGlobe::deinitialize() {
+    _heightmapCache.clear();
     _layerManager.deinitialize();
 }
 
@@ -929,6 +957,7 @@ void RenderableGlobe::update(const UpdateData& data) {
 
     if (_debugProperties.resetTileProviders) {
         _layerManager.reset();
+        _heightmapCache.clear();
         _debugProperties.resetTileProviders = false;
     }
 
@@ -955,6 +984,8 @@ void RenderableGlobe::update(const UpdateData& data) {
     //                           // LayerManager hasn't updated yet :o
     _layerManagerDirty = true;
 
+    prefetchTiles();
+
     _geoJsonManager.update();
 }
 
@@ -986,6 +1017,136 @@ const glm::dmat4& RenderableGlobe::modelTransform() const {
     return _cachedModelTransform;
 }
 
+void RenderableGlobe::prefetchTiles() {
+    ZoneScoped;
+
+    const Camera* camera = global::navigationHandler->camera();
+    if (!_prefetchProperties.enabled || !camera) {
+        return;
+    }
+
+    // Calculations are done in the reference frame of the globe. Hence, the camera
+    // position needs to be transformed with the inverse model matrix. This also means
+    // that the rotation of the globe underneath a still camera is considered a movement
+    const glm::dvec3 position = glm::dvec3(
+        _cachedInverseModelTransform * glm::dvec4(camera->positionVec3(), 1.0)
+    );
+    const double now = global::windowDelegate->applicationTime();
+
+    if (!_prefetchState.time.has_value() || now <= *_prefetchState.time) {
+        _prefetchState.cameraPosition = position;
+        _prefetchState.time = now;
+        return;
+    }
+
+    const double dt = now - *_prefetchState.time;
+    const glm::dvec3 measuredVelocity = (position - _prefetchState.cameraPosition) / dt;
+    const glm::dvec3 previousVelocity = _prefetchState.cameraVelocity;
+    _prefetchState.cameraPosition = position;
+    _prefetchState.cameraVelocity =
+        glm::mix(previousVelocity, measuredVelocity, VelocitySmoothing);
+    _prefetchState.time = now;
+
+    const double measuredSpeed = glm::length(measuredVelocity);
+    const double previousSpeed = glm::length(previousVelocity);
+    if (measuredSpeed > 0.0 && previousSpeed > 0.0) {
+        const double course = glm::dot(measuredVelocity, previousVelocity) /
+            (measuredSpeed * previousSpeed);
+        if (course < CourseChangeThreshold) {
+            // The tiles we asked for previously are most likely not needed anymore
+            cancelPrefetches();
+            _prefetchState.cameraVelocity = measuredVelocity;
+        }
+    }
+
+    const double lookAhead = _prefetchProperties.lookAhead;
+    const glm::dvec3 predicted = position + _prefetchState.cameraVelocity * lookAhead;
+
+    // Use the same heuristic as the distance-based chunk level evaluation, but ignoring
+    // the height map as the predicted position might not have any height data loaded yet
+    const Geodetic2 predictedGeodetic = _ellipsoid.cartesianToGeodetic2(predicted);
+    const glm::dvec3 surface = _ellipsoid.cartesianSurfacePosition(predictedGeodetic);
+    const double distance = std::max(
+        glm::length(predicted) - glm::length(surface),
+        1.0
+    );
+    const double scaleFactor =
+        _generalProperties.currentLodScaleFactor * _ellipsoid.minimumRadius();
+    const int level = std::clamp(
+        static_cast<int>(std::ceil(std::log2(scaleFactor / distance))),
+        MinSplitDepth,
+        MaxSplitDepth
+    );
+
+    // The candidates are enqueued from the finest to the coarsest level. The most
+    // recently enqueued tile is loaded first, so the coarser tiles that cover the
+    // predicted area will be available first
+    std::vector<TileIndex> candidates;
+    const TileIndex center = tileIndexAt(predictedGeodetic, level);
+    const int nX = 1 << level;
+    const int nY = 1 << (level - 1);
+    for (int dy = -1; dy <= 1; dy++) {
+        const int y = static_cast<int>(center.y) + dy;
+        if (y < 0 || y >= nY) {
+            continue;
+        }
+        for (int dx = -1; dx <= 1; dx++) {
+            // Wrap around the anti meridian
+            const int x = (static_cast<int>(center.x) + dx + nX) % nX;
+            candidates.emplace_back(
+                static_cast<uint32_t>(x),
+                static_cast<uint32_t>(y),
+                static_cast<uint8_t>(level)
+            );
+        }
+    }
+    for (int l = level - 1; l >= std::max(level - 2, MinSplitDepth); l--) {
+        candidates.push_back(tileIndexAt(predictedGeodetic, l));
+    }
+
+    int budget = _prefetchProperties.budget;
+    PrefetchCounters counters;
+    for (const LayerGroup* layerGroup : _layerManager.layerGroups()) {
+        for (const Layer* layer : layerGroup->activeLayers()) {
+            TileProvider* provider = layer->tileProvider();
+            if (!provider || !provider->isInitialized) {
+                continue;
+            }
+
+            for (const TileIndex& tileIndex : candidates) {
+                if (budget <= 0) {
+                    break;
+                }
+                if (provider->prefetchTile(tileIndex)) {
+                    budget--;
+                }
+            }
+
+            counters.requests += provider->prefetchCounters.requests;
+            counters.hits += provider->prefetchCounters.hits;
+            counters.waste += provider->prefetchCounters.waste;
+        }
+    }
+
+    auto toInt = [](uint64_t v) {
+        return static_cast<int>(std::min<uint64_t>(v, std::numeric_limits<int>::max()));
+    };
+    _prefetchProperties.requests = toInt(counters.requests);
+    _prefetchProperties.hits = toInt(counters.hits);
+    _prefetchProperties.waste = toInt(counters.waste);
+}
+
+void RenderableGlobe::cancelPrefetches() {
+    for (const LayerGroup* layerGroup : _layerManager.layerGroups()) {
+        for (const Layer* layer : layerGroup->activeLayers()) {
+            TileProvider* provider = layer->tileProvider();
+            if (provider && provider->isInitialized) {
+                provider->cancelPrefetches();
+            }
+        }
+    }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////
 //  Rendering code
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1111,9 +1272,35 @@ void RenderableGlobe::renderChunks(const RenderData& data, RendererTasks&,
         viewTransform;
     const glm::dmat4 mvp = vp * _cachedModelTransform;
 
+    ChunkView view;
+    view.modelViewProjection = mvp;
+    // Calculations are done in the reference frame of the globe. Hence, the camera
+    // position needs to be transformed with the inverse model matrix
+    view.cameraPosition = glm::dvec3(
+        _cachedInverseModelTransform * glm::dvec4(data.camera.positionVec3(), 1.0)
+    );
+    view.cameraGeodetic = _ellipsoid.cartesianToGeodetic2(view.cameraPosition);
+    view.lodScaleFactor = _generalProperties.currentLodScaleFactor;
+    view.levelByProjectedArea = _debugProperties.levelByProjectedAreaElseDistance;
+    view.performHorizonCulling = PreformHorizonCulling;
+    view.performFrustumCulling = _debugProperties.performFrustumCulling;
+    view.updateCorners = _chunkCornersDirty;
+    view.minLevel = MinSplitDepth;
+    view.maxLevel = MaxSplitDepth;
+
     _allChunksAvailable = true;
-    updateChunkTree(_leftRoot, data, mvp);
-    updateChunkTree(_rightRoot, data, mvp);
+    collectChunks(_leftRoot);
+    collectChunks(_rightRoot);
+    evaluateChunks(
+        _chunkEvaluations,
+        _ellipsoid,
+        view,
+        global::moduleEngine->module<GlobeBrowsingModule>()->chunkThreadPool()
+    );
+    updateChunkTree(_leftRoot);
+    updateChunkTree(_rightRoot);
+    // Merging the chunk tree might have freed some of the evaluated chunks
+    _chunkEvaluations.clear();
     _chunkCornersDirty = false;
     _iterationsOfAvailableData =
         (_allChunksAvailable ? _iterationsOfAvailableData + 1 : 0);
@@ -1891,187 +2078,251 @@ SurfacePositionHandle RenderableGlobe::calculateSurfacePositionHandle(
     };
 }
 
-bool RenderableGlobe::testIfCullable(const Chunk& chunk,
-                                     const RenderData& renderData,
-                                     const BoundingHeights& heights,
-                                     const glm::dmat4& mvp) const
-{
-    ZoneScoped;
-
-    return (PreformHorizonCulling && isCullableByHorizon(chunk, renderData, heights)) ||
-           (_debugProperties.performFrustumCulling && isCullableByFrustum(chunk, renderData, mvp));
+float RenderableGlobe::getHeight(const glm::dvec3& position) const {
+    float height = 0.f;
+    getHeights(std::span(&position, 1), std::span(&height, 1));
+    return height;
 }
 
-int RenderableGlobe::desiredLevel(const Chunk& chunk, const RenderData& renderData,
-                                  const BoundingHeights& heights) const
+void RenderableGlobe::getHeights(std::span<const glm::dvec3> positions,
+                                 std::span<float> heights) const
 {
     ZoneScoped;
 
-    const int desiredLevel = _debugProperties.levelByProjectedAreaElseDistance ?
-        desiredLevelByProjectedArea(chunk, renderData, heights) :
-        desiredLevelByDistance(chunk, renderData, heights);
-    const int levelByAvailableData = desiredLevelByAvailableTileData(chunk);
-
-    if (LimitLevelByAvailableData && (levelByAvailableData != UnknownDesiredLevel)) {
-        const int l = glm::min(desiredLevel, levelByAvailableData);
-        return glm::clamp(l, MinSplitDepth, MaxSplitDepth);
-    }
-    else {
-        return glm::clamp(desiredLevel, MinSplitDepth, MaxSplitDepth);
-    }
-}
-
-float RenderableGlobe::getHeight(const glm::dvec3& position) const {
-    ZoneScoped;
-
-    float height = 0;
-
-    // Get the uv coordinates to sample from
-    const Geodetic2 geodeticPosition = _ellipsoid.cartesianToGeodetic2(position);
-    const Chunk& node = geodeticPosition.lon < Coverage.center().lon ?
-        findChunkNode(_leftRoot, geodeticPosition) :
-        findChunkNode(_rightRoot, geodeticPosition);
-    const int chunkLevel = node.tileIndex.level;
-
+    ghoul_assert(positions.size() == heights.size(), "Mismatching number of heights");
 
-    const int numIndicesAtLevel = 1 << chunkLevel;
-    const double u = 0.5 + geodeticPosition.lon / glm::two_pi<double>();
-    const double v = 0.25 - geodeticPosition.lat / glm::two_pi<double>();
-    const double xIndexSpace = u * numIndicesAtLevel;
-    const double yIndexSpace = v * numIndicesAtLevel;
-
-    const int x = static_cast<int>(floor(xIndexSpace));
-    const int y = static_cast<int>(floor(yIndexSpace));
-
-    ghoul_assert(chunkLevel < std::numeric_limits<uint8_t>::max(), "Too high level");
-    const TileIndex tileIndex(x, y, static_cast<uint8_t>(chunkLevel));
-    const GeodeticPatch patch = GeodeticPatch(tileIndex);
+    struct HeightSample {
+        TileIndex tileIndex;
+        glm::vec2 patchUV;
+        size_t index;
+    };
+    std::vector<HeightSample> samples;
+    samples.reserve(positions.size());
+
+    for (size_t i = 0; i < positions.size(); i++) {
+        // Get the uv coordinates to sample from
+        const Geodetic2 geodeticPosition = _ellipsoid.cartesianToGeodetic2(positions[i]);
+        const Chunk& node = geodeticPosition.lon < Coverage.center().lon ?
+            findChunkNode(_leftRoot, geodeticPosition) :
+            findChunkNode(_rightRoot, geodeticPosition);
+        const int chunkLevel = node.tileIndex.level;
+
+        const int numIndicesAtLevel = 1 << chunkLevel;
+        const double u = 0.5 + geodeticPosition.lon / glm::two_pi<double>();
+        const double v = 0.25 - geodeticPosition.lat / glm::two_pi<double>();
+        const double xIndexSpace = u * numIndicesAtLevel;
+        const double yIndexSpace = v * numIndicesAtLevel;
+
+        const int x = static_cast<int>(floor(xIndexSpace));
+        const int y = static_cast<int>(floor(yIndexSpace));
+
+        ghoul_assert(chunkLevel < std::numeric_limits<uint8_t>::max(), "Too high level");
+        const TileIndex tileIndex(x, y, static_cast<uint8_t>(chunkLevel));
+        const GeodeticPatch patch = GeodeticPatch(tileIndex);
+
+        const Geodetic2 northEast = patch.corner(Quad::NORTH_EAST);
+        const Geodetic2 southWest = patch.corner(Quad::SOUTH_WEST);
+
+        const Geodetic2 geoDiffPatch = {
+            .lat = northEast.lat - southWest.lat,
+            .lon = northEast.lon - southWest.lon
+        };
 
-    const Geodetic2 northEast = patch.corner(Quad::NORTH_EAST);
-    const Geodetic2 southWest = patch.corner(Quad::SOUTH_WEST);
+        const Geodetic2 geoDiffPoint = {
+            .lat = geodeticPosition.lat - southWest.lat,
+            .lon = geodeticPosition.lon - southWest.lon
+        };
+        const glm::vec2 patchUV = glm::vec2(
+            geoDiffPoint.lon / geoDiffPatch.lon,
+            geoDiffPoint.lat / geoDiffPatch.lat
+        );
 
-    const Geodetic2 geoDiffPatch = {
-        .lat = northEast.lat - southWest.lat,
-        .lon = northEast.lon - southWest.lon
-    };
+        samples.push_back({ tileIndex, patchUV, i });
+        heights[i] = 0.f;
+    }
 
-    const Geodetic2 geoDiffPoint = {
-        .lat = geodeticPosition.lat - southWest.lat,
-        .lon = geodeticPosition.lon - southWest.lon
-    };
-    const glm::vec2 patchUV = glm::vec2(
-        geoDiffPoint.lon / geoDiffPatch.lon,
-        geoDiffPoint.lat / geoDiffPatch.lat
+    // Group the positions by the tile they fall into so that every height layer only has
+    // to be queried once per tile rather than once per position
+    std::sort(
+        samples.begin(),
+        samples.end(),
+        [](const HeightSample& lhs, const HeightSample& rhs) {
+            return lhs.tileIndex.hashKey() < rhs.tileIndex.hashKey();
+        }
     );
 
     // Get the tile providers for the height maps
     const std::vector<Layer*>& heightMapLayers =
         _layerManager.layerGroup(layers::Group::ID::HeightLayers).activeLayers();
 
-    for (Layer* layer : heightMapLayers) {
-        TileProvider* tileProvider = layer->tileProvider();
-        if (!tileProvider) {
-            continue;
-        }
-        // Transform the uv coordinates to the current tile texture
-        const ChunkTile chunkTile = tileProvider->chunkTile(tileIndex);
-        const Tile& tile = chunkTile.tile;
-        const TileUvTransform& uvTransform = chunkTile.uvTransform;
-        const TileDepthTransform& depthTransform = tileProvider->depthTransform();
-        if (tile.status != Tile::Status::OK) {
-            return 0;
-        }
+    auto begin = samples.begin();
+    while (begin != samples.end()) {
+        const TileIndex tileIndex = begin->tileIndex;
+        const auto end = std::find_if(
+            begin,
+            samples.end(),
+            [&tileIndex](const HeightSample& s) { return !(s.tileIndex == tileIndex); }
+        );
+        const std::span<const HeightSample> tileSamples = std::span(begin, end);
+        begin = end;
 
-        ghoul::opengl::Texture* tileTexture = tile.texture;
-        if (!tileTexture) {
-            return 0;
-        }
+        for (Layer* layer : heightMapLayers) {
+            TileProvider* tileProvider = layer->tileProvider();
+            if (!tileProvider) {
+                continue;
+            }
+            const TileDepthTransform& depthTransform = tileProvider->depthTransform();
+            const float noDataValue = tileProvider->noDataValueAsFloat();
 
-        glm::vec2 transformedUv = layer->tileUvToTextureSamplePosition(
-            uvTransform,
-            patchUV,
-            glm::uvec2(tileTexture->dimensions())
-        );
+            // Only the tiles of static tile providers are kept in the heightmap cache as
+            // the tiles of all other providers might change from one frame to the next
+            const bool isCacheable =
+                dynamic_cast<DefaultTileProvider*>(tileProvider) != nullptr;
 
-        // Sample and do linear interpolation
-        // (could possibly be moved as a function in ghoul texture)
-        // Suggestion: a function in ghoul::opengl::Texture that takes uv coordinates
-        // in range [0,1] and uses the set interpolation method and clamping.
+            TileUvTransform uvTransform = {
+                .uvOffset = glm::vec2(0.f, 0.f),
+                .uvScale = glm::vec2(1.f, 1.f)
+            };
+            const cache::Heightmap* heightmap = nullptr;
+            const ghoul::opengl::Texture* tileTexture = nullptr;
+            if (isCacheable) {
+                heightmap = _heightmapCache.get({
+                    .tileIndex = tileIndex,
+                    .providerID = tileProvider->uniqueIdentifier
+                });
+            }
 
-        const glm::uvec3 dimensions = tileTexture->dimensions();
+            if (!heightmap) {
+                // Transform the uv coordinates to the current tile texture
+                const ChunkTile chunkTile = tileProvider->chunkTile(tileIndex);
+                const Tile& tile = chunkTile.tile;
+                if (tile.status != Tile::Status::OK || !tile.texture) {
+                    for (const HeightSample& s : tileSamples) {
+                        heights[s.index] = 0.f;
+                    }
+                    break;
+                }
 
-        glm::vec2 samplePos = transformedUv * glm::vec2(dimensions);
-        // @TODO (emmbr, 2023-06-14) This 0.5f offset was added as a bandaid for issue
-        // #2696. It seems to improve the behavior, but I am not certain of why. And the
-        // underlying problem is still there and should at some point be looked at again
-        samplePos -= glm::vec2(0.5f);
+                uvTransform = chunkTile.uvTransform;
+                tileTexture = tile.texture;
 
-        glm::uvec2 samplePos00 = samplePos;
-        samplePos00 = glm::clamp(
-            samplePos00,
-            glm::uvec2(0, 0),
-            glm::uvec2(dimensions) - glm::uvec2(1)
-        );
-        const glm::vec2 samplePosFract = samplePos - glm::vec2(samplePos00);
+                if (isCacheable) {
+                    // The provided tile might belong to an ancestor of the requested
+                    // tile, in which case the number of levels between them is encoded
+                    // in the scale of the uv transform
+                    const int n = static_cast<int>(
+                        std::round(std::log2(1.f / uvTransform.uvScale.x))
+                    );
+                    const cache::ProviderTileKey key = {
+                        .tileIndex = TileIndex(
+                            tileIndex.x >> n,
+                            tileIndex.y >> n,
+                            static_cast<uint8_t>(tileIndex.level - n)
+                        ),
+                        .providerID = tileProvider->uniqueIdentifier
+                    };
+                    heightmap = _heightmapCache.get(key);
+                    if (!heightmap) {
+                        heightmap = _heightmapCache.put(key, *tileTexture);
+                    }
+                }
+            }
 
-        const glm::uvec2 samplePos10 = glm::min(
-            samplePos00 + glm::uvec2(1, 0),
-            glm::uvec2(dimensions) - glm::uvec2(1)
-        );
-        const glm::uvec2 samplePos01 = glm::min(
-            samplePos00 + glm::uvec2(0, 1),
-            glm::uvec2(dimensions) - glm::uvec2(1)
-        );
-        const glm::uvec2 samplePos11 = glm::min(
-            samplePos00 + glm::uvec2(1, 1),
-            glm::uvec2(dimensions) - glm::uvec2(1)
-        );
+            const glm::uvec2 dimensions = heightmap ?
+                heightmap->dimensions :
+                glm::uvec2(tileTexture->dimensions());
+            auto texel = [heightmap, tileTexture](const glm::uvec2& p) {
+                return heightmap ? heightmap->texel(p) : tileTexture->texelAsFloat(p).x;
+            };
 
-        const float sample00 = tileTexture->texelAsFloat(samplePos00).x;
-        const float sample10 = tileTexture->texelAsFloat(samplePos10).x;
-        const float sample01 = tileTexture->texelAsFloat(samplePos01).x;
-        const float sample11 = tileTexture->texelAsFloat(samplePos11).x;
-
-        // In case the texture has NaN or no data values don't use this height map.
-        const bool anySampleIsNaN =
-            std::isnan(sample00) ||
-            std::isnan(sample01) ||
-            std::isnan(sample10) ||
-            std::isnan(sample11);
-
-        const bool anySampleIsNoData =
-            sample00 == tileProvider->noDataValueAsFloat() ||
-            sample01 == tileProvider->noDataValueAsFloat() ||
-            sample10 == tileProvider->noDataValueAsFloat() ||
-            sample11 == tileProvider->noDataValueAsFloat();
-
-        if (anySampleIsNaN || anySampleIsNoData) {
-            continue;
-        }
+            for (const HeightSample& s : tileSamples) {
+                const glm::vec2 transformedUv = layer->tileUvToTextureSamplePosition(
+                    uvTransform,
+                    s.patchUV,
+                    dimensions
+                );
+
+                // Sample and do linear interpolation
+                // (could possibly be moved as a function in ghoul texture)
+                // Suggestion: a function in ghoul::opengl::Texture that takes uv
+                // coordinates in range [0,1] and uses the set interpolation method and
+                // clamping.
+
+                glm::vec2 samplePos = transformedUv * glm::vec2(dimensions);
+                // @TODO (emmbr, 2023-06-14) This 0.5f offset was added as a bandaid for
+                // issue #2696. It seems to improve the behavior, but I am not certain of
+                // why. And the underlying problem is still there and should at some
+                // point be looked at again
+                samplePos -= glm::vec2(0.5f);
+
+                glm::uvec2 samplePos00 = samplePos;
+                samplePos00 = glm::clamp(
+                    samplePos00,
+                    glm::uvec2(0, 0),
+                    dimensions - glm::uvec2(1)
+                );
+                const glm::vec2 samplePosFract = samplePos - glm::vec2(samplePos00);
+
+                const glm::uvec2 samplePos10 = glm::min(
+                    samplePos00 + glm::uvec2(1, 0),
+                    dimensions - glm::uvec2(1)
+                );
+                const glm::uvec2 samplePos01 = glm::min(
+                    samplePos00 + glm::uvec2(0, 1),
+                    dimensions - glm::uvec2(1)
+                );
+                const glm::uvec2 samplePos11 = glm::min(
+                    samplePos00 + glm::uvec2(1, 1),
+                    dimensions - glm::uvec2(1)
+                );
+
+                const float sample00 = texel(samplePos00);
+                const float sample10 = texel(samplePos10);
+                const float sample01 = texel(samplePos01);
+                const float sample11 = texel(samplePos11);
+
+                // In case the texture has NaN or no data values don't use this height map
+                const bool anySampleIsNaN =
+                    std::isnan(sample00) ||
+                    std::isnan(sample01) ||
+                    std::isnan(sample10) ||
+                    std::isnan(sample11);
+
+                const bool anySampleIsNoData =
+                    sample00 == noDataValue ||
+                    sample01 == noDataValue ||
+                    sample10 == noDataValue ||
+                    sample11 == noDataValue;
+
+                if (anySampleIsNaN || anySampleIsNoData) {
+                    continue;
+                }
 
-        const float sample0 = sample00 * (1.f - samplePosFract.x) +
-            sample10 * samplePosFract.x;
-        const float sample1 = sample01 * (1.f - samplePosFract.x) +
-            sample11 * samplePosFract.x;
-
-        const float sample = sample0 * (1.f - samplePosFract.y) +
-            sample1 * samplePosFract.y;
-
-        // Same as is used in the shader. This is not a perfect solution but
-        // if the sample is actually a no-data-value (min_float) the interpolated
-        // value might not be. Therefore we have a cut-off. Assuming no data value
-        // is smaller than -100000
-        if (sample > -100000) {
-            // Perform depth transform to get the value in meters
-            height = depthTransform.offset + depthTransform.scale * sample;
-            // Make sure that the height value follows the layer settings.
-            // For example if the multiplier is set to a value bigger than one,
-            // the sampled height should be modified as well.
-            height = layer->renderSettings().performLayerSettings(height);
+                const float sample0 = sample00 * (1.f - samplePosFract.x) +
+                    sample10 * samplePosFract.x;
+                const float sample1 = sample01 * (1.f - samplePosFract.x) +
+                    sample11 * samplePosFract.x;
+
+                const float sample = sample0 * (1.f - samplePosFract.y) +
+                    sample1 * samplePosFract.y;
+
+                // Same as is used in the shader. This is not a perfect solution but
+                // if the sample is actually a no-data-value (min_float) the interpolated
+                // value might not be. Therefore we have a cut-off. Assuming no data value
+                // is smaller than -100000
+                if (sample > -100000) {
+                    // Perform depth transform to get the value in meters
+                    const float height =
+                        depthTransform.offset + depthTransform.scale * sample;
+                    // Make sure that the height value follows the layer settings.
+                    // For example if the multiplier is set to a value bigger than one,
+                    // the sampled height should be modified as well.
+                    heights[s.index] =
+                        layer->renderSettings().performLayerSettings(height);
+                }
+            }
         }
     }
-    // Return the result
-    return height;
 }
 
 void RenderableGlobe::calculateEclipseShadows(ghoul::opengl::ProgramObject& programObject,
@@ -2236,127 +2487,6 @@ void RenderableGlobe::calculateEclipseShadows(ghoul::opengl::ProgramObject& prog
 //  Desired Level
 //////////////////////////////////////////////////////////////////////////////////////////
 
-int RenderableGlobe::desiredLevelByDistance(const Chunk& chunk,
-                                            const RenderData& data,
-                                            const BoundingHeights& heights) const
-{
-    ZoneScoped;
-
-    // Calculations are done in the reference frame of the globe
-    // (model space). Hence, the camera position needs to be transformed
-    // with the inverse model matrix
-    const glm::dvec3 cameraPosition = glm::dvec3(_cachedInverseModelTransform *
-        glm::dvec4(data.camera.positionVec3(), 1.0));
-
-    const Geodetic2 pointOnPatch = chunk.surfacePatch.closestPoint(
-        _ellipsoid.cartesianToGeodetic2(cameraPosition)
-    );
-    const glm::dvec3 patchNormal = _ellipsoid.geodeticSurfaceNormal(pointOnPatch);
-    glm::dvec3 patchPosition = _ellipsoid.cartesianSurfacePosition(pointOnPatch);
-
-    const double heightToChunk = heights.min;
-
-    // Offset position according to height
-    patchPosition += patchNormal * heightToChunk;
-
-    const glm::dvec3 cameraToChunk = patchPosition - cameraPosition;
-
-    // Calculate desired level based on distance
-    const double distanceToPatch = glm::length(cameraToChunk);
-    const double distance = distanceToPatch;
-
-    const double scaleFactor = _generalProperties.currentLodScaleFactor *
-        _ellipsoid.minimumRadius();
-    const double projectedScaleFactor = scaleFactor / distance;
-    const int desiredLevel = static_cast<int>(ceil(log2(projectedScaleFactor)));
-    return desiredLevel;
-}
-
-int RenderableGlobe::desiredLevelByProjectedArea(const Chunk& chunk,
-                                                 const RenderData& data,
-                                                 const BoundingHeights& heights) const
-{
-    ZoneScoped;
-
-    // Calculations are done in the reference frame of the globe
-    // (model space). Hence, the camera position needs to be transformed
-    // with the inverse model matrix
-    const glm::dvec3 cameraPosition = glm::dvec3(
-        _cachedInverseModelTransform * glm::dvec4(data.camera.positionVec3(), 1.0)
-    );
-
-    // Approach:
-    // The projected area of the chunk will be calculated based on a small area that
-    // is close to the camera, and the scaled up to represent the full area.
-    // The advantage of doing this is that it will better handle the cases where the
-    // full patch is very curved (e.g. stretches from latitude 0 to 90 deg).
-
-    const Geodetic2 closestCorner = chunk.surfacePatch.closestCorner(
-        _ellipsoid.cartesianToGeodetic2(cameraPosition)
-    );
-
-    //  Camera
-    //  |
-    //  V
-    //
-    //  oo
-    // [  ]<
-    //                     *geodetic space*
-    //
-    //   closestCorner
-    //    +-----------------+  <-- north east corner
-    //    |                 |
-    //    |      center     |
-    //    |                 |
-    //    +-----------------+  <-- south east corner
-
-    const Geodetic2 center = chunk.surfacePatch.center();
-    const Geodetic3 c = { center, heights.min };
-    const Geodetic3 c1 = { Geodetic2{ center.lat, closestCorner.lon }, heights.min };
-    const Geodetic3 c2 = { Geodetic2{ closestCorner.lat, center.lon }, heights.min };
-
-    //  Camera
-    //  |
-    //  V
-    //
-    //  oo
-    // [  ]<
-    //                     *geodetic space*
-    //
-    //    +--------c2-------+  <-- north east corner
-    //    |                 |
-    //    c1       c        |
-    //    |                 |
-    //    +-----------------+  <-- south east corner
-
-
-    // Go from geodetic to cartesian space and project onto unit sphere
-    const glm::dvec3 camToCenter = -cameraPosition;
-    const glm::dvec3 A = glm::normalize(camToCenter + _ellipsoid.cartesianPosition(c));
-    const glm::dvec3 B = glm::normalize(camToCenter + _ellipsoid.cartesianPosition(c1));
-    const glm::dvec3 C = glm::normalize(camToCenter + _ellipsoid.cartesianPosition(c2));
-
-    // Camera                      *cartesian space*
-    // |                    +--------+---+
-    // V             __--''   __--''    /
-    //              C-------A--------- +
-    // oo          /       /          /
-    //[  ]<       +-------B----------+
-    //
-
-    // If the geodetic patch is small (i.e. has small width), that means the patch in
-    // cartesian space will be almost flat, and in turn, the triangle ABC will roughly
-    // correspond to 1/8 of the full area
-    const glm::dvec3 AB = B - A;
-    const glm::dvec3 AC = C - A;
-    const double areaABC = 0.5 * glm::length(glm::cross(AC, AB));
-    const double projectedChunkAreaApprox = 8 * areaABC;
-
-    const double scaledArea = _generalProperties.currentLodScaleFactor *
-                              projectedChunkAreaApprox;
-    return chunk.tileIndex.level + static_cast<int>(round(scaledArea - 1));
-}
-
 int RenderableGlobe::desiredLevelByAvailableTileData(const Chunk& chunk) const {
     ZoneScoped;
 
@@ -2377,101 +2507,6 @@ int RenderableGlobe::desiredLevelByAvailableTileData(const Chunk& chunk) const {
     return currLevel - 1;
 }
 
-//////////////////////////////////////////////////////////////////////////////////////////
-//  Culling
-//////////////////////////////////////////////////////////////////////////////////////////
-
-bool RenderableGlobe::isCullableByFrustum(const Chunk& chunk,
-                                          const RenderData&,
-                                          const glm::dmat4& mvp) const
-{
-    ZoneScoped;
-
-    const std::array<glm::dvec4, 8>& corners = chunk.corners;
-
-    // Create a bounding box that fits the patch corners
-    AABB3 bounds; // in screen space
-    for (size_t i = 0; i < 8; ++i) {
-        const glm::dvec4 cornerClippingSpace = mvp * corners[i];
-        const glm::dvec3 ndc = glm::dvec3(
-            (1.f / glm::abs(cornerClippingSpace.w)) * cornerClippingSpace
-        );
-        expand(bounds, ndc);
-    }
-
-    return !(intersects(CullingFrustum, bounds));
-}
-
-bool RenderableGlobe::isCullableByHorizon(const Chunk& chunk,
-                                          const RenderData& renderData,
-                                          const BoundingHeights& heights) const
-{
-    ZoneScoped;
-
-    // Calculations are done in the reference frame of the globe. Hence, the camera
-    // position needs to be transformed with the inverse model matrix
-    const GeodeticPatch& patch = chunk.surfacePatch;
-    const float maxHeight = heights.max;
-    const glm::dvec3 globePos = glm::dvec3(0.0, 0.0, 0.0); // In model space it is 0
-    const double minimumGlobeRadius = _ellipsoid.minimumRadius();
-
-    const glm::dvec3 cameraPos = glm::dvec3(
-        _cachedInverseModelTransform * glm::dvec4(renderData.camera.positionVec3(), 1.0)
-    );
-
-    const glm::dvec3 globeToCamera = cameraPos;
-
-    const Geodetic2 camPosOnGlobe = _ellipsoid.cartesianToGeodetic2(globeToCamera);
-    const Geodetic2 closestPatchPoint = patch.closestPoint(camPosOnGlobe);
-    glm::dvec3 objectPos = _ellipsoid.cartesianSurfacePosition(closestPatchPoint);
-
-    // objectPosition is closest in latlon space but not guaranteed to be closest in
-    // castesian coordinates. Therefore we compare it to the corners and pick the
-    // real closest point,
-    std::array<glm::dvec3, 4> corners = {
-        _ellipsoid.cartesianSurfacePosition(chunk.surfacePatch.corner(NORTH_WEST)),
-        _ellipsoid.cartesianSurfacePosition(chunk.surfacePatch.corner(NORTH_EAST)),
-        _ellipsoid.cartesianSurfacePosition(chunk.surfacePatch.corner(SOUTH_WEST)),
-        _ellipsoid.cartesianSurfacePosition(chunk.surfacePatch.corner(SOUTH_EAST))
-    };
-
-    for (int i = 0; i < 4; ++i) {
-        const double distance = glm::length(cameraPos - corners[i]);
-        if (distance < glm::length(cameraPos - objectPos)) {
-            objectPos = corners[i];
-        }
-    }
-
-
-    const double objectP = pow(length(objectPos - globePos), 2);
-    const double horizonP = pow(minimumGlobeRadius - maxHeight, 2);
-    if (objectP < horizonP) {
-        return false;
-    }
-
-    const double cameraP = pow(length(cameraPos - globePos), 2);
-    const double minR = pow(minimumGlobeRadius, 2);
-    if (cameraP < minR) {
-        return false;
-    }
-
-    const double minimumAllowedDistanceToObjectFromHorizon = sqrt(objectP - horizonP);
-    const double distanceToHorizon = sqrt(cameraP - minR);
-
-    // Minimum allowed for the object to be occluded
-    const double minimumAllowedDistanceToObjectSquared =
-        pow(distanceToHorizon + minimumAllowedDistanceToObjectFromHorizon, 2) +
-        pow(maxHeight, 2);
-
-    const double distanceToObjectSquared = pow(
-        length(objectPos - cameraPos),
-        2
-    );
-    return distanceToObjectSquared > minimumAllowedDistanceToObjectSquared;
-}
-
-
-
 //////////////////////////////////////////////////////////////////////////////////////////
 //  Chunk node handling
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -2530,9 +2565,32 @@ void RenderableGlobe::mergeChunkNode(Chunk& cn) {
     cn.children.fill(nullptr);
 }
 
-bool RenderableGlobe::updateChunkTree(Chunk& cn, const RenderData& data,
-                                      const glm::dmat4& mvp)
-{
+void RenderableGlobe::collectChunks(Chunk& cn) {
+    ZoneScoped;
+
+    // The tile providers are not thread-safe, so all information that is needed from
+    // the layers is gathered here on the main thread before the chunks are evaluated
+    ChunkEvaluation evaluation;
+    evaluation.chunk = &cn;
+    evaluation.heights = boundingHeightsForChunk(cn, _layerManager);
+    if (LimitLevelByAvailableData) {
+        const int levelByAvailableData = desiredLevelByAvailableTileData(cn);
+        if (levelByAvailableData != UnknownDesiredLevel) {
+            evaluation.levelByAvailableData = levelByAvailableData;
+        }
+    }
+    cn.heightTileOK = evaluation.heights.tileOK;
+    cn.colorTileOK = colorAvailableForChunk(cn, _layerManager);
+    _chunkEvaluations.push_back(std::move(evaluation));
+
+    if (!isLeaf(cn)) {
+        for (Chunk* child : cn.children) {
+            collectChunks(*child);
+        }
+    }
+}
+
+bool RenderableGlobe::updateChunkTree(Chunk& cn) {
     ZoneScoped;
 
     // abock:  I tried turning this into a queue and use iteration, rather than recursion
@@ -2540,9 +2598,11 @@ bool RenderableGlobe::updateChunkTree(Chunk& cn, const RenderData& data,
     //         requires parents to be passed through the pipe twice (first to add the
     //         children and then again it self to be processed after the children finish).
     //         In addition, this didn't even improve performance ---  2018-10-04
+    //
+    // The status of all chunks has already been computed in evaluateChunks, so this only
+    // applies the resulting splits and merges to the tree
     if (isLeaf(cn)) {
         ZoneScopedN("leaf");
-        updateChunk(cn, data, mvp);
 
         if (cn.status == Chunk::Status::WantSplit) {
             splitChunkNode(cn, 1);
@@ -2558,13 +2618,12 @@ bool RenderableGlobe::updateChunkTree(Chunk& cn, const RenderData& data,
         ZoneScopedN("!leaf");
         char requestedMergeMask = 0;
         for (int i = 0; i < 4; ++i) {
-            if (updateChunkTree(*cn.children[i], data, mvp)) {
+            if (updateChunkTree(*cn.children[i])) {
                 requestedMergeMask |= (1 << i);
             }
         }
 
         const bool allChildrenWantsMerge = requestedMergeMask == 0xf;
-        updateChunk(cn, data, mvp);
 
         if (allChildrenWantsMerge && (cn.status != Chunk::Status::WantSplit)) {
             mergeChunkNode(cn);
@@ -2580,40 +2639,4 @@ bool RenderableGlobe::updateChunkTree(Chunk& cn, const RenderData& data,
     }
 }
 
-void RenderableGlobe::updateChunk(Chunk& chunk, const RenderData& data,
-                                  const glm::dmat4& mvp) const
-{
-    ZoneScoped;
-
-    const BoundingHeights& heights = boundingHeightsForChunk(chunk, _layerManager);
-    chunk.heightTileOK = heights.tileOK;
-    chunk.colorTileOK = colorAvailableForChunk(chunk, _layerManager);
-
-    if (_chunkCornersDirty) {
-        chunk.corners = boundingCornersForChunk(chunk, _ellipsoid, heights);
-
-        // The flag gets set to false globally after the updateChunkTree calls
-    }
-
-    if (testIfCullable(chunk, data, heights, mvp)) {
-        chunk.isVisible = false;
-        chunk.status = Chunk::Status::WantMerge;
-    }
-    else {
-        chunk.isVisible = true;
-    }
-
-    const int dl = desiredLevel(chunk, data, heights);
-
-    if (dl < chunk.tileIndex.level) {
-        chunk.status = Chunk::Status::WantMerge;
-    }
-    else if (chunk.tileIndex.level < dl) {
-        chunk.status = Chunk::Status::WantSplit;
-    }
-    else {
-        chunk.status = Chunk::Status::DoNothing;
-    }
-}
-
 } // namespace openspace::globebrowsing
@@ -27,11 +27,13 @@
 
 #include <openspace/rendering/renderable.h>
 
+#include <modules/globebrowsing/src/chunk.h>
 #include <modules/globebrowsing/src/ellipsoid.h>
 #include <modules/globebrowsing/src/geodeticpatch.h>
 #include <modules/globebrowsing/src/geojson/geojsonmanager.h>
 #include <modules/globebrowsing/src/globelabelscomponent.h>
 #include <modules/globebrowsing/src/gpulayergroup.h>
+#include <modules/globebrowsing/src/heightmapcache.h>
 #include <modules/globebrowsing/src/layermanager.h>
 #include <modules/globebrowsing/src/ringscomponent.h>
 #include <modules/globebrowsing/src/shadowcomponent.h>
@@ -43,6 +45,8 @@
 #include <ghoul/misc/memorypool.h>
 #include <ghoul/opengl/uniformcache.h>
 #include <cstddef>
+#include <optional>
+#include <span>
 
 namespace openspace::documentation { struct Documentation; }
 
@@ -52,38 +56,6 @@ class GPULayerGroup;
 class RenderableGlobe;
 struct TileIndex;
 
-struct BoundingHeights {
-    float min;
-    float max;
-    bool available;
-    bool tileOK;
-};
-
-namespace chunklevelevaluator { class Evaluator; }
-namespace culling { class ChunkCuller; }
-
-struct Chunk {
-    enum class Status : uint8_t {
-        DoNothing,
-        WantMerge,
-        WantSplit
-    };
-
-    Chunk(const TileIndex& tileIndex);
-
-    const TileIndex tileIndex;
-    const GeodeticPatch surfacePatch;
-
-    Status status;
-
-    bool isVisible = true;
-    bool colorTileOK = false;
-    bool heightTileOK = false;
-
-    std::array<glm::dvec4, 8> corners;
-    std::array<Chunk*, 4> children = { { nullptr, nullptr, nullptr, nullptr } };
-};
-
 enum class ShadowCompType {
     GLOBAL_SHADOW,
     LOCAL_SHADOW
@@ -110,6 +82,21 @@ public:
     SurfacePositionHandle calculateSurfacePositionHandle(
         const glm::dvec3& targetModelSpace) const override;
 
+    /**
+     * Calculates the heights from the surface of the reference ellipsoid to the height
+     * mapped surface for all \p positions and stores them in \p heights. This is
+     * equivalent to calculating the height for each position individually, but the
+     * height layers are only queried once for all positions that fall into the same
+     * tile and the decoded height tiles are kept in a cache on the CPU.
+     *
+     * \param positions The positions in cartesian model space that get geodetically
+     *        projected on the reference ellipsoid
+     * \param heights The heights from the reference ellipsoid to the globe surface. Must
+     *        contain as many elements as \p positions
+     */
+    void getHeights(std::span<const glm::dvec3> positions,
+        std::span<float> heights) const;
+
     bool renderedWithDesiredData() const override;
 
     const Ellipsoid& ellipsoid() const;
@@ -125,6 +112,7 @@ public:
 private:
     static constexpr int MinSplitDepth = 2;
     static constexpr int MaxSplitDepth = 22;
+    static constexpr size_t HeightmapCacheSize = 64 * 1024 * 1024;
 
     struct {
         properties::BoolProperty showChunkEdges;
@@ -155,28 +143,22 @@ private:
 
     properties::PropertyOwner _shadowMappingPropertyOwner;
 
-    /**
-     * Test if a specific chunk can safely be culled without affecting the rendered
-     * image.
-     *
-     * Goes through all available `ChunkCuller`s and check if any of them
-     * allows culling of the `Chunk`s in question.
-     */
-    bool testIfCullable(const Chunk& chunk, const RenderData& renderData,
-        const BoundingHeights& heights, const glm::dmat4& mvp) const;
+    struct {
+        properties::BoolProperty  enabled;
+        properties::IntProperty   budget;
+        properties::FloatProperty lookAhead;
+        properties::IntProperty   requests;
+        properties::IntProperty   hits;
+        properties::IntProperty   waste;
+    } _prefetchProperties;
 
-    /**
-     * Gets the desired level which can be used to determine if a chunk should split
-     * or merge.
-     *
-     * Using `ChunkLevelEvaluator`s, the desired level can be higher or
-     * lower than the current level of the `Chunks`s
-     * `TileIndex`. If the desired level is higher than that of the
-     * `Chunk`, it wants to split. If it is lower, it wants to merge with
-     * its siblings.
-     */
-    int desiredLevel(const Chunk& chunk, const RenderData& renderData,
-        const BoundingHeights& heights) const;
+    properties::PropertyOwner _prefetchPropertyOwner;
+
+    struct {
+        glm::dvec3 cameraPosition = glm::dvec3(0.0);
+        glm::dvec3 cameraVelocity = glm::dvec3(0.0);
+        std::optional<double> time;
+    } _prefetchState;
 
     /**
      * Calculates the height from the surface of the reference ellipsoid to the
@@ -225,15 +207,6 @@ private:
     void debugRenderChunk(const Chunk& chunk, const glm::dmat4& mvp,
         bool renderBounds) const;
 
-    bool isCullableByFrustum(const Chunk& chunk, const RenderData& renderData,
-        const glm::dmat4& mvp) const;
-    bool isCullableByHorizon(const Chunk& chunk, const RenderData& renderData,
-        const BoundingHeights& heights) const;
-
-    int desiredLevelByDistance(const Chunk& chunk, const RenderData& data,
-        const BoundingHeights& heights) const;
-    int desiredLevelByProjectedArea(const Chunk& chunk, const RenderData& data,
-        const BoundingHeights& heights) const;
     int desiredLevelByAvailableTileData(const Chunk& chunk) const;
 
 
@@ -247,15 +220,38 @@ private:
     void recompileShaders();
 
 
+    /**
+     * Extrapolates the movement of the camera and asks the tile providers of all active
+     * layers to load the tiles that will likely be needed at the predicted position.
+     * Outstanding prefetch requests are cancelled if the camera changes its course.
+     */
+    void prefetchTiles();
+    void cancelPrefetches();
+
     void splitChunkNode(Chunk& cn, int depth);
     void mergeChunkNode(Chunk& cn);
-    bool updateChunkTree(Chunk& cn, const RenderData& data, const glm::dmat4& mvp);
-    void updateChunk(Chunk& chunk, const RenderData& data, const glm::dmat4& mvp) const;
+
+    /**
+     * Adds the chunk \p cn and all of its descendants to `_chunkEvaluations` together
+     * with the information about them that is provided by the layers.
+     */
+    void collectChunks(Chunk& cn);
+
+    /**
+     * Splits and merges the chunks in the subtree of \p cn according to the status that
+     * was computed for them by `evaluateChunks`. Returns `true` if \p cn wants to be
+     * merged into its parent.
+     */
+    bool updateChunkTree(Chunk& cn);
     void freeChunkNode(Chunk* n);
 
     Ellipsoid _ellipsoid;
     SkirtedGrid _grid;
     LayerManager _layerManager;
+    // Decoded height tiles that are used by getHeights. Mutable as the cache is filled
+    // lazily by the const height queries
+    mutable cache::HeightmapCache _heightmapCache =
+        cache::HeightmapCache(HeightmapCacheSize);
 
     GeoJsonManager _geoJsonManager;
 
@@ -267,6 +263,7 @@ private:
     std::vector<const Chunk*> _globalChunkBuffer;
     std::vector<const Chunk*> _localChunkBuffer;
     std::vector<const Chunk*> _traversalMemory;
+    std::vector<ChunkEvaluation> _chunkEvaluations;
 
 
     Chunk _leftRoot;  // Covers all negative longitudes
@@ -35,6 +35,9 @@ struct TileCacheProperties {
     std::string path;
     int quality;
     int blockSize;
+
+    /// The number of GDAL dataset handles that are used to read tiles concurrently
+    int nDatasetHandles = 1;
 };
 
 } // namespace openspace::globebrowsing
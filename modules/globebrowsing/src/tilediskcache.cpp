@@ -0,0 +1,331 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2023                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/globebrowsing/src/tilediskcache.h>
+
+#include <ghoul/fmt.h>
+#include <ghoul/logging/logmanager.h>
+#include <ghoul/misc/profiling.h>
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <vector>
+
+namespace {
+    constexpr std::string_view _loggerCat = "TileDiskCache";
+
+    constexpr int8_t TileCacheFileVersion = 1;
+    constexpr std::string_view TileExtension = ".tile";
+    constexpr std::string_view TemporaryExtension = ".tmp";
+} // namespace
+
+namespace openspace::globebrowsing::cache {
+
+TileDiskCache::TileDiskCache(std::filesystem::path root, size_t maximumSize)
+    : _root(std::move(root))
+    , _maximumSize(maximumSize)
+{
+    ZoneScoped;
+
+    std::error_code ec;
+    std::filesystem::create_directories(_root, ec);
+    if (ec) {
+        LWARNING(fmt::format(
+            "Failed to create tile disk cache at {}: {}", _root, ec.message()
+        ));
+        return;
+    }
+
+    // Register the tiles from previous runs with the oldest tiles at the back
+    struct File {
+        std::filesystem::path path;
+        size_t size;
+        std::filesystem::file_time_type time;
+    };
+    std::vector<File> files;
+    namespace fs = std::filesystem;
+    for (const fs::directory_entry& e : fs::recursive_directory_iterator(_root, ec)) {
+        if (!e.is_regular_file()) {
+            continue;
+        }
+
+        if (e.path().extension() == TemporaryExtension) {
+            // Left-over from a write that was interrupted
+            fs::remove(e.path(), ec);
+        }
+        else if (e.path().extension() == TileExtension) {
+            files.push_back({ e.path(), e.file_size(ec), e.last_write_time(ec) });
+        }
+    }
+
+    std::sort(
+        files.begin(),
+        files.end(),
+        [](const File& lhs, const File& rhs) { return lhs.time > rhs.time; }
+    );
+
+    std::lock_guard lock(_mutex);
+    for (const File& file : files) {
+        _entries.push_back({ file.path, file.size });
+        _entryMap[file.path.string()] = std::prev(_entries.end());
+        _totalSize += file.size;
+    }
+    evict();
+
+    LINFO(fmt::format(
+        "Tile disk cache at {} contains {} tiles ({} MB)",
+        _root, _entries.size(), _totalSize / (1024 * 1024)
+    ));
+}
+
+std::filesystem::path TileDiskCache::filePath(uint64_t layerHash,
+                                              const TileIndex& tileIndex) const
+{
+    return _root / fmt::format("{:016x}", layerHash) / std::to_string(tileIndex.level) /
+        fmt::format("{}_{}{}", tileIndex.x, tileIndex.y, TileExtension);
+}
+
+std::optional<RawTile> TileDiskCache::get(uint64_t layerHash, const TileIndex& tileIndex,
+                                          const TileTextureInitData& initData)
+{
+    ZoneScoped;
+
+    const std::filesystem::path path = filePath(layerHash, tileIndex);
+    {
+        std::lock_guard lock(_mutex);
+        if (_entryMap.find(path.string()) == _entryMap.end()) {
+            return std::nullopt;
+        }
+    }
+
+    // The file is read without holding the lock, so it might be evicted or replaced in
+    // the meantime. Replacing is atomic, so a file that cannot be opened or is too short
+    // has been removed or is broken and its entry is dropped
+    std::ifstream file(path, std::ifstream::binary);
+    if (!file.good()) {
+        std::lock_guard lock(_mutex);
+        remove(path);
+        return std::nullopt;
+    }
+
+    int8_t version = 0;
+    file.read(reinterpret_cast<char*>(&version), sizeof(int8_t));
+    uint64_t initDataHash = 0;
+    file.read(reinterpret_cast<char*>(&initDataHash), sizeof(uint64_t));
+    uint64_t nBytes = 0;
+    file.read(reinterpret_cast<char*>(&nBytes), sizeof(uint64_t));
+    if (!file.good()) {
+        LWARNING(fmt::format("Failed to read cached tile {}", path));
+        file.close();
+        std::lock_guard lock(_mutex);
+        remove(path);
+        return std::nullopt;
+    }
+    if (version != TileCacheFileVersion || initDataHash != initData.hashKey ||
+        nBytes != initData.totalNumBytes)
+    {
+        // The tile was written by a different version or with different settings
+        return std::nullopt;
+    }
+
+    RawTile rawTile;
+    TileMetaData& meta = rawTile.tileMetaData;
+    file.read(reinterpret_cast<char*>(meta.maxValues.data()), 4 * sizeof(float));
+    file.read(reinterpret_cast<char*>(meta.minValues.data()), 4 * sizeof(float));
+    for (bool& hasMissingData : meta.hasMissingData) {
+        uint8_t v = 0;
+        file.read(reinterpret_cast<char*>(&v), sizeof(uint8_t));
+        hasMissingData = (v != 0);
+    }
+    file.read(reinterpret_cast<char*>(&meta.nValues), sizeof(uint8_t));
+
+    rawTile.imageData = std::unique_ptr<std::byte[]>(new std::byte[nBytes]);
+    file.read(reinterpret_cast<char*>(rawTile.imageData.get()), nBytes);
+    if (!file.good()) {
+        LWARNING(fmt::format("Failed to read cached tile {}", path));
+        file.close();
+        std::lock_guard lock(_mutex);
+        remove(path);
+        return std::nullopt;
+    }
+
+    rawTile.tileIndex = tileIndex;
+    rawTile.textureInitData = initData;
+    rawTile.error = RawTile::ReadError::None;
+
+    // Store the access on disk so that the LRU order survives a restart
+    std::error_code ec;
+    std::filesystem::last_write_time(
+        path,
+        std::filesystem::file_time_type::clock::now(),
+        ec
+    );
+
+    // A tile that was evicted while it was read must not be registered again
+    std::lock_guard lock(_mutex);
+    auto it = _entryMap.find(path.string());
+    if (it != _entryMap.end()) {
+        _entries.splice(_entries.begin(), _entries, it->second);
+    }
+    return rawTile;
+}
+
+void TileDiskCache::put(uint64_t layerHash, const RawTile& rawTile) {
+    ZoneScoped;
+
+    if (rawTile.error != RawTile::ReadError::None || !rawTile.imageData ||
+        !rawTile.textureInitData.has_value())
+    {
+        return;
+    }
+
+    const std::filesystem::path path = filePath(layerHash, rawTile.tileIndex);
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+    if (ec) {
+        return;
+    }
+
+    // Write into a temporary file first so that concurrent readers or an interrupted
+    // write never observe a partial tile. Every write gets its own temporary file, as
+    // layers with the same dataset share their tiles and might write the same tile at
+    // the same time
+    static std::atomic_uint64_t TemporaryCounter = 0;
+    std::filesystem::path tmp = path;
+    tmp += fmt::format(".{}{}", TemporaryCounter++, TemporaryExtension);
+    {
+        std::ofstream file(tmp, std::ofstream::binary);
+        file.write(
+            reinterpret_cast<const char*>(&TileCacheFileVersion),
+            sizeof(int8_t)
+        );
+        const uint64_t initDataHash = rawTile.textureInitData->hashKey;
+        file.write(reinterpret_cast<const char*>(&initDataHash), sizeof(uint64_t));
+        const uint64_t nBytes = rawTile.textureInitData->totalNumBytes;
+        file.write(reinterpret_cast<const char*>(&nBytes), sizeof(uint64_t));
+
+        const TileMetaData& meta = rawTile.tileMetaData;
+        file.write(
+            reinterpret_cast<const char*>(meta.maxValues.data()),
+            4 * sizeof(float)
+        );
+        file.write(
+            reinterpret_cast<const char*>(meta.minValues.data()),
+            4 * sizeof(float)
+        );
+        for (bool hasMissingData : meta.hasMissingData) {
+            const uint8_t v = hasMissingData ? 1 : 0;
+            file.write(reinterpret_cast<const char*>(&v), sizeof(uint8_t));
+        }
+        file.write(reinterpret_cast<const char*>(&meta.nValues), sizeof(uint8_t));
+
+        file.write(reinterpret_cast<const char*>(rawTile.imageData.get()), nBytes);
+        if (!file.good()) {
+            file.close();
+            std::filesystem::remove(tmp, ec);
+            return;
+        }
+    }
+
+    std::filesystem::rename(tmp, path, ec);
+    if (ec) {
+        std::filesystem::remove(tmp, ec);
+        return;
+    }
+
+    const size_t size = std::filesystem::file_size(path, ec);
+    std::lock_guard lock(_mutex);
+    touch(path, ec ? 0 : size);
+    evict();
+}
+
+void TileDiskCache::clear() {
+    std::lock_guard lock(_mutex);
+    std::error_code ec;
+    for (const Entry& entry : _entries) {
+        std::filesystem::remove(entry.path, ec);
+    }
+    _entries.clear();
+    _entryMap.clear();
+    _totalSize = 0;
+}
+
+size_t TileDiskCache::size() const {
+    std::lock_guard lock(_mutex);
+    return _totalSize;
+}
+
+void TileDiskCache::touch(const std::filesystem::path& path, size_t size) {
+    auto it = _entryMap.find(path.string());
+    if (it != _entryMap.end()) {
+        if (size > 0) {
+            // The file was rewritten, so its size might have changed
+            _totalSize = _totalSize - it->second->size + size;
+            it->second->size = size;
+        }
+        _entries.splice(_entries.begin(), _entries, it->second);
+    }
+    else {
+        _entries.push_front({ path, size });
+        _entryMap[path.string()] = _entries.begin();
+        _totalSize += size;
+    }
+}
+
+bool TileDiskCache::remove(Entries::iterator it) {
+    std::error_code ec;
+    std::filesystem::remove(it->path, ec);
+    if (ec) {
+        // The file is kept in the index as long as it occupies space on disk
+        LWARNING(fmt::format(
+            "Failed to remove cached tile {}: {}", it->path, ec.message()
+        ));
+        return false;
+    }
+
+    _totalSize -= it->size;
+    _entryMap.erase(it->path.string());
+    _entries.erase(it);
+    return true;
+}
+
+bool TileDiskCache::remove(const std::filesystem::path& path) {
+    auto it = _entryMap.find(path.string());
+    return it != _entryMap.end() && remove(it->second);
+}
+
+void TileDiskCache::evict() {
+    // Files that cannot be removed are moved to the front so that they are retried
+    // during a later eviction instead of being retried endlessly
+    size_t nCandidates = _entries.size();
+    while (_totalSize > _maximumSize && nCandidates > 0) {
+        nCandidates--;
+        Entries::iterator it = std::prev(_entries.end());
+        if (!remove(it)) {
+            _entries.splice(_entries.begin(), _entries, it);
+        }
+    }
+}
+
+} // namespace openspace::globebrowsing::cache
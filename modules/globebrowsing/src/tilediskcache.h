@@ -0,0 +1,126 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2023                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_MODULE_GLOBEBROWSING___TILE_DISK_CACHE___H__
+#define __OPENSPACE_MODULE_GLOBEBROWSING___TILE_DISK_CACHE___H__
+
+#include <modules/globebrowsing/src/rawtile.h>
+#include <modules/globebrowsing/src/tileindex.h>
+#include <filesystem>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace openspace::globebrowsing::cache {
+
+/**
+ * A persistent, second-level cache that stores `RawTile`s on disk so that they survive
+ * restarts of the application. The tiles are stored after they have been preprocessed,
+ * so a tile that is found in this cache can be used directly without touching the
+ * original dataset.
+ *
+ * Every tile is stored in its own file whose location is derived from a hash of the
+ * layer settings that influence the contents of the tile (the `layerHash`) and the
+ * `TileIndex`. The total size of all files is kept below a maximum size by removing the
+ * least recently used tiles. The recency of a tile is stored as the modification time
+ * of its file, so it is preserved across restarts.
+ *
+ * All public functions of this class are thread-safe.
+ */
+class TileDiskCache {
+public:
+    /**
+     * Creates a disk cache in the \p root folder and registers all tiles that have been
+     * written by previous runs.
+     *
+     * \param root The folder in which the cached tiles are stored
+     * \param maximumSize The maximum number of bytes that the cached tiles can occupy
+     */
+    TileDiskCache(std::filesystem::path root, size_t maximumSize);
+
+    /**
+     * Returns the tile for \p tileIndex of the layer identified by \p layerHash, if it
+     * has been cached previously with the same \p initData.
+     */
+    std::optional<RawTile> get(uint64_t layerHash, const TileIndex& tileIndex,
+        const TileTextureInitData& initData);
+
+    /**
+     * Stores the \p rawTile for the layer identified by \p layerHash. Tiles that were not
+     * read successfully are ignored.
+     */
+    void put(uint64_t layerHash, const RawTile& rawTile);
+
+    /**
+     * Removes all cached tiles from disk.
+     */
+    void clear();
+
+    /**
+     * Returns the number of bytes that are currently occupied by the cached tiles.
+     */
+    size_t size() const;
+
+private:
+    struct Entry {
+        std::filesystem::path path;
+        size_t size = 0;
+    };
+    using Entries = std::list<Entry>;
+
+    std::filesystem::path filePath(uint64_t layerHash, const TileIndex& tileIndex) const;
+
+    /// Adds or bumps the file at \p path to the front of the list of entries
+    void touch(const std::filesystem::path& path, size_t size);
+
+    /**
+     * Removes the file of the entry \p it from disk. The entry is only removed if the
+     * file was removed or did not exist anymore.
+     *
+     * \return `true` if the entry was removed
+     */
+    bool remove(Entries::iterator it);
+
+    /// Removes the file at \p path and its entry, if the file is part of the cache
+    bool remove(const std::filesystem::path& path);
+
+    /// Removes the least recently used tiles until the maximum size is respected
+    void evict();
+
+    const std::filesystem::path _root;
+    const size_t _maximumSize;
+
+    /// Most recently used entries are at the front of the list
+    Entries _entries;
+    std::unordered_map<std::string, Entries::iterator> _entryMap;
+    size_t _totalSize = 0;
+
+    mutable std::mutex _mutex;
+};
+
+} // namespace openspace::globebrowsing::cache
+
+#endif // __OPENSPACE_MODULE_GLOBEBROWSING___TILE_DISK_CACHE___H__
@@ -60,7 +60,7 @@ glm::vec2 TileIndex::positionRelativeParent() const {
 TileIndex::TileHashKey TileIndex::hashKey() const {
     TileHashKey key = 0LL;
     key |= level;
-    key |= x << 5;
+    key |= static_cast<TileHashKey>(x) << 5;
     key |= static_cast<TileHashKey>(y) << 35;
 
     return key;
@@ -34,6 +34,7 @@ namespace openspace::globebrowsing {
 struct TileIndex {
     using TileHashKey = uint64_t;
 
+    TileIndex() = default;
     TileIndex(uint32_t x, uint32_t y, uint8_t level);
 
     uint32_t x = 0;
@@ -0,0 +1,347 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2023                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/globebrowsing/src/tilejobscheduler.h>
+
+#include <ghoul/misc/assert.h>
+#include <ghoul/misc/profiling.h>
+#include <algorithm>
+#include <limits>
+
+namespace {
+    constexpr openspace::properties::Property::PropertyInfo QueueDepthInfo = {
+        "QueueDepth",
+        "Queue depth",
+        "The number of tile load jobs that are waiting to be executed",
+        openspace::properties::Property::Visibility::Developer
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo RunningJobsInfo = {
+        "RunningJobs",
+        "Running jobs",
+        "The number of tile load jobs that are currently being executed",
+        openspace::properties::Property::Visibility::Developer
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo FinishedJobsInfo = {
+        "FinishedJobs",
+        "Finished jobs",
+        "The total number of tile load jobs that have been executed",
+        openspace::properties::Property::Visibility::Developer
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo CancelledJobsInfo = {
+        "CancelledJobs",
+        "Cancelled jobs",
+        "The total number of tile load jobs that had already been cancelled when they "
+        "were started",
+        openspace::properties::Property::Visibility::Developer
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo AverageWaitTimeInfo = {
+        "AverageWaitTime",
+        "Average wait time (ms)",
+        "The average time that the tile load jobs that were started since the last frame "
+        "have been waiting in the queue",
+        openspace::properties::Property::Visibility::Developer
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo AverageExecutionTimeInfo = {
+        "AverageExecutionTime",
+        "Average execution time (ms)",
+        "The average time it took to execute the tile load jobs that were finished since "
+        "the last frame",
+        openspace::properties::Property::Visibility::Developer
+    };
+
+    int clampToInt(uint64_t value) {
+        return static_cast<int>(
+            std::min<uint64_t>(value, std::numeric_limits<int>::max())
+        );
+    }
+
+    uint64_t toMicroseconds(std::chrono::steady_clock::duration duration) {
+        using namespace std::chrono;
+        return static_cast<uint64_t>(duration_cast<microseconds>(duration).count());
+    }
+} // namespace
+
+namespace openspace::globebrowsing {
+
+void CancellationToken::cancel() {
+    _isCancelled = true;
+}
+
+bool CancellationToken::isCancelled() const {
+    return _isCancelled;
+}
+
+TileJobScheduler::Client::Client(int maxConcurrentJobs)
+    : _maxConcurrentJobs(std::max(maxConcurrentJobs, 1))
+{}
+
+size_t TileJobScheduler::TaskKeyHasher::operator()(const TaskKey& key) const {
+    const size_t client = std::hash<const Client*>()(key.client);
+    const size_t k = std::hash<uint64_t>()(key.key);
+    return client ^ (k + 0x9e3779b97f4a7c15ULL + (client << 6) + (client >> 2));
+}
+
+TileJobScheduler::TileJobScheduler(int nThreads)
+    : properties::PropertyOwner({ "TileJobScheduler", "Tile Job Scheduler" })
+    , _queueDepth(QueueDepthInfo, 0, 0, std::numeric_limits<int>::max())
+    , _runningJobs(RunningJobsInfo, 0, 0, std::numeric_limits<int>::max())
+    , _finishedJobs(FinishedJobsInfo, 0, 0, std::numeric_limits<int>::max())
+    , _cancelledJobs(CancelledJobsInfo, 0, 0, std::numeric_limits<int>::max())
+    , _averageWaitTime(AverageWaitTimeInfo, 0.f, 0.f, std::numeric_limits<float>::max())
+    , _averageExecutionTime(
+        AverageExecutionTimeInfo,
+        0.f,
+        0.f,
+        std::numeric_limits<float>::max()
+    )
+{
+    if (nThreads <= 0) {
+        nThreads = std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+    }
+
+    _queueDepth.setReadOnly(true);
+    addProperty(_queueDepth);
+    _runningJobs.setReadOnly(true);
+    addProperty(_runningJobs);
+    _finishedJobs.setReadOnly(true);
+    addProperty(_finishedJobs);
+    _cancelledJobs.setReadOnly(true);
+    addProperty(_cancelledJobs);
+    _averageWaitTime.setReadOnly(true);
+    addProperty(_averageWaitTime);
+    _averageExecutionTime.setReadOnly(true);
+    addProperty(_averageExecutionTime);
+
+    _shards.reserve(nThreads);
+    for (int i = 0; i < nThreads; i++) {
+        _shards.push_back(std::make_unique<Shard>());
+    }
+    _workers.reserve(nThreads);
+    for (int i = 0; i < nThreads; i++) {
+        _workers.emplace_back([this, i]() { work(static_cast<size_t>(i)); });
+    }
+}
+
+TileJobScheduler::~TileJobScheduler() {
+    {
+        std::lock_guard lock(_sleepMutex);
+        _stop = true;
+    }
+    _condition.notify_all();
+
+    for (std::thread& worker : _workers) {
+        worker.join();
+    }
+}
+
+std::shared_ptr<TileJobScheduler::Client> TileJobScheduler::createClient(
+                                                                    int maxConcurrentJobs)
+{
+    return std::make_shared<Client>(maxConcurrentJobs);
+}
+
+void TileJobScheduler::enqueue(std::shared_ptr<Client> client, uint64_t key,
+                               Priority priority, std::function<void()> job,
+                               std::shared_ptr<CancellationToken> token)
+{
+    ZoneScoped;
+
+    ghoul_assert(client, "No client provided");
+    ghoul_assert(job, "No job provided");
+
+    const TaskKey taskKey = { client.get(), key };
+    Shard& s = shard(taskKey);
+    {
+        std::lock_guard lock(s.mutex);
+        ghoul_assert(
+            !s.index.contains(taskKey),
+            "A job with the same key is already enqueued for this client"
+        );
+
+        const uint64_t sequence = ++_sequence;
+        s.tasks[static_cast<int>(priority)].emplace(
+            sequence,
+            Task {
+                .client = std::move(client),
+                .key = key,
+                .job = std::move(job),
+                .token = std::move(token),
+                .enqueueTime = std::chrono::steady_clock::now()
+            }
+        );
+        s.index.insertOrAssign(taskKey, std::make_pair(priority, sequence));
+        _nQueuedTasks++;
+    }
+
+    {
+        std::lock_guard lock(_sleepMutex);
+        _generation++;
+    }
+    _condition.notify_one();
+}
+
+bool TileJobScheduler::bump(const Client& client, uint64_t key, Priority priority) {
+    ZoneScoped;
+
+    const TaskKey taskKey = { &client, key };
+    Shard& s = shard(taskKey);
+    std::lock_guard lock(s.mutex);
+    std::pair<Priority, uint64_t>* entry = s.index.find(taskKey);
+    if (!entry) {
+        return false;
+    }
+
+    const auto [previousPriority, previousSequence] = *entry;
+    auto node = s.tasks[static_cast<int>(previousPriority)].extract(previousSequence);
+    ghoul_assert(!node.empty(), "Index and tasks are out of sync");
+    const uint64_t sequence = ++_sequence;
+    node.key() = sequence;
+    s.tasks[static_cast<int>(priority)].insert(std::move(node));
+    *entry = std::make_pair(priority, sequence);
+    return true;
+}
+
+void TileJobScheduler::update() {
+    _queueDepth = std::max(_nQueuedTasks.load(), 0);
+    _runningJobs = std::max(_nRunningTasks.load(), 0);
+
+    const uint64_t nFinished = _nFinishedTasks.exchange(0);
+    const uint64_t nCancelled = _nCancelledTasks.exchange(0);
+    const uint64_t waitTime = _waitTimeUs.exchange(0);
+    const uint64_t executionTime = _executionTimeUs.exchange(0);
+
+    _nTotalFinishedTasks += nFinished;
+    _nTotalCancelledTasks += nCancelled;
+    _finishedJobs = clampToInt(_nTotalFinishedTasks);
+    _cancelledJobs = clampToInt(_nTotalCancelledTasks);
+
+    if (nFinished > 0) {
+        // The wait time is recorded when a task is started and the execution time when
+        // it finishes, but over a frame these are close enough to the same set of tasks
+        _averageWaitTime = static_cast<float>(waitTime / 1000.0 / nFinished);
+        _averageExecutionTime = static_cast<float>(executionTime / 1000.0 / nFinished);
+    }
+}
+
+int TileJobScheduler::numThreads() const {
+    return static_cast<int>(_workers.size());
+}
+
+TileJobScheduler::Shard& TileJobScheduler::shard(const TaskKey& key) {
+    return *_shards[TaskKeyHasher()(key) % _shards.size()];
+}
+
+std::optional<TileJobScheduler::Task> TileJobScheduler::popTask(size_t home) {
+    ZoneScoped;
+
+    // All regular tasks have precedence over all low priority tasks. For each priority
+    // the worker's own shard is visited first before stealing work from the others
+    const size_t nShards = _shards.size();
+    for (size_t priority = 0; priority < 2; priority++) {
+        for (size_t i = 0; i < nShards; i++) {
+            Shard& s = *_shards[(home + i) % nShards];
+            std::lock_guard lock(s.mutex);
+            std::map<uint64_t, Task>& tasks = s.tasks[priority];
+            for (auto it = tasks.rbegin(); it != tasks.rend(); it++) {
+                // Reserve one of the client's slots. If the client already uses all of
+                // its slots, we look at the next task instead
+                Client& client = *it->second.client;
+                std::atomic_int& nRunning = client._nRunningJobs;
+                int n = nRunning;
+                bool hasReserved = false;
+                while (!hasReserved && n < client._maxConcurrentJobs) {
+                    hasReserved = nRunning.compare_exchange_weak(n, n + 1);
+                }
+                if (!hasReserved) {
+                    continue;
+                }
+
+                Task task = std::move(it->second);
+                s.index.erase(TaskKey{ task.client.get(), task.key });
+                tasks.erase(std::next(it).base());
+                _nQueuedTasks--;
+                return task;
+            }
+        }
+    }
+    return std::nullopt;
+}
+
+void TileJobScheduler::work(size_t home) {
+    while (true) {
+        uint64_t generation = 0;
+        {
+            std::lock_guard lock(_sleepMutex);
+            if (_stop) {
+                return;
+            }
+            generation = _generation;
+        }
+
+        std::optional<Task> task = popTask(home);
+        if (!task.has_value()) {
+            // Either there is nothing to do or all remaining tasks belong to clients that
+            // are already running the maximum number of jobs
+            std::unique_lock lock(_sleepMutex);
+            _condition.wait(lock, [&]() { return _stop || _generation != generation; });
+            continue;
+        }
+
+        using namespace std::chrono;
+        const steady_clock::time_point start = steady_clock::now();
+        _waitTimeUs += toMicroseconds(start - task->enqueueTime);
+        if (task->token && task->token->isCancelled()) {
+            _nCancelledTasks++;
+        }
+
+        _nRunningTasks++;
+        task->job();
+        _nRunningTasks--;
+
+        _executionTimeUs += toMicroseconds(steady_clock::now() - start);
+        _nFinishedTasks++;
+        task->client->_nRunningJobs--;
+
+        // Destroy the task before waking up other workers, as it might hold the last
+        // reference to resources of its client
+        const bool hasQueuedTasks = _nQueuedTasks > 0;
+        task = std::nullopt;
+
+        if (hasQueuedTasks) {
+            // A slot of the client was freed, which might make a skipped task runnable
+            {
+                std::lock_guard lock(_sleepMutex);
+                _generation++;
+            }
+            _condition.notify_all();
+        }
+    }
+}
+
+} // namespace openspace::globebrowsing
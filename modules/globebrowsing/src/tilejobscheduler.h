@@ -0,0 +1,194 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2023                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_MODULE_GLOBEBROWSING___TILE_JOB_SCHEDULER___H__
+#define __OPENSPACE_MODULE_GLOBEBROWSING___TILE_JOB_SCHEDULER___H__
+
+#include <modules/globebrowsing/src/flathashmap.h>
+#include <openspace/properties/propertyowner.h>
+
+#include <openspace/properties/scalar/floatproperty.h>
+#include <openspace/properties/scalar/intproperty.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace openspace::globebrowsing {
+
+/**
+ * A flag that is shared between the owner of a job and the job itself. The owner can
+ * cancel the job at any point in time and a running job is expected to check the token
+ * at suitable points and finish early if it was cancelled.
+ */
+class CancellationToken {
+public:
+    void cancel();
+    bool isCancelled() const;
+
+private:
+    std::atomic_bool _isCancelled = false;
+};
+
+/**
+ * A pool of worker threads that executes the tile load jobs of all tile providers. The
+ * jobs are distributed over one queue per worker thread based on their key, so that
+ * enqueuing and bumping jobs from different providers rarely contends for the same lock.
+ * Each worker prefers its own queue, but steals from the queues of the other workers if
+ * it runs out of jobs.
+ *
+ * Jobs with a Priority::Regular priority are always executed before jobs with a
+ * Priority::Low priority. Within the same priority, the most recently enqueued or bumped
+ * job is executed first. Every job is executed exactly once, even if it was cancelled in
+ * the meantime, so that the owner can reliably account for all of its jobs. It is the
+ * responsibility of the job to finish early if its CancellationToken is set.
+ */
+class TileJobScheduler : public properties::PropertyOwner {
+public:
+    enum class Priority {
+        Regular = 0,
+        Low
+    };
+
+    /**
+     * Represents a single owner of jobs, for example a tile provider. The number of jobs
+     * of a client that are executed concurrently is limited, so that a single client
+     * with a slow data source can not occupy all worker threads.
+     */
+    class Client {
+    public:
+        explicit Client(int maxConcurrentJobs);
+
+    private:
+        friend class TileJobScheduler;
+
+        const int _maxConcurrentJobs;
+        std::atomic_int _nRunningJobs = 0;
+    };
+
+    /**
+     * \param nThreads is the number of worker threads. If it is 0, the number of
+     *        hardware threads is used
+     */
+    explicit TileJobScheduler(int nThreads = 0);
+    ~TileJobScheduler() override;
+
+    std::shared_ptr<Client> createClient(int maxConcurrentJobs);
+
+    /**
+     * Enqueues the \p job for the \p client. The \p key has to be unique for all jobs of
+     * the \p client that are enqueued at the same time. The \p token is checked for
+     * statistics purposes only; the \p job has to check it itself.
+     */
+    void enqueue(std::shared_ptr<Client> client, uint64_t key, Priority priority,
+        std::function<void()> job, std::shared_ptr<CancellationToken> token);
+
+    /**
+     * Moves the job with the provided \p key to the front of the queue with the
+     * \p priority. If the job has already been started, this function does nothing.
+     *
+     * \return `true` if the job was found in the queue
+     */
+    bool bump(const Client& client, uint64_t key, Priority priority);
+
+    /**
+     * Updates the properties with the metrics that were gathered since the last call.
+     * This function has to be called from the main thread.
+     */
+    void update();
+
+    int numThreads() const;
+
+private:
+    struct TaskKey {
+        const Client* client;
+        uint64_t key;
+
+        bool operator==(const TaskKey& rhs) const = default;
+    };
+
+    struct TaskKeyHasher {
+        size_t operator()(const TaskKey& key) const;
+    };
+
+    struct Task {
+        std::shared_ptr<Client> client;
+        uint64_t key = 0;
+        std::function<void()> job;
+        std::shared_ptr<CancellationToken> token;
+        std::chrono::steady_clock::time_point enqueueTime;
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        // The tasks of each priority are ordered by their sequence number. The task with
+        // the highest sequence number was enqueued or bumped most recently
+        std::array<std::map<uint64_t, Task>, 2> tasks;
+        cache::FlatHashMap<TaskKey, std::pair<Priority, uint64_t>, TaskKeyHasher> index;
+    };
+
+    void work(size_t home);
+    std::optional<Task> popTask(size_t home);
+    Shard& shard(const TaskKey& key);
+
+    std::vector<std::unique_ptr<Shard>> _shards;
+    std::vector<std::thread> _workers;
+
+    std::atomic_uint64_t _sequence = 0;
+    std::atomic_int _nQueuedTasks = 0;
+    std::atomic_int _nRunningTasks = 0;
+
+    // Workers that did not find a runnable task sleep until the generation changes,
+    // which happens when a task is enqueued or a task finishes
+    std::mutex _sleepMutex;
+    std::condition_variable _condition;
+    uint64_t _generation = 0;
+    bool _stop = false;
+
+    // Metrics that are accumulated between two calls to the update function
+    std::atomic_uint64_t _nFinishedTasks = 0;
+    std::atomic_uint64_t _nCancelledTasks = 0;
+    std::atomic_uint64_t _waitTimeUs = 0;
+    std::atomic_uint64_t _executionTimeUs = 0;
+    uint64_t _nTotalFinishedTasks = 0;
+    uint64_t _nTotalCancelledTasks = 0;
+
+    properties::IntProperty _queueDepth;
+    properties::IntProperty _runningJobs;
+    properties::IntProperty _finishedJobs;
+    properties::IntProperty _cancelledJobs;
+    properties::FloatProperty _averageWaitTime;
+    properties::FloatProperty _averageExecutionTime;
+};
+
+} // namespace openspace::globebrowsing
+
+#endif // __OPENSPACE_MODULE_GLOBEBROWSING___TILE_JOB_SCHEDULER___H__
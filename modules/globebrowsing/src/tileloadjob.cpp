@@ -25,11 +25,14 @@
 #include <modules/globebrowsing/src/tileloadjob.h>
 
 #include <modules/globebrowsing/src/rawtiledatareader.h>
+#include <modules/globebrowsing/src/tilejobscheduler.h>
 
 namespace openspace::globebrowsing {
 
-TileLoadJob::TileLoadJob(RawTileDataReader& rawTileDataReader, TileIndex tileIndex)
-    : _rawTileDataReader(rawTileDataReader)
+TileLoadJob::TileLoadJob(std::shared_ptr<const RawTileDataReader> rawTileDataReader,
+                         TileIndex tileIndex, std::shared_ptr<CancellationToken> token)
+    : _rawTileDataReader(std::move(rawTileDataReader))
+    , _token(std::move(token))
     , _chunkIndex(std::move(tileIndex))
 {}
 
@@ -40,7 +43,7 @@ TileLoadJob::~TileLoadJob() {
 }
 
 void TileLoadJob::execute() {
-    _rawTile = _rawTileDataReader.readTileData(_chunkIndex);
+    _rawTile = _rawTileDataReader->readTileData(_chunkIndex, _token.get());
     _hasTile = true;
 }
 
@@ -49,4 +52,8 @@ RawTile TileLoadJob::product() {
     return std::move(_rawTile);
 }
 
+bool TileLoadJob::isCancelled() const {
+    return _token && _token->isCancelled();
+}
+
 } // namespace openspace::globebrowsing
@@ -29,9 +29,11 @@
 
 #include <modules/globebrowsing/src/rawtile.h>
 #include <modules/globebrowsing/src/tileindex.h>
+#include <memory>
 
 namespace openspace::globebrowsing {
 
+class CancellationToken;
 class RawTileDataReader;
 
 struct TileLoadJob : public Job<RawTile> {
@@ -39,9 +41,12 @@ struct TileLoadJob : public Job<RawTile> {
      * Allocates enough data for one tile. When calling `product()`, the
      * ownership of this data will be released. If `product()` has not been
      * called before the TileLoadJob is finished, the data will be deleted as it has not
-     * been exposed outside of this object.
+     * been exposed outside of this object. The job keeps the \p rawTileDataReader alive
+     * until it is destroyed, as the job might outlive the owner of the reader. If the
+     * \p token is cancelled, the job finishes early without any tile data.
      */
-    TileLoadJob(RawTileDataReader& rawTileDataReader, TileIndex tileIndex);
+    TileLoadJob(std::shared_ptr<const RawTileDataReader> rawTileDataReader,
+        TileIndex tileIndex, std::shared_ptr<CancellationToken> token);
 
     /**
      * Destroys the allocated data pointer if it has been allocated and the TileLoadJob
@@ -63,8 +68,15 @@ struct TileLoadJob : public Job<RawTile> {
     */
     RawTile product() override;
 
+    /**
+     * Returns `true` if the job was cancelled, in which case the product should be
+     * discarded.
+     */
+    bool isCancelled() const;
+
 protected:
-    RawTileDataReader& _rawTileDataReader;
+    std::shared_ptr<const RawTileDataReader> _rawTileDataReader;
+    std::shared_ptr<CancellationToken> _token;
     RawTile _rawTile;
     const TileIndex _chunkIndex;
     bool _hasTile = false;
@@ -0,0 +1,157 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2023                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/globebrowsing/src/tilemetadata.h>
+
+#include <ghoul/misc/assert.h>
+#include <ghoul/misc/exception.h>
+#include <ghoul/misc/profiling.h>
+#include <algorithm>
+#include <array>
+#include <limits>
+
+namespace {
+    using namespace openspace::globebrowsing;
+
+    /**
+     * Scans \p nPixels pixels of \p NRasters interleaved values of type T. The values are
+     * processed in blocks of a fixed number of lanes that are a multiple of the number of
+     * rasters, so that every lane always accumulates the same raster. The lanes are kept
+     * free of branches which lets the compiler vectorize the min/max and masking
+     */
+    template <typename T, size_t NRasters>
+    TileMetaData scan(T* data, size_t nPixels, float noDataValue, bool& allIsMissing) {
+        constexpr size_t PixelsPerBlock = 4;
+        constexpr size_t Lanes = NRasters * PixelsPerBlock;
+        constexpr T Lowest = std::numeric_limits<T>::lowest();
+
+        std::array<float, Lanes> minValues;
+        std::array<float, Lanes> maxValues;
+        std::array<int, Lanes> nMissing;
+        std::array<int, Lanes> nValid;
+        minValues.fill(std::numeric_limits<float>::max());
+        maxValues.fill(-std::numeric_limits<float>::max());
+        nMissing.fill(0);
+        nValid.fill(0);
+
+        auto process = [noDataValue](T& datum, float& min, float& max, int& missing,
+                                     int& valid)
+        {
+            const float v = static_cast<float>(datum);
+            // The comparison v == v is false for NaN values
+            const bool isValid = (v != noDataValue) && (v == v);
+            min = isValid ? std::min(v, min) : min;
+            max = isValid ? std::max(v, max) : max;
+            missing += isValid ? 0 : 1;
+            valid += isValid ? 1 : 0;
+            datum = isValid ? datum : Lowest;
+        };
+
+        const size_t nBlocks = nPixels / PixelsPerBlock;
+        for (size_t b = 0; b < nBlocks; b++) {
+            T* block = data + b * Lanes;
+            for (size_t l = 0; l < Lanes; l++) {
+                process(block[l], minValues[l], maxValues[l], nMissing[l], nValid[l]);
+            }
+        }
+
+        // Remaining pixels that did not fill an entire block
+        T* rest = data + nBlocks * Lanes;
+        const size_t nRest = (nPixels - nBlocks * PixelsPerBlock) * NRasters;
+        for (size_t i = 0; i < nRest; i++) {
+            process(rest[i], minValues[i], maxValues[i], nMissing[i], nValid[i]);
+        }
+
+        TileMetaData result;
+        result.nValues = static_cast<uint8_t>(NRasters);
+        result.maxValues.fill(-std::numeric_limits<float>::max());
+        result.minValues.fill(std::numeric_limits<float>::max());
+        result.hasMissingData.fill(false);
+
+        int totalValid = 0;
+        for (size_t l = 0; l < Lanes; l++) {
+            const size_t raster = l % NRasters;
+            result.minValues[raster] = std::min(result.minValues[raster], minValues[l]);
+            result.maxValues[raster] = std::max(result.maxValues[raster], maxValues[l]);
+            result.hasMissingData[raster] =
+                result.hasMissingData[raster] || nMissing[l] > 0;
+            totalValid += nValid[l];
+        }
+        allIsMissing = (totalValid == 0);
+        return result;
+    }
+
+    template <typename T>
+    TileMetaData scan(std::byte* data, size_t nPixels, size_t nRasters, float noDataValue,
+                      bool& allIsMissing)
+    {
+        T* d = reinterpret_cast<T*>(data);
+        switch (nRasters) {
+            case 1:  return scan<T, 1>(d, nPixels, noDataValue, allIsMissing);
+            case 2:  return scan<T, 2>(d, nPixels, noDataValue, allIsMissing);
+            case 3:  return scan<T, 3>(d, nPixels, noDataValue, allIsMissing);
+            case 4:  return scan<T, 4>(d, nPixels, noDataValue, allIsMissing);
+            default: throw ghoul::MissingCaseException();
+        }
+    }
+} // namespace
+
+namespace openspace::globebrowsing {
+
+TileMetaData calculateTileMetaData(std::byte* data, size_t nPixels, GLenum glType,
+                                   size_t nRasters, float noDataValue,
+                                   bool& allIsMissing)
+{
+    ZoneScoped;
+
+    ghoul_assert(data, "No data provided");
+    ghoul_assert(nRasters >= 1 && nRasters <= 4, "Unexpected number of rasters");
+
+    switch (glType) {
+        case GL_UNSIGNED_BYTE:
+            return scan<GLubyte>(data, nPixels, nRasters, noDataValue, allIsMissing);
+        case GL_BYTE:
+            return scan<GLbyte>(data, nPixels, nRasters, noDataValue, allIsMissing);
+        case GL_UNSIGNED_SHORT:
+            return scan<GLushort>(data, nPixels, nRasters, noDataValue, allIsMissing);
+        case GL_SHORT:
+            return scan<GLshort>(data, nPixels, nRasters, noDataValue, allIsMissing);
+        case GL_UNSIGNED_INT:
+            return scan<GLuint>(data, nPixels, nRasters, noDataValue, allIsMissing);
+        case GL_INT:
+            return scan<GLint>(data, nPixels, nRasters, noDataValue, allIsMissing);
+        case GL_HALF_FLOAT:
+            // GLhalf is stored as an unsigned short and was always interpreted as such
+            return scan<GLhalf>(data, nPixels, nRasters, noDataValue, allIsMissing);
+        case GL_FLOAT:
+            return scan<GLfloat>(data, nPixels, nRasters, noDataValue, allIsMissing);
+        case GL_DOUBLE:
+            return scan<GLdouble>(data, nPixels, nRasters, noDataValue, allIsMissing);
+        default:
+            ghoul_assert(false, "Unknown data type");
+            throw ghoul::MissingCaseException();
+    }
+}
+
+} // namespace openspace::globebrowsing
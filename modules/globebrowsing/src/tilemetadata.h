@@ -22,61 +22,33 @@
  * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
  ****************************************************************************************/
 
-#include <ghoul/misc/assert.h>
+#ifndef __OPENSPACE_MODULE_GLOBEBROWSING___TILE_META_DATA___H__
+#define __OPENSPACE_MODULE_GLOBEBROWSING___TILE_META_DATA___H__
 
-namespace openspace::globebrowsing {
-
-template <typename P, typename KeyType>
-PrioritizingConcurrentJobManager<P, KeyType>::PrioritizingConcurrentJobManager(
-                                                              LRUThreadPool<KeyType> pool)
-    : _threadPool(std::move(pool))
-{}
-
-template <typename P, typename KeyType>
-void PrioritizingConcurrentJobManager<P, KeyType>::enqueueJob(std::shared_ptr<Job<P>> job,
-                                                              KeyType key)
-{
-    _threadPool.enqueue([this, job]() {
-        job->execute();
-        std::lock_guard lock(_finishedJobsMutex);
-        _finishedJobs.push(job);
-    }, key);
-}
-
-template <typename P, typename KeyType>
-std::vector<KeyType>
-PrioritizingConcurrentJobManager<P, KeyType>::keysToUnfinishedJobs() {
-    return _threadPool.getUnqueuedTasksKeys();
-}
-
-template <typename P, typename KeyType>
-std::vector<KeyType>
-PrioritizingConcurrentJobManager<P, KeyType>::keysToEnqueuedJobs() {
-    return _threadPool.getQueuedTasksKeys();
-}
+#include <modules/globebrowsing/src/basictypes.h>
+#include <ghoul/opengl/ghoul_gl.h>
+#include <cstddef>
 
-template <typename P, typename KeyType>
-bool PrioritizingConcurrentJobManager<P, KeyType>::touch(KeyType key) {
-    return _threadPool.touch(key);
-}
-
-template <typename P, typename KeyType>
-void PrioritizingConcurrentJobManager<P, KeyType>::clearEnqueuedJobs() {
-    _threadPool.clearEnqueuedTasks();
-}
-
-template <typename P, typename KeyType>
-std::shared_ptr<Job<P>> PrioritizingConcurrentJobManager<P, KeyType>::popFinishedJob() {
-    ghoul_assert(!_finishedJobs.empty(), "There is no finished job to pop");
-
-    std::lock_guard lock(_finishedJobsMutex);
-    std::shared_ptr<Job<P>> result = _finishedJobs.pop();
-    return result;
-}
+namespace openspace::globebrowsing {
 
-template <typename P, typename KeyType>
-size_t PrioritizingConcurrentJobManager<P, KeyType>::numFinishedJobs() const {
-    return _finishedJobs.size();
-}
+/**
+ * Calculates the minimum and maximum value of each raster in the interleaved pixel
+ * \p data that consists of \p nPixels pixels with \p nRasters values of type \p glType
+ * each. Values that are equal to the \p noDataValue or that are NaN are not considered
+ * for the minimum and maximum, but instead mark the raster as having missing data and are
+ * overwritten in \p data with the lowest value representable by \p glType.
+ *
+ * \param data The interleaved pixel data that is inspected and modified
+ * \param nPixels The number of pixels in \p data
+ * \param glType The data type of each value in \p data
+ * \param nRasters The number of values per pixel, which must be between 1 and 4
+ * \param noDataValue The value that signals missing data
+ * \param allIsMissing Will be set to `true` if no valid value was found in \p data
+ * \return The minimum and maximum values of each raster
+ */
+TileMetaData calculateTileMetaData(std::byte* data, size_t nPixels, GLenum glType,
+    size_t nRasters, float noDataValue, bool& allIsMissing);
 
 } // namespace openspace::globebrowsing
+
+#endif // __OPENSPACE_MODULE_GLOBEBROWSING___TILE_META_DATA___H__
@@ -0,0 +1,249 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2023                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/globebrowsing/src/tilepipelinetelemetry.h>
+
+#include <ghoul/misc/assert.h>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+
+namespace {
+    constexpr openspace::properties::Property::PropertyInfo EnqueuedInfo = {
+        "Enqueued",
+        "Enqueued tiles",
+        "The total number of tile load requests that have been enqueued",
+        openspace::properties::Property::Visibility::Developer
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo InFlightInfo = {
+        "InFlight",
+        "In-flight tiles",
+        "The number of tile load requests that have been enqueued, but whose results "
+        "have not been collected yet",
+        openspace::properties::Property::Visibility::Developer
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo CompletedInfo = {
+        "Completed",
+        "Completed tiles",
+        "The total number of tiles that have been loaded and delivered",
+        openspace::properties::Property::Visibility::Developer
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo DroppedInfo = {
+        "Dropped",
+        "Dropped tiles",
+        "The total number of tile load requests that were cancelled before their tile "
+        "was delivered",
+        openspace::properties::Property::Visibility::Developer
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo CacheHitsInfo = {
+        "CacheHits",
+        "Cache hits",
+        "The total number of requested tiles that were available in the tile cache",
+        openspace::properties::Property::Visibility::Developer
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo CacheMissesInfo = {
+        "CacheMisses",
+        "Cache misses",
+        "The total number of requested tiles that were not available in the tile cache",
+        openspace::properties::Property::Visibility::Developer
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo ReadTimeMedianInfo = {
+        "ReadTimeMedian",
+        "Read time median (ms)",
+        "The median time it took to read a tile from its dataset or the disk cache",
+        openspace::properties::Property::Visibility::Developer
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo ReadTime99Info = {
+        "ReadTime99",
+        "Read time 99th percentile (ms)",
+        "The 99th percentile of the time it took to read a tile from its dataset or the "
+        "disk cache",
+        openspace::properties::Property::Visibility::Developer
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo DecodeTimeMedianInfo = {
+        "DecodeTimeMedian",
+        "Decode time median (ms)",
+        "The median time it took to compute the metadata of a tile after it was read",
+        openspace::properties::Property::Visibility::Developer
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo DecodeTime99Info = {
+        "DecodeTime99",
+        "Decode time 99th percentile (ms)",
+        "The 99th percentile of the time it took to compute the metadata of a tile after "
+        "it was read",
+        openspace::properties::Property::Visibility::Developer
+    };
+
+    // Collecting the counters requires walking all tile providers of a layer, so the
+    // properties are refreshed less frequently than every frame
+    constexpr std::chrono::milliseconds UpdateInterval = std::chrono::milliseconds(500);
+
+    int clampToInt(uint64_t value) {
+        return static_cast<int>(
+            std::min<uint64_t>(value, std::numeric_limits<int>::max())
+        );
+    }
+} // namespace
+
+namespace openspace::globebrowsing {
+
+void LatencyHistogram::add(std::chrono::microseconds duration) {
+    const uint64_t us = static_cast<uint64_t>(std::max<int64_t>(duration.count(), 0));
+    const size_t index = std::min<size_t>(std::bit_width(us), NumBuckets - 1);
+    _buckets[index]++;
+    _count++;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (size_t i = 0; i < NumBuckets; i++) {
+        _buckets[i] += other._buckets[i];
+    }
+    _count += other._count;
+}
+
+void LatencyHistogram::clear() {
+    _buckets.fill(0);
+    _count = 0;
+}
+
+uint64_t LatencyHistogram::count() const {
+    return _count;
+}
+
+float LatencyHistogram::percentile(float p) const {
+    ghoul_assert(p >= 0.f && p <= 1.f, "Percentile out of range");
+
+    if (_count == 0) {
+        return 0.f;
+    }
+
+    const uint64_t target = std::max<uint64_t>(
+        static_cast<uint64_t>(std::ceil(p * static_cast<double>(_count))),
+        1
+    );
+    uint64_t accumulated = 0;
+    for (size_t i = 0; i < NumBuckets; i++) {
+        accumulated += _buckets[i];
+        if (accumulated >= target) {
+            return static_cast<float>(bucketUpperBound(i)) / 1000.f;
+        }
+    }
+    return static_cast<float>(bucketUpperBound(NumBuckets - 1)) / 1000.f;
+}
+
+const std::array<uint64_t, LatencyHistogram::NumBuckets>&
+LatencyHistogram::buckets() const
+{
+    return _buckets;
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(size_t index) {
+    ghoul_assert(index < NumBuckets, "Bucket index out of range");
+    return uint64_t(1) << index;
+}
+
+void TilePipelineCounters::merge(const TilePipelineCounters& other) {
+    enqueued += other.enqueued;
+    inFlight += other.inFlight;
+    completed += other.completed;
+    dropped += other.dropped;
+    cacheHits += other.cacheHits;
+    cacheMisses += other.cacheMisses;
+    readTime.merge(other.readTime);
+    decodeTime.merge(other.decodeTime);
+}
+
+TilePipelineTelemetry::TilePipelineTelemetry()
+    : properties::PropertyOwner({ "Telemetry", "Telemetry" })
+    , _enqueued(EnqueuedInfo, 0, 0, std::numeric_limits<int>::max())
+    , _inFlight(InFlightInfo, 0, 0, std::numeric_limits<int>::max())
+    , _completed(CompletedInfo, 0, 0, std::numeric_limits<int>::max())
+    , _dropped(DroppedInfo, 0, 0, std::numeric_limits<int>::max())
+    , _cacheHits(CacheHitsInfo, 0, 0, std::numeric_limits<int>::max())
+    , _cacheMisses(CacheMissesInfo, 0, 0, std::numeric_limits<int>::max())
+    , _readTimeMedian(ReadTimeMedianInfo, 0.f, 0.f, std::numeric_limits<float>::max())
+    , _readTime99(ReadTime99Info, 0.f, 0.f, std::numeric_limits<float>::max())
+    , _decodeTimeMedian(
+        DecodeTimeMedianInfo,
+        0.f,
+        0.f,
+        std::numeric_limits<float>::max()
+    )
+    , _decodeTime99(DecodeTime99Info, 0.f, 0.f, std::numeric_limits<float>::max())
+{
+    _enqueued.setReadOnly(true);
+    addProperty(_enqueued);
+    _inFlight.setReadOnly(true);
+    addProperty(_inFlight);
+    _completed.setReadOnly(true);
+    addProperty(_completed);
+    _dropped.setReadOnly(true);
+    addProperty(_dropped);
+    _cacheHits.setReadOnly(true);
+    addProperty(_cacheHits);
+    _cacheMisses.setReadOnly(true);
+    addProperty(_cacheMisses);
+    _readTimeMedian.setReadOnly(true);
+    addProperty(_readTimeMedian);
+    _readTime99.setReadOnly(true);
+    addProperty(_readTime99);
+    _decodeTimeMedian.setReadOnly(true);
+    addProperty(_decodeTimeMedian);
+    _decodeTime99.setReadOnly(true);
+    addProperty(_decodeTime99);
+}
+
+bool TilePipelineTelemetry::isUpdateDue() {
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (now - _lastUpdate < UpdateInterval) {
+        return false;
+    }
+    _lastUpdate = now;
+    return true;
+}
+
+void TilePipelineTelemetry::update(const TilePipelineCounters& counters) {
+    _enqueued = clampToInt(counters.enqueued);
+    _inFlight = clampToInt(counters.inFlight);
+    _completed = clampToInt(counters.completed);
+    _dropped = clampToInt(counters.dropped);
+    _cacheHits = clampToInt(counters.cacheHits);
+    _cacheMisses = clampToInt(counters.cacheMisses);
+    _readTimeMedian = counters.readTime.percentile(0.5f);
+    _readTime99 = counters.readTime.percentile(0.99f);
+    _decodeTimeMedian = counters.decodeTime.percentile(0.5f);
+    _decodeTime99 = counters.decodeTime.percentile(0.99f);
+}
+
+} // namespace openspace::globebrowsing
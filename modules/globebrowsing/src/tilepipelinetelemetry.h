@@ -0,0 +1,133 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2023                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_MODULE_GLOBEBROWSING___TILEPIPELINETELEMETRY___H__
+#define __OPENSPACE_MODULE_GLOBEBROWSING___TILEPIPELINETELEMETRY___H__
+
+#include <openspace/properties/propertyowner.h>
+
+#include <openspace/properties/scalar/floatproperty.h>
+#include <openspace/properties/scalar/intproperty.h>
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+namespace openspace::globebrowsing {
+
+/**
+ * A histogram of durations with logarithmic bucket sizes. Bucket `i` counts the
+ * durations that are at least `2^(i-1)` and less than `2^i` microseconds, with the first
+ * bucket counting everything below one microsecond and the last bucket everything that
+ * does not fit in the other buckets. Adding a duration is a constant time operation,
+ * which makes it cheap enough to be done for every tile that is loaded.
+ */
+class LatencyHistogram {
+public:
+    static constexpr size_t NumBuckets = 28;
+
+    void add(std::chrono::microseconds duration);
+    void merge(const LatencyHistogram& other);
+    void clear();
+
+    uint64_t count() const;
+
+    /**
+     * Returns the upper bound of the bucket that contains the percentile \p p of all
+     * durations, in milliseconds, or 0 if the histogram is empty.
+     *
+     * \pre \p p must be in the range [0, 1]
+     */
+    float percentile(float p) const;
+
+    const std::array<uint64_t, NumBuckets>& buckets() const;
+
+    /**
+     * Returns the upper bound, in microseconds, of the durations that are counted in the
+     * bucket with the provided \p index.
+     */
+    static uint64_t bucketUpperBound(size_t index);
+
+private:
+    std::array<uint64_t, NumBuckets> _buckets = {};
+    uint64_t _count = 0;
+};
+
+/**
+ * The counters of the tiles that a TileProvider has requested from its tile pipeline.
+ * All counters are cumulative since the provider was created, except for #inFlight,
+ * which is the number of jobs that have been enqueued but whose results have not been
+ * collected yet. The counters are only accessed from the main thread.
+ */
+struct TilePipelineCounters {
+    uint64_t enqueued = 0;
+    uint64_t inFlight = 0;
+    uint64_t completed = 0;
+    /// Requests that were cancelled before their tile was delivered
+    uint64_t dropped = 0;
+    /// Tiles that were requested and were already available in the in-memory cache
+    uint64_t cacheHits = 0;
+    /// Tiles that were requested and had to be loaded first
+    uint64_t cacheMisses = 0;
+
+    LatencyHistogram readTime;
+    LatencyHistogram decodeTime;
+
+    void merge(const TilePipelineCounters& other);
+};
+
+/**
+ * Exposes the TilePipelineCounters of a layer as read-only properties. The properties
+ * are only refreshed a few times per second so that observing them does not cost more
+ * than necessary.
+ */
+class TilePipelineTelemetry : public properties::PropertyOwner {
+public:
+    TilePipelineTelemetry();
+
+    /**
+     * Returns `true` if enough time has passed since the last time this function
+     * returned `true` for the properties to be refreshed through #update.
+     */
+    bool isUpdateDue();
+
+    void update(const TilePipelineCounters& counters);
+
+private:
+    properties::IntProperty _enqueued;
+    properties::IntProperty _inFlight;
+    properties::IntProperty _completed;
+    properties::IntProperty _dropped;
+    properties::IntProperty _cacheHits;
+    properties::IntProperty _cacheMisses;
+    properties::FloatProperty _readTimeMedian;
+    properties::FloatProperty _readTime99;
+    properties::FloatProperty _decodeTimeMedian;
+    properties::FloatProperty _decodeTime99;
+
+    std::chrono::steady_clock::time_point _lastUpdate;
+};
+
+} // namespace openspace::globebrowsing
+
+#endif // __OPENSPACE_MODULE_GLOBEBROWSING___TILEPIPELINETELEMETRY___H__
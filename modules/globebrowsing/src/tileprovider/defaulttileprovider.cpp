@@ -32,6 +32,10 @@
 #include <optional>
 
 namespace {
+    // The maximum number of prefetched tiles that can be waiting to be used. This keeps
+    // a prediction that is far off from flooding the tile cache
+    constexpr size_t MaxPendingPrefetches = 256;
+
     constexpr openspace::properties::Property::PropertyInfo FilePathInfo = {
         "FilePath",
         "File Path",
@@ -85,6 +89,12 @@ namespace {
         // Determines if the tiles should be preprocessed before uploading to the GPU
         std::optional<bool> performPreProcessing;
 
+        // The number of tiles of this layer that can be read from the dataset at the same
+        // time. Each concurrent read opens a separate handle to the dataset and uses a
+        // separate loading thread. Larger values improve loading times for local datasets
+        // at the cost of more memory and open files, but might overload remote servers
+        std::optional<int> concurrentReads [[codegen::inrange(1, 32)]];
+
         struct CacheSettings {
             // Specifies whether to use caching or not
             std::optional<bool> enabled;
@@ -113,6 +123,61 @@ namespace {
 
     };
 #include "defaulttileprovider_codegen.cpp"
+
+    openspace::globebrowsing::TileCacheProperties parametersToCacheProperties(
+                                                                      const Parameters& p)
+    {
+        using namespace openspace;
+        using namespace openspace::globebrowsing;
+
+        const layers::Group::ID groupId = layers::Group::ID(p.layerGroupID);
+
+        // Get the name of the layergroup to which this layer belongs
+        auto it = std::find_if(
+            layers::Groups.begin(),
+            layers::Groups.end(),
+            [groupId](const layers::Group& gi) {
+                return gi.id == groupId;
+            }
+        );
+
+        std::string layerGroup =
+            it != layers::Groups.end() ?
+            std::string(it->name) :
+            std::to_string(static_cast<int>(groupId));
+
+        std::string identifier = p.identifier.value_or("unspecified");
+        std::string enclosing = p.globeName.value_or("unspecified");
+
+        std::string path = fmt::format("{}/{}/{}/", enclosing, layerGroup, identifier);
+
+        GlobeBrowsingModule& module =
+            *global::moduleEngine->module<GlobeBrowsingModule>();
+        bool enabled = module.isMRFCachingEnabled();
+        Compression compression =
+            groupId == layers::Group::ID::HeightLayers ?
+            Compression::LERC :
+            Compression::JPEG;
+        int quality = 75;
+        int blockSize = 1024;
+        if (p.cacheSettings.has_value()) {
+            enabled = p.cacheSettings->enabled.value_or(enabled);
+            if (p.cacheSettings->compression.has_value()) {
+                compression = codegen::map<Compression>(*p.cacheSettings->compression);
+            }
+            quality = p.cacheSettings->quality.value_or(quality);
+            blockSize = p.cacheSettings->blockSize.value_or(blockSize);
+        }
+
+        TileCacheProperties cacheProperties;
+        cacheProperties.enabled = enabled;
+        cacheProperties.path = path;
+        cacheProperties.quality = quality;
+        cacheProperties.blockSize = blockSize;
+        cacheProperties.compression = codegen::toString(compression);
+        cacheProperties.nDatasetHandles = p.concurrentReads.value_or(1);
+        return cacheProperties;
+    }
 } // namespace
 
 namespace openspace::globebrowsing {
@@ -121,6 +186,13 @@ documentation::Documentation DefaultTileProvider::Documentation() {
     return codegen::doc<Parameters>("globebrowsing_defaulttileprovider");
 }
 
+TileCacheProperties DefaultTileProvider::cacheProperties(
+                                                      const ghoul::Dictionary& dictionary)
+{
+    const Parameters p = codegen::bake<Parameters>(dictionary);
+    return parametersToCacheProperties(p);
+}
+
 DefaultTileProvider::DefaultTileProvider(const ghoul::Dictionary& dictionary)
     : _filePath(FilePathInfo, "")
     , _tilePixelSize(TilePixelSizeInfo, 32, 32, 2048)
@@ -145,47 +217,7 @@ DefaultTileProvider::DefaultTileProvider(const ghoul::Dictionary& dictionary)
     _performPreProcessing = _layerGroupID == layers::Group::ID::HeightLayers;
     _performPreProcessing = p.performPreProcessing.value_or(_performPreProcessing);
 
-    // Get the name of the layergroup to which this layer belongs
-    auto it = std::find_if(
-        layers::Groups.begin(),
-        layers::Groups.end(),
-        [id = _layerGroupID](const layers::Group& gi) {
-            return gi.id == id;
-        }
-    );
-
-    std::string layerGroup =
-        it != layers::Groups.end() ?
-        std::string(it->name) :
-        std::to_string(static_cast<int>(_layerGroupID));
-
-    std::string identifier = p.identifier.value_or("unspecified");
-    std::string enclosing = p.globeName.value_or("unspecified");
-
-    std::string path = fmt::format("{}/{}/{}/", enclosing, layerGroup, identifier);
-
-    GlobeBrowsingModule& module = *global::moduleEngine->module<GlobeBrowsingModule>();
-    bool enabled = module.isMRFCachingEnabled();
-    Compression compression =
-        _layerGroupID == layers::Group::ID::HeightLayers ?
-        Compression::LERC :
-        Compression::JPEG;
-    int quality = 75;
-    int blockSize = 1024;
-    if (p.cacheSettings.has_value()) {
-        enabled = p.cacheSettings->enabled.value_or(enabled);
-        if (p.cacheSettings->compression.has_value()) {
-            compression = codegen::map<Compression>(*p.cacheSettings->compression);
-        }
-        quality = p.cacheSettings->quality.value_or(quality);
-        blockSize = p.cacheSettings->blockSize.value_or(blockSize);
-    }
-
-    _cacheProperties.enabled = enabled;
-    _cacheProperties.path = path;
-    _cacheProperties.quality = quality;
-    _cacheProperties.blockSize = blockSize;
-    _cacheProperties.compression = codegen::toString(compression);
+    _cacheProperties = parametersToCacheProperties(p);
 
     TileTextureInitData initData(
         tileTextureInitData(_layerGroupID, pixelSize)
@@ -227,10 +259,18 @@ Tile DefaultTileProvider::tile(const TileIndex& tileIndex) {
     cache::MemoryAwareTileCache* tileCache =
         global::moduleEngine->module<GlobeBrowsingModule>()->tileCache();
     Tile tile = tileCache->get(key);
-    if (!tile.texture) {
+    if (tile.texture) {
+        pipelineCounters.cacheHits++;
+    }
+    else {
+        pipelineCounters.cacheMisses++;
         _asyncTextureDataProvider->enqueueTileIO(tileIndex);
     }
 
+    if (!_prefetchedTiles.empty() && _prefetchedTiles.erase(tileIndex.hashKey()) > 0) {
+        prefetchCounters.hits++;
+    }
+
     return tile;
 }
 
@@ -259,6 +299,7 @@ TileDepthTransform DefaultTileProvider::depthTransform() {
 void DefaultTileProvider::update() {
     ghoul_assert(_asyncTextureDataProvider, "No data provider");
     _asyncTextureDataProvider->update();
+    sweepPrefetchedTiles();
 
     std::optional<RawTile> tile = _asyncTextureDataProvider->popFinishedRawTile();
     if (tile) {
@@ -269,10 +310,14 @@ void DefaultTileProvider::update() {
         cache::MemoryAwareTileCache* tileCache =
             global::moduleEngine->module<GlobeBrowsingModule>()->tileCache();
         ghoul_assert(!tileCache->exist(key), "Tile must not be existing in cache");
-        tileCache->createTileAndPut(key, std::move(*tile));
+        const double cost = cache::tileCost(*tile);
+        tileCache->createTileAndPut(key, std::move(*tile), cost);
     }
 
     if (_asyncTextureDataProvider->shouldBeDeleted()) {
+        // Keep the counters of the old reader, whose jobs have all been collected by now
+        pipelineCounters.merge(_asyncTextureDataProvider->counters());
+        pipelineCounters.inFlight = 0;
         initAsyncTileDataReader(
             tileTextureInitData(_layerGroupID, _tilePixelSize),
             _cacheProperties
@@ -280,8 +325,16 @@ void DefaultTileProvider::update() {
     }
 }
 
+void DefaultTileProvider::collectPipelineCounters(TilePipelineCounters& counters) const
+{
+    ghoul_assert(_asyncTextureDataProvider, "No data provider");
+    counters.merge(pipelineCounters);
+    counters.merge(_asyncTextureDataProvider->counters());
+}
+
 void DefaultTileProvider::reset() {
     global::moduleEngine->module<GlobeBrowsingModule>()->tileCache()->clear();
+    _prefetchedTiles.clear();
     ghoul_assert(_asyncTextureDataProvider, "No data provider");
     _asyncTextureDataProvider->prepareToBeDeleted();
 }
@@ -301,4 +354,70 @@ float DefaultTileProvider::noDataValueAsFloat() {
     return _asyncTextureDataProvider->noDataValueAsFloat();
 }
 
+bool DefaultTileProvider::prefetchTile(const TileIndex& tileIndex) {
+    ZoneScoped;
+
+    ghoul_assert(_asyncTextureDataProvider, "No data provider");
+    if (tileIndex.level < minLevel() || _prefetchedTiles.size() >= MaxPendingPrefetches)
+    {
+        return false;
+    }
+
+    // Tiles beyond the maximum level are rendered using their ancestor at the maximum
+    // level, so that is the tile that will be needed
+    TileIndex index = tileIndex;
+    while (index.level > maxLevel()) {
+        index = TileIndex(index.x / 2, index.y / 2, index.level - 1);
+    }
+
+    const cache::ProviderTileKey key = {
+        .tileIndex = index,
+        .providerID = uniqueIdentifier
+    };
+    cache::MemoryAwareTileCache* tileCache =
+        global::moduleEngine->module<GlobeBrowsingModule>()->tileCache();
+    if (tileCache->exist(key)) {
+        return false;
+    }
+
+    if (_asyncTextureDataProvider->enqueueTilePrefetch(index)) {
+        _prefetchedTiles.emplace(index.hashKey(), index);
+        prefetchCounters.requests++;
+        return true;
+    }
+    return false;
+}
+
+void DefaultTileProvider::cancelPrefetches() {
+    ghoul_assert(_asyncTextureDataProvider, "No data provider");
+    const size_t nCancelled = _asyncTextureDataProvider->cancelTilePrefetches();
+    if (nCancelled > 0) {
+        // The cancelled tiles are neither enqueued nor in the cache anymore
+        sweepPrefetchedTiles();
+    }
+}
+
+void DefaultTileProvider::sweepPrefetchedTiles() {
+    if (_prefetchedTiles.empty()) {
+        return;
+    }
+
+    cache::MemoryAwareTileCache* tileCache =
+        global::moduleEngine->module<GlobeBrowsingModule>()->tileCache();
+    for (auto it = _prefetchedTiles.begin(); it != _prefetchedTiles.end();) {
+        const cache::ProviderTileKey key = {
+            .tileIndex = it->second,
+            .providerID = uniqueIdentifier
+        };
+        const bool isLoading = _asyncTextureDataProvider->isEnqueued(it->second);
+        if (!isLoading && !tileCache->exist(key)) {
+            prefetchCounters.waste++;
+            it = _prefetchedTiles.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
 } // namespace openspace::globebrowsing
@@ -29,6 +29,7 @@
 #include <modules/globebrowsing/src/tilecacheproperties.h>
 #include <modules/globebrowsing/src/asynctiledataprovider.h>
 #include <memory>
+#include <unordered_map>
 
 namespace openspace::globebrowsing {
 
@@ -44,13 +45,29 @@ public:
     int minLevel() override final;
     int maxLevel() override final;
     float noDataValueAsFloat() override final;
+    bool prefetchTile(const TileIndex& tileIndex) override final;
+    void cancelPrefetches() override final;
+    void collectPipelineCounters(TilePipelineCounters& counters) const override final;
 
     static documentation::Documentation Documentation();
 
+    /**
+     * Returns the MRF cache properties that a DefaultTileProvider created from the
+     * provided \p dictionary would use. This determines the location and the format of
+     * the cache, so that it can also be generated outside of a running session.
+     */
+    static TileCacheProperties cacheProperties(const ghoul::Dictionary& dictionary);
+
 private:
     void initAsyncTileDataReader(TileTextureInitData initData,
         TileCacheProperties cacheProperties);
 
+    /**
+     * Removes all prefetched tiles that were evicted from the tile cache or whose
+     * loading failed before they were used, and counts them as wasted.
+     */
+    void sweepPrefetchedTiles();
+
     properties::StringProperty _filePath;
     properties::IntProperty _tilePixelSize;
 
@@ -58,6 +75,9 @@ private:
     layers::Group::ID _layerGroupID = layers::Group::ID::Unknown;
     bool _performPreProcessing = false;
     TileCacheProperties _cacheProperties;
+
+    /// Prefetched tiles that have not been requested through #tile yet
+    std::unordered_map<TileIndex::TileHashKey, TileIndex> _prefetchedTiles;
 };
 
 } // namespace openspace::globebrowsing
@@ -132,6 +132,11 @@ void ImageSequenceTileProvider::update() {
         _index >= 0 && _index < static_cast<int>(_imagePaths.size()))
     {
         if (_currentTileProvider) {
+            // Keep the counters of the previous image, but not its unfinished jobs
+            TilePipelineCounters previous;
+            _currentTileProvider->collectPipelineCounters(previous);
+            previous.inFlight = 0;
+            pipelineCounters.merge(previous);
             _currentTileProvider->deinitialize();
         }
 
@@ -183,4 +188,13 @@ float ImageSequenceTileProvider::noDataValueAsFloat() {
         std::numeric_limits<float>::min();
 }
 
+void ImageSequenceTileProvider::collectPipelineCounters(
+                                                     TilePipelineCounters& counters) const
+{
+    if (_currentTileProvider) {
+        _currentTileProvider->collectPipelineCounters(counters);
+    }
+    counters.merge(pipelineCounters);
+}
+
 } // namespace openspace::globebrowsing
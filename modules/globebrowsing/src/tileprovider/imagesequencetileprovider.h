@@ -43,6 +43,7 @@ public:
     int minLevel() override final;
     int maxLevel() override final;
     float noDataValueAsFloat() override final;
+    void collectPipelineCounters(TilePipelineCounters& counters) const override final;
 
     static documentation::Documentation Documentation();
 
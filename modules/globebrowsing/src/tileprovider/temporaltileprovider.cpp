@@ -30,6 +30,7 @@
 #include <openspace/documentation/documentation.h>
 #include <openspace/engine/globals.h>
 #include <openspace/engine/moduleengine.h>
+#include <openspace/engine/windowdelegate.h>
 #include <openspace/rendering/renderengine.h>
 #include <openspace/util/memorymanager.h>
 #include <openspace/util/spicemanager.h>
@@ -38,6 +39,7 @@
 #include <ghoul/io/texture/texturereader.h>
 #include <ghoul/opengl/openglstatecache.h>
 #include <ghoul/opengl/textureunit.h>
+#include <chrono>
 #include <ctime>
 #include <iomanip>
 #include <iostream>
@@ -63,6 +65,30 @@ namespace {
         openspace::properties::Property::Visibility::AdvancedUser
     };
 
+    constexpr openspace::properties::Property::PropertyInfo MaxTimestepsInfo = {
+        "MaxTimesteps",
+        "Maximum Timesteps",
+        "The maximum number of timesteps for which the data is kept open at the same "
+        "time. If more timesteps have been visited, the least recently used ones are "
+        "closed. Timesteps that are currently shown or warmed are never closed, so this "
+        "limit can be exceeded temporarily",
+        openspace::properties::Property::Visibility::AdvancedUser
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo LookAheadInfo = {
+        "LookAhead",
+        "Look Ahead",
+        "The number of upcoming timesteps that are loaded ahead of time while the time "
+        "is running. The timesteps are chosen in the direction of the current delta time "
+        "and, for fast delta times, skip the timesteps that would not be shown anyway. A "
+        "value of 0 disables the look-ahead",
+        openspace::properties::Property::Visibility::AdvancedUser
+    };
+
+    // At most this many timestep providers are created by the look-ahead in a single
+    // frame, as opening a dataset is done synchronously
+    constexpr int MaxNewLookAheadProvidersPerFrame = 1;
+
     struct [[codegen::Dictionary(TemporalTileProvider)]] Parameters {
         // [[codegen::verbatim(UseFixedTimeInfo.description)]]
         std::optional<bool> useFixedTime;
@@ -70,6 +96,12 @@ namespace {
         // [[codegen::verbatim(FixedTimeInfo.description)]]
         std::optional<std::string> fixedTime;
 
+        // [[codegen::verbatim(MaxTimestepsInfo.description)]]
+        std::optional<int> maxTimesteps [[codegen::greaterequal(1)]];
+
+        // [[codegen::verbatim(LookAheadInfo.description)]]
+        std::optional<int> lookAhead [[codegen::greaterequal(0)]];
+
         enum class Mode {
             Prototyped,
             Folder
@@ -166,6 +198,8 @@ TemporalTileProvider::TemporalTileProvider(const ghoul::Dictionary& dictionary)
     : _initDict(dictionary)
     , _useFixedTime(UseFixedTimeInfo, false)
     , _fixedTime(FixedTimeInfo)
+    , _maxTimesteps(MaxTimestepsInfo, 16, 1, 256)
+    , _lookAhead(LookAheadInfo, 2, 0, 16)
 {
     ZoneScoped;
 
@@ -192,6 +226,12 @@ TemporalTileProvider::TemporalTileProvider(const ghoul::Dictionary& dictionary)
     _fixedTime.onChange([this]() { _fixedTimeDirty = true; });
     addProperty(_fixedTime);
 
+    _maxTimesteps = p.maxTimesteps.value_or(_maxTimesteps);
+    addProperty(_maxTimesteps);
+
+    _lookAhead = p.lookAhead.value_or(_lookAhead);
+    addProperty(_lookAhead);
+
     _colormap = p.colormap.value_or(_colormap);
 
     if (p.prototyped.has_value()) {
@@ -215,6 +255,10 @@ TemporalTileProvider::TemporalTileProvider(const ghoul::Dictionary& dictionary)
             );
             _prototyped.timeQuantizer.setResolution(p.prototyped->temporalResolution);
             _prototyped.temporalResolution = p.prototyped->temporalResolution;
+            _prototyped.resolutionSeconds =
+                _prototyped.timeQuantizer.parseTimeResolutionStr(
+                    p.prototyped->temporalResolution
+                );
         }
         catch (const ghoul::RuntimeError& e) {
             throw ghoul::RuntimeError(fmt::format(
@@ -321,7 +365,15 @@ Tile TemporalTileProvider::tile(const TileIndex& tileIndex) {
         update();
     }
 
-    return _currentTileProvider->tile(tileIndex);
+    Tile t = _currentTileProvider->tile(tileIndex);
+    if (t.status == Tile::Status::OK) {
+        // Only request the tiles of the upcoming timesteps once the current timestep has
+        // them, so that the look-ahead does not compete with the visible data
+        for (DefaultTileProvider* provider : _lookAheadProviders) {
+            provider->prefetchTile(tileIndex);
+        }
+    }
+    return t;
 }
 
 Tile::Status TemporalTileProvider::tileStatus(const TileIndex& index) {
@@ -341,6 +393,8 @@ TileDepthTransform TemporalTileProvider::depthTransform() {
 }
 
 void TemporalTileProvider::update() {
+    _frame++;
+
     TileProvider* newCurr = nullptr;
     try {
         if (_useFixedTime && !_fixedTime.value().empty()) {
@@ -365,11 +419,23 @@ void TemporalTileProvider::update() {
     if (_currentTileProvider) {
         _currentTileProvider->update();
     }
+
+    _lookAheadProviders.clear();
+    if (!_useFixedTime || _fixedTime.value().empty()) {
+        try {
+            warmLookAhead(global::timeManager->time());
+        }
+        catch (const ghoul::RuntimeError& e) {
+            LERRORC("TemporalTileProvider", e.message);
+        }
+    }
+
+    evictTimesteps();
 }
 
 void TemporalTileProvider::reset() {
-    for (std::pair<const double, DefaultTileProvider>& it : _tileProviderMap) {
-        it.second.reset();
+    for (std::pair<const double, TimestepProvider>& it : _tileProviderMap) {
+        it.second.provider.reset();
     }
 }
 
@@ -388,6 +454,14 @@ float TemporalTileProvider::noDataValueAsFloat() {
     return std::numeric_limits<float>::min();
 }
 
+void TemporalTileProvider::collectPipelineCounters(TilePipelineCounters& counters) const
+{
+    for (const std::pair<const double, TimestepProvider>& it : _tileProviderMap) {
+        it.second.provider.collectPipelineCounters(counters);
+    }
+    counters.merge(pipelineCounters);
+}
+
 DefaultTileProvider TemporalTileProvider::createTileProvider(
                                                            std::string_view timekey) const
 {
@@ -431,7 +505,8 @@ DefaultTileProvider* TemporalTileProvider::retrieveTileProvider(const Time& t) {
 
     const double time = t.j2000Seconds();
     if (const auto it = _tileProviderMap.find(time);  it != _tileProviderMap.end()) {
-        return &it->second;
+        it->second.lastUsedFrame = _frame;
+        return &it->second.provider;
     }
 
     std::string_view timeStr = [this, time]() {
@@ -459,8 +534,165 @@ DefaultTileProvider* TemporalTileProvider::retrieveTileProvider(const Time& t) {
     DefaultTileProvider tileProvider = createTileProvider(timeStr);
     tileProvider.initialize();
 
-    auto it = _tileProviderMap.insert({ time, std::move(tileProvider) });
-    return &it.first->second;
+    auto it = _tileProviderMap.insert({
+        time,
+        TimestepProvider{ std::move(tileProvider), _frame }
+    });
+    return &it.first->second.provider;
+}
+
+std::vector<double> TemporalTileProvider::lookAheadTimes(const Time& time,
+                                                         double deltaTime)
+{
+    ZoneScoped;
+
+    const int direction = deltaTime > 0.0 ? 1 : -1;
+    // The simulation time that passes between two rendered frames. If this is longer
+    // than a timestep, intermediate timesteps are never shown and should be skipped
+    const double advance =
+        std::abs(deltaTime) * global::windowDelegate->averageDeltaTime();
+
+    std::vector<double> res;
+    res.reserve(static_cast<size_t>(_lookAhead.value()));
+    switch (_mode) {
+        case Mode::Folder: {
+            using Files = std::vector<std::pair<double, std::string>>;
+            auto indexAt = [this](double t) {
+                Files::const_iterator it = std::upper_bound(
+                    _folder.files.cbegin(),
+                    _folder.files.cend(),
+                    t,
+                    [](double sec, const std::pair<double, std::string>& p) {
+                        return sec < p.first;
+                    }
+                );
+                // The index of the last file that starts before or at t
+                return static_cast<int>(std::distance(_folder.files.cbegin(), it)) - 1;
+            };
+
+            const int nFiles = static_cast<int>(_folder.files.size());
+            int prev = std::max(indexAt(time.j2000Seconds()), 0);
+            for (int i = 1; i <= _lookAhead; i++) {
+                int index = indexAt(time.j2000Seconds() + direction * i * advance);
+                index = direction > 0 ? std::max(index, prev + 1) :
+                                        std::min(index, prev - 1);
+                if (index < 0 || index >= nFiles) {
+                    break;
+                }
+                res.push_back(_folder.files[index].first);
+                prev = index;
+            }
+            break;
+        }
+        case Mode::Prototype: {
+            Time current = time;
+            if (!_prototyped.timeQuantizer.quantize(current, true)) {
+                break;
+            }
+
+            const double step = _prototyped.resolutionSeconds;
+            double prev = current.j2000Seconds();
+            for (int i = 1; i <= _lookAhead; i++) {
+                // Quantization rounds down, so aiming half a step beyond the next
+                // boundary also works for resolutions of varying length, such as months
+                const double target = time.j2000Seconds() + direction * i * advance;
+                Time next = Time(
+                    direction > 0 ?
+                    std::max(target, prev + 1.5 * step) :
+                    std::min(target, prev - 0.5 * step)
+                );
+                if (!_prototyped.timeQuantizer.quantize(next, true) ||
+                    next.j2000Seconds() * direction <= prev * direction)
+                {
+                    // We have reached the end of the dataset
+                    break;
+                }
+                res.push_back(next.j2000Seconds());
+                prev = next.j2000Seconds();
+            }
+            break;
+        }
+        default:
+            throw ghoul::MissingCaseException();
+    }
+    return res;
+}
+
+void TemporalTileProvider::warmLookAhead(const Time& time) {
+    ZoneScoped;
+
+    const double deltaTime = global::timeManager->deltaTime();
+    if (_lookAhead == 0 || global::timeManager->isPaused() || deltaTime == 0.0) {
+        return;
+    }
+
+    int nNewProviders = 0;
+    for (double t : lookAheadTimes(time, deltaTime)) {
+        const bool exists = _tileProviderMap.find(t) != _tileProviderMap.end();
+        if (!exists) {
+            if (nNewProviders == MaxNewLookAheadProvidersPerFrame) {
+                // The remaining timesteps are warmed in one of the next frames
+                break;
+            }
+            nNewProviders++;
+        }
+
+        DefaultTileProvider* provider = retrieveTileProvider(Time(t));
+        if (provider != _currentTileProvider) {
+            _lookAheadProviders.push_back(provider);
+        }
+    }
+
+    for (DefaultTileProvider* provider : _lookAheadProviders) {
+        // Uploads the prefetched tiles that have finished loading
+        provider->update();
+    }
+}
+
+void TemporalTileProvider::evictTimesteps() {
+    ZoneScoped;
+
+    auto isInUse = [this](const TimestepProvider& p) {
+        if (p.lastUsedFrame == _frame || &p.provider == _currentTileProvider) {
+            return true;
+        }
+        if (_isInterpolating) {
+            const InterpolateTileProvider& ip = *_interpolateTileProvider;
+            return &p.provider == ip.t1 || &p.provider == ip.t2 ||
+                   &p.provider == ip.before || &p.provider == ip.future;
+        }
+        return false;
+    };
+
+    const size_t maxTimesteps = static_cast<size_t>(_maxTimesteps);
+    while (_tileProviderMap.size() > maxTimesteps) {
+        using It = std::unordered_map<double, TimestepProvider>::iterator;
+        It victim = _tileProviderMap.end();
+        for (It it = _tileProviderMap.begin(); it != _tileProviderMap.end(); it++) {
+            if (isInUse(it->second)) {
+                continue;
+            }
+            if (victim == _tileProviderMap.end() ||
+                it->second.lastUsedFrame < victim->second.lastUsedFrame)
+            {
+                victim = it;
+            }
+        }
+
+        if (victim == _tileProviderMap.end()) {
+            // All remaining providers are needed for the current frame
+            break;
+        }
+
+        // Keep the counters of the evicted timestep, but not its unfinished jobs
+        TilePipelineCounters evicted;
+        victim->second.provider.collectPipelineCounters(evicted);
+        evicted.inFlight = 0;
+        pipelineCounters.merge(evicted);
+
+        victim->second.provider.deinitialize();
+        _tileProviderMap.erase(victim);
+    }
 }
 
 template <>
@@ -740,6 +972,8 @@ Tile TemporalTileProvider::InterpolateTileProvider::tile(const TileIndex& tileIn
         TileTextureInitData::ShouldAllocateDataOnCPU::No
     );
 
+    const auto start = std::chrono::steady_clock::now();
+
     // Check if a tile exists for the given key in the tileCache
     // Initializing the tile that will contian the interpolated texture
     Tile ourTile;
@@ -747,15 +981,16 @@ Tile TemporalTileProvider::InterpolateTileProvider::tile(const TileIndex& tileIn
     ghoul::opengl::Texture* writeTexture;
     cache::MemoryAwareTileCache* tileCache =
         global::moduleEngine->module<GlobeBrowsingModule>()->tileCache();
-    if (tileCache->exist(key)) {
+    const bool isCached = tileCache->exist(key);
+    if (isCached) {
         ourTile = tileCache->get(key);
         writeTexture = ourTile.texture;
     }
     else {
-        // Create a texture with the initialization data
+        // Create a texture with the initialization data. The tile is put into the cache
+        // once it has been rendered and the time that took is known
         writeTexture = tileCache->texture(initData);
         ourTile = Tile{ writeTexture, std::nullopt, Tile::Status::OK };
-        tileCache->put(key, initData.hashKey, ourTile);
     }
 
     // Saves current state
@@ -814,6 +1049,15 @@ Tile TemporalTileProvider::InterpolateTileProvider::tile(const TileIndex& tileIn
     global::renderEngine->openglStateCache().resetPolygonAndClippingState();
     global::renderEngine->openglStateCache().resetViewportState();
 
+    if (!isCached) {
+        const double cost = cache::tileCost(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start
+            )
+        );
+        tileCache->put(key, initData.hashKey, ourTile, cost);
+    }
+
     return ourTile;
 }
 
@@ -29,6 +29,7 @@
 
 #include <modules/globebrowsing/src/tileprovider/defaulttileprovider.h>
 #include <modules/globebrowsing/src/tileprovider/singleimagetileprovider.h>
+#include <openspace/properties/scalar/intproperty.h>
 
 namespace openspace::globebrowsing {
 
@@ -54,6 +55,7 @@ public:
     int minLevel() override final;
     int maxLevel() override final;
     float noDataValueAsFloat() override final;
+    void collectPipelineCounters(TilePipelineCounters& counters) const override final;
 
     static documentation::Documentation Documentation();
 
@@ -91,6 +93,28 @@ private:
     DefaultTileProvider createTileProvider(std::string_view timekey) const;
     DefaultTileProvider* retrieveTileProvider(const Time& t);
 
+    /**
+     * Returns the times of the next timesteps, at most `LookAhead` many, that will be
+     * shown if the time continues to advance with the current delta time. The returned
+     * times are ordered by how soon they will be needed and do not include the timestep
+     * of the provided \p time.
+     */
+    std::vector<double> lookAheadTimes(const Time& time, double deltaTime);
+
+    /**
+     * Creates the tile providers for the timesteps that follow \p time in the
+     * direction of the current delta time, so that they are ready when the time
+     * reaches them.
+     */
+    void warmLookAhead(const Time& time);
+
+    /**
+     * Removes the least recently used timestep providers until no more than
+     * `MaxTimesteps` providers are alive. Providers that are needed in the current
+     * frame are never removed.
+     */
+    void evictTimesteps();
+
     template <Mode mode, bool interpolation>
     TileProvider* tileProvider(const Time& time);
 
@@ -106,6 +130,7 @@ private:
         std::string timeFormat;
         TimeQuantizer timeQuantizer;
         std::string prototype;
+        double resolutionSeconds = 0.0;
     } _prototyped;
 
     struct {
@@ -118,10 +143,21 @@ private:
     ghoul::Dictionary _initDict;
     properties::BoolProperty _useFixedTime;
     properties::StringProperty _fixedTime;
+    properties::IntProperty _maxTimesteps;
+    properties::IntProperty _lookAhead;
     bool _fixedTimeDirty = true;
 
+    struct TimestepProvider {
+        DefaultTileProvider provider;
+        /// The frame in which this provider was last requested
+        uint64_t lastUsedFrame = 0;
+    };
+
     TileProvider* _currentTileProvider = nullptr;
-    std::unordered_map<double, DefaultTileProvider> _tileProviderMap;
+    std::unordered_map<double, TimestepProvider> _tileProviderMap;
+    /// The providers of the upcoming timesteps that are warmed in the current frame
+    std::vector<DefaultTileProvider*> _lookAheadProviders;
+    uint64_t _frame = 0;
 
     bool _isInterpolating = false;
 
@@ -32,6 +32,7 @@
 #include <ghoul/font/fontmanager.h>
 #include <ghoul/font/fontrenderer.h>
 #include <ghoul/opengl/openglstatecache.h>
+#include <chrono>
 
 namespace openspace::globebrowsing {
 
@@ -69,6 +70,7 @@ Tile TextTileProvider::renderTile(const TileIndex& tileIndex, const std::string&
     cache::ProviderTileKey key = { tileIndex, uniqueIdentifier };
     Tile tile = tileCache->get(key);
     if (!tile.texture) {
+        const auto start = std::chrono::steady_clock::now();
         ghoul::opengl::Texture* texture = tileCache->texture(initData);
 
         GLint prevProgram, prevFBO;
@@ -100,7 +102,12 @@ Tile TextTileProvider::renderTile(const TileIndex& tileIndex, const std::string&
         fontRenderer->render(*font, position, text, color);
 
         tile = Tile{ texture, std::nullopt, Tile::Status::OK };
-        tileCache->put(key, initData.hashKey, tile);
+        const double cost = cache::tileCost(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start
+            )
+        );
+        tileCache->put(key, initData.hashKey, tile, cost);
 
         // Reset FBO, shader program and viewport
         glUseProgram(prevProgram);
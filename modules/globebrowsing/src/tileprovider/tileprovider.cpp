@@ -194,6 +194,16 @@ ChunkTile TileProvider::traverseTree(TileIndex tileIndex, int parents, int maxPa
 void TileProvider::internalInitialize() {}
 void TileProvider::internalDeinitialize() {}
 
+bool TileProvider::prefetchTile(const TileIndex&) {
+    return false;
+}
+
+void TileProvider::cancelPrefetches() {}
+
+void TileProvider::collectPipelineCounters(TilePipelineCounters& counters) const {
+    counters.merge(pipelineCounters);
+}
+
 ChunkTile TileProvider::chunkTile(TileIndex tileIndex, int parents, int maxParents) {
     ZoneScoped;
 
@@ -31,6 +31,7 @@
 #include <modules/globebrowsing/src/ellipsoid.h>
 #include <modules/globebrowsing/src/layergroupid.h>
 #include <modules/globebrowsing/src/tileindex.h>
+#include <modules/globebrowsing/src/tilepipelinetelemetry.h>
 #include <modules/globebrowsing/src/tiletextureinitdata.h>
 #include <modules/globebrowsing/src/timequantizer.h>
 #include <openspace/properties/stringproperty.h>
@@ -71,6 +72,18 @@ enum class Type {
     FfmpegTileProvider
 };
 
+/**
+ * Counters that describe how useful the tiles were that a TileProvider has prefetched.
+ * A prefetched tile is a hit if it was requested through TileProvider::tile before it
+ * was evicted and it is wasted if its loading was cancelled or if it was evicted from
+ * the tile cache without being used.
+ */
+struct PrefetchCounters {
+    uint64_t requests = 0;
+    uint64_t hits = 0;
+    uint64_t waste = 0;
+};
+
 struct TileProvider : public properties::PropertyOwner {
     static unsigned int NumTileProviders;
 
@@ -131,6 +144,26 @@ struct TileProvider : public properties::PropertyOwner {
      */
     virtual float noDataValueAsFloat() = 0;
 
+    /**
+     * Requests the tile with the provided \p tileIndex to be loaded in the background
+     * as it is expected to be needed soon. Prefetched tiles are loaded with a lower
+     * priority than the tiles requested through #tile. The default implementation does
+     * not support prefetching.
+     *
+     * \return `true` if a request for the tile was issued
+     */
+    virtual bool prefetchTile(const TileIndex& tileIndex);
+
+    /**
+     * Cancels all prefetch requests that have not been started yet.
+     */
+    virtual void cancelPrefetches();
+
+    /**
+     * Adds the TilePipelineCounters of this TileProvider and of all TileProviders that
+     * it owns to \p counters. The default implementation only adds #pipelineCounters.
+     */
+    virtual void collectPipelineCounters(TilePipelineCounters& counters) const;
 
     virtual ChunkTile chunkTile(TileIndex tileIndex, int parents = 0,
         int maxParents = 1337);
@@ -141,6 +174,8 @@ struct TileProvider : public properties::PropertyOwner {
 
     uint16_t uniqueIdentifier = 0;
     bool isInitialized = false;
+    PrefetchCounters prefetchCounters;
+    TilePipelineCounters pipelineCounters;
 protected:
     ChunkTile traverseTree(TileIndex tileIndex, int parents, int maxParents,
         std::function<void(TileIndex&, TileUvTransform&)>& ascendToParent,
@@ -154,4 +154,15 @@ float TileProviderByIndex::noDataValueAsFloat() {
     return std::numeric_limits<float>::min();
 }
 
+void TileProviderByIndex::collectPipelineCounters(TilePipelineCounters& counters) const
+{
+    using K = TileIndex::TileHashKey;
+    using V = std::unique_ptr<TileProvider>;
+    for (const std::pair<const K, V>& it : _providers) {
+        it.second->collectPipelineCounters(counters);
+    }
+    _defaultTileProvider->collectPipelineCounters(counters);
+    counters.merge(pipelineCounters);
+}
+
 } // namespace openspace::globebrowsing
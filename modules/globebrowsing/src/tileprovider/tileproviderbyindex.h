@@ -41,6 +41,7 @@ public:
     int minLevel() override final;
     int maxLevel() override final;
     float noDataValueAsFloat() override final;
+    void collectPipelineCounters(TilePipelineCounters& counters) const override final;
 
     static documentation::Documentation Documentation();
 
@@ -175,4 +175,12 @@ float TileProviderByLevel::noDataValueAsFloat() {
     return std::numeric_limits<float>::min();
 }
 
+void TileProviderByLevel::collectPipelineCounters(TilePipelineCounters& counters) const
+{
+    for (const std::unique_ptr<TileProvider>& provider : _levelTileProviders) {
+        provider->collectPipelineCounters(counters);
+    }
+    counters.merge(pipelineCounters);
+}
+
 } // namespace openspace::globebrowsing
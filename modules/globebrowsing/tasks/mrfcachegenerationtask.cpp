@@ -0,0 +1,413 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2023                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/globebrowsing/tasks/mrfcachegenerationtask.h>
+
+#include <modules/globebrowsing/globebrowsingmodule.h>
+#include <modules/globebrowsing/src/layergroupid.h>
+#include <modules/globebrowsing/src/rawtile.h>
+#include <modules/globebrowsing/src/rawtiledatareader.h>
+#include <modules/globebrowsing/src/tilecacheproperties.h>
+#include <modules/globebrowsing/src/tileindex.h>
+#include <modules/globebrowsing/src/tiletextureinitdata.h>
+#include <modules/globebrowsing/src/tileprovider/defaulttileprovider.h>
+#include <openspace/documentation/documentation.h>
+#include <openspace/documentation/verifier.h>
+#include <openspace/engine/globals.h>
+#include <openspace/engine/moduleengine.h>
+#include <ghoul/fmt.h>
+#include <ghoul/filesystem/filesystem.h>
+#include <ghoul/logging/logmanager.h>
+#include <ghoul/misc/exception.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+#include <gdal.h>
+
+namespace {
+    constexpr std::string_view _loggerCat = "MRFCacheGenerationTask";
+
+    using Clock = std::chrono::steady_clock;
+
+    // The tiles of a level are handed out to the threads in batches of this many tiles.
+    // The progress of a level is only stored at batch boundaries
+    constexpr uint64_t BatchSize = 64;
+
+    // The minimum time between two updates of the progress file of a layer
+    constexpr std::chrono::seconds ProgressInterval = std::chrono::seconds(2);
+
+    constexpr std::string_view ProgressFileName = "generation.progress";
+
+    // The number of tiles of a level in the tile pyramid of a globe
+    uint64_t numTiles(int level) {
+        return uint64_t(1) << (2 * level - 1);
+    }
+
+    double tilesPerSecond(uint64_t nTiles, double seconds) {
+        return seconds > 0.0 ? static_cast<double>(nTiles) / seconds : 0.0;
+    }
+
+    double megabytesPerSecond(uint64_t nBytes, double seconds) {
+        return seconds > 0.0 ?
+            static_cast<double>(nBytes) / (1024.0 * 1024.0) / seconds :
+            0.0;
+    }
+
+    struct [[codegen::Dictionary(MRFCacheGenerationTask)]] Parameters {
+        struct Layer {
+            // The identifier of the layer, which has to be the same as in the asset that
+            // adds the layer for the cache to be found
+            std::string identifier;
+
+            // The path to the file that is loaded by GDAL to produce tiles. This has to
+            // be the same file that is used by the layer
+            std::string filePath;
+
+            // The layer group to which the layer is added, which determines the format
+            // of the tiles
+            std::string layerGroup [[codegen::inlist("HeightLayers", "ColorLayers",
+                "Overlays", "NightLayers", "WaterMasks")]];
+
+            // The preferred size of the tiles in pixels, if it is specified for the
+            // layer
+            std::optional<int> tilePixelSize [[codegen::greater(0)]];
+
+            // The cache settings of the layer, if they are specified for the layer. The
+            // 'Enabled' setting is ignored as the cache is always generated
+            std::optional<ghoul::Dictionary> cacheSettings;
+
+            // The name of the enclosing globe, if it is specified for the layer
+            std::optional<std::string> globeName;
+        };
+        // The layers whose caches are generated
+        std::vector<Layer> layers;
+
+        // The deepest level of the tile pyramid whose tiles are cached. Each level
+        // contains four times as many tiles as the previous one. If a dataset does not
+        // have enough resolution for this level, its caching stops at the deepest level
+        // that the dataset provides
+        int maxLevel [[codegen::inrange(1, 22)]];
+
+        // The number of threads that read tiles concurrently. Each thread opens a
+        // separate handle to the dataset. The default is the number of cores
+        std::optional<int> threads [[codegen::greater(0)]];
+    };
+#include "mrfcachegenerationtask_codegen.cpp"
+} // namespace
+
+namespace openspace::globebrowsing {
+
+documentation::Documentation MRFCacheGenerationTask::Documentation() {
+    return codegen::doc<Parameters>("globebrowsing_mrfcachegenerationtask");
+}
+
+MRFCacheGenerationTask::MRFCacheGenerationTask(const ghoul::Dictionary& dictionary) {
+    const Parameters p = codegen::bake<Parameters>(dictionary);
+
+    for (const Parameters::Layer& l : p.layers) {
+        const layers::Group::ID groupId =
+            ghoul::from_string<layers::Group::ID>(l.layerGroup);
+
+        // The cache location depends on the file path, which is an absolute path when
+        // it is provided by an asset
+        const std::string filePath = absPath(l.filePath).string();
+
+        // Build the definition that a DefaultTileProvider would receive from its layer
+        ghoul::Dictionary definition;
+        definition.setValue("Identifier", l.identifier);
+        definition.setValue("FilePath", filePath);
+        definition.setValue("LayerGroupID", static_cast<int>(groupId));
+        if (l.cacheSettings.has_value()) {
+            definition.setValue("CacheSettings", *l.cacheSettings);
+        }
+        if (l.globeName.has_value()) {
+            definition.setValue("GlobeName", *l.globeName);
+        }
+
+        _layers.push_back({
+            .definition = std::move(definition),
+            .identifier = l.identifier,
+            .filePath = filePath,
+            .tilePixelSize = l.tilePixelSize.value_or(0)
+        });
+    }
+
+    _maxLevel = p.maxLevel;
+    _nThreads = p.threads.value_or(
+        std::max(static_cast<int>(std::thread::hardware_concurrency()), 1)
+    );
+}
+
+std::string MRFCacheGenerationTask::description() {
+    return fmt::format(
+        "Generate the MRF caches of {} layers down to level {}", _layers.size(), _maxLevel
+    );
+}
+
+MRFCacheGenerationTask::Progress MRFCacheGenerationTask::readProgress(const Layer& layer,
+                                                 const std::filesystem::path& path) const
+{
+    std::ifstream file(path);
+    if (!file.good()) {
+        return Progress();
+    }
+
+    // The progress is only valid for the dataset it was recorded for
+    std::string filePath;
+    std::getline(file, filePath);
+    Progress progress;
+    file >> progress.level >> progress.nTiles;
+    if (file.fail() || filePath != layer.filePath || progress.level < 1) {
+        LWARNING(fmt::format(
+            "Ignoring the progress file {} of layer '{}'", path, layer.identifier
+        ));
+        return Progress();
+    }
+    return progress;
+}
+
+void MRFCacheGenerationTask::writeProgress(const Layer& layer,
+                                           const std::filesystem::path& path,
+                                           const Progress& progress) const
+{
+    // Write to a temporary file first so that an interruption while writing does not
+    // leave a broken progress file behind
+    std::filesystem::path tmp = path;
+    tmp += ".tmp";
+    {
+        std::ofstream file(tmp, std::ofstream::trunc);
+        file << layer.filePath << '\n';
+        file << progress.level << ' ' << progress.nTiles << '\n';
+        if (!file.good()) {
+            LWARNING(fmt::format("Could not write progress file {}", tmp));
+            return;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp, path, ec);
+    if (ec) {
+        LWARNING(fmt::format(
+            "Could not write progress file {}: {}", path, ec.message()
+        ));
+    }
+}
+
+void MRFCacheGenerationTask::perform(const Task::ProgressCallback& onProgress) {
+    onProgress(0.f);
+
+    // Normally the GdalWrapper registers the drivers, but it is only created together
+    // with an OpenGL context
+    GDALAllRegister();
+
+    GlobeBrowsingModule& module = *global::moduleEngine->module<GlobeBrowsingModule>();
+
+    uint64_t nTotalTiles = 0;
+    uint64_t nTotalBytes = 0;
+    const Clock::time_point totalStart = Clock::now();
+
+    for (size_t iLayer = 0; iLayer < _layers.size(); iLayer++) {
+        const Layer& layer = _layers[iLayer];
+        const layers::Group::ID groupId = layers::Group::ID(
+            layer.definition.value<int>("LayerGroupID")
+        );
+
+        TileCacheProperties cacheProperties =
+            DefaultTileProvider::cacheProperties(layer.definition);
+        cacheProperties.enabled = true;
+        cacheProperties.nDatasetHandles = _nThreads;
+
+        const TileTextureInitData initData = tileTextureInitData(
+            groupId,
+            static_cast<size_t>(layer.tilePixelSize)
+        );
+
+        std::unique_ptr<RawTileDataReader> reader;
+        try {
+            // Creating the reader creates the MRF cache if it does not exist yet. The
+            // tile disk cache has to be bypassed, as a tile that is found there would
+            // never be read through GDAL and thus never be written into the MRF cache
+            reader = std::make_unique<RawTileDataReader>(
+                layer.filePath,
+                initData,
+                cacheProperties,
+                RawTileDataReader::PerformPreprocessing::No,
+                RawTileDataReader::UseDiskCache::No
+            );
+        }
+        catch (const ghoul::RuntimeError& e) {
+            LERROR(fmt::format(
+                "Skipping layer '{}': {}", layer.identifier, e.message
+            ));
+            continue;
+        }
+
+        const int maxLevel = std::min(_maxLevel, reader->maxChunkLevel());
+        uint64_t nLayerTiles = 0;
+        for (int level = 1; level <= maxLevel; level++) {
+            nLayerTiles += numTiles(level);
+        }
+
+        const std::filesystem::path progressPath =
+            absPath(fmt::format("{}/{}", module.mrfCacheLocation(), cacheProperties.path))
+            / ProgressFileName;
+        Progress progress = readProgress(layer, progressPath);
+
+        uint64_t nSkippedTiles = 0;
+        for (int level = 1; level < std::min(progress.level, maxLevel + 1); level++) {
+            nSkippedTiles += numTiles(level);
+        }
+        if (progress.level <= maxLevel) {
+            nSkippedTiles += progress.nTiles;
+        }
+        if (nSkippedTiles > 0) {
+            LINFO(fmt::format(
+                "Resuming layer '{}' at level {} after {} tiles",
+                layer.identifier, progress.level, nSkippedTiles
+            ));
+        }
+
+        std::atomic<uint64_t> nRead = 0;
+        std::atomic<uint64_t> nFailed = 0;
+        const Clock::time_point layerStart = Clock::now();
+
+        for (int level = progress.level; level <= maxLevel; level++) {
+            const uint64_t nTiles = numTiles(level);
+            const uint64_t width = uint64_t(1) << level;
+            const uint64_t nBatches = (nTiles + BatchSize - 1) / BatchSize;
+            const uint64_t firstBatch =
+                level == progress.level ? progress.nTiles / BatchSize : 0;
+
+            // The threads finish their batches out of order, so the progress of the
+            // level is the number of leading batches that have all been finished
+            std::mutex finishedMutex;
+            std::vector<bool> isFinished(nBatches - firstBatch, false);
+            uint64_t nLeadingFinished = 0;
+
+            std::atomic<uint64_t> nextBatch = firstBatch;
+            std::atomic<int> nRunningThreads = _nThreads;
+            auto work = [&]() {
+                while (true) {
+                    const uint64_t batch = nextBatch++;
+                    if (batch >= nBatches) {
+                        break;
+                    }
+
+                    const uint64_t end = std::min((batch + 1) * BatchSize, nTiles);
+                    for (uint64_t i = batch * BatchSize; i < end; i++) {
+                        const TileIndex tileIndex = TileIndex(
+                            static_cast<uint32_t>(i % width),
+                            static_cast<uint32_t>(i / width),
+                            static_cast<uint8_t>(level)
+                        );
+                        const RawTile tile = reader->readTileData(tileIndex);
+                        if (tile.error >= RawTile::ReadError::Failure) {
+                            nFailed++;
+                        }
+                        nRead++;
+                    }
+
+                    std::lock_guard lock(finishedMutex);
+                    isFinished[batch - firstBatch] = true;
+                    while (nLeadingFinished < isFinished.size() &&
+                           isFinished[nLeadingFinished])
+                    {
+                        nLeadingFinished++;
+                    }
+                }
+                nRunningThreads--;
+            };
+
+            std::vector<std::thread> threads;
+            threads.reserve(_nThreads);
+            for (int i = 0; i < _nThreads; i++) {
+                threads.emplace_back(work);
+            }
+
+            auto currentProgress = [&]() {
+                std::lock_guard lock(finishedMutex);
+                const uint64_t nFinished = (firstBatch + nLeadingFinished) * BatchSize;
+                return Progress { .level = level, .nTiles = std::min(nFinished, nTiles) };
+            };
+
+            Clock::time_point lastWrite = Clock::now();
+            while (nRunningThreads > 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+                const float layerProgress = static_cast<float>(
+                    static_cast<double>(nSkippedTiles + nRead) /
+                    static_cast<double>(std::max<uint64_t>(nLayerTiles, 1))
+                );
+                onProgress(
+                    (static_cast<float>(iLayer) + std::min(layerProgress, 1.f)) /
+                    static_cast<float>(_layers.size())
+                );
+
+                if (Clock::now() - lastWrite > ProgressInterval) {
+                    writeProgress(layer, progressPath, currentProgress());
+                    lastWrite = Clock::now();
+                }
+            }
+            for (std::thread& thread : threads) {
+                thread.join();
+            }
+
+            writeProgress(layer, progressPath, Progress{ .level = level + 1 });
+            LINFO(fmt::format(
+                "Layer '{}': finished level {} ({} tiles)",
+                layer.identifier, level, nTiles
+            ));
+        }
+
+        const double seconds = std::chrono::duration<double>(
+            Clock::now() - layerStart
+        ).count();
+        const uint64_t nBytes = nRead * initData.totalNumBytes;
+        LINFO(fmt::format(
+            "Layer '{}': read {} tiles in {:.1f} s ({:.1f} tiles/s, {:.1f} MB/s), "
+            "{} tiles failed",
+            layer.identifier, nRead.load(), seconds,
+            tilesPerSecond(nRead, seconds), megabytesPerSecond(nBytes, seconds),
+            nFailed.load()
+        ));
+        nTotalTiles += nRead;
+        nTotalBytes += nBytes;
+    }
+
+    const double seconds = std::chrono::duration<double>(
+        Clock::now() - totalStart
+    ).count();
+    LINFO(fmt::format(
+        "Read {} tiles of {} layers in {:.1f} s ({:.1f} tiles/s, {:.1f} MB/s)",
+        nTotalTiles, _layers.size(), seconds,
+        tilesPerSecond(nTotalTiles, seconds), megabytesPerSecond(nTotalBytes, seconds)
+    ));
+
+    onProgress(1.f);
+}
+
+} // namespace openspace::globebrowsing
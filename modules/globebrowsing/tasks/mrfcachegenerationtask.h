@@ -0,0 +1,87 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2023                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_MODULE_GLOBEBROWSING___MRF_CACHE_GENERATION_TASK___H__
+#define __OPENSPACE_MODULE_GLOBEBROWSING___MRF_CACHE_GENERATION_TASK___H__
+
+#include <openspace/util/task.h>
+
+#include <ghoul/misc/dictionary.h>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace openspace::documentation { struct Documentation; }
+
+namespace openspace::globebrowsing {
+
+/**
+ * Fills the MRF caches of a list of layers ahead of time. Normally, the MRF cache of a
+ * layer is filled lazily with the tiles that are requested while the layer is shown.
+ * This task instead reads all tiles of each layer down to a maximum level, using as
+ * many threads as requested, so that the tiles are already cached locally when the layer
+ * is shown for the first time. The caches are written to the same location and with the
+ * same settings as the caches of a DefaultTileProvider created from the same layer
+ * definition.
+ *
+ * The progress of each layer is stored next to its cache, so that an interrupted task
+ * continues where it stopped when it is started again.
+ */
+class MRFCacheGenerationTask : public Task {
+public:
+    explicit MRFCacheGenerationTask(const ghoul::Dictionary& dictionary);
+    ~MRFCacheGenerationTask() override = default;
+
+    std::string description() override;
+    void perform(const Task::ProgressCallback& onProgress) override;
+    static documentation::Documentation Documentation();
+
+private:
+    struct Layer {
+        /// The layer definition in the format that is used by DefaultTileProvider
+        ghoul::Dictionary definition;
+        std::string identifier;
+        std::string filePath;
+        int tilePixelSize = 0;
+    };
+
+    /// The position in the tile pyramid up to which all tiles of a layer have been read
+    struct Progress {
+        int level = 1;
+        /// The number of tiles of #level that have been read
+        uint64_t nTiles = 0;
+    };
+
+    Progress readProgress(const Layer& layer, const std::filesystem::path& path) const;
+    void writeProgress(const Layer& layer, const std::filesystem::path& path,
+        const Progress& progress) const;
+
+    std::vector<Layer> _layers;
+    int _maxLevel;
+    int _nThreads;
+};
+
+} // namespace openspace::globebrowsing
+
+#endif // __OPENSPACE_MODULE_GLOBEBROWSING___MRF_CACHE_GENERATION_TASK___H__
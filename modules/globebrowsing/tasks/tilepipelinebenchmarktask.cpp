@@ -0,0 +1,514 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2023                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+
+#include <modules/globebrowsing/tasks/tilepipelinebenchmarktask.h>
+
+#include <modules/globebrowsing/globebrowsingmodule.h>
+#include <modules/globebrowsing/src/asynctiledataprovider.h>
+#include <modules/globebrowsing/src/chunk.h>
+#include <modules/globebrowsing/src/costawarecache.h>
+#include <modules/globebrowsing/src/ellipsoid.h>
+#include <modules/globebrowsing/src/flathashmap.h>
+#include <modules/globebrowsing/src/layergroupid.h>
+#include <modules/globebrowsing/src/rawtile.h>
+#include <modules/globebrowsing/src/rawtiledatareader.h>
+#include <modules/globebrowsing/src/tilecacheproperties.h>
+#include <modules/globebrowsing/src/tiletextureinitdata.h>
+#include <openspace/documentation/documentation.h>
+#include <openspace/documentation/verifier.h>
+#include <openspace/engine/globals.h>
+#include <openspace/engine/moduleengine.h>
+#include <openspace/interaction/sessionrecording.h>
+#include <openspace/network/messagestructures.h>
+#include <ghoul/fmt.h>
+#include <ghoul/filesystem/filesystem.h>
+#include <ghoul/logging/logmanager.h>
+#include <ghoul/misc/dictionary.h>
+#include <ghoul/misc/dictionaryjsonformatter.h>
+#include <ghoul/misc/exception.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <optional>
+#include <sstream>
+#include <thread>
+#include <variant>
+
+#include <gdal.h>
+
+namespace {
+    constexpr std::string_view _loggerCat = "TilePipelineBenchmarkTask";
+
+    using Clock = std::chrono::steady_clock;
+
+    // The provider ID that is used for the benchmark's tile cache
+    constexpr uint16_t ProviderID = 0;
+
+    // A chunk tree without any height information, which is driven the same way as the
+    // chunk tree of a RenderableGlobe
+    struct ChunkTree {
+        ~ChunkTree() {
+            merge(left);
+            merge(right);
+        }
+
+        static void merge(openspace::globebrowsing::Chunk& chunk) {
+            for (openspace::globebrowsing::Chunk*& child : chunk.children) {
+                if (child) {
+                    merge(*child);
+                    delete child;
+                    child = nullptr;
+                }
+            }
+        }
+
+        void collect(openspace::globebrowsing::Chunk& chunk) {
+            using namespace openspace::globebrowsing;
+            chunks.push_back({
+                &chunk,
+                BoundingHeights{ 0.f, 0.f, true, true },
+                maxLevel
+            });
+            if (chunk.children[0]) {
+                for (Chunk* child : chunk.children) {
+                    collect(*child);
+                }
+            }
+        }
+
+        static bool update(openspace::globebrowsing::Chunk& chunk) {
+            using namespace openspace::globebrowsing;
+            if (!chunk.children[0]) {
+                if (chunk.status == Chunk::Status::WantSplit) {
+                    for (size_t i = 0; i < chunk.children.size(); i++) {
+                        chunk.children[i] = new Chunk(
+                            chunk.tileIndex.child(static_cast<Quad>(i))
+                        );
+                    }
+                }
+                return chunk.status == Chunk::Status::WantMerge;
+            }
+
+            bool allChildrenWantMerge = true;
+            for (Chunk* child : chunk.children) {
+                allChildrenWantMerge &= update(*child);
+            }
+            if (allChildrenWantMerge && chunk.status != Chunk::Status::WantSplit) {
+                merge(chunk);
+            }
+            return false;
+        }
+
+        void step(const openspace::globebrowsing::Ellipsoid& ellipsoid,
+                  const openspace::globebrowsing::ChunkView& view,
+                  openspace::ThreadPool* pool)
+        {
+            chunks.clear();
+            collect(left);
+            collect(right);
+            evaluateChunks(chunks, ellipsoid, view, pool);
+            update(left);
+            update(right);
+        }
+
+        openspace::globebrowsing::Chunk left =
+            openspace::globebrowsing::Chunk(openspace::globebrowsing::TileIndex(0, 0, 1));
+        openspace::globebrowsing::Chunk right =
+            openspace::globebrowsing::Chunk(openspace::globebrowsing::TileIndex(1, 0, 1));
+        std::vector<openspace::globebrowsing::ChunkEvaluation> chunks;
+        int maxLevel = 0;
+    };
+
+    double percentile(const std::vector<double>& sorted, double p) {
+        if (sorted.empty()) {
+            return 0.0;
+        }
+        const size_t i = static_cast<size_t>(p * static_cast<double>(sorted.size() - 1));
+        return sorted[i];
+    }
+
+    struct [[codegen::Dictionary(TilePipelineBenchmarkTask)]] Parameters {
+        // The dataset from which the tiles are read. This can be any dataset that GDAL
+        // can open, for example a GeoTIFF file or a GDAL WMS description
+        std::filesystem::path dataset;
+
+        // A session recording in the ASCII format that contains the camera path. Binary
+        // recordings can be converted with the ConvertRecFormatTask
+        std::filesystem::path cameraPath;
+
+        // If this value is specified, only the camera keyframes with this focus node are
+        // used. The positions of the keyframes are relative to the focus node, which is
+        // assumed to be the globe of the dataset. The rotation of the globe is not known
+        // to the benchmark, so the keyframes should be recorded while following the
+        // rotation of the focus node
+        std::optional<std::string> focusNode;
+
+        // The radii of the globe in meters. If a single value is provided, all three
+        // radii are equal. The default value is the radius of the Earth
+        std::optional<std::variant<glm::dvec3, double>> radii;
+
+        // The layer group of the dataset, which determines the format of the tiles
+        std::optional<std::string> layerGroup [[codegen::inlist("HeightLayers",
+            "ColorLayers", "Overlays", "NightLayers", "WaterMasks")]];
+
+        // The preferred size of the tiles in pixels
+        std::optional<int> tilePixelSize [[codegen::greater(0)]];
+
+        // The number of GDAL dataset handles that are used to read tiles concurrently
+        std::optional<int> datasetHandles [[codegen::greater(0)]];
+
+        // The budget of the tile cache in MB, which is used to compute the hit ratio
+        std::optional<int> cacheSize [[codegen::greaterequal(0)]];
+
+        // The speed at which the camera path is replayed relative to the recording
+        std::optional<double> playbackSpeed [[codegen::greater(0.0)]];
+
+        // The vertical field of view of the camera in degrees
+        std::optional<double> fieldOfView [[codegen::inrange(1.0, 179.0)]];
+
+        // The maximum number of seconds to wait for outstanding tiles after the end of
+        // the camera path has been reached
+        std::optional<double> drainTimeout [[codegen::greaterequal(0.0)]];
+
+        // If this value is specified, the results are also written as JSON to this file
+        std::optional<std::string> output [[codegen::annotation("A valid filepath")]];
+    };
+#include "tilepipelinebenchmarktask_codegen.cpp"
+} // namespace
+
+namespace openspace::globebrowsing {
+
+documentation::Documentation TilePipelineBenchmarkTask::Documentation() {
+    return codegen::doc<Parameters>("globebrowsing_tilepipelinebenchmarktask");
+}
+
+TilePipelineBenchmarkTask::TilePipelineBenchmarkTask(const ghoul::Dictionary& dictionary)
+{
+    const Parameters p = codegen::bake<Parameters>(dictionary);
+
+    _dataset = absPath(p.dataset);
+    _cameraPath = absPath(p.cameraPath);
+    _focusNode = p.focusNode;
+    if (p.output.has_value()) {
+        _output = absPath(*p.output);
+    }
+
+    if (p.radii.has_value()) {
+        if (std::holds_alternative<glm::dvec3>(*p.radii)) {
+            _radii = std::get<glm::dvec3>(*p.radii);
+        }
+        else {
+            _radii = glm::dvec3(std::get<double>(*p.radii));
+        }
+    }
+    else {
+        _radii = glm::dvec3(6378137.0, 6378137.0, 6356752.314245);
+    }
+
+    _layerGroup = p.layerGroup.value_or("HeightLayers");
+    _tilePixelSize = p.tilePixelSize.value_or(0);
+    _nDatasetHandles = p.datasetHandles.value_or(4);
+    _cacheBudget = static_cast<size_t>(p.cacheSize.value_or(512)) * 1024 * 1024;
+    _playbackSpeed = p.playbackSpeed.value_or(1.0);
+    _fieldOfView = p.fieldOfView.value_or(60.0);
+    _drainTimeout = p.drainTimeout.value_or(30.0);
+}
+
+std::string TilePipelineBenchmarkTask::description() {
+    return fmt::format(
+        "Replay the camera path of {} against the dataset {} and measure the tile "
+        "pipeline", _cameraPath, _dataset
+    );
+}
+
+std::vector<TilePipelineBenchmarkTask::CameraPose>
+TilePipelineBenchmarkTask::readCameraPath() const
+{
+    using SR = interaction::SessionRecording;
+
+    std::ifstream file(_cameraPath);
+    if (!file.good()) {
+        throw ghoul::RuntimeError(
+            fmt::format("Could not open camera path {}", _cameraPath),
+            "TilePipelineBenchmarkTask"
+        );
+    }
+
+    std::string header;
+    std::getline(file, header);
+    const size_t headerLength = SR::FileHeaderTitle.size() + SR::FileHeaderVersionLength;
+    if (!header.starts_with(SR::FileHeaderTitle) || header.size() <= headerLength) {
+        throw ghoul::RuntimeError(
+            fmt::format("{} is not a session recording", _cameraPath),
+            "TilePipelineBenchmarkTask"
+        );
+    }
+    if (header[headerLength] != SR::DataFormatAsciiTag) {
+        throw ghoul::RuntimeError(
+            fmt::format(
+                "{} is not an ASCII session recording. Use the ConvertRecFormatTask to "
+                "convert it first", _cameraPath
+            ),
+            "TilePipelineBenchmarkTask"
+        );
+    }
+
+    std::vector<CameraPose> poses;
+    std::string line;
+    int lineNumber = 1;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        std::istringstream iss(line);
+        std::string entryType;
+        iss >> entryType;
+        if (entryType != SR::HeaderCameraAscii) {
+            continue;
+        }
+
+        double timeOs = 0.0;
+        double timeRec = 0.0;
+        double timeSim = 0.0;
+        iss >> timeOs >> timeRec >> timeSim;
+        datamessagestructures::CameraKeyframe kf;
+        kf.read(iss);
+        if (iss.fail()) {
+            LWARNING(fmt::format(
+                "Error parsing camera line {} of {}", lineNumber, _cameraPath
+            ));
+            continue;
+        }
+
+        if (_focusNode.has_value() && kf._focusNode != *_focusNode) {
+            continue;
+        }
+        poses.push_back({ timeRec, kf._position, kf._rotation });
+    }
+    return poses;
+}
+
+void TilePipelineBenchmarkTask::perform(const Task::ProgressCallback& onProgress) {
+    onProgress(0.f);
+
+    // Normally the GdalWrapper registers the drivers, but it is only created together
+    // with an OpenGL context
+    GDALAllRegister();
+
+    const std::vector<CameraPose> poses = readCameraPath();
+    if (poses.empty()) {
+        LERROR(fmt::format("No camera poses found in {}", _cameraPath));
+        return;
+    }
+
+    const layers::Group::ID groupId = ghoul::from_string<layers::Group::ID>(_layerGroup);
+    TileCacheProperties cacheProperties;
+    cacheProperties.nDatasetHandles = _nDatasetHandles;
+    std::unique_ptr<RawTileDataReader> reader = std::make_unique<RawTileDataReader>(
+        _dataset.string(),
+        tileTextureInitData(groupId, static_cast<size_t>(_tilePixelSize)),
+        cacheProperties,
+        groupId == layers::Group::ID::HeightLayers ?
+            RawTileDataReader::PerformPreprocessing::Yes :
+            RawTileDataReader::PerformPreprocessing::No
+    );
+    const int maxLevel = reader->maxChunkLevel();
+    AsyncTileDataProvider provider("TilePipelineBenchmark", std::move(reader));
+
+    GlobeBrowsingModule* module = global::moduleEngine->module<GlobeBrowsingModule>();
+    ThreadPool* pool = module->chunkThreadPool();
+    const Ellipsoid ellipsoid = Ellipsoid(_radii);
+    ChunkTree tree;
+    tree.maxLevel = maxLevel;
+
+    // The value of an item is its size, as only the hit ratio is of interest
+    CostAwareCache<
+        TileIndex::TileHashKey, size_t, std::hash<TileIndex::TileHashKey>
+    > tileCache;
+    // The time of the first request for every tile that has not arrived yet
+    struct PendingTile {
+        TileIndex tileIndex;
+        Clock::time_point requested;
+    };
+    cache::FlatHashMap<
+        TileIndex::TileHashKey, PendingTile, std::hash<TileIndex::TileHashKey>
+    > pending;
+
+    std::vector<double> timesToTile;
+    uint64_t nHits = 0;
+    uint64_t nMisses = 0;
+    uint64_t nCancelled = 0;
+    uint64_t nFailed = 0;
+    uint64_t nBytesDelivered = 0;
+
+    auto receiveTiles = [&]() {
+        while (std::optional<RawTile> tile = provider.popFinishedRawTile()) {
+            const TileIndex::TileHashKey key = tile->tileIndex.hashKey();
+            const PendingTile* p = pending.find(key);
+            if (tile->error != RawTile::ReadError::None) {
+                nFailed++;
+                if (p) {
+                    pending.erase(key);
+                }
+                continue;
+            }
+
+            if (p) {
+                const std::chrono::duration<double, std::milli> d =
+                    Clock::now() - p->requested;
+                timesToTile.push_back(d.count());
+                pending.erase(key);
+            }
+
+            const size_t nBytes = tile->textureInitData->totalNumBytes;
+            nBytesDelivered += nBytes;
+            tileCache.put(key, nBytes, nBytes);
+            while (tileCache.totalSize() > _cacheBudget) {
+                tileCache.popVictim();
+            }
+        }
+
+        // Requests that are no longer enqueued were cancelled by the provider
+        nCancelled += pending.eraseIf(
+            [&provider](TileIndex::TileHashKey, const PendingTile& p) {
+                return !provider.isEnqueued(p.tileIndex);
+            }
+        );
+        provider.update();
+    };
+
+    const glm::dmat4 projection = glm::perspective(
+        glm::radians(_fieldOfView),
+        16.0 / 9.0,
+        1.0,
+        1e10
+    );
+
+    const Clock::time_point start = Clock::now();
+    for (size_t i = 0; i < poses.size(); i++) {
+        const CameraPose& pose = poses[i];
+
+        // Replay the poses with the same timing as they were recorded
+        const std::chrono::duration<double> offset = std::chrono::duration<double>(
+            (pose.timestamp - poses.front().timestamp) / _playbackSpeed
+        );
+        std::this_thread::sleep_until(
+            start + std::chrono::duration_cast<Clock::duration>(offset)
+        );
+
+        const glm::dvec3 forward = pose.rotation * glm::dvec3(0.0, 0.0, -1.0);
+        const glm::dvec3 up = pose.rotation * glm::dvec3(0.0, 1.0, 0.0);
+        ChunkView view;
+        view.modelViewProjection =
+            projection * glm::lookAt(pose.position, pose.position + forward, up);
+        view.cameraPosition = pose.position;
+        view.cameraGeodetic = ellipsoid.cartesianToGeodetic2(pose.position);
+        // The chunks of the tree are created without their corners
+        view.updateCorners = true;
+        view.maxLevel = std::max(maxLevel, view.minLevel);
+        tree.step(ellipsoid, view, pool);
+
+        for (const ChunkEvaluation& evaluation : tree.chunks) {
+            const Chunk& chunk = *evaluation.chunk;
+            if (chunk.children[0] || !chunk.isVisible) {
+                continue;
+            }
+
+            const TileIndex::TileHashKey key = chunk.tileIndex.hashKey();
+            if (tileCache.get(key)) {
+                nHits++;
+                continue;
+            }
+
+            // A tile that is still on its way is requested again to bump its priority,
+            // but it is only counted as a miss when it is requested for the first time
+            const bool isPending = pending.contains(key);
+            if (!isPending) {
+                nMisses++;
+            }
+            provider.enqueueTileIO(chunk.tileIndex);
+            if (!isPending && provider.isEnqueued(chunk.tileIndex)) {
+                pending.insertOrAssign(key, { chunk.tileIndex, Clock::now() });
+            }
+        }
+
+        receiveTiles();
+        onProgress(0.9f * static_cast<float>(i + 1) / static_cast<float>(poses.size()));
+    }
+
+    // Wait for the tiles that are still being loaded
+    const Clock::time_point drainStart = Clock::now();
+    const std::chrono::duration<double> drainTimeout =
+        std::chrono::duration<double>(_drainTimeout);
+    while (!pending.isEmpty() && Clock::now() - drainStart < drainTimeout) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        receiveTiles();
+    }
+    const std::chrono::duration<double> duration = Clock::now() - start;
+    const uint64_t nUnfinished = pending.size();
+
+    std::sort(timesToTile.begin(), timesToTile.end());
+    const double tilesPerSecond =
+        static_cast<double>(timesToTile.size()) / duration.count();
+    const double p50 = percentile(timesToTile, 0.5);
+    const double p99 = percentile(timesToTile, 0.99);
+    const uint64_t nLookups = nHits + nMisses;
+    const double hitRatio = nLookups > 0 ?
+        static_cast<double>(nHits) / static_cast<double>(nLookups) :
+        0.0;
+
+    LINFO(fmt::format(
+        "Replayed {} camera poses in {:.2f} s", poses.size(), duration.count()
+    ));
+    LINFO(fmt::format(
+        "Tiles: {} loaded ({:.1f} tiles/s), {} failed, {} cancelled, {} unfinished",
+        timesToTile.size(), tilesPerSecond, nFailed, nCancelled, nUnfinished
+    ));
+    LINFO(fmt::format("Time to tile: p50 {:.2f} ms, p99 {:.2f} ms", p50, p99));
+    LINFO(fmt::format(
+        "Cache hit ratio: {:.3f} ({} hits, {} misses)", hitRatio, nHits, nMisses
+    ));
+    LINFO(fmt::format("Bytes delivered: {}", nBytesDelivered));
+
+    if (_output.has_value()) {
+        ghoul::Dictionary result;
+        result.setValue("Poses", static_cast<int>(poses.size()));
+        result.setValue("Duration", duration.count());
+        result.setValue("TilesLoaded", static_cast<int>(timesToTile.size()));
+        result.setValue("TilesFailed", static_cast<int>(nFailed));
+        result.setValue("TilesCancelled", static_cast<int>(nCancelled));
+        result.setValue("TilesUnfinished", static_cast<int>(nUnfinished));
+        result.setValue("TilesPerSecond", tilesPerSecond);
+        result.setValue("TimeToTileP50", p50);
+        result.setValue("TimeToTileP99", p99);
+        result.setValue("CacheHitRatio", hitRatio);
+        result.setValue("BytesDelivered", static_cast<double>(nBytesDelivered));
+
+        std::ofstream output(*_output);
+        output << ghoul::formatJson(result);
+    }
+
+    onProgress(1.f);
+}
+
+} // namespace openspace::globebrowsing
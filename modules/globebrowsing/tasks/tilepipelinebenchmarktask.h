@@ -22,74 +22,66 @@
  * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
  ****************************************************************************************/
 
-#ifndef __OPENSPACE_MODULE_GLOBEBROWSING___LRU_THREAD_POOL___H__
-#define __OPENSPACE_MODULE_GLOBEBROWSING___LRU_THREAD_POOL___H__
 
-#include <modules/globebrowsing/src/lrucache.h>
-#include <condition_variable>
-#include <functional>
-#include <mutex>
-#include <thread>
-#include <vector>
-
-// Implementation based on http://progsch.net/wordpress/?p=81
+#ifndef __OPENSPACE_MODULE_GLOBEBROWSING___TILE_PIPELINE_BENCHMARK_TASK___H__
+#define __OPENSPACE_MODULE_GLOBEBROWSING___TILE_PIPELINE_BENCHMARK_TASK___H__
 
-namespace openspace::globebrowsing {
+#include <openspace/util/task.h>
 
-template<typename KeyType> class LRUThreadPool;
+#include <ghoul/glm.h>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
 
-template<typename KeyType>
-class LRUThreadPoolWorker {
-public:
-    LRUThreadPoolWorker(LRUThreadPool<KeyType>& pool);
-    void operator()();
+namespace openspace::documentation { struct Documentation; }
 
-private:
-    LRUThreadPool<KeyType>& _pool;
-};
+namespace openspace::globebrowsing {
 
 /**
- * The `LRUThreadPool` will only enqueue a certain number of tasks. The most
- * recently enqueued task is the one that will be executed first. This class is templated
- * on a key type which used as an identifier to determine wheter or not a task with the
- * given key has been enqueued or not. This means that a task can be enqueued several
- * times. The user must ensure that an enqueued task with a given key should be equal in
- * outcome to a second enqueued task with the same key. This is because a second enqueued
- * task with the same key will simply be bumped and prioritised before other enqueued
- * tasks. The given task will be ignored.
+ * Replays the camera path of an ASCII session recording against a single dataset without
+ * rendering anything. For every recorded camera pose, the chunk tree of a globe is
+ * updated in the same way as for a RenderableGlobe and the tiles of all visible chunks
+ * are requested through an AsyncTileDataProvider. Afterwards, the throughput of the tile
+ * pipeline, the time between the first request for a tile and its arrival, the hit ratio
+ * of a tile cache with a fixed budget and the number of decoded bytes that were delivered
+ * are reported.
  */
-template<typename KeyType>
-class LRUThreadPool {
+class TilePipelineBenchmarkTask : public Task {
 public:
-    LRUThreadPool(size_t numThreads, size_t queueSize);
-    LRUThreadPool(const LRUThreadPool& toCopy);
-    ~LRUThreadPool();
+    explicit TilePipelineBenchmarkTask(const ghoul::Dictionary& dictionary);
+    ~TilePipelineBenchmarkTask() override = default;
 
-    void enqueue(std::function<void()> f, KeyType key);
-    bool touch(KeyType key);
-    std::vector<KeyType> getQueuedTasksKeys();
-    std::vector<KeyType> getUnqueuedTasksKeys();
-    void clearEnqueuedTasks();
+    std::string description() override;
+    void perform(const Task::ProgressCallback& onProgress) override;
+    static documentation::Documentation Documentation();
 
 private:
-    struct DefaultHasher {
-        unsigned long long operator()(const KeyType& key) const {
-            return static_cast<unsigned long long>(key);
-        }
+    struct CameraPose {
+        /// The time in seconds since the beginning of the recording
+        double timestamp;
+        /// The position relative to the globe in meters
+        glm::dvec3 position;
+        glm::dquat rotation;
     };
-    friend class LRUThreadPoolWorker<KeyType>;
 
-    std::vector<std::thread> _workers;
-    cache::LRUCache<KeyType, std::function<void()>, DefaultHasher> _queuedTasks;
-    std::vector<KeyType> _unqueuedTasks;
-    std::mutex _queueMutex;
-    std::condition_variable _condition;
+    std::vector<CameraPose> readCameraPath() const;
 
-    bool _stop = false;
+    std::filesystem::path _dataset;
+    std::filesystem::path _cameraPath;
+    std::optional<std::string> _focusNode;
+    std::optional<std::filesystem::path> _output;
+
+    glm::dvec3 _radii;
+    std::string _layerGroup;
+    int _tilePixelSize;
+    int _nDatasetHandles;
+    size_t _cacheBudget;
+    double _playbackSpeed;
+    double _fieldOfView;
+    double _drainTimeout;
 };
 
 } // namespace openspace::globebrowsing
 
-#include "lruthreadpool.inl"
-
-#endif // __OPENSPACE_MODULE_GLOBEBROWSING___LRU_THREAD_POOL___H__
+#endif // __OPENSPACE_MODULE_GLOBEBROWSING___TILE_PIPELINE_BENCHMARK_TASK___H__
@@ -1,5 +1,6 @@
 set(DEFAULT_MODULE ON)
 
 set(OPENSPACE_DEPENDENCIES
+  globebrowsing
   skybrowser
 )
@@ -38,6 +38,7 @@
 #include <modules/server/include/topics/shortcuttopic.h>
 #include <modules/server/include/topics/skybrowsertopic.h>
 #include <modules/server/include/topics/subscriptiontopic.h>
+#include <modules/server/include/topics/tilepipelinetopic.h>
 #include <modules/server/include/topics/timetopic.h>
 #include <modules/server/include/topics/topic.h>
 #include <modules/server/include/topics/triggerpropertytopic.h>
@@ -99,6 +100,7 @@ Connection::Connection(std::unique_ptr<ghoul::io::Socket> s, std::string address
     _topicFactory.registerClass<VersionTopic>("version");
     _topicFactory.registerClass<SkyBrowserTopic>("skybrowser");
     _topicFactory.registerClass<CameraTopic>("camera");
+    _topicFactory.registerClass<TilePipelineTopic>("tilePipeline");
 }
 
 void Connection::handleMessage(const std::string& message) {
@@ -0,0 +1,163 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2023                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "modules/server/include/topics/tilepipelinetopic.h"
+
+#include <modules/server/include/connection.h>
+#include <modules/server/servermodule.h>
+#include <modules/globebrowsing/src/layer.h>
+#include <modules/globebrowsing/src/layergroup.h>
+#include <modules/globebrowsing/src/layermanager.h>
+#include <modules/globebrowsing/src/renderableglobe.h>
+#include <modules/globebrowsing/src/tilepipelinetelemetry.h>
+#include <modules/globebrowsing/src/tileprovider/tileprovider.h>
+#include <openspace/engine/moduleengine.h>
+#include <openspace/engine/globals.h>
+#include <openspace/rendering/renderengine.h>
+#include <openspace/scene/scene.h>
+#include <openspace/scene/scenegraphnode.h>
+
+namespace {
+    constexpr std::string_view SubscribeEvent = "start_subscription";
+
+    nlohmann::json histogramJson(const openspace::globebrowsing::LatencyHistogram& h) {
+        using namespace openspace::globebrowsing;
+
+        // Only the buckets up to the last non-empty one are sent, as the upper buckets
+        // are empty for all but the slowest datasets
+        size_t nBuckets = 0;
+        for (size_t i = 0; i < LatencyHistogram::NumBuckets; i++) {
+            if (h.buckets()[i] > 0) {
+                nBuckets = i + 1;
+            }
+        }
+
+        nlohmann::json upperBounds = nlohmann::json::array();
+        nlohmann::json counts = nlohmann::json::array();
+        for (size_t i = 0; i < nBuckets; i++) {
+            upperBounds.push_back(LatencyHistogram::bucketUpperBound(i));
+            counts.push_back(h.buckets()[i]);
+        }
+
+        return {
+            { "count", h.count() },
+            { "median", h.percentile(0.5f) },
+            { "p99", h.percentile(0.99f) },
+            { "bucketUpperBoundsUs", upperBounds },
+            { "bucketCounts", counts }
+        };
+    }
+} // namespace
+
+using nlohmann::json;
+
+namespace openspace {
+
+TilePipelineTopic::TilePipelineTopic()
+    : _lastUpdateTime(std::chrono::system_clock::now())
+{}
+
+TilePipelineTopic::~TilePipelineTopic() {
+    if (_dataCallbackHandle != UnsetOnChangeHandle) {
+        ServerModule* module = global::moduleEngine->module<ServerModule>();
+        if (module) {
+            module->removePreSyncCallback(_dataCallbackHandle);
+        }
+    }
+}
+
+bool TilePipelineTopic::isDone() const {
+    return _isDone;
+}
+
+void TilePipelineTopic::handleJson(const nlohmann::json& json) {
+    std::string event = json.at("event").get<std::string>();
+
+    if (event != SubscribeEvent) {
+        _isDone = true;
+        return;
+    }
+
+    ServerModule* module = global::moduleEngine->module<ServerModule>();
+    _dataCallbackHandle = module->addPreSyncCallback(
+        [this]() {
+            std::chrono::system_clock::time_point now = std::chrono::system_clock::now();
+            if (now - _lastUpdateTime > _updateInterval) {
+                sendTelemetry();
+                _lastUpdateTime = std::chrono::system_clock::now();
+            }
+        }
+    );
+}
+
+void TilePipelineTopic::sendTelemetry() {
+    using namespace globebrowsing;
+
+    Scene* scene = global::renderEngine->scene();
+    if (!scene) {
+        return;
+    }
+
+    json globes = json::array();
+    for (SceneGraphNode* node : scene->allSceneGraphNodes()) {
+        RenderableGlobe* globe = dynamic_cast<RenderableGlobe*>(node->renderable());
+        if (!globe) {
+            continue;
+        }
+
+        json layers = json::array();
+        for (LayerGroup* group : globe->layerManager().layerGroups()) {
+            for (Layer* layer : group->activeLayers()) {
+                TileProvider* provider = layer->tileProvider();
+                if (!provider) {
+                    continue;
+                }
+
+                TilePipelineCounters counters;
+                provider->collectPipelineCounters(counters);
+                layers.push_back({
+                    { "layerGroup", group->identifier() },
+                    { "layer", layer->identifier() },
+                    { "enqueued", counters.enqueued },
+                    { "inFlight", counters.inFlight },
+                    { "completed", counters.completed },
+                    { "dropped", counters.dropped },
+                    { "cacheHits", counters.cacheHits },
+                    { "cacheMisses", counters.cacheMisses },
+                    { "readTime", histogramJson(counters.readTime) },
+                    { "decodeTime", histogramJson(counters.decodeTime) }
+                });
+            }
+        }
+
+        globes.push_back({
+            { "identifier", node->identifier() },
+            { "layers", std::move(layers) }
+        });
+    }
+
+    _connection->sendJson(wrappedPayload({ { "globes", std::move(globes) } }));
+}
+
+} // namespace openspace
@@ -1030,7 +1030,7 @@ void RenderableStars::renderPSFToTexture() {
 }
 
 void RenderableStars::render(const RenderData& data, RendererTasks&) {
-    if (_dataset.entries.empty()) {
+    if (_dataset.empty()) {
         return;
     }
 
@@ -1127,7 +1127,7 @@ void RenderableStars::render(const RenderData& data, RendererTasks&) {
 
 
     glBindVertexArray(_vao);
-    const GLsizei nStars = static_cast<GLsizei>(_dataset.entries.size());
+    const GLsizei nStars = static_cast<GLsizei>(_dataset.size());
     glDrawArrays(GL_POINTS, 0, nStars);
 
     glBindVertexArray(0);
@@ -1145,7 +1145,7 @@ void RenderableStars::update(const UpdateData&) {
         _dataIsDirty = true;
     }
 
-    if (_dataset.entries.empty()) {
+    if (_dataset.empty()) {
         return;
     }
 
@@ -1176,7 +1176,7 @@ void RenderableStars::update(const UpdateData&) {
             "in_bvLumAbsMagAppMag"
         );
 
-        const size_t nStars = _dataset.entries.size();
+        const size_t nStars = _dataset.size();
         const size_t nValues = slice.size() / nStars;
 
         GLsizei stride = static_cast<GLsizei>(sizeof(GLfloat) * nValues);
@@ -1355,8 +1355,8 @@ void RenderableStars::loadData() {
         return;
     }
 
-    _dataset = speck::data::loadFileWithCache(file);
-    if (_dataset.entries.empty()) {
+    _dataset = speck::data::loadColumnarFileWithCache(file);
+    if (_dataset.empty()) {
         return;
     }
 
@@ -1389,6 +1389,11 @@ std::vector<float> RenderableStars::createDataSlice(ColorOption option) {
     const int vzIdx = std::max(_dataset.index(_dataMapping.vz.value()), 0);
     const int speedIdx = std::max(_dataset.index(_dataMapping.speed.value()), 0);
 
+    const std::vector<float>& bv = _dataset.columns[bvIdx];
+    const std::vector<float>& lum = _dataset.columns[lumIdx];
+    const std::vector<float>& absMag = _dataset.columns[absMagIdx];
+    const std::vector<float>& appMag = _dataset.columns[appMagIdx];
+
     _otherDataRange = glm::vec2(
         std::numeric_limits<float>::max(),
         -std::numeric_limits<float>::max()
@@ -1398,9 +1403,10 @@ std::vector<float> RenderableStars::createDataSlice(ColorOption option) {
 
     std::vector<float> result;
     // 7 for the default Color option of 3 positions + bv + lum + abs + app magnitude
-    result.reserve(_dataset.entries.size() * 7);
-    for (const speck::Dataset::Entry& e : _dataset.entries) {
-        glm::dvec3 position = glm::dvec3(e.position) * distanceconstants::Parsec;
+    result.reserve(_dataset.size() * 7);
+    for (size_t i = 0; i < _dataset.size(); i++) {
+        glm::dvec3 position =
+            glm::dvec3(_dataset.position(i)) * distanceconstants::Parsec;
         maxRadius = std::max(maxRadius, glm::length(position));
 
         switch (option) {
@@ -1418,10 +1424,10 @@ std::vector<float> RenderableStars::createDataSlice(ColorOption option) {
                     static_cast<float>(position[2])
                 }};
 
-                layout.value.value = e.data[bvIdx];
-                layout.value.luminance = e.data[lumIdx];
-                layout.value.absoluteMagnitude = e.data[absMagIdx];
-                layout.value.apparentMagnitude = e.data[appMagIdx];
+                layout.value.value = bv[i];
+                layout.value.luminance = lum[i];
+                layout.value.absoluteMagnitude = absMag[i];
+                layout.value.apparentMagnitude = appMag[i];
 
                 result.insert(result.end(), layout.data.begin(), layout.data.end());
                 break;
@@ -1439,14 +1445,14 @@ std::vector<float> RenderableStars::createDataSlice(ColorOption option) {
                     static_cast<float>(position[2])
                 }};
 
-                layout.value.value = e.data[bvIdx];
-                layout.value.luminance = e.data[lumIdx];
-                layout.value.absoluteMagnitude = e.data[absMagIdx];
-                layout.value.apparentMagnitude = e.data[appMagIdx];
+                layout.value.value = bv[i];
+                layout.value.luminance = lum[i];
+                layout.value.absoluteMagnitude = absMag[i];
+                layout.value.apparentMagnitude = appMag[i];
 
-                layout.value.vx = e.data[vxIdx];
-                layout.value.vy = e.data[vyIdx];
-                layout.value.vz = e.data[vzIdx];
+                layout.value.vx = _dataset.columns[vxIdx][i];
+                layout.value.vy = _dataset.columns[vyIdx][i];
+                layout.value.vz = _dataset.columns[vzIdx][i];
 
                 result.insert(result.end(), layout.data.begin(), layout.data.end());
                 break;
@@ -1464,11 +1470,11 @@ std::vector<float> RenderableStars::createDataSlice(ColorOption option) {
                     static_cast<float>(position[2])
                 }};
 
-                layout.value.value = e.data[bvIdx];
-                layout.value.luminance = e.data[lumIdx];
-                layout.value.absoluteMagnitude = e.data[absMagIdx];
-                layout.value.apparentMagnitude = e.data[appMagIdx];
-                layout.value.speed = e.data[speedIdx];
+                layout.value.value = bv[i];
+                layout.value.luminance = lum[i];
+                layout.value.absoluteMagnitude = absMag[i];
+                layout.value.apparentMagnitude = appMag[i];
+                layout.value.speed = _dataset.columns[speedIdx][i];
 
                 result.insert(result.end(), layout.data.begin(), layout.data.end());
                 break;
@@ -1486,12 +1492,10 @@ std::vector<float> RenderableStars::createDataSlice(ColorOption option) {
                     static_cast<float>(position[2])
                 }};
 
-                int index = _otherDataOption.value();
-                // plus 3 because of the position
-                layout.value.value = e.data[index];
+                const float value = _dataset.columns[_otherDataOption.value()][i];
+                layout.value.value = value;
 
-                if (_staticFilterValue.has_value() && e.data[index] == _staticFilterValue)
-                {
+                if (_staticFilterValue.has_value() && value == _staticFilterValue) {
                     layout.value.value = _staticFilterReplacementValue;
                 }
 
@@ -1502,9 +1506,9 @@ std::vector<float> RenderableStars::createDataSlice(ColorOption option) {
                 _otherDataRange.setMinValue(glm::vec2(range.x));
                 _otherDataRange.setMaxValue(glm::vec2(range.y));
 
-                layout.value.luminance = e.data[lumIdx];
-                layout.value.absoluteMagnitude = e.data[absMagIdx];
-                layout.value.apparentMagnitude = e.data[appMagIdx];
+                layout.value.luminance = lum[i];
+                layout.value.absoluteMagnitude = absMag[i];
+                layout.value.apparentMagnitude = appMag[i];
 
                 result.insert(result.end(), layout.data.begin(), layout.data.end());
                 break;
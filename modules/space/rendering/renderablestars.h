@@ -143,7 +143,7 @@ private:
     bool _dataIsDirty = true;
     bool _otherDataColorMapIsDirty = true;
 
-    speck::Dataset _dataset;
+    speck::ColumnarDataset _dataset;
 
     std::string _queuedOtherData;
 
@@ -34,6 +34,7 @@
 #include <modules/space/rendering/renderablerings.h>
 #include <modules/space/rendering/renderablestars.h>
 #include <modules/space/rendering/renderabletravelspeed.h>
+#include <modules/space/tasks/speckloaderbenchmarktask.h>
 #include <modules/space/translation/keplertranslation.h>
 #include <modules/space/translation/spicetranslation.h>
 #include <modules/space/translation/gptranslation.h>
@@ -46,6 +47,7 @@
 #include <openspace/util/coordinateconversion.h>
 #include <openspace/util/factorymanager.h>
 #include <openspace/util/spicemanager.h>
+#include <openspace/util/task.h>
 #include <ghoul/misc/assert.h>
 #include <ghoul/misc/templatefactory.h>
 
@@ -109,6 +111,11 @@ void SpaceModule::internalInitialize(const ghoul::Dictionary& dictionary) {
 
     fRotation->registerClass<SpiceRotation>("SpiceRotation");
 
+    ghoul::TemplateFactory<Task>* fTask = FactoryManager::ref().factory<Task>();
+    ghoul_assert(fTask, "No task factory existed");
+
+    fTask->registerClass<SpeckLoaderBenchmarkTask>("SpeckLoaderBenchmarkTask");
+
     if (dictionary.hasValue<bool>(SpiceExceptionInfo.identifier)) {
         _showSpiceExceptions = dictionary.value<bool>(SpiceExceptionInfo.identifier);
     }
@@ -131,6 +138,7 @@ std::vector<documentation::Documentation> SpaceModule::documentations() const {
         RenderableOrbitalKepler::Documentation(),
         RenderableStars::Documentation(),
         RenderableTravelSpeed::Documentation(),
+        SpeckLoaderBenchmarkTask::Documentation(),
         SpiceRotation::Documentation(),
         SpiceTranslation::Documentation(),
         LabelsComponent::Documentation(),
@@ -24,22 +24,50 @@
 
 #include <modules/space/speckloader.h>
 
+#include <openspace/util/memorymappedfile.h>
 #include <ghoul/fmt.h>
 #include <ghoul/filesystem/cachemanager.h>
 #include <ghoul/filesystem/file.h>
 #include <ghoul/filesystem/filesystem.h>
 #include <ghoul/logging/logmanager.h>
 #include <ghoul/misc/assert.h>
+#include <algorithm>
+#include <atomic>
 #include <cctype>
+#include <charconv>
+#include <exception>
 #include <fstream>
 #include <functional>
+#include <sstream>
 #include <string_view>
+#include <thread>
+#include <unordered_map>
 
 namespace {
     constexpr int8_t DataCacheFileVersion = 10;
     constexpr int8_t LabelCacheFileVersion = 11;
     constexpr int8_t ColorCacheFileVersion = 10;
 
+    // The mapped cache files share the cache file name with the older data cache files
+    // and are told apart by their version
+    constexpr int8_t MappedDataCacheFileVersion = 20;
+
+    // Alignment of each of the arrays in a mapped cache file relative to the beginning of
+    // the file. Since the mapping itself starts at a page boundary, this is also the
+    // alignment of the arrays in memory
+    constexpr size_t MappedDataAlignment = 64;
+
+    // Data sections that are smaller than this are not split between several threads, as
+    // starting the threads would take longer than parsing the data
+    constexpr size_t MinBytesPerChunk = 1024 * 1024;
+
+#ifdef __cpp_lib_to_chars
+    constexpr bool HasFloatingPointFromChars = true;
+#else // ^^^^ __cpp_lib_to_chars // !__cpp_lib_to_chars vvvv
+    // Some standard libraries only implement std::from_chars for integers
+    constexpr bool HasFloatingPointFromChars = false;
+#endif // __cpp_lib_to_chars
+
     bool startsWith(std::string lhs, std::string_view rhs) noexcept {
         for (size_t i = 0; i < lhs.size(); i++) {
             lhs[i] = static_cast<char>(tolower(lhs[i]));
@@ -70,6 +98,435 @@ namespace {
         }
     }
 
+    std::string_view stripped(std::string_view line) noexcept {
+        // Same as strip, but for a view into the memory-mapped file
+        while (!line.empty() && (line.front() == ' ' || line.front() == '\t')) {
+            line.remove_prefix(1);
+        }
+
+        if (!line.empty() && line.front() == '#') {
+            line.remove_prefix(1);
+        }
+
+        while (!line.empty() && (line.front() == ' ' || line.front() == '\t')) {
+            line.remove_prefix(1);
+        }
+
+        while (!line.empty() && (line.back() == ' ' || line.back() == '\t')) {
+            line.remove_suffix(1);
+        }
+        return line;
+    }
+
+    // Returns the first line of the text and removes it, including its line break, from
+    // the text. Just as with std::getline, a line break at the very end of the text does
+    // not result in an additional empty line
+    std::string_view nextLine(std::string_view& text) noexcept {
+        const size_t end = text.find('\n');
+        const std::string_view line = text.substr(0, end);
+        text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+        return line;
+    }
+
+    bool isSpace(char c) noexcept {
+        // The characters that std::isspace accepts in the "C" locale
+        return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+    }
+
+    // Returns the first whitespace-separated token of the text and removes everything up
+    // to the end of the token from the text. This is the token that `operator>>` would
+    // read into a std::string
+    std::string_view nextToken(std::string_view& text) noexcept {
+        size_t begin = 0;
+        while (begin < text.size() && isSpace(text[begin])) {
+            begin++;
+        }
+        size_t end = begin;
+        while (end < text.size() && !isSpace(text[end])) {
+            end++;
+        }
+        const std::string_view token = text.substr(begin, end - begin);
+        text.remove_prefix(end);
+        return token;
+    }
+
+    // Parses the entire token as a number. Returns false for every token that reading the
+    // value from a std::stringstream might treat differently, for example a leading '+',
+    // 'inf', out-of-range values, or trailing characters. These have to be parsed through
+    // the stream instead, so that the result is the same as it has always been
+    template <typename T>
+    bool parseValue(std::string_view token, T& value) noexcept {
+        if (token.empty()) {
+            return false;
+        }
+        const char first = (token[0] == '-' && token.size() > 1) ? token[1] : token[0];
+        const bool isNumber = (first >= '0' && first <= '9') ||
+                              (std::is_floating_point_v<T> && first == '.');
+        if (!isNumber) {
+            return false;
+        }
+
+        if constexpr (std::is_floating_point_v<T> && !HasFloatingPointFromChars) {
+            // All floating point values have to be parsed through the stream instead
+            return false;
+        }
+        else {
+            const char* end = token.data() + token.size();
+            auto [ptr, ec] = std::from_chars(token.data(), end, value);
+            return ec == std::errc() && ptr == end;
+        }
+    }
+
+    // Splits the text into consecutive pieces that each end with a line break, apart from
+    // the last one. There are at most as many pieces as threads, but each piece is at
+    // least MinBytesPerChunk large as the threads are not worth starting otherwise
+    std::vector<std::string_view> splitIntoChunks(std::string_view text, int nThreads) {
+        if (nThreads <= 0) {
+            nThreads = std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+        }
+        const size_t nChunks = std::clamp<size_t>(
+            text.size() / MinBytesPerChunk,
+            1,
+            static_cast<size_t>(nThreads)
+        );
+
+        std::vector<std::string_view> chunks;
+        chunks.reserve(nChunks);
+        for (size_t i = 1; i < nChunks && !text.empty(); i++) {
+            const size_t target = text.size() / (nChunks - i + 1);
+            const size_t end = text.find('\n', target);
+            if (end == std::string_view::npos) {
+                break;
+            }
+            chunks.push_back(text.substr(0, end + 1));
+            text.remove_prefix(end + 1);
+        }
+        if (!text.empty() || chunks.empty()) {
+            chunks.push_back(text);
+        }
+        return chunks;
+    }
+
+    // Calls the parse function for each chunk, each on its own thread. If any of them
+    // throws an exception, the exception of the first of those chunks is rethrown, which
+    // is the same error that parsing the chunks one after another would have reported
+    template <typename T, typename Func>
+    std::vector<T> parseChunks(const std::vector<std::string_view>& chunks, Func parse) {
+        ghoul_assert(!chunks.empty(), "There must be at least one chunk");
+
+        std::vector<T> results(chunks.size());
+        std::vector<std::exception_ptr> errors(chunks.size());
+        auto parseChunk = [&](size_t i) {
+            try {
+                results[i] = parse(chunks[i]);
+            }
+            catch (...) {
+                errors[i] = std::current_exception();
+            }
+        };
+
+        // The calling thread parses the first chunk itself
+        std::vector<std::thread> threads;
+        threads.reserve(chunks.size() - 1);
+        for (size_t i = 1; i < chunks.size(); i++) {
+            threads.emplace_back(parseChunk, i);
+        }
+        parseChunk(0);
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+
+        for (const std::exception_ptr& error : errors) {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+        return results;
+    }
+
+    // Parses the position and the data values of a stripped data line and returns the
+    // offset at which the rest of the line starts. Returns std::nullopt for any line that
+    // has to be parsed by parseDataLineStream instead
+    std::optional<size_t> parseDataLine(std::string_view line, glm::vec3& position,
+                                        std::vector<float>& values, bool& allZero)
+    {
+        std::string_view rest = line;
+        if (!parseValue(nextToken(rest), position.x) ||
+            !parseValue(nextToken(rest), position.y) ||
+            !parseValue(nextToken(rest), position.z) ||
+            rest.empty())
+        {
+            // A line that ends right after the position is also passed on, as the stream
+            // reaches its end there, which is reported as an error
+            return std::nullopt;
+        }
+        allZero = (position == glm::vec3(0.0));
+
+        for (float& value : values) {
+            const std::string_view token = nextToken(rest);
+            if (token == "nan" || token == "NaN") {
+                value = std::numeric_limits<float>::quiet_NaN();
+            }
+            else if (parseValue(token, value)) {
+                allZero &= (value == 0.0);
+            }
+            else {
+                return std::nullopt;
+            }
+        }
+        return line.size() - rest.size();
+    }
+
+    // Parses a stripped data line through a std::stringstream, which is much slower than
+    // parseDataLine, but is able to handle everything that can appear in a data line
+    template <typename LineNumberFunc>
+    size_t parseDataLineStream(std::string_view line, glm::vec3& position,
+                               std::vector<float>& values, bool& allZero,
+                               const std::filesystem::path& path,
+                               LineNumberFunc lineNumber)
+    {
+        std::stringstream str = std::stringstream(std::string(line));
+        str >> position.x >> position.y >> position.z;
+        allZero = (position == glm::vec3(0.0));
+
+        if (!str.good()) {
+            throw ghoul::RuntimeError(fmt::format(
+                "Error loading position information out of data line {} in file {}. "
+                "Value was not a number",
+                lineNumber(), path
+            ));
+        }
+
+        std::stringstream valueStream;
+        for (size_t i = 0; i < values.size(); i += 1) {
+            std::string value;
+            str >> value;
+            if (value == "nan" || value == "NaN") {
+                values[i] = std::numeric_limits<float>::quiet_NaN();
+            }
+            else {
+                valueStream.clear();
+                valueStream.str(value);
+                valueStream >> values[i];
+
+                allZero &= (values[i] == 0.0);
+                if (valueStream.fail()) {
+                    throw ghoul::RuntimeError(fmt::format(
+                        "Error loading data value {} out of data line {} in file {}. "
+                        "Value was not a number",
+                        i, lineNumber(), path
+                    ));
+                }
+            }
+        }
+
+        // If the stream reached the end of the line, there is nothing left for a comment
+        return str.eof() ? line.size() : static_cast<size_t>(str.tellg());
+    }
+
+    // The entries that were parsed from one chunk of the data section
+    struct DataChunk {
+        std::vector<float> positionX;
+        std::vector<float> positionY;
+        std::vector<float> positionZ;
+        std::vector<std::vector<float>> columns;
+
+        // The distinct comments of this chunk, pointing into the memory-mapped file
+        std::vector<std::string_view> comments;
+        std::vector<uint32_t> commentIndices;
+    };
+
+    using openspace::speck::ColumnarDataset;
+    using openspace::speck::Labelset;
+
+    DataChunk parseDataChunk(std::string_view chunk, std::string_view data,
+                             int firstLineNumber, int nDataValues,
+                             openspace::speck::SkipAllZeroLines skipAllZeroLines,
+                             const std::filesystem::path& path)
+    {
+        DataChunk res;
+        res.columns.resize(nDataValues);
+
+        // Maps each distinct comment to its location in the res.comments list
+        std::unordered_map<std::string_view, uint32_t> commentIndices;
+
+        // The values of the current line are parsed into this buffer first, as we only
+        // know whether they should be added to the columns once the entire line was read
+        std::vector<float> values(nDataValues);
+
+        while (!chunk.empty()) {
+            std::string_view line = nextLine(chunk);
+
+            // The line number is only needed for error messages, so instead of counting
+            // every line, it is computed from the beginning of the data section on demand
+            const char* lineBegin = line.data();
+            auto lineNumber = [&]() {
+                return firstLineNumber +
+                    static_cast<int>(std::count(data.data(), lineBegin, '\n'));
+            };
+
+            // Ignore empty line or commented-out lines
+            if (line.empty() || line[0] == '#') {
+                continue;
+            }
+
+            // Guard against wrong line endings (copying files from Windows to Mac) causes
+            // lines to have a final \r
+            if (line.back() == '\r') {
+                line.remove_suffix(1);
+            }
+
+            line = stripped(line);
+
+            if (line.empty()) {
+                continue;
+            }
+
+            // If the first character is a digit, we have left the preamble and are in
+            // the data section of the file
+            if (!std::isdigit(line[0]) && line[0] != '-') {
+                throw ghoul::RuntimeError(fmt::format(
+                    "Error loading speck file {}: Header information and datasegment "
+                    "intermixed", path
+                ));
+            }
+
+            bool allZero = true;
+            glm::vec3 position = glm::vec3(0.f);
+            std::optional<size_t> restOffset =
+                parseDataLine(line, position, values, allZero);
+            if (!restOffset.has_value()) {
+                restOffset = parseDataLineStream(
+                    line,
+                    position,
+                    values,
+                    allZero,
+                    path,
+                    lineNumber
+                );
+            }
+
+            if (skipAllZeroLines && allZero) {
+                continue;
+            }
+
+            res.positionX.push_back(position.x);
+            res.positionY.push_back(position.y);
+            res.positionZ.push_back(position.z);
+            for (int i = 0; i < nDataValues; i += 1) {
+                res.columns[i].push_back(values[i]);
+            }
+
+            std::string_view rest = line.substr(*restOffset);
+            if (!rest.empty()) {
+                rest = stripped(rest);
+                auto it = commentIndices.find(rest);
+                if (it == commentIndices.end()) {
+                    const uint32_t idx = static_cast<uint32_t>(res.comments.size());
+                    it = commentIndices.emplace(rest, idx).first;
+                    res.comments.push_back(rest);
+                }
+                res.commentIndices.push_back(it->second);
+            }
+            else {
+                res.commentIndices.push_back(ColumnarDataset::NoComment);
+            }
+        }
+
+        return res;
+    }
+
+    std::vector<Labelset::Entry> parseLabelChunk(std::string_view chunk,
+                                                 const std::filesystem::path& path)
+    {
+        std::vector<Labelset::Entry> res;
+        while (!chunk.empty()) {
+            std::string line = std::string(nextLine(chunk));
+
+            // Ignore empty line or commented-out lines
+            if (line.empty() || line[0] == '#') {
+                continue;
+            }
+
+            // Guard against wrong line endings (copying files from Windows to Mac) causes
+            // lines to have a final \r
+            if (line.back() == '\r') {
+                line = line.substr(0, line.length() - 1);
+            }
+
+            strip(line);
+
+            if (line.empty()) {
+                continue;
+            }
+
+            // If the first character is a digit, we have left the preamble and are in
+            // the data section of the file
+            if (!std::isdigit(line[0]) && line[0] != '-') {
+                throw ghoul::RuntimeError(fmt::format(
+                    "Error loading label file {}: Header information and datasegment "
+                    "intermixed", path
+                ));
+            }
+
+            // Each line looks like this:
+            // <x> <y> <z> text <label> # potential comment
+            // so we want to get the position, remove the 'text' text and the potential
+            // comment at the end
+            Labelset::Entry entry;
+            std::string rest;
+            std::string_view remainder = line;
+            if (parseValue(nextToken(remainder), entry.position.x) &&
+                parseValue(nextToken(remainder), entry.position.y) &&
+                parseValue(nextToken(remainder), entry.position.z))
+            {
+                rest = std::string(remainder);
+            }
+            else {
+                std::stringstream str(line);
+                str >> entry.position.x >> entry.position.y >> entry.position.z;
+                std::getline(str, rest);
+            }
+            strip(rest);
+
+            if (startsWith(rest, "id")) {
+                // optional arument with identifier
+                // Remove the 'id' text
+                rest = rest.substr(std::string_view("id ").size());
+                size_t index = rest.find("text");
+                entry.identifier = rest.substr(0, index - 1);
+
+                // update the rest, remove the identifier
+                rest = rest.substr(index);
+            }
+            if (!startsWith(rest, "text")) {
+                throw ghoul::RuntimeError(fmt::format(
+                    "Error loading label file {}: File contains an unsupported value "
+                    "between positions and text label", path
+                ));
+            }
+
+            // Remove the 'text' text
+            rest = rest.substr(std::string_view("text ").size());
+
+            // Remove the trailing comment
+            for (size_t i = 0; i < rest.size(); i += 1) {
+                if (rest[i] == '#') {
+                    rest = rest.substr(0, i);
+                    break;
+                }
+            }
+
+            strip(rest);
+
+            entry.text = rest;
+            if (!rest.empty()) {
+                res.push_back(std::move(entry));
+            }
+        }
+        return res;
+    }
+
     template <typename T, typename U>
     void checkSize(U value, std::string_view message) {
         if (value > std::numeric_limits<U>::max()) {
@@ -77,6 +534,132 @@ namespace {
         }
     }
 
+    // Returns the location of the comment in the list of comments, adding it to the list
+    // if it has not been encountered before
+    uint32_t internComment(std::string comment, std::vector<std::string>& comments,
+                           std::unordered_map<std::string, uint32_t>& commentIndices)
+    {
+        auto it = commentIndices.find(comment);
+        if (it == commentIndices.end()) {
+            const uint32_t idx = static_cast<uint32_t>(comments.size());
+            it = commentIndices.emplace(comment, idx).first;
+            comments.push_back(std::move(comment));
+        }
+        return it->second;
+    }
+
+    // The variables, textures, and the special indices are stored in the same way for the
+    // entry-based and the columnar datasets, so they share the code for the cache header
+    template <typename T>
+    void readCacheHeader(std::ifstream& file, T& result) {
+        //
+        // Read variables
+        uint16_t nVariables;
+        file.read(reinterpret_cast<char*>(&nVariables), sizeof(uint16_t));
+        result.variables.resize(nVariables);
+        for (int i = 0; i < nVariables; i += 1) {
+            openspace::speck::Dataset::Variable var;
+
+            int16_t idx;
+            file.read(reinterpret_cast<char*>(&idx), sizeof(int16_t));
+            var.index = idx;
+
+            uint16_t len;
+            file.read(reinterpret_cast<char*>(&len), sizeof(uint16_t));
+            var.name.resize(len);
+            file.read(var.name.data(), len);
+
+            result.variables[i] = std::move(var);
+        }
+
+        //
+        // Read textures
+        uint16_t nTextures;
+        file.read(reinterpret_cast<char*>(&nTextures), sizeof(uint16_t));
+        result.textures.resize(nTextures);
+        for (int i = 0; i < nTextures; i += 1) {
+            openspace::speck::Dataset::Texture tex;
+
+            int16_t idx;
+            file.read(reinterpret_cast<char*>(&idx), sizeof(int16_t));
+            tex.index = idx;
+
+            uint16_t len;
+            file.read(reinterpret_cast<char*>(&len), sizeof(uint16_t));
+            tex.file.resize(len);
+            file.read(tex.file.data(), len);
+
+            result.textures[i] = std::move(tex);
+        }
+
+        //
+        // Read indices
+        int16_t texDataIdx;
+        file.read(reinterpret_cast<char*>(&texDataIdx), sizeof(int16_t));
+        result.textureDataIndex = texDataIdx;
+
+        int16_t oriDataIdx;
+        file.read(reinterpret_cast<char*>(&oriDataIdx), sizeof(int16_t));
+        result.orientationDataIndex = oriDataIdx;
+    }
+
+    template <typename T>
+    void writeCacheHeader(std::ofstream& file, const T& dataset) {
+        //
+        // Store variables
+        checkSize<uint16_t>(dataset.variables.size(), "Too many variables");
+        uint16_t nVariables = static_cast<uint16_t>(dataset.variables.size());
+        file.write(reinterpret_cast<const char*>(&nVariables), sizeof(uint16_t));
+        for (const openspace::speck::Dataset::Variable& var : dataset.variables) {
+            checkSize<int16_t>(var.index, "Variable index too large");
+            int16_t idx = static_cast<int16_t>(var.index);
+            file.write(reinterpret_cast<const char*>(&idx), sizeof(int16_t));
+
+            checkSize<uint16_t>(var.name.size(), "Variable name too long");
+            uint16_t len = static_cast<uint16_t>(var.name.size());
+            file.write(reinterpret_cast<const char*>(&len), sizeof(uint16_t));
+            file.write(var.name.data(), len);
+        }
+
+        //
+        // Store textures
+        checkSize<uint16_t>(dataset.textures.size(), "Too many textures");
+        uint16_t nTextures = static_cast<uint16_t>(dataset.textures.size());
+        file.write(reinterpret_cast<const char*>(&nTextures), sizeof(uint16_t));
+        for (const openspace::speck::Dataset::Texture& tex : dataset.textures) {
+            checkSize<int16_t>(tex.index, "Texture index too large");
+            int16_t idx = static_cast<int16_t>(tex.index);
+            file.write(reinterpret_cast<const char*>(&idx), sizeof(int16_t));
+
+
+            checkSize<uint16_t>(tex.file.size(), "Texture file too long");
+            uint16_t len = static_cast<uint16_t>(tex.file.size());
+            file.write(reinterpret_cast<const char*>(&len), sizeof(uint16_t));
+            file.write(tex.file.data(), len);
+        }
+
+        //
+        // Store indices
+        checkSize<int16_t>(dataset.textureDataIndex, "Texture index too large");
+        int16_t texIdx = static_cast<int16_t>(dataset.textureDataIndex);
+        file.write(reinterpret_cast<const char*>(&texIdx), sizeof(int16_t));
+
+        checkSize<int16_t>(dataset.orientationDataIndex, "Orientation index too large");
+        int16_t orientationIdx = static_cast<int16_t>(dataset.orientationDataIndex);
+        file.write(reinterpret_cast<const char*>(&orientationIdx), sizeof(int16_t));
+    }
+
+    size_t alignedSize(size_t bytes) {
+        return (bytes + MappedDataAlignment - 1) / MappedDataAlignment *
+            MappedDataAlignment;
+    }
+
+    void writePadding(std::ofstream& file) {
+        const size_t position = static_cast<size_t>(file.tellp());
+        const std::vector<char> padding(alignedSize(position) - position, 0);
+        file.write(padding.data(), padding.size());
+    }
+
     template <typename T>
     using LoadCacheFunc = std::function<std::optional<T>(std::filesystem::path)>;
 
@@ -97,7 +680,6 @@ namespace {
                                      SaveCacheFunc<T> saveCacheFunction)
     {
         static_assert(
-            std::is_same_v<T, openspace::speck::Dataset> ||
             std::is_same_v<T, openspace::speck::Labelset> ||
             std::is_same_v<T, openspace::speck::ColorMap>
         );
@@ -135,21 +717,31 @@ namespace openspace::speck {
 namespace data {
 
 Dataset loadFile(std::filesystem::path path, SkipAllZeroLines skipAllZeroLines) {
+    return loadColumnarFile(path, skipAllZeroLines).toDataset();
+}
+
+ColumnarDataset loadColumnarFile(std::filesystem::path path,
+                                 SkipAllZeroLines skipAllZeroLines, int nThreads)
+{
     ghoul_assert(std::filesystem::exists(path), "File must exist");
 
-    std::ifstream file(path);
-    if (!file.good()) {
-        throw ghoul::RuntimeError(fmt::format("Failed to open speck file {}", path));
-    }
+    // The file is mapped into memory so that the threads can parse their part of the
+    // data section directly out of it
+    MemoryMappedFile file = MemoryMappedFile(path);
+    std::string_view text = file.view();
 
-    Dataset res;
+    ColumnarDataset res;
 
     int nDataValues = 0;
     int currentLineNumber = 0;
 
-    std::string line;
+    // Everything from the first data line until the end of the file
+    std::string_view data;
+
     // First phase: Loading the header information
-    while (std::getline(file, line)) {
+    while (!text.empty()) {
+        const std::string_view rawLine = nextLine(text);
+        std::string line = std::string(rawLine);
         currentLineNumber++;
 
         // Guard against wrong line endings (copying files from Windows to Mac) causes
@@ -168,6 +760,7 @@ Dataset loadFile(std::filesystem::path path, SkipAllZeroLines skipAllZeroLines)
         // If the first character is a digit, we have left the preamble and are in the
         // data section of the file
         if (std::isdigit(line[0]) || line[0] == '-') {
+            data = file.view().substr(rawLine.data() - file.data());
             break;
         }
 
@@ -294,318 +887,544 @@ Dataset loadFile(std::filesystem::path path, SkipAllZeroLines skipAllZeroLines)
         }
     );
 
-    // For the first line, we already loaded it and rejected it above, so if we do another
-    // std::getline, we'd miss the first data value line
-    bool isFirst = true;
-    while (isFirst || std::getline(file, line)) {
-        currentLineNumber++;
-        isFirst = false;
+    // Second phase: Loading the data section, which is split into chunks of lines that
+    // are parsed in parallel. The chunks are then joined in the order of the file
+    std::vector<DataChunk> chunks = parseChunks<DataChunk>(
+        splitIntoChunks(data, nThreads),
+        [&](std::string_view chunk) {
+            return parseDataChunk(
+                chunk,
+                data,
+                currentLineNumber,
+                nDataValues,
+                skipAllZeroLines,
+                path
+            );
+        }
+    );
 
-        // Ignore empty line or commented-out lines
-        if (line.empty() || line[0] == '#') {
-            continue;
+    size_t nEntries = 0;
+    for (const DataChunk& chunk : chunks) {
+        nEntries += chunk.positionX.size();
+    }
+    res.positionX.reserve(nEntries);
+    res.positionY.reserve(nEntries);
+    res.positionZ.reserve(nEntries);
+    res.commentIndices.reserve(nEntries);
+    res.columns.resize(nDataValues);
+    for (std::vector<float>& column : res.columns) {
+        column.reserve(nEntries);
+    }
+
+    // The comments are interned once more across all chunks. As each chunk lists its
+    // comments in the order in which they first appear, the resulting order is the same
+    // as if the whole file was parsed at once
+    std::unordered_map<std::string_view, uint32_t> commentIndices;
+    std::vector<uint32_t> chunkToDataset;
+    for (DataChunk& chunk : chunks) {
+        auto append = [](std::vector<float>& target, const std::vector<float>& source) {
+            target.insert(target.end(), source.begin(), source.end());
+        };
+        append(res.positionX, chunk.positionX);
+        append(res.positionY, chunk.positionY);
+        append(res.positionZ, chunk.positionZ);
+        for (int i = 0; i < nDataValues; i += 1) {
+            append(res.columns[i], chunk.columns[i]);
         }
 
-        // Guard against wrong line endings (copying files from Windows to Mac) causes
-        // lines to have a final \r
-        if (line.back() == '\r') {
-            line = line.substr(0, line.length() - 1);
+        chunkToDataset.clear();
+        for (std::string_view comment : chunk.comments) {
+            auto it = commentIndices.find(comment);
+            if (it == commentIndices.end()) {
+                const uint32_t idx = static_cast<uint32_t>(res.comments.size());
+                it = commentIndices.emplace(comment, idx).first;
+                res.comments.emplace_back(comment);
+            }
+            chunkToDataset.push_back(it->second);
+        }
+        for (uint32_t idx : chunk.commentIndices) {
+            res.commentIndices.push_back(
+                idx == ColumnarDataset::NoComment ? idx : chunkToDataset[idx]
+            );
         }
 
-        strip(line);
+        // Release the memory of each chunk as soon as it has been copied
+        chunk = DataChunk();
+    }
 
-        if (line.empty()) {
-            continue;
-        }
+    return res;
+}
 
-        // If the first character is a digit, we have left the preamble and are in the
-        // data section of the file
-        if (!std::isdigit(line[0]) && line[0] != '-') {
-            throw ghoul::RuntimeError(fmt::format(
-                "Error loading speck file {}: Header information and datasegment "
-                "intermixed", path
-            ));
-        }
+std::optional<Dataset> loadCachedFile(std::filesystem::path path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.good()) {
+        return std::nullopt;
+    }
 
-        bool allZero = true;
+    Dataset result;
 
-        std::stringstream str(line);
-        Dataset::Entry entry;
-        str >> entry.position.x >> entry.position.y >> entry.position.z;
-        allZero &= (entry.position == glm::vec3(0.0));
+    int8_t fileVersion;
+    file.read(reinterpret_cast<char*>(&fileVersion), sizeof(int8_t));
+    if (fileVersion != DataCacheFileVersion) {
+        // Incompatible version and we won't be able to read the file
+        return std::nullopt;
+    }
 
-        if (!str.good()) {
-            // Need to subtract one of the line number here as we increase the current
-            // line count in the beginning of the while loop we are currently in
-            throw ghoul::RuntimeError(fmt::format(
-                "Error loading position information out of data line {} in file {}. "
-                "Value was not a number",
-                currentLineNumber - 1, path
-            ));
-        }
+    readCacheHeader(file, result);
 
-        entry.data.resize(nDataValues);
-        std::stringstream valueStream;
-        for (int i = 0; i < nDataValues; i += 1) {
-            std::string value;
-            str >> value;
-            if (value == "nan" || value == "NaN") {
-                entry.data[i] = std::numeric_limits<float>::quiet_NaN();
-            }
-            else {
-                valueStream.clear();
-                valueStream.str(value);
-                valueStream >> entry.data[i];
+    //
+    // Read entries
+    uint64_t nEntries;
+    file.read(reinterpret_cast<char*>(&nEntries), sizeof(uint64_t));
+    result.entries.reserve(nEntries);
+    for (uint64_t i = 0; i < nEntries; i += 1) {
+        Dataset::Entry e;
+        file.read(reinterpret_cast<char*>(&e.position.x), sizeof(float));
+        file.read(reinterpret_cast<char*>(&e.position.y), sizeof(float));
+        file.read(reinterpret_cast<char*>(&e.position.z), sizeof(float));
 
-                allZero &= (entry.data[i] == 0.0);
-                if (valueStream.fail()) {
-                    // Need to subtract one of the line number here as we increase the
-                    // current line count in the beginning of the while loop we are
-                    // currently in
-                    throw ghoul::RuntimeError(fmt::format(
-                        "Error loading data value {} out of data line {} in file {}. "
-                        "Value was not a number",
-                        i, currentLineNumber - 1, path
-                    ));
-                }
-            }
+        uint16_t nValues;
+        file.read(reinterpret_cast<char*>(&nValues), sizeof(uint16_t));
+        e.data.resize(nValues);
+        file.read(reinterpret_cast<char*>(e.data.data()), nValues * sizeof(float));
+
+        uint16_t len;
+        file.read(reinterpret_cast<char*>(&len), sizeof(uint16_t));
+        if (len > 0) {
+            std::string comment;
+            comment.resize(len);
+            file.read(comment.data(), len);
+            e.comment = std::move(comment);
         }
 
-        if (skipAllZeroLines && allZero) {
-            continue;
+        result.entries.push_back(std::move(e));
+    }
+
+    return result;
+}
+
+void saveCachedFile(const Dataset& dataset, std::filesystem::path path) {
+    std::ofstream file(path, std::ofstream::binary);
+
+    file.write(reinterpret_cast<const char*>(&DataCacheFileVersion), sizeof(int8_t));
+
+    writeCacheHeader(file, dataset);
+
+    //
+    // Store entries
+    checkSize<uint64_t>(dataset.entries.size(), "Too many entries");
+    uint64_t nEntries = static_cast<uint64_t>(dataset.entries.size());
+    file.write(reinterpret_cast<const char*>(&nEntries), sizeof(uint64_t));
+    for (const Dataset::Entry& e : dataset.entries) {
+        file.write(reinterpret_cast<const char*>(&e.position.x), sizeof(float));
+        file.write(reinterpret_cast<const char*>(&e.position.y), sizeof(float));
+        file.write(reinterpret_cast<const char*>(&e.position.z), sizeof(float));
+
+        checkSize<uint16_t>(e.data.size(), "Too many data variables");
+        uint16_t nValues = static_cast<uint16_t>(e.data.size());
+        file.write(reinterpret_cast<const char*>(&nValues), sizeof(uint16_t));
+        file.write(
+            reinterpret_cast<const char*>(e.data.data()),
+            e.data.size() * sizeof(float)
+        );
+
+        if (e.comment.has_value()) {
+            checkSize<uint16_t>(e.comment->size(), "Comment too long");
+        }
+        uint16_t commentLen = e.comment.has_value() ?
+            static_cast<uint16_t>(e.comment->size()) :
+            0;
+        file.write(reinterpret_cast<const char*>(&commentLen), sizeof(uint16_t));
+        if (e.comment.has_value()) {
+            file.write(e.comment->data(), e.comment->size());
         }
+    }
+}
 
-        std::string rest;
-        std::getline(str, rest);
-        if (!rest.empty()) {
+Dataset loadFileWithCache(std::filesystem::path speckPath,
+                               SkipAllZeroLines skipAllZeroLines)
+{
+    return loadMappedFileWithCache(speckPath, skipAllZeroLines)
+        .toColumnarDataset()
+        .toDataset();
+}
 
-            strip(rest);
-            entry.comment = rest;
+std::optional<ColumnarDataset> loadCachedColumnarFile(std::filesystem::path path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.good()) {
+        return std::nullopt;
+    }
+
+    ColumnarDataset result;
+
+    int8_t fileVersion;
+    file.read(reinterpret_cast<char*>(&fileVersion), sizeof(int8_t));
+    if (fileVersion != DataCacheFileVersion) {
+        // Incompatible version and we won't be able to read the file
+        return std::nullopt;
+    }
+
+    readCacheHeader(file, result);
+
+    //
+    // Read entries
+    uint64_t nEntries;
+    file.read(reinterpret_cast<char*>(&nEntries), sizeof(uint64_t));
+    result.positionX.resize(nEntries);
+    result.positionY.resize(nEntries);
+    result.positionZ.resize(nEntries);
+    result.commentIndices.resize(nEntries);
+
+    std::unordered_map<std::string, uint32_t> commentIndices;
+    std::string comment;
+    for (uint64_t i = 0; i < nEntries; i += 1) {
+        file.read(reinterpret_cast<char*>(&result.positionX[i]), sizeof(float));
+        file.read(reinterpret_cast<char*>(&result.positionY[i]), sizeof(float));
+        file.read(reinterpret_cast<char*>(&result.positionZ[i]), sizeof(float));
+
+        uint16_t nValues;
+        file.read(reinterpret_cast<char*>(&nValues), sizeof(uint16_t));
+        if (i == 0) {
+            result.columns.resize(nValues, std::vector<float>(nEntries));
+        }
+        else if (nValues != result.columns.size()) {
+            // The entry-based cache format allows for a different number of values for
+            // each entry, which does not have a columnar representation
+            return std::nullopt;
+        }
+        for (std::vector<float>& column : result.columns) {
+            file.read(reinterpret_cast<char*>(&column[i]), sizeof(float));
+        }
+
+        uint16_t len;
+        file.read(reinterpret_cast<char*>(&len), sizeof(uint16_t));
+        if (len > 0) {
+            comment.resize(len);
+            file.read(comment.data(), len);
+            result.commentIndices[i] =
+                internComment(comment, result.comments, commentIndices);
+        }
+        else {
+            result.commentIndices[i] = ColumnarDataset::NoComment;
         }
+    }
 
-        res.entries.push_back(std::move(entry));
+    if (!file.good()) {
+        return std::nullopt;
     }
 
-#ifdef _DEBUG
-    if (!res.entries.empty()) {
-        size_t nValues = res.entries[0].data.size();
-        ghoul_assert(nDataValues == nValues, "nDataValues calculation went wrong");
-        for (const Dataset::Entry& e : res.entries) {
-            ghoul_assert(
-                e.data.size() == nDataValues,
-                "Row had different number of data values"
-            );
+    return result;
+}
+
+void saveCachedColumnarFile(const ColumnarDataset& dataset, std::filesystem::path path)
+{
+    std::ofstream file(path, std::ofstream::binary);
+
+    file.write(reinterpret_cast<const char*>(&DataCacheFileVersion), sizeof(int8_t));
+
+    writeCacheHeader(file, dataset);
+
+    //
+    // Store entries
+    checkSize<uint64_t>(dataset.size(), "Too many entries");
+    uint64_t nEntries = static_cast<uint64_t>(dataset.size());
+    file.write(reinterpret_cast<const char*>(&nEntries), sizeof(uint64_t));
+
+    checkSize<uint16_t>(dataset.columns.size(), "Too many data variables");
+    uint16_t nValues = static_cast<uint16_t>(dataset.columns.size());
+    std::vector<float> values(nValues);
+    for (uint64_t i = 0; i < nEntries; i += 1) {
+        file.write(reinterpret_cast<const char*>(&dataset.positionX[i]), sizeof(float));
+        file.write(reinterpret_cast<const char*>(&dataset.positionY[i]), sizeof(float));
+        file.write(reinterpret_cast<const char*>(&dataset.positionZ[i]), sizeof(float));
+
+        for (uint16_t j = 0; j < nValues; j += 1) {
+            values[j] = dataset.columns[j][i];
+        }
+        file.write(reinterpret_cast<const char*>(&nValues), sizeof(uint16_t));
+        file.write(reinterpret_cast<const char*>(values.data()), nValues * sizeof(float));
+
+        std::optional<std::string_view> comment = dataset.comment(i);
+        if (comment.has_value()) {
+            checkSize<uint16_t>(comment->size(), "Comment too long");
+        }
+        uint16_t commentLen = comment.has_value() ?
+            static_cast<uint16_t>(comment->size()) :
+            0;
+        file.write(reinterpret_cast<const char*>(&commentLen), sizeof(uint16_t));
+        if (comment.has_value()) {
+            file.write(comment->data(), comment->size());
         }
     }
-#endif
+}
 
-    return res;
+ColumnarDataset loadColumnarFileWithCache(std::filesystem::path speckPath,
+                                          SkipAllZeroLines skipAllZeroLines)
+{
+    return loadMappedFileWithCache(speckPath, skipAllZeroLines).toColumnarDataset();
 }
 
-std::optional<Dataset> loadCachedFile(std::filesystem::path path) {
+std::optional<MappedDataset> loadMappedCachedFile(std::filesystem::path path) {
+    // The header is small and has a variable length, so it is read through a stream and
+    // only the arrays that follow it are used directly from the mapped file
     std::ifstream file(path, std::ios::binary);
     if (!file.good()) {
         return std::nullopt;
     }
 
-    Dataset result;
+    MappedDataset result;
 
     int8_t fileVersion;
     file.read(reinterpret_cast<char*>(&fileVersion), sizeof(int8_t));
-    if (fileVersion != DataCacheFileVersion) {
+    if (fileVersion != MappedDataCacheFileVersion) {
         // Incompatible version and we won't be able to read the file
         return std::nullopt;
     }
 
-    //
-    // Read variables
-    uint16_t nVariables;
-    file.read(reinterpret_cast<char*>(&nVariables), sizeof(uint16_t));
-    result.variables.resize(nVariables);
-    for (int i = 0; i < nVariables; i += 1) {
-        Dataset::Variable var;
-
-        int16_t idx;
-        file.read(reinterpret_cast<char*>(&idx), sizeof(int16_t));
-        var.index = idx;
+    readCacheHeader(file, result);
 
-        uint16_t len;
-        file.read(reinterpret_cast<char*>(&len), sizeof(uint16_t));
-        var.name.resize(len);
-        file.read(var.name.data(), len);
+    uint64_t nEntries;
+    file.read(reinterpret_cast<char*>(&nEntries), sizeof(uint64_t));
+    uint16_t nValues;
+    file.read(reinterpret_cast<char*>(&nValues), sizeof(uint16_t));
+    uint32_t nComments;
+    file.read(reinterpret_cast<char*>(&nComments), sizeof(uint32_t));
+    uint64_t dataOffset;
+    file.read(reinterpret_cast<char*>(&dataOffset), sizeof(uint64_t));
+    if (!file.good() || dataOffset % MappedDataAlignment != 0) {
+        return std::nullopt;
+    }
+    file.close();
 
-        result.variables[i] = std::move(var);
+    std::shared_ptr<MemoryMappedFile> mapping;
+    try {
+        mapping = std::make_shared<MemoryMappedFile>(path);
+    }
+    catch (const ghoul::RuntimeError& e) {
+        LERRORC("SpeckLoader", e.message);
+        return std::nullopt;
     }
 
-    //
-    // Read textures
-    uint16_t nTextures;
-    file.read(reinterpret_cast<char*>(&nTextures), sizeof(uint16_t));
-    result.textures.resize(nTextures);
-    for (int i = 0; i < nTextures; i += 1) {
-        Dataset::Texture tex;
+    // The counts are checked against the size of the file before they are used to
+    // compute any offsets, as the offsets of a corrupted file could otherwise overflow
+    const size_t fileSize = mapping->size();
+    if (nEntries > fileSize / sizeof(float) || nComments > fileSize / sizeof(uint64_t) ||
+        dataOffset > fileSize)
+    {
+        return std::nullopt;
+    }
 
-        int16_t idx;
-        file.read(reinterpret_cast<char*>(&idx), sizeof(int16_t));
-        tex.index = idx;
+    // The positions, the data columns, and the comment indices all have one 4 byte value
+    // per point and each of them starts at an aligned offset
+    const size_t arraySize = alignedSize(nEntries * sizeof(float));
+    const size_t nArrays = 3 + nValues + 1;
+    if (arraySize > 0 && nArrays > (fileSize - dataOffset) / arraySize) {
+        return std::nullopt;
+    }
+    const size_t commentOffsetsBegin = dataOffset + nArrays * arraySize;
+    const size_t commentsBegin =
+        commentOffsetsBegin + alignedSize((nComments + 1) * sizeof(uint64_t));
+    if (fileSize < commentsBegin) {
+        return std::nullopt;
+    }
 
-        uint16_t len;
-        file.read(reinterpret_cast<char*>(&len), sizeof(uint16_t));
-        tex.file.resize(len);
-        file.read(tex.file.data(), len);
+    const char* data = mapping->data();
+    auto floatArray = [&](size_t i) {
+        const char* begin = data + dataOffset + i * arraySize;
+        return std::span<const float>(reinterpret_cast<const float*>(begin), nEntries);
+    };
+    result.positionX = floatArray(0);
+    result.positionY = floatArray(1);
+    result.positionZ = floatArray(2);
+    result.columns.reserve(nValues);
+    for (uint16_t i = 0; i < nValues; i += 1) {
+        result.columns.push_back(floatArray(3 + i));
+    }
+    result.commentIndices = std::span<const uint32_t>(
+        reinterpret_cast<const uint32_t*>(data + dataOffset + (nArrays - 1) * arraySize),
+        nEntries
+    );
+    // The comment indices are used without any further checks, so a corrupted file must
+    // not be able to refer to comments that don't exist
+    for (uint32_t index : result.commentIndices) {
+        if (index >= nComments && index != ColumnarDataset::NoComment) {
+            return std::nullopt;
+        }
+    }
 
-        result.textures[i] = std::move(tex);
+    // The comments are stored back to back, with the offsets of their beginnings and the
+    // offset of the end of the last comment stored ahead of them
+    const uint64_t* commentOffsets =
+        reinterpret_cast<const uint64_t*>(data + commentOffsetsBegin);
+    const size_t commentsSize = fileSize - commentsBegin;
+    result.comments.reserve(nComments);
+    for (uint32_t i = 0; i < nComments; i += 1) {
+        const uint64_t begin = commentOffsets[i];
+        const uint64_t end = commentOffsets[i + 1];
+        if (begin > end || end > commentsSize) {
+            return std::nullopt;
+        }
+        result.comments.emplace_back(data + commentsBegin + begin, end - begin);
     }
 
-    //
-    // Read indices
-    int16_t texDataIdx;
-    file.read(reinterpret_cast<char*>(&texDataIdx), sizeof(int16_t));
-    result.textureDataIndex = texDataIdx;
+    result.storage = std::move(mapping);
+    return result;
+}
 
-    int16_t oriDataIdx;
-    file.read(reinterpret_cast<char*>(&oriDataIdx), sizeof(int16_t));
-    result.orientationDataIndex = oriDataIdx;
+void saveMappedCachedFile(const ColumnarDataset& dataset, std::filesystem::path path) {
+    checkSize<uint64_t>(dataset.size(), "Too many entries");
+    uint64_t nEntries = static_cast<uint64_t>(dataset.size());
+    checkSize<uint16_t>(dataset.columns.size(), "Too many data variables");
+    uint16_t nValues = static_cast<uint16_t>(dataset.columns.size());
+    checkSize<uint32_t>(dataset.comments.size(), "Too many comments");
+    uint32_t nComments = static_cast<uint32_t>(dataset.comments.size());
+
+    // The cache file might currently be mapped by another dataset, so it must not be
+    // changed in place. Instead the file is written under a temporary name and then
+    // replaces the old file, which also prevents a half-written cache file if the
+    // writing is interrupted
+    static std::atomic_uint64_t TemporaryCounter = 0;
+    std::filesystem::path tmp = path;
+    tmp += fmt::format(".{}.tmp", TemporaryCounter++);
+    {
+        std::ofstream file(tmp, std::ofstream::binary);
 
-    //
-    // Read entries
-    uint64_t nEntries;
-    file.read(reinterpret_cast<char*>(&nEntries), sizeof(uint64_t));
-    result.entries.reserve(nEntries);
-    for (uint64_t i = 0; i < nEntries; i += 1) {
-        Dataset::Entry e;
-        file.read(reinterpret_cast<char*>(&e.position.x), sizeof(float));
-        file.read(reinterpret_cast<char*>(&e.position.y), sizeof(float));
-        file.read(reinterpret_cast<char*>(&e.position.z), sizeof(float));
+        file.write(
+            reinterpret_cast<const char*>(&MappedDataCacheFileVersion),
+            sizeof(int8_t)
+        );
 
-        uint16_t nValues;
-        file.read(reinterpret_cast<char*>(&nValues), sizeof(uint16_t));
-        e.data.resize(nValues);
-        file.read(reinterpret_cast<char*>(e.data.data()), nValues * sizeof(float));
+        writeCacheHeader(file, dataset);
 
-        uint16_t len;
-        file.read(reinterpret_cast<char*>(&len), sizeof(uint16_t));
-        if (len > 0) {
-            std::string comment;
-            comment.resize(len);
-            file.read(comment.data(), len);
-            e.comment = std::move(comment);
+        file.write(reinterpret_cast<const char*>(&nEntries), sizeof(uint64_t));
+        file.write(reinterpret_cast<const char*>(&nValues), sizeof(uint16_t));
+        file.write(reinterpret_cast<const char*>(&nComments), sizeof(uint32_t));
+
+        // The data offset is the first aligned offset after the offset value itself
+        const size_t headerSize = static_cast<size_t>(file.tellp()) + sizeof(uint64_t);
+        uint64_t dataOffset = static_cast<uint64_t>(alignedSize(headerSize));
+        file.write(reinterpret_cast<const char*>(&dataOffset), sizeof(uint64_t));
+        writePadding(file);
+
+        auto writeArray = [&file](const auto& values) {
+            file.write(
+                reinterpret_cast<const char*>(values.data()),
+                values.size() * sizeof(values[0])
+            );
+            writePadding(file);
+        };
+        writeArray(dataset.positionX);
+        writeArray(dataset.positionY);
+        writeArray(dataset.positionZ);
+        for (const std::vector<float>& column : dataset.columns) {
+            writeArray(column);
+        }
+        writeArray(dataset.commentIndices);
+
+        std::vector<uint64_t> commentOffsets;
+        commentOffsets.reserve(dataset.comments.size() + 1);
+        uint64_t offset = 0;
+        for (const std::string& comment : dataset.comments) {
+            commentOffsets.push_back(offset);
+            offset += comment.size();
+        }
+        commentOffsets.push_back(offset);
+        writeArray(commentOffsets);
+        for (const std::string& comment : dataset.comments) {
+            file.write(comment.data(), comment.size());
         }
 
-        result.entries.push_back(std::move(e));
+        file.close();
+        if (!file.good()) {
+            LERRORC("SpeckLoader", fmt::format("Error writing cache file {}", tmp));
+            std::error_code ec;
+            std::filesystem::remove(tmp, ec);
+            return;
+        }
     }
 
-    return result;
+    std::error_code ec;
+    std::filesystem::rename(tmp, path, ec);
+    if (ec) {
+        // On some systems a file that is mapped can't be replaced, in which case the old
+        // cache file is kept
+        LERRORC(
+            "SpeckLoader",
+            fmt::format("Error replacing cache file {}: {}", path, ec.message())
+        );
+        std::filesystem::remove(tmp, ec);
+    }
 }
 
-void saveCachedFile(const Dataset& dataset, std::filesystem::path path) {
-    std::ofstream file(path, std::ofstream::binary);
-
-    file.write(reinterpret_cast<const char*>(&DataCacheFileVersion), sizeof(int8_t));
-
-    //
-    // Store variables
-    checkSize<uint16_t>(dataset.variables.size(), "Too many variables");
-    uint16_t nVariables = static_cast<uint16_t>(dataset.variables.size());
-    file.write(reinterpret_cast<const char*>(&nVariables), sizeof(uint16_t));
-    for (const Dataset::Variable& var : dataset.variables) {
-        checkSize<int16_t>(var.index, "Variable index too large");
-        int16_t idx = static_cast<int16_t>(var.index);
-        file.write(reinterpret_cast<const char*>(&idx), sizeof(int16_t));
-
-        checkSize<uint16_t>(var.name.size(), "Variable name too long");
-        uint16_t len = static_cast<uint16_t>(var.name.size());
-        file.write(reinterpret_cast<const char*>(&len), sizeof(uint16_t));
-        file.write(var.name.data(), len);
-    }
+MappedDataset loadMappedFileWithCache(std::filesystem::path speckPath,
+                                      SkipAllZeroLines skipAllZeroLines)
+{
+    std::filesystem::path cached = FileSys.cacheManager()->cachedFilename(speckPath);
 
-    //
-    // Store textures
-    checkSize<uint16_t>(dataset.textures.size(), "Too many textures");
-    uint16_t nTextures = static_cast<uint16_t>(dataset.textures.size());
-    file.write(reinterpret_cast<const char*>(&nTextures), sizeof(uint16_t));
-    for (const Dataset::Texture& tex : dataset.textures) {
-        checkSize<int16_t>(tex.index, "Texture index too large");
-        int16_t idx = static_cast<int16_t>(tex.index);
-        file.write(reinterpret_cast<const char*>(&idx), sizeof(int16_t));
-
-
-        checkSize<uint16_t>(tex.file.size(), "Texture file too long");
-        uint16_t len = static_cast<uint16_t>(tex.file.size());
-        file.write(reinterpret_cast<const char*>(&len), sizeof(uint16_t));
-        file.write(tex.file.data(), len);
-    }
+    if (std::filesystem::exists(cached)) {
+        LINFOC(
+            "SpeckLoader",
+            fmt::format("Cached file {} used for file {}", cached, speckPath)
+        );
 
-    //
-    // Store indices
-    checkSize<int16_t>(dataset.textureDataIndex, "Texture index too large");
-    int16_t texIdx = static_cast<int16_t>(dataset.textureDataIndex);
-    file.write(reinterpret_cast<const char*>(&texIdx), sizeof(int16_t));
+        std::optional<MappedDataset> dataset = loadMappedCachedFile(cached);
+        if (dataset.has_value()) {
+            // We could load the cache file and we are now done with this
+            return *dataset;
+        }
 
-    checkSize<int16_t>(dataset.orientationDataIndex, "Orientation index too large");
-    int16_t orientationIdx = static_cast<int16_t>(dataset.orientationDataIndex);
-    file.write(reinterpret_cast<const char*>(&orientationIdx), sizeof(int16_t));
+        // Cache files that were written before the mapped format existed are still read
+        // and replaced with a cache file in the new format
+        std::optional<ColumnarDataset> columnar = loadCachedColumnarFile(cached);
+        if (columnar.has_value()) {
+            LINFOC("SpeckLoader", "Converting cache to the mapped format");
+            saveMappedCachedFile(*columnar, cached);
+            dataset = loadMappedCachedFile(cached);
+            if (dataset.has_value()) {
+                return *dataset;
+            }
+            return MappedDataset::fromColumnarDataset(std::move(*columnar));
+        }
 
-    //
-    // Store entries
-    checkSize<uint64_t>(dataset.entries.size(), "Too many entries");
-    uint64_t nEntries = static_cast<uint64_t>(dataset.entries.size());
-    file.write(reinterpret_cast<const char*>(&nEntries), sizeof(uint64_t));
-    for (const Dataset::Entry& e : dataset.entries) {
-        file.write(reinterpret_cast<const char*>(&e.position.x), sizeof(float));
-        file.write(reinterpret_cast<const char*>(&e.position.y), sizeof(float));
-        file.write(reinterpret_cast<const char*>(&e.position.z), sizeof(float));
+        FileSys.cacheManager()->removeCacheFile(cached);
+    }
+    LINFOC("SpeckLoader", fmt::format("Loading file {}", speckPath));
+    ColumnarDataset dataset = loadColumnarFile(speckPath, skipAllZeroLines);
 
-        checkSize<uint16_t>(e.data.size(), "Too many data variables");
-        uint16_t nValues = static_cast<uint16_t>(e.data.size());
-        file.write(reinterpret_cast<const char*>(&nValues), sizeof(uint16_t));
-        file.write(
-            reinterpret_cast<const char*>(e.data.data()),
-            e.data.size() * sizeof(float)
-        );
+    if (!dataset.empty()) {
+        LINFOC("SpeckLoader", "Saving cache");
+        saveMappedCachedFile(dataset, cached);
 
-        if (e.comment.has_value()) {
-            checkSize<uint16_t>(e.comment->size(), "Comment too long");
-        }
-        uint16_t commentLen = e.comment.has_value() ?
-            static_cast<uint16_t>(e.comment->size()) :
-            0;
-        file.write(reinterpret_cast<const char*>(&commentLen), sizeof(uint16_t));
-        if (e.comment.has_value()) {
-            file.write(e.comment->data(), e.comment->size());
+        std::optional<MappedDataset> mapped = loadMappedCachedFile(cached);
+        if (mapped.has_value()) {
+            return *mapped;
         }
     }
-}
 
-Dataset loadFileWithCache(std::filesystem::path speckPath,
-                               SkipAllZeroLines skipAllZeroLines)
-{
-    return internalLoadFileWithCache<Dataset>(
-        speckPath,
-        skipAllZeroLines,
-        &loadFile,
-        &loadCachedFile,
-        &saveCachedFile
-    );
+    // The cache file could not be written, so the spans point into the parsed dataset
+    return MappedDataset::fromColumnarDataset(std::move(dataset));
 }
 
 } // namespace data
 
 namespace label {
 
-Labelset loadFile(std::filesystem::path path, SkipAllZeroLines) {
+Labelset loadFile(std::filesystem::path path, SkipAllZeroLines, int nThreads) {
     ghoul_assert(std::filesystem::exists(path), "File must exist");
 
-    std::ifstream file(path);
-    if (!file.good()) {
-        throw ghoul::RuntimeError(fmt::format("Failed to open speck file {}", path));
-    }
+    MemoryMappedFile file = MemoryMappedFile(path);
+    std::string_view text = file.view();
 
     Labelset res;
 
-    std::string line;
+    // Everything from the first data line until the end of the file
+    std::string_view data;
+
     // First phase: Loading the header information
-    while (std::getline(file, line)) {
+    while (!text.empty()) {
+        const std::string_view rawLine = nextLine(text);
+        std::string line = std::string(rawLine);
+
         // Ignore empty line or commented-out lines
         if (line.empty() || line[0] == '#') {
             continue;
@@ -622,6 +1441,7 @@ Labelset loadFile(std::filesystem::path path, SkipAllZeroLines) {
         // If the first character is a digit, we have left the preamble and are in the
         // data section of the file
         if (std::isdigit(line[0]) || line[0] == '-') {
+            data = file.view().substr(rawLine.data() - file.data());
             break;
         }
 
@@ -645,84 +1465,21 @@ Labelset loadFile(std::filesystem::path path, SkipAllZeroLines) {
         }
     }
 
-    // For the first line, we already loaded it and rejected it above, so if we do another
-    // std::getline, we'd miss the first data value line
-    bool isFirst = true;
-    while (isFirst || std::getline(file, line)) {
-        isFirst = false;
-
-        // Ignore empty line or commented-out lines
-        if (line.empty() || line[0] == '#') {
-            continue;
-        }
-
-        // Guard against wrong line endings (copying files from Windows to Mac) causes
-        // lines to have a final \r
-        if (line.back() == '\r') {
-            line = line.substr(0, line.length() - 1);
-        }
-
-        strip(line);
-
-        if (line.empty()) {
-            continue;
-        }
-
-        // If the first character is a digit, we have left the preamble and are in the
-        // data section of the file
-        if (!std::isdigit(line[0]) && line[0] != '-') {
-            throw ghoul::RuntimeError(fmt::format(
-                "Error loading label file {}: Header information and datasegment "
-                "intermixed", path
-            ));
-        }
-
-        // Each line looks like this:
-        // <x> <y> <z> text <label> # potential comment
-        // so we want to get the position, remove the 'text' text and the potential
-        // comment at the end
-        std::stringstream str(line);
-        Labelset::Entry entry;
-        str >> entry.position.x >> entry.position.y >> entry.position.z;
-
-        std::string rest;
-        std::getline(str, rest);
-        strip(rest);
-
-        if (startsWith(rest, "id")) {
-            // optional arument with identifier
-            // Remove the 'id' text
-            rest = rest.substr(std::string_view("id ").size());
-            size_t index = rest.find("text");
-            entry.identifier = rest.substr(0, index - 1);
-
-            // update the rest, remove the identifier
-            rest = rest.substr(index);
-        }
-        if (!startsWith(rest, "text")) {
-            throw ghoul::RuntimeError(fmt::format(
-                "Error loading label file {}: File contains an unsupported value "
-                "between positions and text label", path
-            ));
-        }
-
-        // Remove the 'text' text
-        rest = rest.substr(std::string_view("text ").size());
-
-        // Remove the trailing comment
-        for (size_t i = 0; i < rest.size(); i += 1) {
-            if (rest[i] == '#') {
-                rest = rest.substr(0, i);
-                break;
-            }
-        }
-
-        strip(rest);
+    // Second phase: Loading the data section, which is split into chunks of lines that
+    // are parsed in parallel
+    std::vector<std::vector<Labelset::Entry>> chunks =
+        parseChunks<std::vector<Labelset::Entry>>(
+            splitIntoChunks(data, nThreads),
+            [&path](std::string_view chunk) { return parseLabelChunk(chunk, path); }
+        );
 
-        entry.text = rest;
-        if (!rest.empty()) {
-            res.entries.push_back(std::move(entry));
-        }
+    size_t nEntries = 0;
+    for (const std::vector<Labelset::Entry>& chunk : chunks) {
+        nEntries += chunk.size();
+    }
+    res.entries.reserve(nEntries);
+    for (std::vector<Labelset::Entry>& chunk : chunks) {
+        std::move(chunk.begin(), chunk.end(), std::back_inserter(res.entries));
     }
 
     return res;
@@ -815,7 +1572,9 @@ Labelset loadFileWithCache(std::filesystem::path speckPath,
     return internalLoadFileWithCache<Labelset>(
         speckPath,
         skipAllZeroLines,
-        &loadFile,
+        [](std::filesystem::path path, SkipAllZeroLines skip) {
+            return loadFile(path, skip);
+        },
         &loadCachedFile,
         &saveCachedFile
     );
@@ -828,10 +1587,10 @@ namespace color {
 ColorMap loadFile(std::filesystem::path path, SkipAllZeroLines) {
     ghoul_assert(std::filesystem::exists(path), "File must exist");
 
-    std::ifstream file(path);
-    if (!file.good()) {
-        throw ghoul::RuntimeError(fmt::format("Failed to open speck file {}", path));
-    }
+    // Color maps only have a few hundred lines at most, so they are not worth splitting
+    // between threads
+    MemoryMappedFile file = MemoryMappedFile(path);
+    std::string_view text = file.view();
 
     ColorMap res;
     int nColorLines = -1;
@@ -839,8 +1598,9 @@ ColorMap loadFile(std::filesystem::path path, SkipAllZeroLines) {
     // The beginning of the speck file has a header that either contains comments
     // (signaled by a preceding '#') or information about the structure of the file
     // (signaled by the keywords 'datavar', 'texturevar', and 'texture')
-    std::string line;
-    while (std::getline(file, line)) {
+    while (!text.empty()) {
+        std::string_view line = nextLine(text);
+
         // Ignore empty line or commented-out lines
         if (line.empty() || line[0] == '#') {
             continue;
@@ -849,17 +1609,20 @@ ColorMap loadFile(std::filesystem::path path, SkipAllZeroLines) {
         // Guard against wrong line endings (copying files from Windows to Mac) causes
         // lines to have a final \r
         if (line.back() == '\r') {
-            line = line.substr(0, line.length() - 1);
+            line.remove_suffix(1);
         }
 
-        strip(line);
+        line = stripped(line);
 
-        std::stringstream str(line);
+        std::string_view rest = line;
         if (nColorLines == -1) {
             // This is the first time we get this far, it will have to be the first number
             // meaning that it is the number of color values
 
-            str >> nColorLines;
+            if (!parseValue(nextToken(rest), nColorLines)) {
+                std::stringstream str = std::stringstream(std::string(line));
+                str >> nColorLines;
+            }
             res.entries.reserve(nColorLines);
         }
         else {
@@ -867,7 +1630,14 @@ ColorMap loadFile(std::filesystem::path path, SkipAllZeroLines) {
             // reading the individual value lines
 
             glm::vec4 color;
-            str >> color.x >> color.y >> color.z >> color.w;
+            if (!parseValue(nextToken(rest), color.x) ||
+                !parseValue(nextToken(rest), color.y) ||
+                !parseValue(nextToken(rest), color.z) ||
+                !parseValue(nextToken(rest), color.w))
+            {
+                std::stringstream str = std::stringstream(std::string(line));
+                str >> color.x >> color.y >> color.z >> color.w;
+            }
             res.entries.push_back(std::move(color));
         }
     }
@@ -977,4 +1747,191 @@ bool Dataset::normalizeVariable(std::string_view variableName) {
     return true;
 }
 
+size_t ColumnarDataset::size() const {
+    return positionX.size();
+}
+
+bool ColumnarDataset::empty() const {
+    return positionX.empty();
+}
+
+glm::vec3 ColumnarDataset::position(size_t entry) const {
+    ghoul_assert(entry < size(), "Entry out of bounds");
+    return glm::vec3(positionX[entry], positionY[entry], positionZ[entry]);
+}
+
+std::optional<std::string_view> ColumnarDataset::comment(size_t entry) const {
+    ghoul_assert(entry < size(), "Entry out of bounds");
+    const uint32_t idx = commentIndices[entry];
+    if (idx == NoComment) {
+        return std::nullopt;
+    }
+    return comments[idx];
+}
+
+int ColumnarDataset::index(std::string_view variableName) const {
+    for (const Dataset::Variable& v : variables) {
+        if (v.name == variableName) {
+            return v.index;
+        }
+    }
+    return -1;
+}
+
+bool ColumnarDataset::normalizeVariable(std::string_view variableName) {
+    const int idx = index(variableName);
+    if (idx == -1) {
+        // We didn't find the variable that was specified
+        return false;
+    }
+
+    std::vector<float>& column = columns[idx];
+    float minValue = std::numeric_limits<float>::max();
+    float maxValue = -std::numeric_limits<float>::max();
+    for (float v : column) {
+        minValue = std::min(minValue, v);
+        maxValue = std::max(maxValue, v);
+    }
+
+    for (float& v : column) {
+        v = (v - minValue) / (maxValue - minValue);
+    }
+
+    return true;
+}
+
+Dataset ColumnarDataset::toDataset() const {
+    Dataset res;
+    res.variables = variables;
+    res.textures = textures;
+    res.textureDataIndex = textureDataIndex;
+    res.orientationDataIndex = orientationDataIndex;
+
+    res.entries.resize(size());
+    for (size_t i = 0; i < size(); i += 1) {
+        Dataset::Entry& e = res.entries[i];
+        e.position = position(i);
+        e.data.resize(columns.size());
+        for (size_t j = 0; j < columns.size(); j += 1) {
+            e.data[j] = columns[j][i];
+        }
+        std::optional<std::string_view> c = comment(i);
+        if (c.has_value()) {
+            e.comment = std::string(*c);
+        }
+    }
+    return res;
+}
+
+ColumnarDataset ColumnarDataset::fromDataset(const Dataset& dataset) {
+    ColumnarDataset res;
+    res.variables = dataset.variables;
+    res.textures = dataset.textures;
+    res.textureDataIndex = dataset.textureDataIndex;
+    res.orientationDataIndex = dataset.orientationDataIndex;
+
+    const size_t nEntries = dataset.entries.size();
+    const size_t nValues = nEntries > 0 ? dataset.entries[0].data.size() : 0;
+    res.positionX.resize(nEntries);
+    res.positionY.resize(nEntries);
+    res.positionZ.resize(nEntries);
+    res.columns.resize(nValues, std::vector<float>(nEntries));
+    res.commentIndices.resize(nEntries);
+
+    std::unordered_map<std::string, uint32_t> commentIndices;
+    for (size_t i = 0; i < nEntries; i += 1) {
+        const Dataset::Entry& e = dataset.entries[i];
+        ghoul_assert(
+            e.data.size() == nValues,
+            "All entries must have the same number of data values"
+        );
+
+        res.positionX[i] = e.position.x;
+        res.positionY[i] = e.position.y;
+        res.positionZ[i] = e.position.z;
+        for (size_t j = 0; j < nValues; j += 1) {
+            res.columns[j][i] = e.data[j];
+        }
+
+        if (e.comment.has_value()) {
+            res.commentIndices[i] =
+                internComment(*e.comment, res.comments, commentIndices);
+        }
+        else {
+            res.commentIndices[i] = NoComment;
+        }
+    }
+    return res;
+}
+
+size_t MappedDataset::size() const {
+    return positionX.size();
+}
+
+bool MappedDataset::empty() const {
+    return positionX.empty();
+}
+
+glm::vec3 MappedDataset::position(size_t entry) const {
+    ghoul_assert(entry < size(), "Entry out of bounds");
+    return glm::vec3(positionX[entry], positionY[entry], positionZ[entry]);
+}
+
+std::optional<std::string_view> MappedDataset::comment(size_t entry) const {
+    ghoul_assert(entry < size(), "Entry out of bounds");
+    const uint32_t idx = commentIndices[entry];
+    if (idx == ColumnarDataset::NoComment) {
+        return std::nullopt;
+    }
+    return comments[idx];
+}
+
+int MappedDataset::index(std::string_view variableName) const {
+    for (const Dataset::Variable& v : variables) {
+        if (v.name == variableName) {
+            return v.index;
+        }
+    }
+    return -1;
+}
+
+ColumnarDataset MappedDataset::toColumnarDataset() const {
+    ColumnarDataset res;
+    res.variables = variables;
+    res.textures = textures;
+    res.textureDataIndex = textureDataIndex;
+    res.orientationDataIndex = orientationDataIndex;
+
+    res.positionX.assign(positionX.begin(), positionX.end());
+    res.positionY.assign(positionY.begin(), positionY.end());
+    res.positionZ.assign(positionZ.begin(), positionZ.end());
+    res.columns.reserve(columns.size());
+    for (std::span<const float> column : columns) {
+        res.columns.emplace_back(column.begin(), column.end());
+    }
+    res.comments.assign(comments.begin(), comments.end());
+    res.commentIndices.assign(commentIndices.begin(), commentIndices.end());
+    return res;
+}
+
+MappedDataset MappedDataset::fromColumnarDataset(ColumnarDataset dataset) {
+    auto storage = std::make_shared<const ColumnarDataset>(std::move(dataset));
+
+    MappedDataset res;
+    res.variables = storage->variables;
+    res.textures = storage->textures;
+    res.textureDataIndex = storage->textureDataIndex;
+    res.orientationDataIndex = storage->orientationDataIndex;
+
+    res.positionX = storage->positionX;
+    res.positionY = storage->positionY;
+    res.positionZ = storage->positionZ;
+    res.columns.assign(storage->columns.begin(), storage->columns.end());
+    res.comments.assign(storage->comments.begin(), storage->comments.end());
+    res.commentIndices = storage->commentIndices;
+
+    res.storage = std::move(storage);
+    return res;
+}
+
 } // namespace openspace::speck
@@ -27,9 +27,14 @@
 
 #include <ghoul/glm.h>
 #include <ghoul/misc/boolean.h>
+#include <cstdint>
 #include <filesystem>
+#include <limits>
+#include <memory>
 #include <optional>
+#include <span>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace openspace::speck {
@@ -63,6 +68,91 @@ struct Dataset {
     bool normalizeVariable(std::string_view variableName);
 };
 
+/**
+ * Column-oriented representation of the contents of a speck file. Each data value is
+ * stored in its own contiguous array, the positions are stored as three separate arrays,
+ * and comments are interned so that each distinct comment is only stored once. The
+ * entry-based Dataset can be created from this representation through #toDataset for
+ * code that has not been converted to the columnar layout yet.
+ */
+struct ColumnarDataset {
+    /// Value of a #commentIndices entry for a point that does not have a comment
+    static constexpr uint32_t NoComment = std::numeric_limits<uint32_t>::max();
+
+    std::vector<Dataset::Variable> variables;
+    std::vector<Dataset::Texture> textures;
+
+    int textureDataIndex = -1;
+    int orientationDataIndex = -1;
+
+    std::vector<float> positionX;
+    std::vector<float> positionY;
+    std::vector<float> positionZ;
+
+    /// One array per data value, each of which has one value per point. The data value
+    /// of variable `v` for point `i` is at `columns[v.index][i]`
+    std::vector<std::vector<float>> columns;
+
+    /// The distinct comments that occur in the dataset
+    std::vector<std::string> comments;
+    /// For each point the index into #comments or #NoComment
+    std::vector<uint32_t> commentIndices;
+
+    size_t size() const;
+    bool empty() const;
+
+    glm::vec3 position(size_t entry) const;
+    std::optional<std::string_view> comment(size_t entry) const;
+
+    int index(std::string_view variableName) const;
+    bool normalizeVariable(std::string_view variableName);
+
+    Dataset toDataset() const;
+    static ColumnarDataset fromDataset(const Dataset& dataset);
+};
+
+/**
+ * Read-only view of a speck dataset that does not own its data. The positions and data
+ * values are spans into #storage, which usually is a memory-mapped cache file written
+ * by data::saveMappedCachedFile, so that loading a cached dataset neither copies nor
+ * allocates per point. If a cache file could not be written, #storage instead holds the
+ * ColumnarDataset the spans point into.
+ */
+struct MappedDataset {
+    std::vector<Dataset::Variable> variables;
+    std::vector<Dataset::Texture> textures;
+
+    int textureDataIndex = -1;
+    int orientationDataIndex = -1;
+
+    std::span<const float> positionX;
+    std::span<const float> positionY;
+    std::span<const float> positionZ;
+
+    /// One span per data value, each of which has one value per point. The data value
+    /// of variable `v` for point `i` is at `columns[v.index][i]`
+    std::vector<std::span<const float>> columns;
+
+    /// The distinct comments that occur in the dataset
+    std::vector<std::string_view> comments;
+    /// For each point the index into #comments or ColumnarDataset::NoComment
+    std::span<const uint32_t> commentIndices;
+
+    /// Keeps the memory alive that all of the spans and views point into
+    std::shared_ptr<const void> storage;
+
+    size_t size() const;
+    bool empty() const;
+
+    glm::vec3 position(size_t entry) const;
+    std::optional<std::string_view> comment(size_t entry) const;
+
+    int index(std::string_view variableName) const;
+
+    ColumnarDataset toColumnarDataset() const;
+    static MappedDataset fromColumnarDataset(ColumnarDataset dataset);
+};
+
 struct Labelset {
     int textColorIndex = -1;
 
@@ -90,12 +180,59 @@ namespace data {
     Dataset loadFileWithCache(std::filesystem::path speckPath,
         SkipAllZeroLines skipAllZeroLines = SkipAllZeroLines::Yes);
 
+    /**
+     * Loads the speck file at \p path. The data section of large files is split into
+     * chunks of lines that are parsed by \p nThreads threads. If \p nThreads is 0, one
+     * thread per core is used.
+     */
+    ColumnarDataset loadColumnarFile(std::filesystem::path path,
+        SkipAllZeroLines skipAllZeroLines = SkipAllZeroLines::Yes, int nThreads = 0);
+
+    std::optional<ColumnarDataset> loadCachedColumnarFile(std::filesystem::path path);
+    void saveCachedColumnarFile(const ColumnarDataset& dataset,
+        std::filesystem::path path);
+
+    ColumnarDataset loadColumnarFileWithCache(std::filesystem::path speckPath,
+        SkipAllZeroLines skipAllZeroLines = SkipAllZeroLines::Yes);
+
+    /**
+     * Maps the cache file at \p path into memory and returns a dataset whose positions
+     * and data values point directly into the mapped file. Returns `std::nullopt` if the
+     * file does not exist, was not written by #saveMappedCachedFile, is truncated, or
+     * refers to comments that are not stored in it.
+     */
+    std::optional<MappedDataset> loadMappedCachedFile(std::filesystem::path path);
+
+    /**
+     * Writes the \p dataset to \p path in a layout in which the positions, each of the
+     * data columns, and the comment indices are stored contiguously and aligned, so that
+     * the file can be used without any copies by #loadMappedCachedFile. The file is
+     * written under a temporary name first and then replaces any existing file at
+     * \p path, so datasets that have mapped the previous file remain valid.
+     */
+    void saveMappedCachedFile(const ColumnarDataset& dataset,
+        std::filesystem::path path);
+
+    /**
+     * Loads the speck file at \p speckPath through its mapped cache file. A cache file
+     * in the older format that is written by #saveCachedFile is read and converted to
+     * the mapped format. If the cache file does not exist, the speck file is parsed and
+     * the cache file is created.
+     */
+    MappedDataset loadMappedFileWithCache(std::filesystem::path speckPath,
+        SkipAllZeroLines skipAllZeroLines = SkipAllZeroLines::Yes);
+
 } // namespace data
 
 namespace label {
 
+    /**
+     * Loads the label file at \p path. The data section of large files is split into
+     * chunks of lines that are parsed by \p nThreads threads. If \p nThreads is 0, one
+     * thread per core is used.
+     */
     Labelset loadFile(std::filesystem::path path,
-        SkipAllZeroLines skipAllZeroLines = SkipAllZeroLines::Yes);
+        SkipAllZeroLines skipAllZeroLines = SkipAllZeroLines::Yes, int nThreads = 0);
 
     std::optional<Labelset> loadCachedFile(std::filesystem::path path);
     void saveCachedFile(const Labelset& labelset, std::filesystem::path path);
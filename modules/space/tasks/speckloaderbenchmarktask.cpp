@@ -0,0 +1,264 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2023                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/space/tasks/speckloaderbenchmarktask.h>
+
+#include <modules/space/speckloader.h>
+#include <openspace/documentation/documentation.h>
+#include <openspace/documentation/verifier.h>
+#include <ghoul/fmt.h>
+#include <ghoul/filesystem/filesystem.h>
+#include <ghoul/logging/logmanager.h>
+#include <ghoul/misc/dictionary.h>
+#include <ghoul/misc/dictionaryjsonformatter.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+namespace {
+    constexpr std::string_view _loggerCat = "SpeckLoaderBenchmarkTask";
+
+    // The floating point values are compared bitwise so that NaN values that were read
+    // from the file are considered equal
+    bool isEqual(const std::vector<float>& a, const std::vector<float>& b) {
+        return a.size() == b.size() &&
+            (a.empty() || std::memcmp(a.data(), b.data(), a.size() * sizeof(float)) == 0);
+    }
+
+    bool isEqual(const openspace::speck::ColumnarDataset& a,
+                 const openspace::speck::ColumnarDataset& b)
+    {
+        if (a.columns.size() != b.columns.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < a.columns.size(); ++i) {
+            if (!isEqual(a.columns[i], b.columns[i])) {
+                return false;
+            }
+        }
+        return isEqual(a.positionX, b.positionX) && isEqual(a.positionY, b.positionY) &&
+            isEqual(a.positionZ, b.positionZ) && a.comments == b.comments &&
+            a.commentIndices == b.commentIndices;
+    }
+
+    bool isEqual(const openspace::speck::Labelset& a,
+                 const openspace::speck::Labelset& b)
+    {
+        if (a.textColorIndex != b.textColorIndex || a.entries.size() != b.entries.size())
+        {
+            return false;
+        }
+        for (size_t i = 0; i < a.entries.size(); ++i) {
+            const openspace::speck::Labelset::Entry& ea = a.entries[i];
+            const openspace::speck::Labelset::Entry& eb = b.entries[i];
+            if (std::memcmp(&ea.position, &eb.position, sizeof(glm::vec3)) != 0 ||
+                ea.identifier != eb.identifier || ea.text != eb.text ||
+                ea.isEnabled != eb.isEnabled)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    struct [[codegen::Dictionary(SpeckLoaderBenchmarkTask)]] Parameters {
+        // The speck, label, or colormap file that is loaded
+        std::filesystem::path file;
+
+        enum class [[codegen::map(openspace::SpeckLoaderBenchmarkTask::FileType)]] Type {
+            Data,
+            Label,
+            Color
+        };
+        // Determines whether the file is loaded as a speck file with data points, as a
+        // label file, or as a colormap. Colormaps are always parsed on a single thread
+        std::optional<Type> fileType;
+
+        // The number of times the file is loaded by each of the loaders
+        std::optional<int> repetitions [[codegen::greater(0)]];
+
+        // The number of threads used for the threaded loading. If this value is not
+        // specified, one thread per core is used
+        std::optional<int> threads [[codegen::greater(0)]];
+
+        // If this value is specified, the results are also written as JSON to this file
+        std::optional<std::string> output [[codegen::annotation("A valid filepath")]];
+    };
+#include "speckloaderbenchmarktask_codegen.cpp"
+} // namespace
+
+namespace openspace {
+
+documentation::Documentation SpeckLoaderBenchmarkTask::Documentation() {
+    return codegen::doc<Parameters>("space_speckloaderbenchmark");
+}
+
+SpeckLoaderBenchmarkTask::SpeckLoaderBenchmarkTask(const ghoul::Dictionary& dictionary) {
+    const Parameters p = codegen::bake<Parameters>(dictionary);
+
+    _file = absPath(p.file);
+    if (p.output.has_value()) {
+        _output = absPath(*p.output);
+    }
+    _fileType = codegen::map<FileType>(p.fileType.value_or(Parameters::Type::Data));
+    _nRepetitions = p.repetitions.value_or(5);
+    _nThreads = p.threads.value_or(
+        std::max(static_cast<int>(std::thread::hardware_concurrency()), 1)
+    );
+}
+
+std::string SpeckLoaderBenchmarkTask::description() {
+    return fmt::format("Measure the time it takes to load {}", _file);
+}
+
+void SpeckLoaderBenchmarkTask::perform(const Task::ProgressCallback& onProgress) {
+    onProgress(0.f);
+
+    if (!std::filesystem::is_regular_file(_file)) {
+        LERROR(fmt::format("Could not find file {}", _file));
+        return;
+    }
+    const double fileSizeInMB =
+        static_cast<double>(std::filesystem::file_size(_file)) / (1024.0 * 1024.0);
+
+    // Loads the file with the provided number of threads and returns the time in
+    // milliseconds and whether the result was the same as the single-threaded one. The
+    // result of the first load is kept as the reference
+    std::optional<speck::ColumnarDataset> referenceDataset;
+    std::optional<speck::Labelset> referenceLabelset;
+    std::optional<speck::ColorMap> referenceColorMap;
+    auto load = [&](int nThreads) -> std::pair<double, bool> {
+        using namespace speck;
+
+        const auto start = std::chrono::steady_clock::now();
+        bool isSame = true;
+        switch (_fileType) {
+            case FileType::Data:
+            {
+                ColumnarDataset d = data::loadColumnarFile(
+                    _file,
+                    SkipAllZeroLines::Yes,
+                    nThreads
+                );
+                if (referenceDataset.has_value()) {
+                    isSame = isEqual(d, *referenceDataset);
+                }
+                else {
+                    referenceDataset = std::move(d);
+                }
+                break;
+            }
+            case FileType::Label:
+            {
+                Labelset l = label::loadFile(_file, SkipAllZeroLines::Yes, nThreads);
+                if (referenceLabelset.has_value()) {
+                    isSame = isEqual(l, *referenceLabelset);
+                }
+                else {
+                    referenceLabelset = std::move(l);
+                }
+                break;
+            }
+            case FileType::Color:
+            {
+                ColorMap c = color::loadFile(_file);
+                if (referenceColorMap.has_value()) {
+                    isSame = c.entries == referenceColorMap->entries;
+                }
+                else {
+                    referenceColorMap = std::move(c);
+                }
+                break;
+            }
+        }
+        const std::chrono::duration<double, std::milli> d =
+            std::chrono::steady_clock::now() - start;
+        return { d.count(), isSame };
+    };
+
+    double singleThreadedTime = 0.0;
+    double multiThreadedTime = 0.0;
+    int nMismatches = 0;
+    for (int i = 0; i < _nRepetitions; ++i) {
+        const auto [singleTime, singleSame] = load(1);
+        const auto [multiTime, multiSame] = load(_nThreads);
+        singleThreadedTime += singleTime;
+        multiThreadedTime += multiTime;
+        nMismatches += (singleSame ? 0 : 1) + (multiSame ? 0 : 1);
+
+        onProgress(static_cast<float>(i + 1) / _nRepetitions);
+    }
+
+    size_t nEntries = 0;
+    if (referenceDataset.has_value()) {
+        nEntries = referenceDataset->size();
+    }
+    else if (referenceLabelset.has_value()) {
+        nEntries = referenceLabelset->entries.size();
+    }
+    else if (referenceColorMap.has_value()) {
+        nEntries = referenceColorMap->entries.size();
+    }
+
+    const double singleMean = singleThreadedTime / _nRepetitions;
+    const double multiMean = multiThreadedTime / _nRepetitions;
+    const double singleThroughput = fileSizeInMB / (singleMean / 1000.0);
+    const double multiThroughput = fileSizeInMB / (multiMean / 1000.0);
+
+    LINFO(fmt::format(
+        "Loaded {:.1f} MB with {} entries {} times", fileSizeInMB, nEntries, _nRepetitions
+    ));
+    LINFO(fmt::format(
+        "1 thread: {:.2f} ms ({:.1f} MB/s), {} threads: {:.2f} ms ({:.1f} MB/s)",
+        singleMean, singleThroughput, _nThreads, multiMean, multiThroughput
+    ));
+    if (nMismatches == 0) {
+        LINFO("All loads produced identical results");
+    }
+    else {
+        LERROR(fmt::format("{} loads differed from the first load", nMismatches));
+    }
+
+    if (_output.has_value()) {
+        ghoul::Dictionary result;
+        result.setValue("FileSizeInMB", fileSizeInMB);
+        result.setValue("Entries", static_cast<int>(nEntries));
+        result.setValue("Repetitions", _nRepetitions);
+        result.setValue("Threads", _nThreads);
+        result.setValue("SingleThreadedMean", singleMean);
+        result.setValue("SingleThreadedThroughput", singleThroughput);
+        result.setValue("MultiThreadedMean", multiMean);
+        result.setValue("MultiThreadedThroughput", multiThroughput);
+        result.setValue("Mismatches", nMismatches);
+
+        std::ofstream output(*_output);
+        output << ghoul::formatJson(result);
+    }
+
+    onProgress(1.f);
+}
+
+} // namespace openspace
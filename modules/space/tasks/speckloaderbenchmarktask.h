@@ -0,0 +1,68 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2023                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_MODULE_SPACE___SPECKLOADERBENCHMARKTASK___H__
+#define __OPENSPACE_MODULE_SPACE___SPECKLOADERBENCHMARKTASK___H__
+
+#include <openspace/util/task.h>
+
+#include <filesystem>
+#include <optional>
+
+namespace openspace {
+
+namespace documentation { struct Documentation; }
+
+/**
+ * Repeatedly parses a speck, label, or colormap file without using the cache and
+ * reports the time per load and the throughput in MB/s. Every file is loaded both on a
+ * single thread and with the requested number of threads, and the two results are
+ * checked to be identical.
+ */
+class SpeckLoaderBenchmarkTask : public Task {
+public:
+    enum class FileType {
+        Data = 0,
+        Label,
+        Color
+    };
+
+    SpeckLoaderBenchmarkTask(const ghoul::Dictionary& dictionary);
+    ~SpeckLoaderBenchmarkTask() override = default;
+
+    std::string description() override;
+    void perform(const Task::ProgressCallback& onProgress) override;
+    static documentation::Documentation Documentation();
+
+private:
+    std::filesystem::path _file;
+    std::optional<std::filesystem::path> _output;
+    FileType _fileType;
+    int _nRepetitions;
+    int _nThreads;
+};
+
+} // namespace openspace
+
+#endif // __OPENSPACE_MODULE_SPACE___SPECKLOADERBENCHMARKTASK___H__
@@ -103,4 +103,8 @@ bool ThreadPool::hasOutstandingTasks() const {
     return !tasks.empty();
 }
 
+size_t ThreadPool::numThreads() const {
+    return workers.size();
+}
+
 } // namespace openspace
@@ -0,0 +1,234 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2023                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include <modules/globebrowsing/src/chunk.h>
+#include <modules/globebrowsing/src/ellipsoid.h>
+#include <openspace/util/threadpool.h>
+#include <ghoul/glm.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace openspace::globebrowsing;
+
+namespace {
+    constexpr double EarthRadius = 6378137.0;
+
+    ChunkView chunkView(const Ellipsoid& ellipsoid, const glm::dvec3& cameraPosition,
+                        const glm::dvec3& target)
+    {
+        const glm::dmat4 view = glm::lookAt(
+            cameraPosition,
+            target,
+            glm::dvec3(0.0, 0.0, 1.0)
+        );
+        const glm::dmat4 projection = glm::perspective(
+            glm::radians(60.0),
+            16.0 / 9.0,
+            1.0,
+            1e10
+        );
+
+        ChunkView res;
+        res.modelViewProjection = projection * view;
+        res.cameraPosition = cameraPosition;
+        res.cameraGeodetic = ellipsoid.cartesianToGeodetic2(cameraPosition);
+        // The chunks in these tests are not created with their corners
+        res.updateCorners = true;
+        return res;
+    }
+
+    // A chunk tree without any height information, which is driven the same way as the
+    // chunk tree of a RenderableGlobe
+    struct ChunkTree {
+        ~ChunkTree() {
+            merge(left);
+            merge(right);
+        }
+
+        static void merge(Chunk& chunk) {
+            for (Chunk*& child : chunk.children) {
+                if (child) {
+                    merge(*child);
+                    delete child;
+                    child = nullptr;
+                }
+            }
+        }
+
+        static void collect(Chunk& chunk, std::vector<ChunkEvaluation>& chunks) {
+            chunks.push_back({ &chunk, BoundingHeights{ 0.f, 0.f, true, true } });
+            if (chunk.children[0]) {
+                for (Chunk* child : chunk.children) {
+                    collect(*child, chunks);
+                }
+            }
+        }
+
+        static bool update(Chunk& chunk) {
+            if (!chunk.children[0]) {
+                if (chunk.status == Chunk::Status::WantSplit) {
+                    for (size_t i = 0; i < chunk.children.size(); ++i) {
+                        chunk.children[i] = new Chunk(
+                            chunk.tileIndex.child(static_cast<Quad>(i))
+                        );
+                    }
+                }
+                return chunk.status == Chunk::Status::WantMerge;
+            }
+
+            bool allChildrenWantMerge = true;
+            for (Chunk* child : chunk.children) {
+                allChildrenWantMerge &= update(*child);
+            }
+            if (allChildrenWantMerge && chunk.status != Chunk::Status::WantSplit) {
+                merge(chunk);
+            }
+            return false;
+        }
+
+        size_t step(const Ellipsoid& ellipsoid, const ChunkView& view,
+                    openspace::ThreadPool* pool)
+        {
+            chunks.clear();
+            collect(left, chunks);
+            collect(right, chunks);
+            evaluateChunks(chunks, ellipsoid, view, pool);
+            update(left);
+            update(right);
+            return chunks.size();
+        }
+
+        Chunk left = Chunk(TileIndex(0, 0, 1));
+        Chunk right = Chunk(TileIndex(1, 0, 1));
+        std::vector<ChunkEvaluation> chunks;
+    };
+
+    // A recorded flight that starts at ten Earth radii and descends to an altitude of a
+    // few kilometers while moving along the equator
+    std::vector<std::pair<glm::dvec3, glm::dvec3>> recordedCameraPath() {
+        constexpr int NPoses = 240;
+
+        std::vector<std::pair<glm::dvec3, glm::dvec3>> res;
+        res.reserve(NPoses);
+        for (int i = 0; i < NPoses; ++i) {
+            const double t = static_cast<double>(i) / (NPoses - 1);
+            const double altitude = EarthRadius * std::pow(10.0, 1.0 - 4.0 * t);
+            const double lon = t * glm::pi<double>();
+            const double lat = 0.3 * std::sin(glm::two_pi<double>() * t);
+            const glm::dvec3 direction = glm::dvec3(
+                std::cos(lat) * std::cos(lon),
+                std::cos(lat) * std::sin(lon),
+                std::sin(lat)
+            );
+            res.emplace_back((EarthRadius + altitude) * direction, glm::dvec3(0.0));
+        }
+        return res;
+    }
+} // namespace
+
+TEST_CASE("Chunk: Culling", "[chunk]") {
+    const Ellipsoid ellipsoid = Ellipsoid(glm::dvec3(EarthRadius));
+    const glm::dvec3 camera = glm::dvec3(3.0 * EarthRadius, 0.0, 0.0);
+
+    // Longitude 0 to 90 degrees on the northern hemisphere, facing the camera
+    Chunk front = Chunk(TileIndex(2, 0, 2));
+    // Longitude -180 to -90 degrees on the northern hemisphere, behind the globe
+    Chunk back = Chunk(TileIndex(0, 0, 2));
+
+    const BoundingHeights heights = { 0.f, 0.f, true, true };
+    front.corners = boundingCornersForChunk(front, ellipsoid, heights);
+    back.corners = boundingCornersForChunk(back, ellipsoid, heights);
+
+    const ChunkView towards = chunkView(ellipsoid, camera, glm::dvec3(0.0));
+    CHECK_FALSE(isCullableByFrustum(front, towards.modelViewProjection));
+    CHECK_FALSE(isCullableByHorizon(front, ellipsoid, towards, heights));
+    CHECK(isCullableByHorizon(back, ellipsoid, towards, heights));
+
+    const ChunkView away = chunkView(ellipsoid, camera, 2.0 * camera);
+    CHECK(isCullableByFrustum(front, away.modelViewProjection));
+}
+
+TEST_CASE("Chunk: Parallel Evaluation", "[chunk]") {
+    const Ellipsoid ellipsoid = Ellipsoid(glm::dvec3(EarthRadius));
+    const glm::dvec3 camera = glm::dvec3(EarthRadius + 100000.0, 0.0, 0.0);
+    const ChunkView view = chunkView(ellipsoid, camera, glm::dvec3(0.0));
+
+    // Let the tree refine itself for the camera position
+    ChunkTree tree;
+    for (int i = 0; i < 20; ++i) {
+        tree.step(ellipsoid, view, nullptr);
+    }
+
+    std::vector<ChunkEvaluation> chunks;
+    ChunkTree::collect(tree.left, chunks);
+    ChunkTree::collect(tree.right, chunks);
+    // Make sure that there are enough chunks for them to be evaluated in parallel
+    REQUIRE(chunks.size() > 1000);
+
+    evaluateChunks(chunks, ellipsoid, view, nullptr);
+    std::vector<std::pair<bool, Chunk::Status>> serial;
+    for (const ChunkEvaluation& c : chunks) {
+        serial.emplace_back(c.chunk->isVisible, c.chunk->status);
+        c.chunk->isVisible = !c.chunk->isVisible;
+        c.chunk->status = Chunk::Status::DoNothing;
+    }
+
+    openspace::ThreadPool pool(4);
+    evaluateChunks(chunks, ellipsoid, view, &pool);
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        CHECK(chunks[i].chunk->isVisible == serial[i].first);
+        CHECK(chunks[i].chunk->status == serial[i].second);
+    }
+}
+
+TEST_CASE("Chunk: Benchmark Recorded Camera Path", "[chunk][.benchmark]") {
+    const Ellipsoid ellipsoid = Ellipsoid(glm::dvec3(EarthRadius));
+    const std::vector<std::pair<glm::dvec3, glm::dvec3>> path = recordedCameraPath();
+
+    auto playback = [&ellipsoid, &path](openspace::ThreadPool* pool) {
+        ChunkTree tree;
+        size_t nEvaluatedChunks = 0;
+        for (const std::pair<glm::dvec3, glm::dvec3>& pose : path) {
+            const ChunkView view = chunkView(ellipsoid, pose.first, pose.second);
+            nEvaluatedChunks += tree.step(ellipsoid, view, pool);
+        }
+        return nEvaluatedChunks;
+    };
+
+    BENCHMARK("Serial") {
+        return playback(nullptr);
+    };
+
+    openspace::ThreadPool pool(std::max(std::thread::hardware_concurrency(), 2u) - 1);
+    BENCHMARK("Parallel") {
+        return playback(&pool);
+    };
+}
@@ -0,0 +1,133 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2023                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <modules/globebrowsing/src/costawarecache.h>
+#include <modules/globebrowsing/src/memoryawaretilecache.h>
+#include <modules/globebrowsing/src/rawtile.h>
+#include <chrono>
+#include <string>
+
+namespace {
+    struct DefaultHasher {
+        unsigned long long operator()(int var) const {
+            return static_cast<unsigned long long>(var);
+        }
+    };
+
+    using Cache = openspace::globebrowsing::cache::CostAwareCache<
+        int, std::string, DefaultHasher
+    >;
+} // namespace
+
+TEST_CASE("CostAwareCache: Get", "[costawarecache]") {
+    Cache cache;
+    cache.put(1, "hej", 10);
+    cache.put(12, "san", 10);
+    REQUIRE(cache.get(1));
+    CHECK(*cache.get(1) == "hej");
+    CHECK(cache.get(123) == nullptr);
+    CHECK(cache.size() == 2);
+    CHECK(cache.totalSize() == 20);
+}
+
+TEST_CASE("CostAwareCache: Replace", "[costawarecache]") {
+    Cache cache;
+    cache.put(1, "hej", 10);
+    cache.put(1, "san", 25);
+    REQUIRE(cache.get(1));
+    CHECK(*cache.get(1) == "san");
+    CHECK(cache.size() == 1);
+    CHECK(cache.totalSize() == 25);
+}
+
+TEST_CASE("CostAwareCache: LeastRecentlyUsed", "[costawarecache]") {
+    Cache cache;
+    cache.put(1, "a", 10);
+    cache.put(2, "b", 10);
+    cache.put(3, "c", 10);
+
+    // Touching the oldest item makes the second one the victim
+    cache.get(1);
+    CHECK(cache.popVictim().first == 2);
+    CHECK(cache.popVictim().first == 3);
+    CHECK(cache.popVictim().first == 1);
+    CHECK(cache.isEmpty());
+    CHECK(cache.totalSize() == 0);
+}
+
+TEST_CASE("CostAwareCache: GreedyDualSize", "[costawarecache]") {
+    using Policy = Cache::Policy;
+    Cache cache(Policy::GreedyDualSize);
+
+    // With equal costs, the largest item is evicted first even if it is the most
+    // recently used one
+    cache.put(1, "small", 10);
+    cache.put(2, "large", 1000);
+    cache.put(3, "medium", 100);
+    cache.get(2);
+    CHECK(cache.popVictim().first == 2);
+
+    // An expensive item outlives a cheap one of the same size
+    cache.put(4, "expensive", 10, 100.0);
+    CHECK(cache.popVictim().first == 3);
+    CHECK(cache.popVictim().first == 1);
+    CHECK(cache.popVictim().first == 4);
+}
+
+TEST_CASE("CostAwareCache: Tile costs", "[costawarecache]") {
+    using namespace openspace::globebrowsing;
+    using namespace std::chrono_literals;
+
+    // A tile that was read from a slow dataset and one that was read from the disk cache
+    RawTile slow;
+    slow.readTime = 40ms;
+    slow.decodeTime = 5ms;
+    RawTile fast;
+    fast.readTime = 200us;
+    const double slowCost = cache::tileCost(slow);
+    const double fastCost = cache::tileCost(fast);
+    CHECK(slowCost == 45.0);
+    CHECK(fastCost == 0.2);
+    CHECK(cache::tileCost(RawTile()) > 0.0);
+
+    // The costly tile outlives the cheap tile of the same size, even though the cheap
+    // tile was added later
+    Cache cache(Cache::Policy::GreedyDualSize);
+    cache.put(1, "slow", 1024, slowCost);
+    cache.put(2, "fast", 1024, fastCost);
+    CHECK(cache.popVictim().first == 2);
+    CHECK(cache.popVictim().first == 1);
+}
+
+TEST_CASE("CostAwareCache: Clear", "[costawarecache]") {
+    Cache cache;
+    cache.put(1, "a", 10);
+    cache.put(2, "b", 10);
+    cache.clear();
+    CHECK(cache.isEmpty());
+    CHECK_FALSE(cache.exist(1));
+    CHECK(cache.totalSize() == 0);
+}
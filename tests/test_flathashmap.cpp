@@ -0,0 +1,170 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2023                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <modules/globebrowsing/src/flathashmap.h>
+#include <modules/globebrowsing/src/memoryawaretilecache.h>
+#include <algorithm>
+#include <set>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+    struct DefaultHasher {
+        unsigned long long operator()(int var) const {
+            return static_cast<unsigned long long>(var);
+        }
+    };
+
+    using Map = openspace::globebrowsing::cache::FlatHashMap<
+        int, std::string, DefaultHasher
+    >;
+
+    uint64_t providerKey(uint32_t x, uint32_t y, uint8_t level, uint16_t providerID) {
+        using namespace openspace::globebrowsing;
+        const cache::ProviderTileKey key = { TileIndex(x, y, level), providerID };
+        return cache::ProviderTileHasher()(key);
+    }
+} // namespace
+
+TEST_CASE("FlatHashMap: Insert and Find", "[flathashmap]") {
+    Map map;
+    CHECK(map.isEmpty());
+    CHECK(map.find(1) == nullptr);
+
+    CHECK(map.insertOrAssign(1, "hej"));
+    CHECK(map.insertOrAssign(12, "san"));
+    CHECK_FALSE(map.insertOrAssign(1, "hopp"));
+    REQUIRE(map.find(1));
+    CHECK(*map.find(1) == "hopp");
+    CHECK(map[12] == "san");
+    CHECK(map.size() == 2);
+
+    map[123] = "new";
+    CHECK(map.contains(123));
+    CHECK(map.size() == 3);
+
+    map.clear();
+    CHECK(map.isEmpty());
+    CHECK_FALSE(map.contains(1));
+}
+
+TEST_CASE("FlatHashMap: Erase", "[flathashmap]") {
+    // The identity hash places consecutive keys into consecutive slots, so erasing
+    // from the middle of a long probe sequence is exercised
+    Map map;
+    for (int i = 0; i < 1000; i++) {
+        map.insertOrAssign(i, std::to_string(i));
+    }
+    for (int i = 0; i < 1000; i += 3) {
+        CHECK(map.erase(i));
+    }
+    CHECK_FALSE(map.erase(0));
+    CHECK_FALSE(map.erase(5000));
+
+    for (int i = 0; i < 1000; i++) {
+        if (i % 3 == 0) {
+            CHECK_FALSE(map.contains(i));
+        }
+        else {
+            REQUIRE(map.find(i));
+            CHECK(*map.find(i) == std::to_string(i));
+        }
+    }
+    CHECK(map.size() == 666);
+}
+
+TEST_CASE("FlatHashMap: EraseIf", "[flathashmap]") {
+    Map map;
+    for (int i = 0; i < 500; i++) {
+        map.insertOrAssign(i, std::to_string(i));
+    }
+
+    std::vector<int> visited;
+    const size_t nErased = map.eraseIf(
+        [&visited](int key, const std::string&) {
+            visited.push_back(key);
+            return key % 2 == 0;
+        }
+    );
+    CHECK(nErased == 250);
+    CHECK(visited.size() == 500);
+    CHECK(map.size() == 250);
+
+    int nItems = 0;
+    map.forEach(
+        [&nItems](int key, std::string& value) {
+            CHECK(key % 2 == 1);
+            CHECK(value == std::to_string(key));
+            nItems++;
+        }
+    );
+    CHECK(nItems == 250);
+}
+
+TEST_CASE("FlatHashMap: ProviderTileKey Unique For All Tiles", "[flathashmap]") {
+    // Every tile up to level 8 of a few providers
+    std::unordered_set<uint64_t> keys;
+    size_t nTiles = 0;
+    for (uint16_t provider : { 0, 1, 2, 65535 }) {
+        for (uint8_t level = 0; level <= 8; level++) {
+            for (uint32_t y = 0; y < (1u << level); y++) {
+                for (uint32_t x = 0; x < (2u << level); x++) {
+                    keys.insert(providerKey(x, y, level, provider));
+                    nTiles++;
+                }
+            }
+        }
+    }
+    CHECK(keys.size() == nTiles);
+}
+
+TEST_CASE("FlatHashMap: ProviderTileKey Unique Up To Level 22", "[flathashmap]") {
+    // The edges of every level and the tiles next to the bit boundaries of x and y
+    std::unordered_set<uint64_t> keys;
+    size_t nTiles = 0;
+    for (uint16_t provider : { 0, 1, 2, 31, 32, 4095, 65535 }) {
+        for (uint8_t level = 0; level <= 22; level++) {
+            const uint32_t maxX = (2u << level) - 1;
+            const uint32_t maxY = (1u << level) - 1;
+            std::set<uint32_t> xs = { 0, maxX, maxX / 2, maxX / 2 + 1 };
+            std::set<uint32_t> ys = { 0, maxY, maxY / 2, std::min(maxY / 2 + 1, maxY) };
+            for (uint32_t y : ys) {
+                for (uint32_t x : xs) {
+                    keys.insert(providerKey(x, y, level, provider));
+                    nTiles++;
+                }
+            }
+        }
+    }
+    CHECK(keys.size() == nTiles);
+
+    // These keys collided with the previous encoding, which added the provider ID
+    // shifted by 25 bits on top of the x value
+    CHECK(providerKey(0, 0, 22, 1) != providerKey(1 << 20, 0, 22, 0));
+    CHECK(providerKey(0, 5, 22, 2) != providerKey(1 << 21, 5, 22, 0));
+}
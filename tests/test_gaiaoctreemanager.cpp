@@ -0,0 +1,342 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2023                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifdef OPENSPACE_MODULE_GAIA_ENABLED
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <modules/gaia/rendering/octreeculler.h>
+#include <modules/gaia/rendering/octreemanager.h>
+#include <modules/gaia/rendering/starslabpool.h>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace openspace;
+
+namespace {
+    constexpr size_t ValuesPerStar = 8;
+    constexpr int MaxDist = 2;
+    constexpr int MaxStarsPerNode = 20;
+
+    // Creates stars with the same layout as the render values of the Gaia files. Most of
+    // the stars are placed in a small cluster so that the subtrees of the cluster are
+    // large enough to be built on threads of their own by `insertBulk()`. Magnitudes are
+    // rounded so that many stars are equally bright
+    std::vector<float> createStars(size_t nStars, unsigned int seed) {
+        std::mt19937 random(seed);
+        std::uniform_real_distribution<float> everywhere(-1.9f, 1.9f);
+        std::normal_distribution<float> cluster(0.3f, 0.05f);
+        std::uniform_real_distribution<float> magnitude(-2.f, 20.f);
+        std::uniform_real_distribution<float> value(-1.f, 1.f);
+
+        std::vector<float> stars;
+        stars.reserve(nStars * ValuesPerStar);
+        for (size_t i = 0; i < nStars; ++i) {
+            const bool isInCluster = i % 5 != 0;
+            for (int j = 0; j < 3; ++j) {
+                stars.push_back(isInCluster ? cluster(random) : everywhere(random));
+            }
+            stars.push_back(std::round(magnitude(random) * 2.f) / 2.f);
+            for (size_t j = 4; j < ValuesPerStar; ++j) {
+                stars.push_back(value(random));
+            }
+        }
+        return stars;
+    }
+
+    void insertSerially(OctreeManager& octree, const std::vector<float>& stars) {
+        for (size_t i = 0; i < stars.size(); i += ValuesPerStar) {
+            octree.insert(std::vector<float>(
+                stars.begin() + i,
+                stars.begin() + i + ValuesPerStar
+            ));
+        }
+    }
+
+    std::filesystem::path testFolder() {
+        const std::filesystem::path path =
+            std::filesystem::temp_directory_path() / "openspace_test_octreemanager";
+        std::filesystem::create_directories(path);
+        return path;
+    }
+
+    void writeOctree(OctreeManager& octree, const std::filesystem::path& path,
+                     bool writeData)
+    {
+        std::ofstream file(path, std::ofstream::binary);
+        octree.writeToFile(file, writeData);
+    }
+
+    // Returns the entire Octree, including the data of all nodes, as it is written to
+    // the binary file
+    std::string serialize(OctreeManager& octree) {
+        const std::filesystem::path path = testFolder() / "serialized.bin";
+        writeOctree(octree, path, true);
+        std::string result;
+        {
+            std::ifstream file(path, std::ifstream::binary);
+            result = std::string(std::istreambuf_iterator<char>(file), {});
+        }
+        std::filesystem::remove(path);
+        return result;
+    }
+
+    // Returns the positions of all stars sorted by their coordinates
+    std::vector<std::array<float, 3>> sortedPositions(const std::vector<float>& values,
+                                                      size_t stride)
+    {
+        std::vector<std::array<float, 3>> result;
+        for (size_t i = 0; i + 2 < values.size(); i += stride) {
+            result.push_back({ values[i], values[i + 1], values[i + 2] });
+        }
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+    void checkEqual(OctreeManager& lhs, OctreeManager& rhs) {
+        CHECK(lhs.numLeafNodes() == rhs.numLeafNodes());
+        CHECK(lhs.numInnerNodes() == rhs.numInnerNodes());
+        CHECK(lhs.totalDepth() == rhs.totalDepth());
+        CHECK(serialize(lhs) == serialize(rhs));
+    }
+} // namespace
+
+TEST_CASE("OctreeManager: Bulk insert", "[octreemanager]") {
+    const std::vector<float> stars = createStars(200000, 1337);
+
+    OctreeManager serial;
+    serial.initOctree(0, MaxDist, MaxStarsPerNode);
+    insertSerially(serial, stars);
+    REQUIRE(serial.totalDepth() > 5);
+
+    for (size_t nThreads : { 1, 2, 7 }) {
+        OctreeManager bulk;
+        bulk.initOctree(0, MaxDist, MaxStarsPerNode);
+        bulk.insertBulk(stars, nThreads);
+        checkEqual(serial, bulk);
+    }
+
+    // The LOD caches are only sliced after all stars have been inserted
+    OctreeManager bulk;
+    bulk.initOctree(0, MaxDist, MaxStarsPerNode);
+    bulk.insertBulk(stars, 3);
+    serial.sliceLodData();
+    bulk.sliceLodData();
+    checkEqual(serial, bulk);
+}
+
+TEST_CASE("OctreeManager: Bulk insert into filled branches", "[octreemanager]") {
+    const std::vector<float> first = createStars(20000, 42);
+    const std::vector<float> second = createStars(100000, 43);
+
+    OctreeManager serial;
+    serial.initOctree(0, MaxDist, MaxStarsPerNode);
+    insertSerially(serial, first);
+    insertSerially(serial, second);
+
+    for (size_t nThreads : { 1, 4 }) {
+        // The stars of the cluster end up in a branch that already contains stars and
+        // have to be inserted one by one, while the other branches are built in bulk
+        OctreeManager bulk;
+        bulk.initOctree(0, MaxDist, MaxStarsPerNode);
+        insertSerially(bulk, std::vector<float>(
+            first.begin(),
+            first.begin() + 10 * ValuesPerStar
+        ));
+        bulk.insertBulk(
+            std::vector<float>(first.begin() + 10 * ValuesPerStar, first.end()),
+            nThreads
+        );
+        bulk.insertBulk(second, nThreads);
+        checkEqual(serial, bulk);
+    }
+}
+
+TEST_CASE("OctreeManager: File round trip", "[octreemanager]") {
+    const std::vector<float> stars = createStars(50000, 7);
+
+    OctreeManager octree;
+    octree.initOctree(0, MaxDist, MaxStarsPerNode);
+    octree.insertBulk(stars);
+    octree.sliceLodData();
+
+    const std::filesystem::path path = testFolder() / "roundtrip.bin";
+    writeOctree(octree, path, true);
+
+    OctreeManager read;
+    read.initOctree();
+    {
+        std::ifstream file(path, std::ifstream::binary);
+        const int nStars = read.readFromFile(file, true);
+        CHECK(nStars == static_cast<int>(stars.size() / ValuesPerStar));
+    }
+    std::filesystem::remove(path);
+
+    CHECK(read.maxDist() == octree.maxDist());
+    CHECK(read.maxStarsPerNode() == octree.maxStarsPerNode());
+    CHECK(read.numLeafNodes() == octree.numLeafNodes());
+    CHECK(read.numInnerNodes() == octree.numInnerNodes());
+    CHECK(serialize(read) == serialize(octree));
+    CHECK(read.getAllData(gaia::RenderMode::Motion) ==
+          octree.getAllData(gaia::RenderMode::Motion));
+}
+
+TEST_CASE("OctreeManager: All data after slicing", "[octreemanager]") {
+    const std::vector<float> stars = createStars(50000, 11);
+
+    OctreeManager octree;
+    octree.initOctree(0, MaxDist, MaxStarsPerNode);
+    octree.insertBulk(stars);
+    const std::vector<float> staticData = octree.getAllData(gaia::RenderMode::Static);
+    const std::vector<float> motionData = octree.getAllData(gaia::RenderMode::Motion);
+
+    // Slicing only changes the LOD caches of the inner nodes and moves the stars of the
+    // leaves into smaller slabs, so every star is still returned exactly once
+    octree.sliceLodData();
+    CHECK(octree.getAllData(gaia::RenderMode::Static) == staticData);
+    CHECK(octree.getAllData(gaia::RenderMode::Motion) == motionData);
+    CHECK(motionData.size() == stars.size());
+    CHECK(sortedPositions(staticData, 3) == sortedPositions(stars, ValuesPerStar));
+
+    // Slicing a single branch is the same as slicing all of them
+    OctreeManager branches;
+    branches.initOctree(0, MaxDist, MaxStarsPerNode);
+    branches.insertBulk(stars);
+    for (size_t i = 0; i < 8; ++i) {
+        branches.sliceLodData(i);
+    }
+    CHECK(serialize(branches) == serialize(octree));
+}
+
+TEST_CASE("OctreeManager: Stream nodes from files", "[octreemanager]") {
+    const std::vector<float> stars = createStars(50000, 13);
+
+    OctreeManager octree;
+    octree.initOctree(0, MaxDist, MaxStarsPerNode);
+    octree.insertBulk(stars);
+    octree.sliceLodData();
+    const std::vector<float> data = octree.getAllData(gaia::RenderMode::Motion);
+
+    const std::filesystem::path folder = testFolder() / "nodes";
+    std::filesystem::remove_all(folder);
+    std::filesystem::create_directories(folder);
+    writeOctree(octree, folder / "index.bin", false);
+
+    // Writing a branch unloads the data of its nodes. Their slabs are returned to the
+    // pool, which keeps the memory to reuse it for the next nodes
+    const size_t memory = octree.memoryInBytes();
+    for (size_t i = 0; i < 8; ++i) {
+        octree.writeToMultipleFiles((folder / "").string(), i);
+    }
+    CHECK(octree.getAllData(gaia::RenderMode::Motion).empty());
+    CHECK(octree.memoryInBytes() == memory);
+
+    OctreeManager streamed;
+    streamed.initOctree(1LL << 30);
+    {
+        std::ifstream file(folder / "index.bin", std::ifstream::binary);
+        streamed.readFromFile(file, false, (folder / "").string());
+    }
+    const long long nNodes = static_cast<long long>(streamed.totalNodes());
+    streamed.initBufferIndexStack(nNodes, false, true);
+
+    // All nodes are requested at once and installed by the following calls as soon as
+    // the files have been read
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<float> streamedData;
+    while (streamedData.size() < data.size() &&
+           std::chrono::steady_clock::now() - start < std::chrono::seconds(30))
+    {
+        streamed.fetchSurroundingNodes(glm::dvec3(0.0), glm::ivec2(0));
+        streamedData = streamed.getAllData(gaia::RenderMode::Motion);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    CHECK(streamedData == data);
+
+    std::filesystem::remove_all(folder);
+}
+
+TEST_CASE("StarSlabPool: Reuse released slabs", "[octreemanager]") {
+    StarSlabPool pool;
+    pool.configure(MaxStarsPerNode, 3, 2, 3);
+
+    // Allocate a slab of every size, as nodes with any number of stars are loaded
+    std::vector<StarSlabPool::Slab> slabs;
+    for (size_t i = 0; i < 200; ++i) {
+        const size_t nStars = i % MaxStarsPerNode + 1;
+        StarSlabPool::Slab slab = pool.allocate(nStars);
+        REQUIRE(pool.capacity(slab) >= nStars);
+        std::fill_n(pool.positions(slab), nStars * 3, static_cast<float>(i));
+        std::fill_n(pool.colors(slab), nStars * 2, static_cast<float>(i));
+        std::fill_n(pool.velocities(slab), nStars * 3, static_cast<float>(i));
+        slabs.push_back(slab);
+    }
+    const size_t bytesInUse = pool.bytesInUse();
+    const size_t bytesReserved = pool.bytesReserved();
+    CHECK(bytesReserved >= bytesInUse);
+
+    // Unloading every other node releases its slab
+    for (size_t i = 0; i < slabs.size(); i += 2) {
+        pool.release(slabs[i]);
+        CHECK_FALSE(slabs[i].isValid());
+    }
+    CHECK(pool.bytesInUse() < bytesInUse);
+    CHECK(pool.bytesReserved() == bytesReserved);
+
+    // Loading the same nodes again reuses the released slabs without allocating memory
+    // and without touching the data of the slabs that are still in use
+    for (size_t i = 0; i < slabs.size(); i += 2) {
+        slabs[i] = pool.allocate(i % MaxStarsPerNode + 1);
+        std::fill_n(pool.positions(slabs[i]), 3, -1.f);
+    }
+    CHECK(pool.bytesInUse() == bytesInUse);
+    CHECK(pool.bytesReserved() == bytesReserved);
+    for (size_t i = 1; i < slabs.size(); i += 2) {
+        const size_t nStars = i % MaxStarsPerNode + 1;
+        const float value = static_cast<float>(i);
+        const float* positions = pool.positions(slabs[i]);
+        const float* colors = pool.colors(slabs[i]);
+        const float* velocities = pool.velocities(slabs[i]);
+        CHECK(std::all_of(positions, positions + nStars * 3, [value](float v) {
+            return v == value;
+        }));
+        CHECK(std::all_of(colors, colors + nStars * 2, [value](float v) {
+            return v == value;
+        }));
+        CHECK(std::all_of(velocities, velocities + nStars * 3, [value](float v) {
+            return v == value;
+        }));
+    }
+}
+
+#endif // OPENSPACE_MODULE_GAIA_ENABLED
@@ -0,0 +1,271 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2023                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifdef OPENSPACE_MODULE_GAIA_ENABLED
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <modules/gaia/rendering/starquantization.h>
+#include <cmath>
+#include <random>
+#include <sstream>
+#include <vector>
+
+using namespace openspace::gaia;
+
+namespace {
+    constexpr size_t ColorSize = 2;
+    constexpr size_t VelocitySize = 3;
+
+    struct Stars {
+        std::vector<float> positions;
+        std::vector<float> colors;
+        std::vector<float> velocities;
+    };
+
+    Stars createStars(size_t nStars, float originX, float originY, float originZ,
+                      float halfDimension, float velocityRange)
+    {
+        std::mt19937 random(1337);
+        std::uniform_real_distribution<float> offset(-halfDimension, halfDimension);
+        std::uniform_real_distribution<float> magnitude(-2.f, 20.f);
+        std::uniform_real_distribution<float> color(-1.f, 5.f);
+        std::uniform_real_distribution<float> velocity(-velocityRange, velocityRange);
+
+        Stars stars;
+        for (size_t i = 0; i < nStars; ++i) {
+            stars.positions.push_back(originX + offset(random));
+            stars.positions.push_back(originY + offset(random));
+            stars.positions.push_back(originZ + offset(random));
+            stars.colors.push_back(magnitude(random));
+            stars.colors.push_back(color(random));
+            stars.velocities.push_back(velocity(random));
+            stars.velocities.push_back(velocity(random));
+            stars.velocities.push_back(velocity(random));
+        }
+        return stars;
+    }
+
+    QuantizedStars quantize(const Stars& stars, float originX, float originY,
+                            float originZ, float halfDimension)
+    {
+        return quantizeStars(
+            stars.positions.data(),
+            stars.colors.data(),
+            stars.velocities.data(),
+            stars.colors.size() / ColorSize,
+            ColorSize,
+            VelocitySize,
+            originX,
+            originY,
+            originZ,
+            halfDimension
+        );
+    }
+
+    Stars dequantize(const QuantizedStars& quantized) {
+        Stars stars;
+        stars.positions.resize(quantized.nStars * 3);
+        stars.colors.resize(quantized.nStars * ColorSize);
+        stars.velocities.resize(quantized.nStars * VelocitySize);
+        dequantizeStars(
+            quantized,
+            stars.positions.data(),
+            stars.colors.data(),
+            stars.velocities.data()
+        );
+        return stars;
+    }
+
+    // The documented error bound for positions, plus the rounding of the decoded float
+    float positionBound(const QuantizedStars& stars, float value) {
+        return stars.scale / 65534.f + 2.f * std::abs(value) * 1.2e-7f;
+    }
+
+    // The documented error bound for half floats with an exponent
+    float halfBound(float value, int exponent) {
+        return std::max(std::abs(value) / 2048.f, std::ldexp(1.f, exponent - 25));
+    }
+} // namespace
+
+TEST_CASE("StarQuantization: Round trip", "[starquantization]") {
+    const float origin[3] = { 125.f, -62.5f, 31.25f };
+    constexpr float HalfDimension = 15.625f;
+    const Stars stars =
+        createStars(1000, origin[0], origin[1], origin[2], HalfDimension, 100.f);
+
+    const QuantizedStars quantized =
+        quantize(stars, origin[0], origin[1], origin[2], HalfDimension);
+    CHECK(quantized.nStars == 1000);
+    CHECK(quantized.scale == HalfDimension);
+    CHECK(quantized.colorExponent == 0);
+    CHECK(quantized.velocityExponent == 0);
+
+    const Stars result = dequantize(quantized);
+    for (size_t i = 0; i < stars.positions.size(); ++i) {
+        const float value = stars.positions[i];
+        CHECK(std::abs(result.positions[i] - value) <= positionBound(quantized, value));
+    }
+    for (size_t i = 0; i < stars.colors.size(); ++i) {
+        const float value = stars.colors[i];
+        CHECK(std::abs(result.colors[i] - value) <= halfBound(value, 0));
+    }
+    for (size_t i = 0; i < stars.velocities.size(); ++i) {
+        const float value = stars.velocities[i];
+        CHECK(std::abs(result.velocities[i] - value) <= halfBound(value, 0));
+    }
+}
+
+TEST_CASE("StarQuantization: Stars outside of node", "[starquantization]") {
+    Stars stars = createStars(10, 0.f, 0.f, 0.f, 1.f, 1.f);
+    // Stars beyond the radius of the octree end up in its outermost nodes
+    stars.positions[4] = -40.f;
+
+    const QuantizedStars quantized = quantize(stars, 0.f, 0.f, 0.f, 1.f);
+    CHECK(quantized.scale == 40.f);
+
+    const Stars result = dequantize(quantized);
+    for (size_t i = 0; i < stars.positions.size(); ++i) {
+        const float value = stars.positions[i];
+        CHECK(std::abs(result.positions[i] - value) <= positionBound(quantized, value));
+    }
+    CHECK(result.positions[4] == -40.f);
+}
+
+TEST_CASE("StarQuantization: Large velocities", "[starquantization]") {
+    // Velocities are stored in m/s, and bad parallaxes lead to huge values
+    const Stars stars = createStars(100, 0.f, 0.f, 0.f, 1.f, 3.e8f);
+
+    const QuantizedStars quantized = quantize(stars, 0.f, 0.f, 0.f, 1.f);
+    CHECK(quantized.velocityExponent > 0);
+
+    const Stars result = dequantize(quantized);
+    for (size_t i = 0; i < stars.velocities.size(); ++i) {
+        const float value = stars.velocities[i];
+        CHECK(std::isfinite(result.velocities[i]));
+        CHECK(
+            std::abs(result.velocities[i] - value) <=
+            halfBound(value, quantized.velocityExponent)
+        );
+    }
+}
+
+TEST_CASE("StarQuantization: Empty node", "[starquantization]") {
+    const QuantizedStars quantized = quantize(Stars(), 0.f, 0.f, 0.f, 1.f);
+    CHECK(quantized.nStars == 0);
+
+    std::stringstream stream;
+    writeQuantizedStars(stream, quantized);
+
+    std::vector<float> positions;
+    std::vector<float> colors;
+    std::vector<float> velocities;
+    const bool success =
+        readStarData(stream, 3, ColorSize, VelocitySize, positions, colors, velocities);
+    CHECK(success);
+    CHECK(positions.empty());
+    CHECK(colors.empty());
+    CHECK(velocities.empty());
+}
+
+TEST_CASE("StarQuantization: Read files", "[starquantization]") {
+    const Stars stars = createStars(500, 1.f, 2.f, 3.f, 4.f, 50.f);
+    const QuantizedStars quantized = quantize(stars, 1.f, 2.f, 3.f, 4.f);
+
+    // Float data as it is written by the OctreeManager
+    std::stringstream floatStream;
+    const int32_t nValues = static_cast<int32_t>(500 * (3 + ColorSize + VelocitySize));
+    floatStream.write(reinterpret_cast<const char*>(&nValues), sizeof(int32_t));
+    for (const std::vector<float>* values :
+         { &stars.positions, &stars.colors, &stars.velocities })
+    {
+        floatStream.write(
+            reinterpret_cast<const char*>(values->data()),
+            values->size() * sizeof(float)
+        );
+    }
+
+    std::stringstream quantizedStream;
+    writeQuantizedStars(quantizedStream, quantized);
+    // The header of the quantized stars is 28 bytes
+    CHECK(quantizedStream.str().size() == 28 + 500 * 16);
+    CHECK(floatStream.str().size() == 4 + 500 * 32);
+
+    std::vector<float> positions;
+    std::vector<float> colors;
+    std::vector<float> velocities;
+    REQUIRE(
+        readStarData(
+            floatStream,
+            3,
+            ColorSize,
+            VelocitySize,
+            positions,
+            colors,
+            velocities
+        )
+    );
+    CHECK(positions == stars.positions);
+    CHECK(colors == stars.colors);
+    CHECK(velocities == stars.velocities);
+
+    REQUIRE(
+        readStarData(
+            quantizedStream,
+            3,
+            ColorSize,
+            VelocitySize,
+            positions,
+            colors,
+            velocities
+        )
+    );
+    const Stars decoded = dequantize(quantized);
+    CHECK(positions == decoded.positions);
+    CHECK(colors == decoded.colors);
+    CHECK(velocities == decoded.velocities);
+
+    // Quantized data with a different layout is rejected
+    std::stringstream otherStream;
+    writeQuantizedStars(otherStream, quantized);
+    CHECK_FALSE(readStarData(otherStream, 3, 1, 4, positions, colors, velocities));
+
+    // Truncated data is rejected
+    std::string truncated = quantizedStream.str();
+    truncated.resize(truncated.size() / 2);
+    std::stringstream truncatedStream(truncated);
+    CHECK_FALSE(
+        readStarData(
+            truncatedStream,
+            3,
+            ColorSize,
+            VelocitySize,
+            positions,
+            colors,
+            velocities
+        )
+    );
+}
+
+#endif // OPENSPACE_MODULE_GAIA_ENABLED
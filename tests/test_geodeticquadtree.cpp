@@ -0,0 +1,274 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2023                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include <modules/globebrowsing/src/ellipsoid.h>
+#include <modules/globebrowsing/src/geodeticquadtree.h>
+#include <ghoul/glm.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <utility>
+#include <vector>
+
+using namespace openspace::globebrowsing;
+
+namespace {
+    constexpr double EarthRadius = 6378137.0;
+
+    struct Points {
+        std::vector<Geodetic2> coordinates;
+        std::vector<glm::dvec3> positions;
+    };
+
+    Points randomSurfacePoints(const Ellipsoid& ellipsoid, size_t nPoints) {
+        std::mt19937 generator(1337);
+        std::uniform_real_distribution<double> sinLatitude(-1.0, 1.0);
+        std::uniform_real_distribution<double> longitude(
+            -glm::pi<double>(),
+            glm::pi<double>()
+        );
+
+        Points res;
+        res.coordinates.reserve(nPoints);
+        res.positions.reserve(nPoints);
+        for (size_t i = 0; i < nPoints; ++i) {
+            const Geodetic2 c = {
+                std::asin(sinLatitude(generator)),
+                longitude(generator)
+            };
+            res.coordinates.push_back(c);
+            res.positions.push_back(ellipsoid.cartesianSurfacePosition(c));
+        }
+        return res;
+    }
+
+    // Approximates the label culling of the GlobeLabelsComponent: A point is visible if
+    // it is closer to the camera than the center of the globe and inside the field of
+    // view of the camera
+    struct View {
+        View(const glm::dvec3& cameraPosition, const glm::dvec3& target)
+            : position(cameraPosition)
+            , direction(glm::normalize(target - cameraPosition))
+            , maxDistance(glm::length(cameraPosition))
+        {}
+
+        bool isPointVisible(const glm::dvec3& p) const {
+            const glm::dvec3 v = p - position;
+            const double distance = glm::length(v);
+            return distance < maxDistance &&
+                   glm::dot(v, direction) > std::cos(HalfFov) * distance;
+        }
+
+        bool isSphereVisible(const glm::dvec3& center, double radius) const {
+            const glm::dvec3 v = center - position;
+            const double distance = glm::length(v);
+            if (distance - radius >= maxDistance) {
+                return false;
+            }
+            if (distance <= radius) {
+                return true;
+            }
+            const double angle = std::acos(
+                std::clamp(glm::dot(v, direction) / distance, -1.0, 1.0)
+            );
+            return angle - std::asin(radius / distance) < HalfFov;
+        }
+
+        static constexpr double HalfFov = glm::pi<double>() / 6.0;
+
+        glm::dvec3 position;
+        glm::dvec3 direction;
+        double maxDistance;
+    };
+
+    // A recorded flight that starts at ten Earth radii and descends to an altitude of a
+    // few kilometers while moving along the equator
+    std::vector<std::pair<glm::dvec3, glm::dvec3>> recordedCameraPath() {
+        constexpr int NPoses = 240;
+
+        std::vector<std::pair<glm::dvec3, glm::dvec3>> res;
+        res.reserve(NPoses);
+        for (int i = 0; i < NPoses; ++i) {
+            const double t = static_cast<double>(i) / (NPoses - 1);
+            const double altitude = EarthRadius * std::pow(10.0, 1.0 - 4.0 * t);
+            const double lon = t * glm::pi<double>();
+            const double lat = 0.3 * std::sin(glm::two_pi<double>() * t);
+            const glm::dvec3 direction = glm::dvec3(
+                std::cos(lat) * std::cos(lon),
+                std::cos(lat) * std::sin(lon),
+                std::sin(lat)
+            );
+            res.emplace_back((EarthRadius + altitude) * direction, glm::dvec3(0.0));
+        }
+        return res;
+    }
+} // namespace
+
+TEST_CASE("GeodeticQuadtree: Empty", "[geodeticquadtree]") {
+    GeodeticQuadtree tree;
+    tree.build({}, {});
+    CHECK(tree.numNodes() == 0);
+    CHECK(tree.numPoints() == 0);
+
+    size_t nVisited = 0;
+    tree.query(
+        [](const glm::dvec3&, double) { return true; },
+        [&nVisited](uint32_t) { nVisited++; }
+    );
+    CHECK(nVisited == 0);
+}
+
+TEST_CASE("GeodeticQuadtree: All Points", "[geodeticquadtree]") {
+    const Ellipsoid ellipsoid = Ellipsoid(glm::dvec3(EarthRadius));
+    const Points points = randomSurfacePoints(ellipsoid, 10000);
+
+    GeodeticQuadtree tree;
+    tree.build(points.coordinates, points.positions);
+    CHECK(tree.numPoints() == points.positions.size());
+    CHECK(tree.numNodes() > 1);
+
+    // Every point has to be visited exactly once
+    std::vector<int> nVisits(points.positions.size(), 0);
+    tree.query(
+        [](const glm::dvec3&, double) { return true; },
+        [&nVisits](uint32_t i) { nVisits[i]++; }
+    );
+    CHECK(std::all_of(nVisits.begin(), nVisits.end(), [](int n) { return n == 1; }));
+}
+
+TEST_CASE("GeodeticQuadtree: Bounding Spheres", "[geodeticquadtree]") {
+    const Ellipsoid ellipsoid = Ellipsoid(glm::dvec3(EarthRadius));
+    const Points points = randomSurfacePoints(ellipsoid, 10000);
+
+    GeodeticQuadtree tree;
+    tree.build(points.coordinates, points.positions);
+
+    // Points that are close to each other on the surface have to end up in the same
+    // small nodes, so only few points are reported for a small query sphere
+    const glm::dvec3 queryCenter = points.positions[0];
+    constexpr double QueryRadius = 0.05 * EarthRadius;
+
+    std::vector<uint32_t> expected;
+    for (uint32_t i = 0; i < points.positions.size(); ++i) {
+        if (glm::distance(points.positions[i], queryCenter) < QueryRadius) {
+            expected.push_back(i);
+        }
+    }
+
+    std::vector<uint32_t> visited;
+    tree.query(
+        [&](const glm::dvec3& center, double radius) {
+            return glm::distance(center, queryCenter) - radius < QueryRadius;
+        },
+        [&visited](uint32_t i) { visited.push_back(i); }
+    );
+    CHECK(visited.size() < points.positions.size() / 10);
+
+    std::vector<uint32_t> found;
+    for (uint32_t i : visited) {
+        if (glm::distance(points.positions[i], queryCenter) < QueryRadius) {
+            found.push_back(i);
+        }
+    }
+    std::sort(found.begin(), found.end());
+    CHECK(found == expected);
+}
+
+TEST_CASE("GeodeticQuadtree: Camera Path", "[geodeticquadtree]") {
+    const Ellipsoid ellipsoid = Ellipsoid(glm::dvec3(EarthRadius));
+    const Points points = randomSurfacePoints(ellipsoid, 10000);
+
+    GeodeticQuadtree tree;
+    tree.build(points.coordinates, points.positions);
+
+    // The indexed query has to report the same points as testing every point
+    for (const std::pair<glm::dvec3, glm::dvec3>& pose : recordedCameraPath()) {
+        const View view = View(pose.first, pose.second);
+
+        std::vector<uint32_t> expected;
+        for (uint32_t i = 0; i < points.positions.size(); ++i) {
+            if (view.isPointVisible(points.positions[i])) {
+                expected.push_back(i);
+            }
+        }
+
+        std::vector<uint32_t> found;
+        tree.query(
+            [&view](const glm::dvec3& center, double radius) {
+                return view.isSphereVisible(center, radius);
+            },
+            [&](uint32_t i) {
+                if (view.isPointVisible(points.positions[i])) {
+                    found.push_back(i);
+                }
+            }
+        );
+        std::sort(found.begin(), found.end());
+        CHECK(found == expected);
+    }
+}
+
+TEST_CASE("GeodeticQuadtree: Benchmark Recorded Camera Path",
+          "[geodeticquadtree][.benchmark]")
+{
+    const Ellipsoid ellipsoid = Ellipsoid(glm::dvec3(EarthRadius));
+    const Points points = randomSurfacePoints(ellipsoid, 100000);
+    const std::vector<std::pair<glm::dvec3, glm::dvec3>> path = recordedCameraPath();
+
+    GeodeticQuadtree tree;
+    BENCHMARK("Build") {
+        tree.build(points.coordinates, points.positions);
+        return tree.numNodes();
+    };
+
+    BENCHMARK("Full Scan") {
+        size_t nVisible = 0;
+        for (const std::pair<glm::dvec3, glm::dvec3>& pose : path) {
+            const View view = View(pose.first, pose.second);
+            for (const glm::dvec3& p : points.positions) {
+                nVisible += view.isPointVisible(p) ? 1 : 0;
+            }
+        }
+        return nVisible;
+    };
+
+    BENCHMARK("Indexed") {
+        size_t nVisible = 0;
+        for (const std::pair<glm::dvec3, glm::dvec3>& pose : path) {
+            const View view = View(pose.first, pose.second);
+            tree.query(
+                [&view](const glm::dvec3& center, double radius) {
+                    return view.isSphereVisible(center, radius);
+                },
+                [&](uint32_t i) {
+                    nVisible += view.isPointVisible(points.positions[i]) ? 1 : 0;
+                }
+            );
+        }
+        return nVisible;
+    };
+}
@@ -0,0 +1,154 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2023                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <modules/globebrowsing/src/rawtiledatareader.h>
+#include <modules/globebrowsing/src/tileindex.h>
+#include <modules/globebrowsing/src/tiletextureinitdata.h>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <vector>
+#include <gdal.h>
+
+namespace {
+    constexpr int GridWidth = 512;
+    constexpr int GridHeight = 256;
+    constexpr int TileSize = 64;
+
+    // Writes a global ASCII grid with a non-repeating pattern that GDAL can read
+    std::filesystem::path createTestDataset() {
+        std::filesystem::path path =
+            std::filesystem::temp_directory_path() / "openspace_test_rawtile.asc";
+
+        std::ofstream file(path);
+        file << "ncols " << GridWidth << '\n';
+        file << "nrows " << GridHeight << '\n';
+        file << "xllcorner -180.0\n";
+        file << "yllcorner -90.0\n";
+        file << "cellsize " << 360.0 / GridWidth << '\n';
+        file << "NODATA_value -9999\n";
+        for (int y = 0; y < GridHeight; y++) {
+            for (int x = 0; x < GridWidth; x++) {
+                file << (x * 7 + y * 13) % 1021 << ' ';
+            }
+            file << '\n';
+        }
+        return path;
+    }
+
+    std::vector<openspace::globebrowsing::TileIndex> allTiles(int maxLevel) {
+        using namespace openspace::globebrowsing;
+
+        // The globe is covered by the two tiles (0,0,1) and (1,0,1), so level L has
+        // 2^L tiles in x and 2^(L-1) tiles in y
+        std::vector<TileIndex> tiles;
+        for (int level = 1; level <= maxLevel; level++) {
+            for (uint32_t y = 0; y < (1u << (level - 1)); y++) {
+                for (uint32_t x = 0; x < (1u << level); x++) {
+                    tiles.emplace_back(x, y, static_cast<uint8_t>(level));
+                }
+            }
+        }
+        return tiles;
+    }
+} // namespace
+
+TEST_CASE("RawTileDataReader: Concurrent Reads", "[rawtiledatareader]") {
+    using namespace openspace::globebrowsing;
+
+    // The GdalWrapper only registers the drivers when OpenGL is initialized, which never
+    // happens in the tests
+    GDALAllRegister();
+
+    const std::filesystem::path dataset = createTestDataset();
+    const TileTextureInitData initData = tileTextureInitData(
+        layers::Group::ID::HeightLayers,
+        TileSize
+    );
+
+    TileCacheProperties serialProperties;
+    serialProperties.nDatasetHandles = 1;
+    const RawTileDataReader serialReader(
+        dataset.string(),
+        initData,
+        serialProperties,
+        RawTileDataReader::PerformPreprocessing::Yes
+    );
+
+    TileCacheProperties concurrentProperties;
+    concurrentProperties.nDatasetHandles = 4;
+    const RawTileDataReader concurrentReader(
+        dataset.string(),
+        initData,
+        concurrentProperties,
+        RawTileDataReader::PerformPreprocessing::Yes
+    );
+    REQUIRE(concurrentReader.numDatasetHandles() == 4);
+    REQUIRE(concurrentReader.maxChunkLevel() == serialReader.maxChunkLevel());
+
+    const std::vector<TileIndex> tiles = allTiles(serialReader.maxChunkLevel());
+
+    std::vector<RawTile> serialTiles;
+    serialTiles.reserve(tiles.size());
+    for (const TileIndex& tile : tiles) {
+        serialTiles.push_back(serialReader.readTileData(tile));
+    }
+
+    // Use more threads than dataset handles to also exercise waiting for a handle
+    std::vector<RawTile> concurrentTiles(tiles.size());
+    std::atomic_size_t next = 0;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 8; i++) {
+        threads.emplace_back([&]() {
+            for (size_t j = next++; j < tiles.size(); j = next++) {
+                concurrentTiles[j] = concurrentReader.readTileData(tiles[j]);
+            }
+        });
+    }
+    for (std::thread& t : threads) {
+        t.join();
+    }
+
+    for (size_t i = 0; i < tiles.size(); i++) {
+        const RawTile& serial = serialTiles[i];
+        const RawTile& concurrent = concurrentTiles[i];
+        REQUIRE(concurrent.tileIndex == serial.tileIndex);
+        CHECK(concurrent.error == serial.error);
+        CHECK(
+            std::memcmp(
+                concurrent.imageData.get(),
+                serial.imageData.get(),
+                initData.totalNumBytes
+            ) == 0
+        );
+        CHECK(concurrent.tileMetaData.minValues == serial.tileMetaData.minValues);
+        CHECK(concurrent.tileMetaData.maxValues == serial.tileMetaData.maxValues);
+    }
+
+    std::filesystem::remove(dataset);
+}
@@ -0,0 +1,343 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2023                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifdef OPENSPACE_MODULE_SPACE_ENABLED
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <modules/space/speckloader.h>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+
+using namespace openspace::speck;
+
+namespace {
+    constexpr std::string_view SpeckFile = R"(# A comment that is ignored
+datavar 0 colorb_v
+datavar 1 lum
+texturevar 1
+texture -M 1 halo.sgi
+texture 0 point.sgi
+
+1.5 2.5 -3.5 0.25 10 # first
+-1 0 1 nan 20 # shared
+0 0 0 0 0 # all zero
+4 5 6 -0.5 30 # shared
+7 8 9 1e3 40
+)";
+
+    // Creates a speck file whose data section is large enough to be split into several
+    // chunks when it is loaded with multiple threads. Some of the values use a syntax
+    // that is not handled by the fast number parsing
+    std::string largeSpeckFile(int nLines) {
+        std::string res = "datavar 0 a\ndatavar 1 b\n\n";
+        for (int i = 0; i < nLines; i++) {
+            res += std::to_string(i) + ".25 -" + std::to_string(i % 97) + " 1e5 ";
+            res += (i % 13 == 0) ? "+3 " : "0.125 ";
+            res += (i % 17 == 0) ? "00012" : std::to_string(i * 0.5f);
+            if (i % 5 == 0) {
+                res += " # comment " + std::to_string(i % 7);
+            }
+            res += (i % 11 == 0) ? "\r\n" : "\n";
+            if (i % 101 == 0) {
+                res += "0 0 0 0 0\n# a commented out line\n\n";
+            }
+        }
+        return res;
+    }
+
+    std::filesystem::path writeFile(std::string_view name, std::string_view content) {
+        std::filesystem::path path = std::filesystem::temp_directory_path() / name;
+        std::ofstream file(path);
+        file << content;
+        return path;
+    }
+
+    void checkEqual(const Dataset& lhs, const Dataset& rhs) {
+        REQUIRE(lhs.variables.size() == rhs.variables.size());
+        for (size_t i = 0; i < lhs.variables.size(); i++) {
+            CHECK(lhs.variables[i].index == rhs.variables[i].index);
+            CHECK(lhs.variables[i].name == rhs.variables[i].name);
+        }
+        REQUIRE(lhs.textures.size() == rhs.textures.size());
+        for (size_t i = 0; i < lhs.textures.size(); i++) {
+            CHECK(lhs.textures[i].index == rhs.textures[i].index);
+            CHECK(lhs.textures[i].file == rhs.textures[i].file);
+        }
+        CHECK(lhs.textureDataIndex == rhs.textureDataIndex);
+        CHECK(lhs.orientationDataIndex == rhs.orientationDataIndex);
+
+        REQUIRE(lhs.entries.size() == rhs.entries.size());
+        for (size_t i = 0; i < lhs.entries.size(); i++) {
+            const Dataset::Entry& l = lhs.entries[i];
+            const Dataset::Entry& r = rhs.entries[i];
+            CHECK(l.position == r.position);
+            REQUIRE(l.data.size() == r.data.size());
+            for (size_t j = 0; j < l.data.size(); j++) {
+                CHECK(
+                    (l.data[j] == r.data[j] || (std::isnan(l.data[j]) &&
+                    std::isnan(r.data[j])))
+                );
+            }
+            CHECK(l.comment == r.comment);
+        }
+    }
+} // namespace
+
+TEST_CASE("SpeckLoader: Columnar Dataset", "[speckloader]") {
+    std::filesystem::path path = writeFile("test_speckloader_columnar.speck", SpeckFile);
+    ColumnarDataset dataset = data::loadColumnarFile(path);
+    std::filesystem::remove(path);
+
+    REQUIRE(dataset.size() == 4);
+    REQUIRE(dataset.columns.size() == 2);
+    CHECK(dataset.index("lum") == 1);
+    CHECK(dataset.textureDataIndex == 1);
+    REQUIRE(dataset.textures.size() == 2);
+    CHECK(dataset.textures[0].file == "point.sgi");
+
+    CHECK(dataset.position(0) == glm::vec3(1.5f, 2.5f, -3.5f));
+    CHECK(dataset.position(3) == glm::vec3(7.f, 8.f, 9.f));
+    CHECK(dataset.columns[0][0] == 0.25f);
+    CHECK(std::isnan(dataset.columns[0][1]));
+    CHECK(dataset.columns[0][2] == -0.5f);
+    CHECK(dataset.columns[0][3] == 1000.f);
+    CHECK(dataset.columns[1][3] == 40.f);
+
+    // The two identical comments are only stored once
+    CHECK(dataset.comments.size() == 2);
+    CHECK(dataset.comment(0) == "first");
+    CHECK(dataset.comment(1) == "shared");
+    CHECK(dataset.comment(2) == "shared");
+    CHECK(dataset.commentIndices[1] == dataset.commentIndices[2]);
+    CHECK_FALSE(dataset.comment(3).has_value());
+
+    CHECK(dataset.normalizeVariable("lum"));
+    CHECK(dataset.columns[1][0] == 0.f);
+    CHECK(dataset.columns[1][3] == 1.f);
+    CHECK_FALSE(dataset.normalizeVariable("nonexisting"));
+}
+
+TEST_CASE("SpeckLoader: Keep All Zero Lines", "[speckloader]") {
+    std::filesystem::path path = writeFile("test_speckloader_zero.speck", SpeckFile);
+    ColumnarDataset dataset = data::loadColumnarFile(path, SkipAllZeroLines::No);
+    std::filesystem::remove(path);
+
+    REQUIRE(dataset.size() == 5);
+    CHECK(dataset.position(2) == glm::vec3(0.f));
+    CHECK(dataset.comment(2) == "all zero");
+}
+
+TEST_CASE("SpeckLoader: Columnar Dataset Conversion", "[speckloader]") {
+    std::filesystem::path path = writeFile("test_speckloader_convert.speck", SpeckFile);
+    Dataset dataset = data::loadFile(path);
+    ColumnarDataset columnar = data::loadColumnarFile(path);
+    std::filesystem::remove(path);
+
+    checkEqual(dataset, columnar.toDataset());
+    checkEqual(dataset, ColumnarDataset::fromDataset(dataset).toDataset());
+}
+
+TEST_CASE("SpeckLoader: Columnar Dataset Cache", "[speckloader]") {
+    std::filesystem::path path = writeFile("test_speckloader_cache.speck", SpeckFile);
+    Dataset dataset = data::loadFile(path);
+    std::filesystem::remove(path);
+
+    // Both representations share the same cache format, so a cache file written by one
+    // can be read by the other
+    std::filesystem::path cache =
+        std::filesystem::temp_directory_path() / "test_speckloader_cache.cache";
+
+    data::saveCachedFile(dataset, cache);
+    std::optional<ColumnarDataset> columnar = data::loadCachedColumnarFile(cache);
+    REQUIRE(columnar.has_value());
+    checkEqual(dataset, columnar->toDataset());
+
+    data::saveCachedColumnarFile(*columnar, cache);
+    std::optional<Dataset> entries = data::loadCachedFile(cache);
+    REQUIRE(entries.has_value());
+    checkEqual(dataset, *entries);
+
+    std::filesystem::remove(cache);
+}
+
+TEST_CASE("SpeckLoader: Mapped Dataset Cache", "[speckloader]") {
+    std::filesystem::path path = writeFile("test_speckloader_mapped.speck", SpeckFile);
+    ColumnarDataset dataset = data::loadColumnarFile(path);
+    std::filesystem::remove(path);
+
+    std::filesystem::path cache =
+        std::filesystem::temp_directory_path() / "test_speckloader_mapped.cache";
+    data::saveMappedCachedFile(dataset, cache);
+
+    // The older cache format can't read the mapped cache file and vice versa
+    CHECK_FALSE(data::loadCachedColumnarFile(cache).has_value());
+    {
+        std::optional<MappedDataset> mapped = data::loadMappedCachedFile(cache);
+        REQUIRE(mapped.has_value());
+        REQUIRE(mapped->size() == dataset.size());
+        REQUIRE(mapped->columns.size() == dataset.columns.size());
+        CHECK(reinterpret_cast<uintptr_t>(mapped->positionX.data()) % 64 == 0);
+        CHECK(reinterpret_cast<uintptr_t>(mapped->columns[1].data()) % 64 == 0);
+        CHECK(mapped->position(3) == glm::vec3(7.f, 8.f, 9.f));
+        CHECK(mapped->columns[1][3] == 40.f);
+        CHECK(mapped->comment(1) == "shared");
+        CHECK_FALSE(mapped->comment(3).has_value());
+        CHECK(mapped->index("lum") == 1);
+        CHECK(mapped->textures.size() == 2);
+
+        checkEqual(dataset.toDataset(), mapped->toColumnarDataset().toDataset());
+
+        // Writing the cache file again does not change the dataset that is mapped
+        data::saveMappedCachedFile(dataset, cache);
+        CHECK(mapped->columns[1][3] == 40.f);
+        CHECK(mapped->comment(1) == "shared");
+        CHECK(data::loadMappedCachedFile(cache).has_value());
+    }
+    // No temporary files are left behind
+    const std::string prefix = cache.filename().string();
+    for (const auto& e : std::filesystem::directory_iterator(cache.parent_path())) {
+        const std::string name = e.path().filename().string();
+        CHECK_FALSE((name.starts_with(prefix) && name.ends_with(".tmp")));
+    }
+
+    // A comment index that is out of range means that the file is corrupted
+    ColumnarDataset corrupted = dataset;
+    corrupted.commentIndices[0] = static_cast<uint32_t>(corrupted.comments.size());
+    data::saveMappedCachedFile(corrupted, cache);
+    CHECK_FALSE(data::loadMappedCachedFile(cache).has_value());
+
+    // A number of entries whose size in bytes overflows means that the file is corrupted
+    data::saveMappedCachedFile(dataset, cache);
+    {
+        const uint64_t nEntries = dataset.size();
+        const uint16_t nValues = static_cast<uint16_t>(dataset.columns.size());
+        const uint32_t nComments = static_cast<uint32_t>(dataset.comments.size());
+        std::string counts;
+        counts.append(reinterpret_cast<const char*>(&nEntries), sizeof(uint64_t));
+        counts.append(reinterpret_cast<const char*>(&nValues), sizeof(uint16_t));
+        counts.append(reinterpret_cast<const char*>(&nComments), sizeof(uint32_t));
+
+        std::ifstream in(cache, std::ios::binary);
+        const std::string content = std::string(
+            std::istreambuf_iterator<char>(in),
+            std::istreambuf_iterator<char>()
+        );
+        in.close();
+        const size_t offset = content.find(counts);
+        REQUIRE(offset != std::string::npos);
+
+        const uint64_t overflowing = (uint64_t(1) << 62) + nEntries;
+        std::fstream out(cache, std::ios::binary | std::ios::in | std::ios::out);
+        out.seekp(offset);
+        out.write(reinterpret_cast<const char*>(&overflowing), sizeof(uint64_t));
+    }
+    CHECK_FALSE(data::loadMappedCachedFile(cache).has_value());
+
+    data::saveCachedColumnarFile(dataset, cache);
+    CHECK_FALSE(data::loadMappedCachedFile(cache).has_value());
+    std::filesystem::remove(cache);
+
+    // Without a cache file, the mapped dataset points into the parsed dataset
+    MappedDataset unmapped = MappedDataset::fromColumnarDataset(dataset);
+    REQUIRE(unmapped.size() == dataset.size());
+    checkEqual(dataset.toDataset(), unmapped.toColumnarDataset().toDataset());
+}
+
+TEST_CASE("SpeckLoader: Threaded Parsing", "[speckloader]") {
+    constexpr int NLines = 100000;
+    std::filesystem::path path = writeFile(
+        "test_speckloader_threaded.speck",
+        largeSpeckFile(NLines)
+    );
+    ColumnarDataset single = data::loadColumnarFile(path, SkipAllZeroLines::No, 1);
+    ColumnarDataset threaded = data::loadColumnarFile(path, SkipAllZeroLines::No, 4);
+    ColumnarDataset skipped = data::loadColumnarFile(path, SkipAllZeroLines::Yes, 4);
+    std::filesystem::remove(path);
+
+    REQUIRE(single.size() == NLines + NLines / 101 + 1);
+    CHECK(skipped.size() == NLines);
+    CHECK(single.columns[0][0] == 3.f);
+    CHECK(single.columns[1][0] == 12.f);
+    CHECK(single.comment(0) == "comment 0");
+    checkEqual(single.toDataset(), threaded.toDataset());
+    CHECK(single.comments == threaded.comments);
+}
+
+TEST_CASE("SpeckLoader: Threaded Parsing Error", "[speckloader]") {
+    std::filesystem::path path = writeFile(
+        "test_speckloader_threadederror.speck",
+        largeSpeckFile(100000) + "1 2 3 abc 4\n" + largeSpeckFile(10)
+    );
+
+    // The error has to be reported for the same line regardless of the chunk in which
+    // it was encountered
+    auto errorMessage = [&path](int nThreads) -> std::string {
+        try {
+            data::loadColumnarFile(path, SkipAllZeroLines::Yes, nThreads);
+            return "";
+        }
+        catch (const std::exception& e) {
+            return e.what();
+        }
+    };
+    const std::string single = errorMessage(1);
+    const std::string threaded = errorMessage(4);
+    std::filesystem::remove(path);
+
+    CHECK(single.find("data line 102977") != std::string::npos);
+    CHECK(single == threaded);
+}
+
+TEST_CASE("SpeckLoader: Threaded Label Parsing", "[speckloader]") {
+    std::string content = "textcolor 1\n\n";
+    for (int i = 0; i < 50000; i++) {
+        content += std::to_string(i) + " +1 -2.5 ";
+        content += (i % 3 == 0) ? "id l" + std::to_string(i) + " " : "";
+        content += "text Label " + std::to_string(i) + " # comment\n";
+    }
+    std::filesystem::path path = writeFile("test_speckloader_threaded.label", content);
+    Labelset single = label::loadFile(path, SkipAllZeroLines::Yes, 1);
+    Labelset threaded = label::loadFile(path, SkipAllZeroLines::Yes, 4);
+    std::filesystem::remove(path);
+
+    CHECK(single.textColorIndex == 1);
+    REQUIRE(single.entries.size() == 50000);
+    CHECK(single.entries[3].position == glm::vec3(3.f, 1.f, -2.5f));
+    CHECK(single.entries[3].identifier == "l3");
+    CHECK(single.entries[3].text == "Label 3");
+    REQUIRE(threaded.entries.size() == single.entries.size());
+    for (size_t i = 0; i < single.entries.size(); i++) {
+        CHECK(single.entries[i].position == threaded.entries[i].position);
+        CHECK(single.entries[i].identifier == threaded.entries[i].identifier);
+        CHECK(single.entries[i].text == threaded.entries[i].text);
+    }
+}
+
+#endif // OPENSPACE_MODULE_SPACE_ENABLED
@@ -0,0 +1,201 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2023                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <modules/globebrowsing/src/rawtile.h>
+#include <modules/globebrowsing/src/tilediskcache.h>
+#include <modules/globebrowsing/src/tileindex.h>
+#include <modules/globebrowsing/src/tiletextureinitdata.h>
+#include <cstring>
+#include <filesystem>
+#include <vector>
+
+using namespace openspace::globebrowsing;
+
+namespace {
+    constexpr uint64_t LayerHash = 0x1234;
+
+    RawTile createTile(const TileTextureInitData& initData, const TileIndex& tileIndex) {
+        RawTile tile;
+        tile.imageData = std::unique_ptr<std::byte[]>(
+            new std::byte[initData.totalNumBytes]
+        );
+        for (size_t i = 0; i < initData.totalNumBytes; i++) {
+            tile.imageData[i] = static_cast<std::byte>((i * 7 + tileIndex.x) % 251);
+        }
+        tile.tileMetaData.maxValues = { 1.f, 2.f, 3.f, 4.f };
+        tile.tileMetaData.minValues = { -1.f, -2.f, -3.f, -4.f };
+        tile.tileMetaData.hasMissingData = { false, true, false, true };
+        tile.tileMetaData.nValues = 1;
+        tile.textureInitData = initData;
+        tile.tileIndex = tileIndex;
+        return tile;
+    }
+
+    std::filesystem::path cacheFolder(std::string_view name) {
+        std::filesystem::path path = std::filesystem::temp_directory_path() / name;
+        std::filesystem::remove_all(path);
+        return path;
+    }
+} // namespace
+
+TEST_CASE("TileDiskCache: Round Trip", "[tilediskcache]") {
+    const std::filesystem::path root = cacheFolder("openspace_test_tilediskcache");
+    const TileTextureInitData initData = tileTextureInitData(
+        layers::Group::ID::HeightLayers,
+        64
+    );
+    const RawTile tile = createTile(initData, TileIndex(3, 1, 2));
+
+    {
+        cache::TileDiskCache cache(root, 1024 * 1024 * 1024);
+        CHECK_FALSE(cache.get(LayerHash, tile.tileIndex, initData).has_value());
+        cache.put(LayerHash, tile);
+        CHECK(cache.size() > initData.totalNumBytes);
+    }
+
+    // The tile has to survive a restart of the cache
+    cache::TileDiskCache cache(root, 1024 * 1024 * 1024);
+    std::optional<RawTile> cached = cache.get(LayerHash, tile.tileIndex, initData);
+    REQUIRE(cached.has_value());
+    CHECK(cached->error == RawTile::ReadError::None);
+    CHECK(cached->tileIndex == tile.tileIndex);
+    CHECK(
+        std::memcmp(
+            cached->imageData.get(),
+            tile.imageData.get(),
+            initData.totalNumBytes
+        ) == 0
+    );
+    CHECK(cached->tileMetaData.maxValues == tile.tileMetaData.maxValues);
+    CHECK(cached->tileMetaData.minValues == tile.tileMetaData.minValues);
+    CHECK(cached->tileMetaData.hasMissingData == tile.tileMetaData.hasMissingData);
+    CHECK(cached->tileMetaData.nValues == tile.tileMetaData.nValues);
+
+    // Other layers and other texture formats don't share the tile
+    CHECK_FALSE(cache.get(LayerHash + 1, tile.tileIndex, initData).has_value());
+    const TileTextureInitData otherInitData = tileTextureInitData(
+        layers::Group::ID::ColorLayers,
+        64
+    );
+    CHECK_FALSE(cache.get(LayerHash, tile.tileIndex, otherInitData).has_value());
+
+    // No temporary files are left behind
+    for (const auto& e : std::filesystem::recursive_directory_iterator(root)) {
+        CHECK(e.path().extension() != ".tmp");
+    }
+
+    cache.clear();
+    CHECK(cache.size() == 0);
+    CHECK_FALSE(cache.get(LayerHash, tile.tileIndex, initData).has_value());
+    std::filesystem::remove_all(root);
+}
+
+TEST_CASE("TileDiskCache: Eviction", "[tilediskcache]") {
+    const std::filesystem::path root = cacheFolder("openspace_test_tilediskcache_lru");
+    const TileTextureInitData initData = tileTextureInitData(
+        layers::Group::ID::HeightLayers,
+        64
+    );
+    const RawTile first = createTile(initData, TileIndex(0, 0, 1));
+    const RawTile second = createTile(initData, TileIndex(1, 0, 1));
+    const RawTile third = createTile(initData, TileIndex(0, 0, 2));
+
+    // Determine the size of a single tile on disk to size the cache for two tiles
+    size_t tileSize = 0;
+    {
+        cache::TileDiskCache cache(root, 1024 * 1024 * 1024);
+        cache.put(LayerHash, first);
+        tileSize = cache.size();
+        cache.clear();
+    }
+    REQUIRE(tileSize > 0);
+
+    cache::TileDiskCache cache(root, 2 * tileSize + tileSize / 2);
+    cache.put(LayerHash, first);
+    cache.put(LayerHash, second);
+    CHECK(cache.size() == 2 * tileSize);
+
+    // Accessing the first tile makes the second one the least recently used
+    CHECK(cache.get(LayerHash, first.tileIndex, initData).has_value());
+    cache.put(LayerHash, third);
+    CHECK(cache.size() == 2 * tileSize);
+    CHECK(cache.get(LayerHash, first.tileIndex, initData).has_value());
+    CHECK_FALSE(cache.get(LayerHash, second.tileIndex, initData).has_value());
+    CHECK(cache.get(LayerHash, third.tileIndex, initData).has_value());
+
+    // Writing the same tile again does not count its size twice
+    cache.put(LayerHash, third);
+    CHECK(cache.size() == 2 * tileSize);
+
+    // A cache with a smaller maximum size evicts the old tiles when it is created
+    cache::TileDiskCache smallCache(root, tileSize);
+    CHECK(smallCache.size() == tileSize);
+
+    smallCache.clear();
+    std::filesystem::remove_all(root);
+}
+
+TEST_CASE("TileDiskCache: Missing And Truncated Files", "[tilediskcache]") {
+    const std::filesystem::path root = cacheFolder("openspace_test_tilediskcache_broken");
+    const TileTextureInitData initData = tileTextureInitData(
+        layers::Group::ID::HeightLayers,
+        64
+    );
+    const RawTile first = createTile(initData, TileIndex(0, 0, 1));
+    const RawTile second = createTile(initData, TileIndex(1, 0, 1));
+
+    cache::TileDiskCache cache(root, 1024 * 1024 * 1024);
+    cache.put(LayerHash, first);
+    const size_t tileSize = cache.size();
+    cache.put(LayerHash, second);
+    REQUIRE(cache.size() == 2 * tileSize);
+
+    std::vector<std::filesystem::path> files;
+    for (const auto& e : std::filesystem::recursive_directory_iterator(root)) {
+        if (e.is_regular_file()) {
+            files.push_back(e.path());
+        }
+    }
+    REQUIRE(files.size() == 2);
+
+    // A file that was removed behind the back of the cache is no longer counted
+    std::filesystem::remove(files[0]);
+    // A truncated file is a miss and is removed as well
+    std::filesystem::resize_file(files[1], tileSize / 2);
+
+    CHECK_FALSE(cache.get(LayerHash, first.tileIndex, initData).has_value());
+    CHECK_FALSE(cache.get(LayerHash, second.tileIndex, initData).has_value());
+    CHECK(cache.size() == 0);
+    CHECK_FALSE(std::filesystem::exists(files[1]));
+
+    // The tiles can be cached again afterwards
+    cache.put(LayerHash, first);
+    CHECK(cache.size() == tileSize);
+    CHECK(cache.get(LayerHash, first.tileIndex, initData).has_value());
+
+    cache.clear();
+    std::filesystem::remove_all(root);
+}
@@ -0,0 +1,156 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2023                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <modules/globebrowsing/src/tilejobscheduler.h>
+#include <atomic>
+#include <future>
+#include <latch>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace openspace::globebrowsing;
+
+// The state that is shared with the jobs is declared before the scheduler in these tests,
+// so that the scheduler has joined its workers before the state is destroyed
+
+TEST_CASE("TileJobScheduler: Priorities", "[tilejobscheduler]") {
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::latch started(1);
+    std::mutex orderMutex;
+    std::vector<uint64_t> order;
+    std::latch finished(4);
+
+    TileJobScheduler scheduler(1);
+    std::shared_ptr<TileJobScheduler::Client> client = scheduler.createClient(1);
+
+    // Occupy the only worker until all other jobs are enqueued
+    scheduler.enqueue(
+        client,
+        0,
+        TileJobScheduler::Priority::Regular,
+        [&]() {
+            started.count_down();
+            released.wait();
+        },
+        nullptr
+    );
+    started.wait();
+
+    auto job = [&](uint64_t key) {
+        return [&, key]() {
+            {
+                std::lock_guard lock(orderMutex);
+                order.push_back(key);
+            }
+            finished.count_down();
+        };
+    };
+    using Priority = TileJobScheduler::Priority;
+    scheduler.enqueue(client, 1, Priority::Low, job(1), nullptr);
+    scheduler.enqueue(client, 2, Priority::Regular, job(2), nullptr);
+    scheduler.enqueue(client, 3, Priority::Regular, job(3), nullptr);
+    scheduler.enqueue(client, 4, Priority::Low, job(4), nullptr);
+
+    // Bumping moves the job to the front of the queue of the new priority
+    CHECK(scheduler.bump(*client, 2, Priority::Regular));
+    CHECK(scheduler.bump(*client, 1, Priority::Regular));
+    CHECK_FALSE(scheduler.bump(*client, 5, Priority::Regular));
+
+    release.set_value();
+    finished.wait();
+
+    CHECK(order == std::vector<uint64_t>{ 1, 2, 3, 4 });
+}
+
+TEST_CASE("TileJobScheduler: Client Concurrency", "[tilejobscheduler]") {
+    std::atomic_int nRunning = 0;
+    std::atomic_int maxRunning = 0;
+    std::latch finished(16);
+
+    TileJobScheduler scheduler(4);
+    std::shared_ptr<TileJobScheduler::Client> limited = scheduler.createClient(1);
+    std::shared_ptr<TileJobScheduler::Client> other = scheduler.createClient(4);
+
+    for (uint64_t i = 0; i < 8; i++) {
+        scheduler.enqueue(
+            limited,
+            i,
+            TileJobScheduler::Priority::Regular,
+            [&]() {
+                const int n = ++nRunning;
+                int m = maxRunning;
+                while (n > m && !maxRunning.compare_exchange_weak(m, n)) {}
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                nRunning--;
+                finished.count_down();
+            },
+            nullptr
+        );
+        scheduler.enqueue(
+            other,
+            i,
+            TileJobScheduler::Priority::Regular,
+            [&]() { finished.count_down(); },
+            nullptr
+        );
+    }
+    finished.wait();
+
+    CHECK(maxRunning == 1);
+}
+
+TEST_CASE("TileJobScheduler: Cancelled Jobs Are Executed", "[tilejobscheduler]") {
+    std::atomic_int nExecuted = 0;
+    std::atomic_int nCancelled = 0;
+    std::latch finished(1);
+
+    TileJobScheduler scheduler(2);
+    std::shared_ptr<TileJobScheduler::Client> client = scheduler.createClient(2);
+
+    // Cancelled jobs are still executed so that their owner can account for them, but
+    // they are expected to finish early
+    std::shared_ptr<CancellationToken> token = std::make_shared<CancellationToken>();
+    token->cancel();
+    scheduler.enqueue(
+        client,
+        0,
+        TileJobScheduler::Priority::Low,
+        [&, token]() {
+            nExecuted++;
+            if (token->isCancelled()) {
+                nCancelled++;
+            }
+            finished.count_down();
+        },
+        token
+    );
+    finished.wait();
+
+    CHECK(nExecuted == 1);
+    CHECK(nCancelled == 1);
+}
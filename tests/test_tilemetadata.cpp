@@ -0,0 +1,142 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2023                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <modules/globebrowsing/src/tilemetadata.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <random>
+#include <type_traits>
+
+namespace {
+    template <typename T>
+    constexpr GLenum glType() {
+        if constexpr (std::is_same_v<T, GLubyte>) { return GL_UNSIGNED_BYTE; }
+        if constexpr (std::is_same_v<T, GLshort>) { return GL_SHORT; }
+        if constexpr (std::is_same_v<T, GLint>) { return GL_INT; }
+        if constexpr (std::is_same_v<T, GLfloat>) { return GL_FLOAT; }
+        if constexpr (std::is_same_v<T, GLdouble>) { return GL_DOUBLE; }
+    }
+
+    // Straight-forward per-value implementation that the optimized version must match
+    template <typename T>
+    openspace::globebrowsing::TileMetaData reference(T* data, size_t nPixels,
+                                                     size_t nRasters, float noDataValue,
+                                                     bool& allIsMissing)
+    {
+        openspace::globebrowsing::TileMetaData res;
+        res.nValues = static_cast<uint8_t>(nRasters);
+        res.maxValues.fill(-std::numeric_limits<float>::max());
+        res.minValues.fill(std::numeric_limits<float>::max());
+        res.hasMissingData.fill(false);
+
+        allIsMissing = true;
+        for (size_t i = 0; i < nPixels * nRasters; i++) {
+            const size_t raster = i % nRasters;
+            const float v = static_cast<float>(data[i]);
+            if (v != noDataValue && !std::isnan(v)) {
+                res.minValues[raster] = std::min(res.minValues[raster], v);
+                res.maxValues[raster] = std::max(res.maxValues[raster], v);
+                allIsMissing = false;
+            }
+            else {
+                res.hasMissingData[raster] = true;
+                data[i] = std::numeric_limits<T>::lowest();
+            }
+        }
+        return res;
+    }
+
+    template <typename T>
+    void compareWithReference(size_t nPixels, size_t nRasters, double missingRatio,
+                              unsigned int seed)
+    {
+        constexpr float NoData = 100.f;
+
+        std::mt19937 gen(seed);
+        std::uniform_int_distribution<int> values(0, 120);
+        std::bernoulli_distribution missing(missingRatio);
+
+        const size_t n = nPixels * nRasters;
+        std::unique_ptr<T[]> data = std::make_unique<T[]>(n);
+        for (size_t i = 0; i < n; i++) {
+            data[i] = missing(gen) ? static_cast<T>(NoData) : static_cast<T>(values(gen));
+            if constexpr (std::is_floating_point_v<T>) {
+                if (missing(gen)) {
+                    data[i] = std::numeric_limits<T>::quiet_NaN();
+                }
+            }
+        }
+        std::unique_ptr<T[]> expectedData = std::make_unique<T[]>(n);
+        std::memcpy(expectedData.get(), data.get(), n * sizeof(T));
+
+        bool expectedAllIsMissing = false;
+        const openspace::globebrowsing::TileMetaData expected = reference(
+            expectedData.get(),
+            nPixels,
+            nRasters,
+            NoData,
+            expectedAllIsMissing
+        );
+
+        bool allIsMissing = false;
+        const openspace::globebrowsing::TileMetaData res =
+            openspace::globebrowsing::calculateTileMetaData(
+                reinterpret_cast<std::byte*>(data.get()),
+                nPixels,
+                glType<T>(),
+                nRasters,
+                NoData,
+                allIsMissing
+            );
+
+        CHECK(res.nValues == expected.nValues);
+        CHECK(allIsMissing == expectedAllIsMissing);
+        for (size_t r = 0; r < nRasters; r++) {
+            CHECK(res.minValues[r] == expected.minValues[r]);
+            CHECK(res.maxValues[r] == expected.maxValues[r]);
+            CHECK(res.hasMissingData[r] == expected.hasMissingData[r]);
+        }
+        CHECK(std::memcmp(data.get(), expectedData.get(), n * sizeof(T)) == 0);
+    }
+} // namespace
+
+TEMPLATE_TEST_CASE("TileMetaData: Random Tiles", "[tilemetadata]",
+                   GLubyte, GLshort, GLint, GLfloat, GLdouble)
+{
+    unsigned int seed = 1;
+    for (size_t nRasters = 1; nRasters <= 4; nRasters++) {
+        // 64x64 tiles fill complete blocks, the odd size also exercises the remainder
+        for (size_t nPixels : { size_t(64 * 64), size_t(33 * 31) }) {
+            compareWithReference<TestType>(nPixels, nRasters, 0.0, seed++);
+            compareWithReference<TestType>(nPixels, nRasters, 0.1, seed++);
+            compareWithReference<TestType>(nPixels, nRasters, 1.0, seed++);
+        }
+    }
+}
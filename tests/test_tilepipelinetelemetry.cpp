@@ -0,0 +1,110 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2023                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <modules/globebrowsing/src/tilepipelinetelemetry.h>
+
+using namespace openspace::globebrowsing;
+using std::chrono::microseconds;
+
+TEST_CASE("LatencyHistogram: Empty", "[tilepipelinetelemetry]") {
+    LatencyHistogram h;
+    CHECK(h.count() == 0);
+    CHECK(h.percentile(0.5f) == 0.f);
+    CHECK(h.percentile(0.99f) == 0.f);
+}
+
+TEST_CASE("LatencyHistogram: Buckets", "[tilepipelinetelemetry]") {
+    LatencyHistogram h;
+    h.add(microseconds(0));
+    h.add(microseconds(1));
+    h.add(microseconds(2));
+    h.add(microseconds(3));
+    h.add(microseconds(1000));
+
+    CHECK(h.count() == 5);
+    CHECK(h.buckets()[0] == 1);
+    CHECK(h.buckets()[1] == 1);
+    CHECK(h.buckets()[2] == 2);
+    // 1000us is in [512, 1024)
+    CHECK(h.buckets()[10] == 1);
+    CHECK(LatencyHistogram::bucketUpperBound(10) == 1024);
+}
+
+TEST_CASE("LatencyHistogram: Out of range", "[tilepipelinetelemetry]") {
+    LatencyHistogram h;
+    h.add(microseconds(-5));
+    h.add(std::chrono::hours(24));
+
+    CHECK(h.buckets()[0] == 1);
+    CHECK(h.buckets()[LatencyHistogram::NumBuckets - 1] == 1);
+}
+
+TEST_CASE("LatencyHistogram: Percentile", "[tilepipelinetelemetry]") {
+    LatencyHistogram h;
+    for (int i = 0; i < 98; i++) {
+        h.add(microseconds(100));
+    }
+    h.add(microseconds(5000));
+    h.add(microseconds(5000));
+
+    // 100us is in [64, 128), 5000us is in [4096, 8192)
+    CHECK(h.percentile(0.f) == Catch::Approx(0.128f));
+    CHECK(h.percentile(0.5f) == Catch::Approx(0.128f));
+    CHECK(h.percentile(0.9f) == Catch::Approx(0.128f));
+    CHECK(h.percentile(0.99f) == Catch::Approx(8.192f));
+    CHECK(h.percentile(1.f) == Catch::Approx(8.192f));
+}
+
+TEST_CASE("TilePipelineCounters: Merge", "[tilepipelinetelemetry]") {
+    TilePipelineCounters a;
+    a.enqueued = 10;
+    a.inFlight = 2;
+    a.completed = 7;
+    a.dropped = 1;
+    a.cacheHits = 100;
+    a.cacheMisses = 10;
+    a.readTime.add(microseconds(100));
+
+    TilePipelineCounters b;
+    b.enqueued = 5;
+    b.inFlight = 1;
+    b.completed = 4;
+    b.cacheHits = 3;
+    b.readTime.add(microseconds(100));
+    b.decodeTime.add(microseconds(10));
+
+    a.merge(b);
+    CHECK(a.enqueued == 15);
+    CHECK(a.inFlight == 3);
+    CHECK(a.completed == 11);
+    CHECK(a.dropped == 1);
+    CHECK(a.cacheHits == 103);
+    CHECK(a.cacheMisses == 10);
+    CHECK(a.readTime.count() == 2);
+    CHECK(a.readTime.buckets()[7] == 2);
+    CHECK(a.decodeTime.count() == 1);
+}